@@ -146,5 +146,44 @@ int BitStreamReaderMSB::Peek(int bitLoc, int numBits)
   return(b);
 }//end Peek.
 
+/** Skip bits in the stream.
+Move the current stream position on without reading.
+@param numBits	: No. of bits to skip.
+@return					: none.
+*/
+void BitStreamReaderMSB::Skip(int numBits)
+{
+	int pos = (_bytePos << 3) + (7 - _bitPos) + numBits;
+	_bytePos	= pos >> 3;
+	_bitPos		= 7 - (pos & 7);
+}//end Skip.
+
+/** Count the leading zero bits.
+Count the zero bits from the current stream position up to the next 1
+bit without disturbing the current stream position.
+@param maxBits	: Max no. of bits to count [1..32].
+@return					: No. of zero bits limited to maxBits.
+*/
+int BitStreamReaderMSB::CountLeadingZeros(int maxBits)
+{
+  int bytePos = _bytePos;
+  int bitPos	= _bitPos;
+	int count		= 0;
+
+	while( (count < maxBits)&&(((_bitStream[bytePos] >> bitPos) & 1) == 0) )
+	{
+		count++;
+    if(bitPos > 0)
+      bitPos--;
+		else
+    {
+      bitPos = 7;
+      bytePos++;
+    }//end else...
+	}//end while count...
+
+	return(count);
+}//end CountLeadingZeros.
+
 
 
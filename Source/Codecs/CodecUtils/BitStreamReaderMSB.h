@@ -84,6 +84,24 @@ public:
 	*/
 	int Peek(int bitLoc, int numBits);
 
+	/** Peek the next bits in the stream.
+	@param numBits	: No. of bits to read [0..32].
+	@return					: The code.
+	*/
+	int PeekNext(int numBits) { return(Peek(BitStreamBaseMSB::GetStreamBitPos(), numBits)); }
+
+	/** Skip bits in the stream.
+	@param numBits	: No. of bits to skip.
+	@return					: none.
+	*/
+	void Skip(int numBits);
+
+	/** Count the leading zero bits from the current stream position.
+	@param maxBits	: Max no. of bits to count [1..32].
+	@return					: No. of zero bits limited to maxBits.
+	*/
+	int CountLeadingZeros(int maxBits);
+
 ///	Use base class implementations.
 public:
 	void SetStream(void* stream, int bitSize) { BitStreamBaseMSB::SetStream(stream, bitSize); }	
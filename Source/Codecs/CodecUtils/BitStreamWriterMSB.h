@@ -93,6 +93,20 @@ public:
       Write(numBits, valL);
   }//end Write.
 
+	/** Write whole bytes to the stream.
+	Write a pre-encoded byte array into the current stream position
+	with the first byte written first.
+	@param pBytes		: Bytes to write.
+	@param numBytes	: No. of bytes to write.
+	@return					: none.
+	*/
+	void WriteBytes(const void* pBytes, int numBytes)
+  {
+    const unsigned char* p = (const unsigned char *)pBytes;
+    for(int i = 0; i < numBytes; i++)
+      Write(8, p[i]);
+  }//end WriteBytes.
+
 	/** Poke bits to the stream.
 	Write multiple bits from the most significant bit downwards
 	into the specified stream position without disturbing the
@@ -43,6 +43,74 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IBitStreamWriter.h"
 #include "CAVLCH264Impl.h"
 
+/*
+---------------------------------------------------------------------------
+	Local helpers.
+---------------------------------------------------------------------------
+*/
+/** Split a level code into its level prefix and suffix.
+@param levelCode				: Level code to split.
+@param suffixLength			: Current suffix length context.
+@param levelSuffix			: Returned suffix bits.
+@param levelSuffixSize	: Returned num of suffix bits.
+@return									: The level prefix.
+*/
+static int CAVLCH264I_LevelPrefix(int levelCode, int suffixLength, int* levelSuffix, int* levelSuffixSize)
+{
+	int levelPrefix;
+
+	/// Use levelPrefix = 14 as an ESC code for 1st trailing large 
+	/// levels from 14 - 29 range.
+	if( (suffixLength == 0)&&(levelCode >= 14)&&(levelCode <= 29) )
+	{
+		*levelSuffixSize	= 4;
+		*levelSuffix			= (levelCode - 14) & 0x0000000F;
+		return(14);
+	}//end if !suffixLength...
+
+	/// Max possible levelCode with this suffixLength and 
+	/// levelPrefix less than 15.
+	int maxLevelCode = (14 << suffixLength) + ~(0xFFFFFFFF << suffixLength);
+
+	/// Extract level prefix and suffix from the levelCode.
+	if(levelCode <= maxLevelCode)
+	{
+		*levelSuffixSize	= suffixLength;
+		*levelSuffix			= levelCode & ~(0xFFFFFFFF << suffixLength);
+		return(levelCode >> suffixLength);
+	}//end if encLevelCode...
+
+	/// Large code levels. Entering here the levelCode is always greater than the level 
+	/// associated with a max prefix = 15 therefore it can be subtracted to promote 
+	/// smaller levels.
+	levelCode -= (15 << suffixLength);
+	/// For a suffixLength of zero the max levelCode can be further 
+	/// reduced by 15 as levelCodes less than 30 are catered for by
+	/// the ESC code with LevelPrefix = 14 described above.
+	if(suffixLength == 0)
+		levelCode -= 15;
+	/// The levelPrefix to set defines the range between octaves in
+	/// the following way:
+	///	LevelPrefix		Range (2^(levelPrefix-3)) offset by (2^x - 1)(2^12)
+	///	15						0..((2^12)-1)
+	///	16												2^12..((2^13)+(2^12)-1)
+	///	17																							((2^13)+(2^12))..((2^14)+(2^12)-1)
+	///	etc.
+	/// Note that the min value for each range can be subtracted to save
+	/// 1 bit per range.
+	levelPrefix = 15;
+	/// Iterate the levelPrefix by checking if levelCode is larger than the min
+	/// levelCode for the next larger range. Put a hard limit max bit size to 32 (= 35 - 3).
+	while((levelCode >= ((1 << (levelPrefix-2)) - 4096))&&(levelPrefix < 35))
+		levelPrefix++;
+	if(levelPrefix >= 16)
+		levelCode -= (1 << (levelPrefix-3)) - 4096;	///< Reduce by min value for this range.
+
+	*levelSuffixSize	= levelPrefix - 3;
+	*levelSuffix			= levelCode & ~(0xFFFFFFFF << (levelPrefix - 3));
+	return(levelPrefix);
+}//end CAVLCH264I_LevelPrefix.
+
 /*
 ---------------------------------------------------------------------------
 	Constants.
@@ -100,6 +168,8 @@ CAVLCH264Impl::CAVLCH264Impl(void)
 	_pRunBeforeVlcEncoder		= NULL;;
 	_pRunBeforeVlcDecoder		= NULL;;
 
+	_lenTablesReady					= 0;
+
 }//end constructor.
 
 CAVLCH264Impl::~CAVLCH264Impl(void)
@@ -114,7 +184,7 @@ CAVLCH264Impl::~CAVLCH264Impl(void)
 /** Encode the input to a CAVLC bit stream.
 Encode the input 2-D block of IT coeffs into the output run-level bit stream. 
 A NULL stream will switch the encoder to count the number of bits used without 
-writing to stream. Error codes are:
+writing to stream (see CountBits()). Error codes are:
 	-1 = Vlc error (no such symbol).
 	-2 = Stream is full.
 @param in		:	Input block to encode.
@@ -127,6 +197,9 @@ int CAVLCH264Impl::Encode(void* in, void* stream)
 	short*						coeffLevel	= (short *)in;
 	IBitStreamWriter*	pBsw				= (IBitStreamWriter *)stream;
 
+	if( (pBsw == NULL)&&(_maxNumCoeff <= 16) )
+		return(CountBits(in));
+
 	int totalEncBits = 0;
 	int level[64]; ///< Max size is for 8x8.
 	int runBefore[64];
@@ -248,67 +321,8 @@ int CAVLCH264Impl::Encode(void* in, void* stream)
 					levelCode -= 2;
 
 				/// Determine the prefix, suffix length & level code before writing to the stream.
-				int done						= 0;
-				int levelPrefix			= 0;
-				int levelSuffix			= 0;
-				int levelSuffixSize = suffixLength;
-				/// Use levelPrefix = 14 as an ESC code for 1st trailing large 
-				/// levels from 14 - 29 range.
-				if(suffixLength == 0)
-				{
-					if((levelCode >= 14)&&(levelCode <= 29))
-					{
-						levelSuffixSize = 4;
-						levelSuffix			= (levelCode - 14) & 0x0000000F;
-						levelPrefix			= 14;
-						done						= 1;	///< Early exit.
-					}//end if encLevelCode...
-				}//end if !suffixLength...
-
-				if(!done)
-				{
-					/// Max possible levelCode with this suffixLength and 
-					/// levelPrefix less than 15.
-					int maxLevelCode = (14 << suffixLength) + ~(0xFFFFFFFF << suffixLength);
-
-					/// Extract level prefix and suffix from the levelCode.
-					if(levelCode <= maxLevelCode)
-					{
-						levelPrefix = levelCode >> suffixLength;
-						levelSuffix = levelCode & ~(0xFFFFFFFF << suffixLength);
-					}//end if encLevelCode...
-					else	///< Large code levels.
-					{
-						/// Entering here the levelCode is always greater than the level 
-						/// associated with a max prefix = 15 therefore it can be subtracted 
-						/// to promote smaller levels.
-						levelCode -= (15 << suffixLength);
-						/// For a suffixLength of zero the max levelCode can be further 
-						/// reduced by 15 as levelCodes less than 30 are catered for by
-						/// the ESC code with LevelPrefix = 14 described above.
-						if(suffixLength == 0)
-							levelCode -= 15;
-						/// The levelPrefix to set defines the range between octaves in
-						/// the following way:
-						///	LevelPrefix		Range (2^(levelPrefix-3)) offset by (2^x - 1)(2^12)
-						///	15						0..((2^12)-1)
-						///	16												2^12..((2^13)+(2^12)-1)
-						///	17																							((2^13)+(2^12))..((2^14)+(2^12)-1)
-						///	etc.
-						/// Note that the min value for each range can be subtracted to save
-						/// 1 bit per range.
-						levelPrefix = 15;
-						/// Iterate the levelPrefix by checking if levelCode is larger than the min
-						/// levelCode for the next larger range. Put a hard limit max bit size to 32 (= 35 - 3).
-						while((levelCode >= ((1 << (levelPrefix-2)) - 4096))&&(levelPrefix < 35))
-							levelPrefix++;
-						if(levelPrefix >= 16)
-							levelCode -= (1 << (levelPrefix-3)) - 4096;	///< Reduce by min value for this range.
-
-						levelSuffixSize = levelPrefix - 3;
-						levelSuffix			= levelCode & ~(0xFFFFFFFF << levelSuffixSize);
-					}//end else...
-				}//end if !done...
+				int levelSuffix, levelSuffixSize;
+				int levelPrefix = CAVLCH264I_LevelPrefix(levelCode, suffixLength, &levelSuffix, &levelSuffixSize);
 
 				/// Write the level_prefix and V to the bit stream.
 				lclNumBits = _pPrefixVlcEncoder->Encode(levelPrefix);
@@ -387,6 +401,128 @@ int CAVLCH264Impl::Encode(void* in, void* stream)
 	return(totalEncBits);
 }//end Encode.
 
+/** Count the bits to encode the input.
+The same context-aware variables as for Encode() are extracted from the input 
+block and the code lengths are looked up in the tables that are built from the 
+attached vlc encoders. Error codes are:
+	-1 = Vlc error (no such symbol).
+@param in		:	Input block to count.
+@return			: Total num of bits. Negative values for errors.
+*/
+int CAVLCH264Impl::CountBits(void* in)
+{
+	short* coeffLevel = (short *)in;
+
+	int level[16];
+	int runBefore[16];
+	int totalCoeff		= 0;
+	int trailingOnes	= 0;
+	int totalZeros		= 0;
+	int count					= 0;
+	int i;
+
+	if(!_lenTablesReady)
+		BuildLenTables();
+
+	/// Scan the input in reverse zigzag order. The zeros after the last non-zero 
+	/// coeff are ignored.
+	for(i = (_maxNumCoeff-1); i >= _dcSkip; i--)
+	{
+		int x = coeffLevel[_zigZag[i]];
+		if(x == 0)
+		{
+			if(totalCoeff > 0)
+				count++;
+			continue;
+		}//end if x...
+
+		if(totalCoeff > 0)
+		{
+			runBefore[totalCoeff-1] = count;
+			totalZeros += count;
+			count = 0;
+		}//end if totalCoeff...
+		level[totalCoeff++] = x;
+		/// Only 3 trailing ones with no non-one values in-between.
+		if( (trailingOnes < 3)&&(trailingOnes == (totalCoeff-1))&&((x == 1)||(x == -1)) )
+			trailingOnes++;
+	}//end for i...
+	totalZeros += count;	///< Zeros at the head (low freq) end.
+
+	/// Select the coeff_token table with the neighbourhood total coeffs.
+	int nC = 3;
+	if(_numTotNeighborCoeff < 0)
+		nC = (_numTotNeighborCoeff == -1)? 4 : 5;
+	else if(_numTotNeighborCoeff < 2)
+		nC = 0;
+	else if(_numTotNeighborCoeff < 4)
+		nC = 1;
+	else if(_numTotNeighborCoeff < 8)
+		nC = 2;
+	int totalBits = _coeffTokenLen[nC][trailingOnes][totalCoeff];
+	if(totalBits == 0)
+		return(VLC_SYMBOL_NOT_RECOGNISED);
+
+	if(totalCoeff > 0)
+	{
+		/// A sign bit for each trailing one.
+		totalBits += trailingOnes;
+
+		int suffixLength	= 0;
+		if((totalCoeff > 10) && (trailingOnes < 3))
+			suffixLength = 1;
+
+		for(i = trailingOnes; i < totalCoeff; i++)
+		{
+			int absLevel	= level[i];
+			int levelCode	= (2*absLevel) - 2;	///< + is even.
+			if(absLevel < 0)
+			{
+				absLevel	= -absLevel;
+				levelCode = (2*absLevel) - 1;		///< - is odd.
+			}//end if absLevel...
+			if((i == trailingOnes) && (trailingOnes < 3))
+				levelCode -= 2;
+
+			if(levelCode < CAVLCH264I_LEVEL_LEN_TABLE)
+				totalBits += _levelLen[suffixLength][levelCode];
+			else
+				totalBits += GetLevelCodeLen(levelCode, suffixLength);
+
+			if(suffixLength == 0)
+				suffixLength = 1;
+			if((absLevel > (3 << (suffixLength-1))) && (suffixLength < 6))
+				suffixLength++;
+		}//end for i...
+
+		if(totalCoeff < (_maxNumCoeff - _dcSkip))	///< i.e. there are some zeros.
+		{
+			int lclNumBits = _totalZerosLen[totalZeros][totalCoeff];
+			if(lclNumBits == 0)
+				return(VLC_SYMBOL_NOT_RECOGNISED);
+			totalBits += lclNumBits;
+
+			int zerosLeft = totalZeros;
+			for(i = 0; (i < (totalCoeff-1)) && zerosLeft; i++)
+			{
+				int zl = zerosLeft;
+				if(zl > 6)
+					zl = 7;
+				lclNumBits = _runBeforeLen[runBefore[i]][zl];
+				if(lclNumBits == 0)
+					return(VLC_SYMBOL_NOT_RECOGNISED);
+				totalBits += lclNumBits;
+				zerosLeft -= runBefore[i];
+			}//end for i...
+		}//end if totalCoeff...
+	}//end if totalCoeff...
+
+	/// Store total coeffs for this count session.
+	_numCoeff = totalCoeff;
+
+	return(totalBits);
+}//end CountBits.
+
 /** Decode a CAVLC bit stream to the output.
 Decode the input run-level bit stream into the output 2-D block of IT coeffs. It
 is unknown how many bits will come off the stream for the next read so the error
@@ -569,6 +705,64 @@ int CAVLCH264Impl::Decode(void* stream, void* out)
 	return(totalDecBits);
 }//end Decode.
 
+/** Build the code length tables.
+Each table entry is the length returned by the attached vlc encoder for that 
+symbol combination. Only the combinations that are valid for the mode are 
+encoded and the remaining entries are set to zero.
+@return	: none.
+*/
+void CAVLCH264Impl::BuildLenTables(void)
+{
+	static const int nCSymbol[6]	= { 0, 2, 4, 8, -1, -2 };
+	static const int nCMaxCoeff[6]	= { 16, 16, 16, 16, 4, 8 };
+	int i, j, k;
+
+	memset((void *)_coeffTokenLen, 0, sizeof(_coeffTokenLen));
+	memset((void *)_totalZerosLen, 0, sizeof(_totalZerosLen));
+	memset((void *)_runBeforeLen, 0, sizeof(_runBeforeLen));
+
+	/// coeff_token for each neighbourhood table.
+	for(k = 0; k < 6; k++)
+		for(i = 0; i <= nCMaxCoeff[k]; i++)
+			for(j = 0; (j <= i)&&(j <= 3); j++)
+				_coeffTokenLen[k][j][i] = (unsigned char)_pCoeffTokenVlcEncoder->Encode3(i, j, nCSymbol[k]);
+
+	/// total_zeros depends on the block size. 
+	int maxNumCoeff = _maxNumCoeff;
+	if(maxNumCoeff > 16)
+		maxNumCoeff = 16;
+	for(i = 1; i < maxNumCoeff; i++)
+		for(j = 0; j <= (maxNumCoeff - i); j++)
+		{
+			if(j < 16)
+				_totalZerosLen[j][i] = (unsigned char)_pTotalZerosVlcEncoder->Encode2(j, i);
+		}//end for i & j...
+
+	/// run_before for zeros left = 1..6 and > 6.
+	for(i = 0; i < 15; i++)
+		for(j = 1; j < 8; j++)
+			_runBeforeLen[i][j] = (unsigned char)_pRunBeforeVlcEncoder->Encode2(i, j);
+
+	/// level_prefix and level_suffix for every suffix length.
+	for(k = 0; k <= 6; k++)
+		for(i = 0; i < CAVLCH264I_LEVEL_LEN_TABLE; i++)
+			_levelLen[k][i] = (unsigned char)GetLevelCodeLen(i, k);
+
+	_lenTablesReady = 1;
+}//end BuildLenTables.
+
+/** Get the code length of a level code.
+@param levelCode		: Level code to count.
+@param suffixLength	: Current suffix length context.
+@return							: Num of bits for the level prefix and suffix.
+*/
+int CAVLCH264Impl::GetLevelCodeLen(int levelCode, int suffixLength)
+{
+	int levelSuffix, levelSuffixSize;
+	int levelPrefix = CAVLCH264I_LevelPrefix(levelCode, suffixLength, &levelSuffix, &levelSuffixSize);
+	return(_pPrefixVlcEncoder->Encode(levelPrefix) + levelSuffixSize);
+}//end GetLevelCodeLen.
+
 /** Set the codec mode.
 The mode defines the block size choice in this implementation.
 @param mode	:	Block size selection defined by class consts.
@@ -597,6 +791,9 @@ void CAVLCH264Impl::SetMode(int mode)
 			_maxNumCoeff	= 16;
 			break;
 	}//end switch mode...
+
+	/// The total_zeros lengths depend on the block size.
+	_lenTablesReady = 0;
 }//end SetMode.
 
 /** Set the codec parameters.
@@ -9,7 +9,9 @@ FILE NAME			: CAVLCH264Impl.h
 DESCRIPTION		: A class to implement a CAVLC codec on the 2-D quantised 
 								integer transformed and quantised coeffs of a coded block 
 								as defined in the H.264 standard. It implements the 
-								IContextAwareRunLevelCodec interface.
+								IContextAwareRunLevelCodec interface. Encoding without a
+								stream counts the bits from code length tables that are
+								built from the attached vlc encoders.
 
 LICENSE	: GNU Lesser General Public License
 
@@ -40,6 +42,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IVlcEncoder.h"
 #include "IVlcDecoder.h"
 
+/*
+---------------------------------------------------------------------------
+	Class constants.
+---------------------------------------------------------------------------
+*/
+/// Level codes below this length are counted from a table.
+#define CAVLCH264I_LEVEL_LEN_TABLE 128
+
 /*
 ---------------------------------------------------------------------------
 	Class definition.
@@ -57,7 +67,7 @@ public:
 	Encode the input 2-D block of IT coeffs into the output 
 	run-level bit stream.
 	@param in		:	Input block to encode.
-	@param rle	:	Run-level encoded stream.
+	@param rle	:	Run-level encoded stream. NULL = count the bits only.
 	@return			: Total num of encoded bits. Negative values for errors.
 	*/
 	int Encode(void* in, void* stream);
@@ -86,15 +96,29 @@ public:
 	@param	vlc	: Vlc encoder reference.
 	@return			: None.
 	*/
-	void SetTokenCoeffVlcEncoder(IVlcEncoder* vlc)	{ _pCoeffTokenVlcEncoder = vlc; }
+	void SetTokenCoeffVlcEncoder(IVlcEncoder* vlc)	{ _pCoeffTokenVlcEncoder = vlc; _lenTablesReady = 0; }
 	void SetTokenCoeffVlcDecoder(IVlcDecoder* vlc)	{ _pCoeffTokenVlcDecoder = vlc; }
-	void SetPrefixVlcEncoder(IVlcEncoder* vlc)			{ _pPrefixVlcEncoder = vlc; }
+	void SetPrefixVlcEncoder(IVlcEncoder* vlc)			{ _pPrefixVlcEncoder = vlc; _lenTablesReady = 0; }
 	void SetPrefixVlcDecoder(IVlcDecoder* vlc)			{ _pPrefixVlcDecoder = vlc; }
-	void SetTotalZerosVlcEncoder(IVlcEncoder* vlc)	{ _pTotalZerosVlcEncoder = vlc; }
+	void SetTotalZerosVlcEncoder(IVlcEncoder* vlc)	{ _pTotalZerosVlcEncoder = vlc; _lenTablesReady = 0; }
 	void SetTotalZerosVlcDecoder(IVlcDecoder* vlc)	{ _pTotalZerosVlcDecoder = vlc; }
-	void SetRunBeforeVlcEncoder(IVlcEncoder* vlc)		{ _pRunBeforeVlcEncoder = vlc; }
+	void SetRunBeforeVlcEncoder(IVlcEncoder* vlc)		{ _pRunBeforeVlcEncoder = vlc; _lenTablesReady = 0; }
 	void SetRunBeforeVlcDecoder(IVlcDecoder* vlc)		{ _pRunBeforeVlcDecoder = vlc; }
 
+	/** Count the bits to encode the input.
+	The code lengths are looked up in tables and no code words are formed.
+	Only the 2x2 and 4x4 modes are supported.
+	@param in		:	Input block to count.
+	@return			: Total num of bits. Negative values for errors.
+	*/
+	int CountBits(void* in);
+
+protected:
+	/// Build the code length tables from the attached vlc encoders.
+	void BuildLenTables(void);
+	/// Code length of a level code for a suffix length without a table.
+	int	 GetLevelCodeLen(int levelCode, int suffixLength);
+
 /// Class constants.
 public:
 	static const int zigZag8x8Pos[64];
@@ -126,6 +150,15 @@ protected:
 	IVlcEncoder*	_pRunBeforeVlcEncoder;
 	IVlcDecoder*	_pRunBeforeVlcDecoder;
 
+	/// Code lengths of the attached vlc encoders for counting. A zero length is
+	/// not a valid symbol. The coeff token tables are selected by the neighbour
+	/// coeffs in the order nC = 0..1, 2..3, 4..7, >= 8, -1 and -2.
+	int						_lenTablesReady;
+	unsigned char	_coeffTokenLen[6][4][17];		///< [nC table][trailing ones][total coeffs].
+	unsigned char	_totalZerosLen[16][16];			///< [total zeros][total coeffs].
+	unsigned char	_runBeforeLen[15][8];				///< [run before][zeros left (> 6 = 7)].
+	unsigned char	_levelLen[7][CAVLCH264I_LEVEL_LEN_TABLE];	///< [suffix length][level code].
+
 	/// Test code.
 public:
 	static int TestLevelPrefixSuffix(void);
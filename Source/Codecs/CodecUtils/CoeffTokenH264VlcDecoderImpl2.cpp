@@ -0,0 +1,145 @@
+/** @file
+
+MODULE				: CoeffTokenH264VlcDecoderImpl2
+
+TAG						: CTH264VDI2
+
+FILE NAME			: CoeffTokenH264VlcDecoderImpl2.cpp
+
+DESCRIPTION		: A coeff token Vlc decoder implementation as defined in
+								H.264 Recommendation (03/2005) Table 9.2 page 200 that
+								resolves the trailing ones and total coeffs with table
+								lookups instead of a code tree. The tables are built from
+								the CoeffTokenH264VlcEncoder tables and decode identically
+								to CoeffTokenH264VlcDecoder. This implementation is 
+								implemented with an IVlcDecoder Interface.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include "CoeffTokenH264VlcDecoderImpl2.h"
+#include "CoeffTokenH264VlcEncoder.h"
+
+/*
+---------------------------------------------------------------------------
+	Construction and destruction.
+---------------------------------------------------------------------------
+*/
+CoeffTokenH264VlcDecoderImpl2::CoeffTokenH264VlcDecoderImpl2(void)
+{
+	_numCodeBits	= 0;
+
+	/// Build the tables from the encoder code words with a representative
+	/// neighbourhood total coeffs for each table.
+	static const int nC[6] = { 0, 2, 4, 8, -1, -2 };
+	CoeffTokenH264VlcEncoder enc;
+	int numBits[4*17];
+	int codeWord[4*17];
+	int symbol[4*17];
+
+	for(int t = 0; t < 6; t++)
+	{
+		int numCodes = 0;
+		for(int tOs = 0; tOs < 4; tOs++)
+		{
+			for(int tCs = 0; tCs < 17; tCs++)
+			{
+				/// The nC = -1 and -2 tables are shorter.
+				if( ((nC[t] == -1)&&(tCs > 4))||((nC[t] == -2)&&(tCs > 8)) )
+					continue;
+				numBits[numCodes]		= enc.Encode3(tCs, tOs, nC[t]);
+				codeWord[numCodes]	= enc.GetCode();
+				symbol[numCodes]		= (tCs << 2) | tOs;
+				numCodes++;
+			}//end for tCs...
+		}//end for tOs...
+		_table[t].Create(numBits, codeWord, symbol, numCodes, 8);
+	}//end for t...
+}//end constructor.
+
+CoeffTokenH264VlcDecoderImpl2::~CoeffTokenH264VlcDecoderImpl2(void)
+{
+}//end destructor.
+
+/*
+---------------------------------------------------------------------------
+	Interface Methods.
+---------------------------------------------------------------------------
+*/
+/** Decode total coeff - trailing ones - neighbour total coeffs symbols from the bit stream.
+The first 2 param symbols represent total coeffs and trailing ones are decoded from the stream. The 
+3rd symbol is the neighbourhood total coeffs that is an input to this method and is used to select
+the appropriate lookup table.
+@param bsr			: Bit stream to get from.
+@param symbol1	: Returned total coeffs for this block
+@param symbol2	: Returned num of trailing ones for this block
+@param symbol3	: Total num of coeffs in neighbourhood blocks
+@return					: Num of bits extracted.
+*/
+int	CoeffTokenH264VlcDecoderImpl2::Decode3(IBitStreamReader* bsr, int* symbol1, int* symbol2, int* symbol3)
+{
+	int numTotNeighborCoeff	= *symbol3;	///< Used as an input.
+	int t;
+
+	/// Select the table depending on the neighbourhood total number of coeffs.
+	switch(numTotNeighborCoeff)
+	{
+		case 0:
+		case 1:
+			t = 0;
+			break;
+		case 2:
+		case 3:
+			t = 1;
+			break;
+		case 4:
+		case 5:
+		case 6:
+		case 7:
+			t = 2;
+			break;
+		case -1:
+			t = 4;
+			break;
+		case -2:
+			t = 5;
+			break;
+		default:	///< Greater than or equal to 8.
+			t = 3;
+			break;
+	}//end switch numTotNeighborCoeff...
+
+	int token = 0;
+	_numCodeBits = _table[t].Decode(bsr, &token);
+
+	/// Load 'em up.
+	*symbol1 = token >> 2;
+	*symbol2 = token & 3;
+
+  return(_numCodeBits);
+}//end Decode3.
+
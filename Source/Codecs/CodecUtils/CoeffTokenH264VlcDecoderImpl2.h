@@ -0,0 +1,76 @@
+/** @file
+
+MODULE				: CoeffTokenH264VlcDecoderImpl2
+
+TAG						: CTH264VDI2
+
+FILE NAME			: CoeffTokenH264VlcDecoderImpl2.h
+
+DESCRIPTION		: A coeff token Vlc decoder implementation as defined in
+								H.264 Recommendation (03/2005) Table 9.2 page 200 that
+								resolves the trailing ones and total coeffs with table
+								lookups instead of a code tree. The tables are built from
+								the CoeffTokenH264VlcEncoder tables and decode identically
+								to CoeffTokenH264VlcDecoder. This implementation is 
+								implemented with an IVlcDecoder Interface.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifndef _COEFFTOKENH264VLCDECODERIMPL2_H
+#define _COEFFTOKENH264VLCDECODERIMPL2_H
+
+#pragma once
+
+#include "IVlcDecoder.h"
+#include "VlcDecodeTable.h"
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class CoeffTokenH264VlcDecoderImpl2 : public IVlcDecoder
+{
+public:
+	CoeffTokenH264VlcDecoderImpl2();
+	virtual ~CoeffTokenH264VlcDecoderImpl2();
+
+public:
+	/// Interface implementation.
+	int GetNumDecodedBits(void)	{ return(_numCodeBits); }
+	int Marker(void)						{ return(0); }	///< No markers for this decoder.
+	/// A single symbol has no meaning for combined multi symbol encoding.
+	virtual int Decode(IBitStreamReader* bsr) { _numCodeBits = 0; return(0); } 
+
+	/// Optional interface implementation.
+	/// The 3 symbols represent total coeffs, trailing ones and neighbours' total coeffs, respectively.
+	virtual int	Decode3(IBitStreamReader* bsr, int* symbol1, int* symbol2, int* symbol3);
+
+protected:
+	int _numCodeBits;	///< Number of coded bits for this symbol.
+
+	/// One table per neighbourhood total coeffs range: 0 to 1, 2 to 3, 4 to 7, 8 up, -1 and -2.
+	/// The decoded symbol is (total coeffs << 2) | trailing ones.
+	VlcDecodeTable	_table[6];
+
+};// end class CoeffTokenH264VlcDecoderImpl2.
+
+#endif	// _COEFFTOKENH264VLCDECODERIMPL2_H
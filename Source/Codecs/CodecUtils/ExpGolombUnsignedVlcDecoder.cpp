@@ -70,10 +70,9 @@ int	ExpGolombUnsignedVlcDecoder::Decode(IBitStreamReader* bsr)
   _numCodeBits = 0;
 	int symbol = 0;
 
-	/// Read leading zeros.
-	int leadingZeros = 0;
-	while(bsr->Read() == 0)
-		leadingZeros++;
+	/// Read leading zeros and the following 1 bit.
+	int leadingZeros = bsr->CountLeadingZeros(32);
+	bsr->Skip(leadingZeros + 1);
 
 	symbol = (1 << leadingZeros) - 1 + bsr->Read(leadingZeros);
 	_numCodeBits = leadingZeros*2 + 1;
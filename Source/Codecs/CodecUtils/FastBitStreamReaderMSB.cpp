@@ -0,0 +1,334 @@
+/** @file
+
+MODULE				: FastBitStreamReaderMSB
+
+TAG						: FBSRMSB
+
+FILE NAME			: FastBitStreamReaderMSB.cpp
+
+DESCRIPTION		: A fast bit stream reader implementation of IBitStreamReader
+								with the first bit as the MSB of the byte. The next bits
+								are held left aligned in a 64 bit cache that is refilled
+								with byte swapped 64 bit loads. Stream positions have the
+								same meaning as for BitStreamReaderMSB and the two may be
+								used interchangeably.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include <string.h>
+#ifdef _MSC_VER
+#include <stdlib.h>
+#include <intrin.h>
+#endif
+
+#include "FastBitStreamReaderMSB.h"
+
+/*
+---------------------------------------------------------------------------
+	Local helpers.
+---------------------------------------------------------------------------
+*/
+/// Load 8 bytes with the first byte in the most significant position.
+static inline unsigned long long FBSRMSB_Load64(const unsigned char* p)
+{
+	unsigned long long x;
+	memcpy((void *)(&x), (const void *)p, sizeof(x));
+#if defined(_MSC_VER)
+	return(_byteswap_uint64(x));
+#elif defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+	return(__builtin_bswap64(x));
+#elif defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	return(x);
+#else
+	return( ((unsigned long long)p[0] << 56)|((unsigned long long)p[1] << 48)|
+					((unsigned long long)p[2] << 40)|((unsigned long long)p[3] << 32)|
+					((unsigned long long)p[4] << 24)|((unsigned long long)p[5] << 16)|
+					((unsigned long long)p[6] << 8) | (unsigned long long)p[7] );
+#endif
+}//end FBSRMSB_Load64.
+
+/// Leading zeros of a non-zero 64 bit value.
+static inline int FBSRMSB_Clz64(unsigned long long x)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long idx;
+	_BitScanReverse64(&idx, x);
+	return(63 - (int)idx);
+#elif defined(_MSC_VER)
+	unsigned long idx;
+	if(x >> 32)
+	{
+		_BitScanReverse(&idx, (unsigned long)(x >> 32));
+		return(31 - (int)idx);
+	}//end if x...
+	_BitScanReverse(&idx, (unsigned long)x);
+	return(63 - (int)idx);
+#elif defined(__GNUC__)
+	return(__builtin_clzll(x));
+#else
+	int n = 0;
+	while( !(x & 0x8000000000000000ULL) )
+	{
+		x <<= 1;
+		n++;
+	}//end while x...
+	return(n);
+#endif
+}//end FBSRMSB_Clz64.
+
+/*
+---------------------------------------------------------------------------
+	Construction.
+---------------------------------------------------------------------------
+*/
+FastBitStreamReaderMSB::FastBitStreamReaderMSB()
+{
+	_bitStream	= NULL;
+	_bitSize		= 0;
+	_byteSize		= 0;
+	_cache			= 0;
+	_cacheBits	= 0;
+	_nextByte		= 0;
+}//end constructor.
+
+FastBitStreamReaderMSB::~FastBitStreamReaderMSB()
+{
+}//end destructor.
+
+/*
+---------------------------------------------------------------------------
+	Interface implementation.
+---------------------------------------------------------------------------
+*/
+/** Read bits from the stream.
+Read multiple bits from the most significant bit downwards
+from the current stream position.
+@param numBits	: No. of bits to read [0..32].
+@return					: The code.
+*/
+int FastBitStreamReaderMSB::Read(int numBits)
+{
+	if(numBits <= 0)
+		return(0);
+	if(_cacheBits < numBits)
+		Refill();
+
+	unsigned int b = (unsigned int)(_cache >> (64 - numBits));
+	_cache			<<= numBits;
+	_cacheBits	-= numBits;
+
+	return((int)b);
+}//end Read.
+
+/** Peek bits in the stream.
+Read multiple bits from the most significant bit downwards
+from the specified stream position without disturbing the
+current stream position.
+@param bitLoc		: Bit pos in stream.
+@param numBits	: No. of bits to read [0..32].
+@return					: The code.
+*/
+int FastBitStreamReaderMSB::Peek(int bitLoc, int numBits)
+{
+	if(numBits <= 0)
+		return(0);
+
+	int pos			= (bitLoc & ~7) + (7 - (bitLoc & 7));
+	int bytePos = pos >> 3;
+
+	unsigned long long x;
+	if( (bytePos + 8) <= _byteSize )
+		x = FBSRMSB_Load64(&(_bitStream[bytePos]));
+	else
+	{
+		x = 0;
+		for(int i = 0; i < 8; i++)
+		{
+			x <<= 8;
+			if( (bytePos + i) < _byteSize )
+				x |= (unsigned long long)_bitStream[bytePos + i];
+		}//end for i...
+	}//end else...
+	x <<= (pos & 7);
+
+	return((int)(unsigned int)(x >> (64 - numBits)));
+}//end Peek.
+
+/** Peek the next bits in the stream.
+Read multiple bits from the current stream position without
+disturbing it.
+@param numBits	: No. of bits to read [0..32].
+@return					: The code.
+*/
+int FastBitStreamReaderMSB::PeekNext(int numBits)
+{
+	if(numBits <= 0)
+		return(0);
+	if(_cacheBits < numBits)
+		Refill();
+
+	return((int)(unsigned int)(_cache >> (64 - numBits)));
+}//end PeekNext.
+
+/** Skip bits in the stream.
+Move the current stream position on without reading.
+@param numBits	: No. of bits to skip.
+@return					: none.
+*/
+void FastBitStreamReaderMSB::Skip(int numBits)
+{
+	if(numBits <= 0)
+		return;
+	if(numBits < _cacheBits)
+	{
+		_cache			<<= numBits;
+		_cacheBits	-= numBits;
+	}//end if numBits...
+	else
+		SetPos(GetPos() + numBits);
+}//end Skip.
+
+/** Count the leading zero bits.
+Count the zero bits from the current stream position up to the next 1
+bit without disturbing the current stream position.
+@param maxBits	: Max no. of bits to count [1..32].
+@return					: No. of zero bits limited to maxBits.
+*/
+int FastBitStreamReaderMSB::CountLeadingZeros(int maxBits)
+{
+	if(_cacheBits < maxBits)
+		Refill();
+
+	/// A marker bit at maxBits limits the count.
+	return(FBSRMSB_Clz64(_cache | (0x8000000000000000ULL >> maxBits)));
+}//end CountLeadingZeros.
+
+/** Set the stream to use.
+Resets the current position to zero.
+@param stream		:	Byte stream pointer.
+@param bitSize	: Length in bits of the stream.
+@return					:	none.
+*/
+void FastBitStreamReaderMSB::SetStream(void* stream, int bitSize)
+{
+	_bitStream	= (unsigned char *)stream;
+	_bitSize		= bitSize;
+	_byteSize		= (bitSize + 7) >> 3;
+	SetPos(0);
+}//end SetStream.
+
+/** Seek to a position.
+@param streamBitPos	: Position to set as byte << 3 plus the bit counted down from the MSB.
+@return							: Success = 1, Past the end = 0;
+*/
+int FastBitStreamReaderMSB::Seek(int streamBitPos)
+{
+	if(streamBitPos >= _bitSize)
+		return(0);
+	SetPos((streamBitPos & ~7) + (7 - (streamBitPos & 7)));
+	return(1);
+}//end Seek.
+
+/** Set/change the bit length of the stream.
+The cache is reloaded from the current position to pick up the new end of
+the stream.
+@param bitSize	: New size in bits.
+@return					: none.
+*/
+void FastBitStreamReaderMSB::SetStreamBitSize(int bitSize)
+{
+	int pos			= GetPos();
+	_bitSize		= bitSize;
+	_byteSize		= (bitSize + 7) >> 3;
+	SetPos(pos);
+}//end SetStreamBitSize.
+
+/** Copy the contents from another bitstream.
+@param pFrom  : Bitstream to copy from.
+@return	      : none.
+*/
+void FastBitStreamReaderMSB::Copy(IBitStreamReader* pFrom)
+{
+	int streamBitPos = pFrom->GetStreamBitPos();
+
+	_bitStream	= (unsigned char *)pFrom->GetStream();
+	_bitSize		= pFrom->GetStreamBitSize();
+	_byteSize		= (_bitSize + 7) >> 3;
+	SetPos((streamBitPos & ~7) + (7 - (streamBitPos & 7)));
+}//end Copy.
+
+/*
+---------------------------------------------------------------------------
+	Protected methods.
+---------------------------------------------------------------------------
+*/
+/** Set the linear bit position and reload the cache.
+The cache must be reloaded whenever the stream bytes under it may have
+changed.
+@param pos	: Bits from the start of the stream.
+@return			: none.
+*/
+void FastBitStreamReaderMSB::SetPos(int pos)
+{
+	_nextByte		= pos >> 3;
+	_cache			= 0;
+	_cacheBits	= 0;
+	Refill();
+	_cache			<<= (pos & 7);
+	_cacheBits	-= (pos & 7);
+}//end SetPos.
+
+/** Top up the cache.
+Whole bytes are added below the valid bits until there are at least 57 valid
+bits. A 64 bit load also places the leading bits of the next byte below the
+valid bits. These are the same bits that the next load adds in the same
+place and therefore they do no harm.
+@return	: none.
+*/
+void FastBitStreamReaderMSB::Refill(void)
+{
+	if( (_nextByte + 8) <= _byteSize )
+	{
+		_cache |= FBSRMSB_Load64(&(_bitStream[_nextByte])) >> _cacheBits;
+		int bytes = (63 - _cacheBits) >> 3;
+		_nextByte		+= bytes;
+		_cacheBits	+= (bytes << 3);
+	}//end if _nextByte...
+	else
+	{
+		/// Near the end of the stream load a byte at a time and pad with zeros.
+		while(_cacheBits <= 56)
+		{
+			if(_nextByte < _byteSize)
+				_cache |= (unsigned long long)_bitStream[_nextByte] << (56 - _cacheBits);
+			_nextByte++;
+			_cacheBits += 8;
+		}//end while _cacheBits...
+	}//end else...
+}//end Refill.
+
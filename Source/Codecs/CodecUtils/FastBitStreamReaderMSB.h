@@ -0,0 +1,138 @@
+/** @file
+
+MODULE				: FastBitStreamReaderMSB
+
+TAG						: FBSRMSB
+
+FILE NAME			: FastBitStreamReaderMSB.h
+
+DESCRIPTION		: A fast bit stream reader implementation of IBitStreamReader
+								with the first bit as the MSB of the byte. The next bits
+								are held left aligned in a 64 bit cache that is refilled
+								with byte swapped 64 bit loads. Stream positions have the
+								same meaning as for BitStreamReaderMSB and the two may be
+								used interchangeably.
+								Basic operation:
+									FastBitStreamReaderMSB* pBsr = new FastBitStreamReaderMSB();
+									pBsr->SetStream((void *)pStream, (streamLen * sizeof(pStream[0]) * 8));
+									codeWord = pBsr->Read(5);
+									.
+									.
+									delete pBsr;
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifndef _FASTBITSTREAMREADERMSB_H
+#define _FASTBITSTREAMREADERMSB_H
+
+#pragma once
+
+#include "IBitStreamReader.h"
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class FastBitStreamReaderMSB : public IBitStreamReader
+{
+public:
+	FastBitStreamReaderMSB();
+	virtual ~FastBitStreamReaderMSB();
+
+/// Interface implementation.
+public:
+	/** Read a single bit.
+	Read from the current bit position in the stream.
+	@return			: The bit [0,1].
+	*/
+	int Read(void) { return(Read(1)); }
+
+	/** Read bits from the stream.
+	Read multiple bits from the most significant bit downwards
+	from the current stream position.
+	@param numBits	: No. of bits to read [0..32].
+	@return					: The code.
+	*/
+	int Read(int numBits);
+
+	/** Peek bits in the stream.
+	Read multiple bits from the most significant bit downwards
+	from the specified stream position without disturbing the
+	current stream position.
+	@param bitLoc		: Bit pos in stream.
+	@param numBits	: No. of bits to read [0..32].
+	@return					: The code.
+	*/
+	int Peek(int bitLoc, int numBits);
+
+	/** Peek the next bits in the stream.
+	@param numBits	: No. of bits to read [0..32].
+	@return					: The code.
+	*/
+	int PeekNext(int numBits);
+
+	/** Skip bits in the stream.
+	@param numBits	: No. of bits to skip.
+	@return					: none.
+	*/
+	void Skip(int numBits);
+
+	/** Count the leading zero bits from the current stream position.
+	@param maxBits	: Max no. of bits to count [1..32].
+	@return					: No. of zero bits limited to maxBits.
+	*/
+	int CountLeadingZeros(int maxBits);
+
+	void	SetStream(void* stream, int bitSize);
+	void* GetStream(void) { return( (void *)_bitStream ); }
+	void	Reset(void) { SetPos(0); }
+	int		Seek(int streamBitPos);
+
+	/// Positions are byte << 3 plus the bit in the byte counted down from the MSB = 7.
+	int		GetStreamBitPos(void)		{ int pos = GetPos(); return( (pos & ~7) + (7 - (pos & 7)) ); }
+	int		GetStreamBytePos(void)	{ return(GetPos() >> 3); }
+
+	void	SetStreamBitSize(int bitSize);
+	int		GetStreamBitSize(void)				{ return(_bitSize); }
+	int		GetStreamBitsRemaining(void)	{ return(_bitSize - GetPos()); }
+
+	void	Copy(IBitStreamReader* pFrom);
+
+protected:
+	/// Linear bit position from the start of the stream.
+	int		GetPos(void) { return( (_nextByte << 3) - _cacheBits ); }
+	void	SetPos(int pos);
+	/// Top up the cache to at least 57 bits.
+	void	Refill(void);
+
+protected:
+	unsigned char*			_bitStream;		///< Reference to byte array.
+	int									_bitSize;			///< Bits in stream.
+	int									_byteSize;		///< Bytes in stream. Bytes beyond are read as zero.
+
+	unsigned long long	_cache;				///< Next bits left aligned.
+	int									_cacheBits;		///< Valid bits in _cache.
+	int									_nextByte;		///< Next byte to load into _cache.
+
+};// end class FastBitStreamReaderMSB.
+
+#endif	// _FASTBITSTREAMREADERMSB_H
@@ -0,0 +1,263 @@
+/** @file
+
+MODULE				: FastBitStreamWriterMSB
+
+TAG						: FBSWMSB
+
+FILE NAME			: FastBitStreamWriterMSB.cpp
+
+DESCRIPTION		: A fast bit stream writer implementation of IBitStreamWriter
+								with the first bit as the MSB of the byte. Bits are
+								accumulated left aligned in a 64 bit register that is
+								stored as a whole byte swapped word on every write, so
+								the stream memory is always up to date. Only the bits
+								of the last partial byte remain in the register. Bytes
+								after the current position may be overwritten with zeros.
+								Stream positions have the same meaning as for
+								BitStreamWriterMSB and the two may be used interchangeably.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include <string.h>
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
+#include "FastBitStreamWriterMSB.h"
+
+/*
+---------------------------------------------------------------------------
+	Local helpers.
+---------------------------------------------------------------------------
+*/
+/// Store 8 bytes with the most significant byte first.
+static inline void FBSWMSB_Store64(unsigned char* p, unsigned long long x)
+{
+#if defined(_MSC_VER)
+	x = _byteswap_uint64(x);
+	memcpy((void *)p, (const void *)(&x), sizeof(x));
+#elif defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+	x = __builtin_bswap64(x);
+	memcpy((void *)p, (const void *)(&x), sizeof(x));
+#elif defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	memcpy((void *)p, (const void *)(&x), sizeof(x));
+#else
+	for(int i = 0; i < 8; i++)
+		p[i] = (unsigned char)(x >> (56 - (i << 3)));
+#endif
+}//end FBSWMSB_Store64.
+
+/*
+---------------------------------------------------------------------------
+	Construction.
+---------------------------------------------------------------------------
+*/
+FastBitStreamWriterMSB::FastBitStreamWriterMSB()
+{
+	_bitStream	= NULL;
+	_bitSize		= 0;
+	_byteSize		= 0;
+	_acc				= 0;
+	_accBits		= 0;
+	_bytePos		= 0;
+}//end constructor.
+
+FastBitStreamWriterMSB::~FastBitStreamWriterMSB()
+{
+}//end destructor.
+
+/*
+---------------------------------------------------------------------------
+	Interface implementation.
+---------------------------------------------------------------------------
+*/
+/** Write bits to the stream.
+Write multiple bits from the most significant bit downwards
+into the current stream position. The completed bytes are
+stepped over and the partial byte bits are kept.
+@param numBits	: No. of bits to write [0..32].
+@param val			: Bit value to write.
+@return					: none.
+*/
+void FastBitStreamWriterMSB::Write(int numBits, int val)
+{
+	if(numBits <= 0)
+		return;
+
+	unsigned long long v = (unsigned long long)((unsigned int)val & (0xFFFFFFFF >> (32 - numBits)));
+	_acc			|= v << (64 - _accBits - numBits);
+	_accBits	+= numBits;
+	Store();
+
+	int bytes = _accBits >> 3;
+	_bytePos	+= bytes;
+	_acc			<<= (bytes << 3);
+	_accBits	&= 7;
+}//end Write.
+
+/** Write whole bytes to the stream.
+Write a pre-encoded byte array into the current stream position
+with the first byte written first. On a byte boundary the bytes
+are copied directly.
+@param pBytes		: Bytes to write.
+@param numBytes	: No. of bytes to write.
+@return					: none.
+*/
+void FastBitStreamWriterMSB::WriteBytes(const void* pBytes, int numBytes)
+{
+	const unsigned char* p = (const unsigned char *)pBytes;
+
+	if(_accBits == 0)
+	{
+		int len = numBytes;
+		if( (_bytePos + len) > _byteSize )
+			len = _byteSize - _bytePos;
+		if(len > 0)
+			memcpy((void *)&(_bitStream[_bytePos]), (const void *)p, len);
+		_bytePos += numBytes;
+		return;
+	}//end if _accBits...
+
+	/// Off a byte boundary write 4 bytes at a time.
+	int i;
+	for(i = 0; (i + 4) <= numBytes; i += 4)
+		Write(32, (p[i] << 24)|(p[i+1] << 16)|(p[i+2] << 8)|p[i+3]);
+	for(; i < numBytes; i++)
+		Write(8, p[i]);
+}//end WriteBytes.
+
+/** Poke bits to the stream.
+Write multiple bits from the most significant bit downwards
+into the specified stream position without disturbing the
+current stream position.
+@param bitLoc		: Bit pos in stream.
+@param numBits	: No. of bits to write.
+@param val			: Bit value to write.
+@return					: none.
+*/
+void FastBitStreamWriterMSB::Poke(int bitLoc, int numBits, int val)
+{
+	int bytePos = bitLoc / 8;
+  int bitPos	= bitLoc % 8;
+
+	int inMask = 1 << (numBits - 1);	// Align a 1 on the MSB of the input val.
+  for(int i = numBits; i > 0; i--)
+  {
+    if(val & inMask)
+			_bitStream[bytePos] = _bitStream[bytePos] | (1 << bitPos);
+    else
+      _bitStream[bytePos] = _bitStream[bytePos] & ~(1 << bitPos);
+
+    // Point to next available bit.
+    if(bitPos > 0)
+			bitPos--;
+		else
+    {
+      bitPos = 7;
+      bytePos++;
+    }//end else...
+
+    inMask = inMask >> 1;
+  }//end for i...
+
+	/// The poked bits may be in the partial byte.
+	Load();
+}//end Poke.
+
+/** Set the stream to use.
+Resets the current position to zero.
+@param stream		:	Byte stream pointer.
+@param bitSize	: Length in bits of the stream.
+@return					:	none.
+*/
+void FastBitStreamWriterMSB::SetStream(void* stream, int bitSize)
+{
+	_bitStream	= (unsigned char *)stream;
+	SetStreamBitSize(bitSize);
+	Reset();
+}//end SetStream.
+
+/** Seek to a position.
+@param streamBitPos	: Position to set as byte << 3 plus the bit counted down from the MSB.
+@return							: Success = 1, Past the end = 0;
+*/
+int FastBitStreamWriterMSB::Seek(int streamBitPos)
+{
+	if(streamBitPos >= _bitSize)
+		return(0);
+	_bytePos	= streamBitPos / 8;
+	_accBits	= 7 - (streamBitPos % 8);
+	Load();
+	return(1);
+}//end Seek.
+
+/** Copy the contents from another bitstream.
+@param pFrom  : Bitstream to copy from.
+@return	      : none.
+*/
+void FastBitStreamWriterMSB::Copy(IBitStreamWriter* pFrom)
+{
+	_bitStream	= (unsigned char *)pFrom->GetStream();
+	SetStreamBitSize(pFrom->GetStreamBitSize());
+	_bytePos		= pFrom->GetStreamBytePos();
+	_accBits		= 7 - (pFrom->GetStreamBitPos() % 8);
+	Load();
+}//end Copy.
+
+/*
+---------------------------------------------------------------------------
+	Protected methods.
+---------------------------------------------------------------------------
+*/
+/** Store the register at the current byte position.
+A whole word is stored when it fits in the stream and otherwise only
+the bytes with valid bits that are in the stream.
+@return	: none.
+*/
+void FastBitStreamWriterMSB::Store(void)
+{
+	if( (_bytePos + 8) <= _byteSize )
+		FBSWMSB_Store64(&(_bitStream[_bytePos]), _acc);
+	else
+	{
+		int bytes = (_accBits + 7) >> 3;
+		for(int i = 0; (i < bytes)&&((_bytePos + i) < _byteSize); i++)
+			_bitStream[_bytePos + i] = (unsigned char)(_acc >> (56 - (i << 3)));
+	}//end else...
+}//end Store.
+
+/** Reload the written bits of the partial byte.
+@return	: none.
+*/
+void FastBitStreamWriterMSB::Load(void)
+{
+	_acc = 0;
+	if( _accBits && (_bytePos < _byteSize) )
+		_acc = ((unsigned long long)_bitStream[_bytePos] << 56) & ~(0xFFFFFFFFFFFFFFFFULL >> _accBits);
+}//end Load.
+
@@ -0,0 +1,147 @@
+/** @file
+
+MODULE				: FastBitStreamWriterMSB
+
+TAG						: FBSWMSB
+
+FILE NAME			: FastBitStreamWriterMSB.h
+
+DESCRIPTION		: A fast bit stream writer implementation of IBitStreamWriter
+								with the first bit as the MSB of the byte. Bits are
+								accumulated left aligned in a 64 bit register that is
+								stored as a whole byte swapped word on every write, so
+								the stream memory is always up to date. Only the bits
+								of the last partial byte remain in the register. Bytes
+								after the current position may be overwritten with zeros.
+								Stream positions have the same meaning as for
+								BitStreamWriterMSB and the two may be used interchangeably.
+								Basic operation:
+									FastBitStreamWriterMSB* pBsw = new FastBitStreamWriterMSB();
+									pBsw->SetStream((void *)pStream, (streamLen * sizeof(pStream[0]) * 8));
+									pBsw->Write(5, codeWord);
+									.
+									.
+									delete pBsw;
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifndef _FASTBITSTREAMWRITERMSB_H
+#define _FASTBITSTREAMWRITERMSB_H
+
+#pragma once
+
+#include "IBitStreamWriter.h"
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class FastBitStreamWriterMSB : public IBitStreamWriter
+{
+public:
+	FastBitStreamWriterMSB();
+	virtual ~FastBitStreamWriterMSB();
+
+/// Interface implementation.
+public:
+	/** Write a single bit.
+	Write to the current bit position into the stream.
+	@param val	: Bit value to write.
+	@return			: none.
+	*/
+	void Write(int val) { Write(1, val); }
+
+	/** Write bits to the stream 32 bits.
+	Write multiple bits from the most significant bit downwards
+	into the current stream position.
+	@param numBits	: No. of bits to write [0..32].
+	@param val			: Bit value to write.
+	@return					: none.
+	*/
+	void Write(int numBits, int val);
+
+	/** Write bits to the stream - 64 bits.
+	Write multiple bits into the current stream position for 64 bit values.
+	@param numBits	: No. of bits to write [0..64].
+	@param valH			: Upper 32 bit value to write.
+	@param valL			: Lower 32 bit value to write.
+	@return					: none.
+	*/
+	void Write(int numBits, int valH, int valL)
+  {
+    if(numBits > 32)
+    {
+      Write(numBits-32, valH);  ///< MSBs first.
+      Write(32, valL);
+    }//end if numBits...
+    else
+      Write(numBits, valL);
+  }//end Write.
+
+	/** Write whole bytes to the stream.
+	@param pBytes		: Bytes to write.
+	@param numBytes	: No. of bytes to write.
+	@return					: none.
+	*/
+	void WriteBytes(const void* pBytes, int numBytes);
+
+	/** Poke bits to the stream.
+	@param bitLoc		: Bit pos in stream.
+	@param numBits	: No. of bits to write.
+	@param val			: Bit value to write.
+	@return					: none.
+	*/
+	void Poke(int bitLoc, int numBits, int val);
+
+	void	SetStream(void* stream, int bitSize);
+	void* GetStream(void) { return( (void *)_bitStream ); }
+	void	Reset(void) { _bytePos = 0; _acc = 0; _accBits = 0; }
+	int		Seek(int streamBitPos);
+
+	/// Positions are byte << 3 plus the bit in the byte counted down from the MSB = 7.
+	int		GetStreamBitPos(void)		{ return( (_bytePos << 3) + (7 - _accBits) ); }
+	int		GetStreamBytePos(void)	{ return(_bytePos); }
+
+	void	SetStreamBitSize(int bitSize) { _bitSize = bitSize; _byteSize = (bitSize + 7) >> 3; }
+	int		GetStreamBitSize(void)				{ return(_bitSize); }
+	int		GetStreamBitsRemaining(void)	{ return(_bitSize - ((_bytePos << 3) + _accBits)); }
+
+	void	Copy(IBitStreamWriter* pFrom);
+
+protected:
+	/// Store the register at the current byte position.
+	void	Store(void);
+	/// Reload the written bits of the partial byte at the current byte position.
+	void	Load(void);
+
+protected:
+	unsigned char*			_bitStream;		///< Reference to byte array.
+	int									_bitSize;			///< Bits in stream.
+	int									_byteSize;		///< Bytes in stream. Bytes beyond are not written.
+
+	unsigned long long	_acc;					///< Bits from _bytePos onwards left aligned.
+	int									_accBits;			///< Valid bits in _acc [0..7] between writes.
+	int									_bytePos;			///< Byte of the first bit in _acc.
+
+};// end class FastBitStreamWriterMSB.
+
+#endif	// _FASTBITSTREAMWRITERMSB_H
@@ -0,0 +1,188 @@
+/** @file
+
+MODULE				: FastSimdForward4x4ITImpl1
+
+TAG						: FSF4ITI1
+
+FILE NAME			: FastSimdForward4x4ITImpl1.cpp
+
+DESCRIPTION		: A class to implement a fast forward 4x4 2-D integer
+								transform defined by the H.264 standard on the input
+								with SSE2 instructions. The 16 coeffs are held in 2
+								registers of 8 x 16 bits. Each 1-D pass transposes the
+								block and applies the butterfly across the registers.
+								The quantisation widens the magnitudes to 32 bits.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include <string.h>
+#include "FastSimdForward4x4ITImpl1.h"
+
+/// The transform passes are in 16 bits and wrap in the same way as the (short) casts
+/// of the scalar code. The TransformAndQuant mode quantises the 16 bit coeffs of the
+/// TransformOnly mode and is therefore bit-exact with FastForward4x4ITImpl2 when the
+/// unquantised coeffs fit in 16 bits, as they do for all 9 bit residual inputs.
+#include "SimdDefs.h"
+
+/*
+---------------------------------------------------------------------------
+	Local helpers.
+---------------------------------------------------------------------------
+*/
+#ifdef RTVC_SIMD
+
+/// One 1-D forward pass on rows [0,1] in lo and [2,3] in hi. The transposed result
+/// is returned in the same layout and a 2nd pass completes the 2-D transform.
+static inline void FSF4ITI1_Pass(__m128i& lo, __m128i& hi)
+{
+	__m128i t0	= _mm_unpacklo_epi16(lo, hi);
+	__m128i t1	= _mm_unpackhi_epi16(lo, hi);
+	__m128i x01 = _mm_unpacklo_epi16(t0, t1);		///< [x0, x1] of each row.
+	__m128i x32 = _mm_shuffle_epi32(_mm_unpackhi_epi16(t0, t1), 0x4E);	///< [x3, x2].
+
+	/// 1st stage.
+	__m128i s01 = _mm_add_epi16(x01, x32);			///< [s0, s1].
+	__m128i s32 = _mm_sub_epi16(x01, x32);			///< [s3, s2].
+	__m128i s10 = _mm_shuffle_epi32(s01, 0x4E);
+	__m128i s23 = _mm_shuffle_epi32(s32, 0x4E);
+
+	/// 2nd stage.
+	__m128i y0 = _mm_add_epi16(s01, s10);												///< s0 + s1.
+	__m128i y1 = _mm_add_epi16(s23, _mm_slli_epi16(s32, 1));		///< s2 + (s3 << 1).
+	__m128i y2 = _mm_sub_epi16(s01, s10);												///< s0 - s1.
+	__m128i y3 = _mm_sub_epi16(s32, _mm_slli_epi16(s23, 1));		///< s3 - (s2 << 1).
+
+	lo = _mm_unpacklo_epi64(y0, y1);
+	hi = _mm_unpacklo_epi64(y2, y3);
+}//end FSF4ITI1_Pass.
+
+/// Scale and quantise 8 coeffs on their magnitudes and restore the signs.
+static inline __m128i FSF4ITI1_Quant(__m128i x, __m128i norm, __m128i f, __m128i scale)
+{
+	__m128i sign	= _mm_srai_epi16(x, 15);
+	__m128i a			= _mm_sub_epi16(_mm_xor_si128(x, sign), sign);	///< Unsigned 16 bit magnitude.
+	__m128i pl		= _mm_mullo_epi16(a, norm);
+	__m128i ph		= _mm_mulhi_epu16(a, norm);
+	__m128i q0		= _mm_srl_epi32(_mm_add_epi32(_mm_unpacklo_epi16(pl, ph), f), scale);
+	__m128i q1		= _mm_srl_epi32(_mm_add_epi32(_mm_unpackhi_epi16(pl, ph), f), scale);
+	__m128i q			= _mm_packs_epi32(q0, q1);
+	return(_mm_sub_epi16(_mm_xor_si128(q, sign), sign));
+}//end FSF4ITI1_Quant.
+
+#endif
+
+/*
+---------------------------------------------------------------------------
+	Construction.
+---------------------------------------------------------------------------
+*/
+FastSimdForward4x4ITImpl1::FastSimdForward4x4ITImpl1()
+{
+	SetNormVector();
+}//end constructor.
+
+/*
+---------------------------------------------------------------------------
+	Interface Methods.
+---------------------------------------------------------------------------
+*/
+/** In-place forward Integer Transform.
+The 2-D IT is performed on the input and replaces it with the coeffs. A 1-D
+transform is performed on the rows first and then the cols.
+@param ptr	: Data to transform.
+@return			:	none.
+*/
+void FastSimdForward4x4ITImpl1::Transform(void* ptr)
+{
+#ifdef RTVC_SIMD
+	short*	block = (short *)ptr;
+	__m128i lo		= _mm_loadu_si128((const __m128i *)block);
+	__m128i hi		= _mm_loadu_si128((const __m128i *)(&block[8]));
+
+	if(_mode != IForwardTransform::QuantOnly)
+	{
+		FSF4ITI1_Pass(lo, hi);	///< Horiz.
+		FSF4ITI1_Pass(lo, hi);	///< Vert.
+	}//end if !QuantOnly...
+
+	if(_mode != IForwardTransform::TransformOnly)
+	{
+		__m128i norm	= _mm_loadu_si128((const __m128i *)_normVec);
+		__m128i f			= _mm_set1_epi32(_f);
+		__m128i scale	= _mm_cvtsi32_si128(_scale);
+		lo = FSF4ITI1_Quant(lo, norm, f, scale);
+		hi = FSF4ITI1_Quant(hi, norm, f, scale);
+	}//end if !TransformOnly...
+
+	_mm_storeu_si128((__m128i *)block, lo);
+	_mm_storeu_si128((__m128i *)(&block[8]), hi);
+#else
+	FastForward4x4ITImpl2::Transform(ptr);
+#endif
+}//end Transform.
+
+/** Transfer forward IT.
+The IT is performed on the input and the coeffs are written to
+the output.
+@param pIn		: Input data.
+@param pCoeff	: Output coeffs.
+@return				:	none.
+*/
+void FastSimdForward4x4ITImpl1::Transform(void* pIn, void* pCoeff)
+{
+	/// Copy to output and then do in-place transform.
+	memcpy(pCoeff, pIn, sizeof(short) * 16);
+	Transform(pCoeff);
+}//end Transform.
+
+/** Set and get parameters for the implementation.
+@param paramID	: Parameter to set/get.
+@param paramVal	: Parameter value.
+@return					: None (Set) or the param value (Get).
+*/
+void FastSimdForward4x4ITImpl1::SetParameter(int paramID, int paramVal)
+{
+	FastForward4x4ITImpl2::SetParameter(paramID, paramVal);
+	if(paramID == QUANT_ID)
+		SetNormVector();
+}//end SetParameter.
+
+/*
+---------------------------------------------------------------------------
+	Protected Methods.
+---------------------------------------------------------------------------
+*/
+/** Load the scaling of the current _qm in coeff order.
+@return: none.
+*/
+void FastSimdForward4x4ITImpl1::SetNormVector(void)
+{
+	for(int i = 0; i < 8; i++)
+		_normVec[i] = (short)NormAdjust[_qm][ColSelector[i]];
+}//end SetNormVector.
+
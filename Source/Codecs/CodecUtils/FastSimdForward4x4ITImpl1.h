@@ -0,0 +1,91 @@
+/** @file
+
+MODULE				: FastSimdForward4x4ITImpl1
+
+TAG						: FSF4ITI1
+
+FILE NAME			: FastSimdForward4x4ITImpl1.h
+
+DESCRIPTION		: A class to implement a fast forward 4x4 2-D integer
+								transform defined by the H.264 standard on the input
+								with SSE2 instructions. It is a drop in replacement for
+								FastForward4x4ITImpl2 with the same modes, parameters
+								and results. The scalar code of FastForward4x4ITImpl2
+								is used where SSE2 is not part of the target instruction
+								set.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================================
+*/
+#ifndef _FASTSIMDFORWARD4X4ITIMPL1_H
+#define _FASTSIMDFORWARD4X4ITIMPL1_H
+
+#pragma once
+
+#include "FastForward4x4ITImpl2.h"
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class FastSimdForward4x4ITImpl1 : public FastForward4x4ITImpl2
+{
+	public:
+		FastSimdForward4x4ITImpl1();
+		virtual ~FastSimdForward4x4ITImpl1()	{ }
+
+	// Interface implementation.
+	public:
+		/** In-place forward IT.
+		The IT is performed on the input and replaces it with the coeffs.
+		@param ptr	: Data to transform.
+		@return			:	none.
+		*/
+		virtual void Transform(void* ptr);
+
+		/** Transfer forward IT.
+		The IT is performed on the input and the coeffs are written to
+		the output.
+		@param pIn		: Input data.
+		@param pCoeff	: Output coeffs.
+		@return				:	none.
+		*/
+		virtual void Transform(void* pIn, void* pCoeff);
+
+		/** Set and get parameters for the implementation.
+		An Intra and Inter parameter and the quantisation parameter are the
+		only requirement for this	implementation.
+		@param paramID	: Parameter to set/get.
+		@param paramVal	: Parameter value.
+		@return					: None (Set) or the param value (Get).
+		*/
+		virtual void	SetParameter(int paramID, int paramVal);
+
+	protected:
+		/// Load the scaling of the current _qm in coeff order.
+		void SetNormVector(void);
+
+	protected:
+		short	_normVec[8];	///< Scaling for 2 rows of coeffs. Rows 2 and 3 repeat rows 0 and 1.
+
+};// end class FastSimdForward4x4ITImpl1.
+
+#endif	//_FASTSIMDFORWARD4X4ITIMPL1_H
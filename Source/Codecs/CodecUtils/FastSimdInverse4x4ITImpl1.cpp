@@ -0,0 +1,242 @@
+/** @file
+
+MODULE				: FastSimdInverse4x4ITImpl1
+
+TAG						: FSI4ITI1
+
+FILE NAME			: FastSimdInverse4x4ITImpl1.cpp
+
+DESCRIPTION		: A class to implement a fast inverse 4x4 2-D integer
+								transform defined by the H.264 standard on the input
+								with SSE2 instructions. The coeffs are scaled with 16 x 16
+								bit multiplies into 32 bit products and the transform
+								passes are done on 32 bit values with the same 16 bit
+								truncation between the passes as the scalar code.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include <string.h>
+#include "FastSimdInverse4x4ITImpl1.h"
+#include "SimdDefs.h"
+
+/*
+---------------------------------------------------------------------------
+	Local helpers.
+---------------------------------------------------------------------------
+*/
+#ifdef RTVC_SIMD
+
+/// Transpose 4 rows of 4 x 32 bit values.
+static inline void FSI4ITI1_Transpose(__m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3)
+{
+	__m128i t0 = _mm_unpacklo_epi32(r0, r1);
+	__m128i t1 = _mm_unpacklo_epi32(r2, r3);
+	__m128i t2 = _mm_unpackhi_epi32(r0, r1);
+	__m128i t3 = _mm_unpackhi_epi32(r2, r3);
+	r0 = _mm_unpacklo_epi64(t0, t1);
+	r1 = _mm_unpackhi_epi64(t0, t1);
+	r2 = _mm_unpacklo_epi64(t2, t3);
+	r3 = _mm_unpackhi_epi64(t2, t3);
+}//end FSI4ITI1_Transpose.
+
+/// One 1-D inverse butterfly across the 4 registers.
+static inline void FSI4ITI1_Butterfly(__m128i& x0, __m128i& x1, __m128i& x2, __m128i& x3)
+{
+	__m128i s0 = _mm_add_epi32(x0, x2);
+	__m128i s1 = _mm_sub_epi32(x0, x2);
+	__m128i s2 = _mm_sub_epi32(_mm_srai_epi32(x1, 1), x3);
+	__m128i s3 = _mm_add_epi32(x1, _mm_srai_epi32(x3, 1));
+	x0 = _mm_add_epi32(s0, s3);
+	x1 = _mm_add_epi32(s1, s2);
+	x2 = _mm_sub_epi32(s1, s2);
+	x3 = _mm_sub_epi32(s0, s3);
+}//end FSI4ITI1_Butterfly.
+
+/// Truncate 32 bit values to 16 bits as a (short) cast does.
+static inline __m128i FSI4ITI1_Short(__m128i x)
+{
+	return(_mm_srai_epi32(_mm_slli_epi32(x, 16), 16));
+}//end FSI4ITI1_Short.
+
+#endif
+
+/*
+--------------------------------------------------------------------------
+	Construction.
+--------------------------------------------------------------------------
+*/
+FastSimdInverse4x4ITImpl1::FastSimdInverse4x4ITImpl1(void)
+{
+	SetLevelScaleVector();
+}//end constructor.
+
+/*
+---------------------------------------------------------------------------
+	Interface Methods.
+---------------------------------------------------------------------------
+*/
+/** In-place inverse Integer Transform.
+The 2-D inverse IT is performed on the input coeffs and replaces them. A 1-D
+inverse transform is performed on the rows first and then the cols.
+@param ptr	: Data to transform.
+@return			:	none.
+*/
+void FastSimdInverse4x4ITImpl1::InverseTransform(void* ptr)
+{
+#ifdef RTVC_SIMD
+	if(!_simd)
+	{
+		FastInverse4x4ITImpl1::InverseTransform(ptr);
+		return;
+	}//end if !_simd...
+
+	short*	block = (short *)ptr;
+	__m128i lo		= _mm_loadu_si128((const __m128i *)block);
+	__m128i hi		= _mm_loadu_si128((const __m128i *)(&block[8]));
+	__m128i r0, r1, r2, r3;
+
+	if( (_mode != QuantOnly)&&(_mode != TransformAndQuant) )
+	{
+		/// Sign extend the rows.
+		r0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16);
+		r1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16);
+		r2 = _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16);
+		r3 = _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16);
+	}//end if TransformOnly...
+	else
+	{
+		/// Pre-scaling and quantisation into 32 bit rows.
+		__m128i s		= _mm_loadu_si128((const __m128i *)(&_levelScaleVec[_qm][0]));
+		__m128i pl	= _mm_mullo_epi16(lo, s);
+		__m128i ph	= _mm_mulhi_epi16(lo, s);
+		r0 = _mm_unpacklo_epi16(pl, ph);
+		r1 = _mm_unpackhi_epi16(pl, ph);
+		s		= _mm_loadu_si128((const __m128i *)(&_levelScaleVec[_qm][8]));
+		pl	= _mm_mullo_epi16(hi, s);
+		ph	= _mm_mulhi_epi16(hi, s);
+		r2 = _mm_unpacklo_epi16(pl, ph);
+		r3 = _mm_unpackhi_epi16(pl, ph);
+
+		if(_q < 24)
+		{
+			__m128i f			= _mm_set1_epi32(_f);
+			__m128i shift = _mm_cvtsi32_si128(_rightScale);
+			r0 = _mm_sra_epi32(_mm_add_epi32(r0, f), shift);
+			r1 = _mm_sra_epi32(_mm_add_epi32(r1, f), shift);
+			r2 = _mm_sra_epi32(_mm_add_epi32(r2, f), shift);
+			r3 = _mm_sra_epi32(_mm_add_epi32(r3, f), shift);
+		}//end if _q...
+		else
+		{
+			__m128i shift = _mm_cvtsi32_si128(_leftScale);
+			r0 = _mm_sll_epi32(r0, shift);
+			r1 = _mm_sll_epi32(r1, shift);
+			r2 = _mm_sll_epi32(r2, shift);
+			r3 = _mm_sll_epi32(r3, shift);
+		}//end else...
+
+		if(_mode == QuantOnly)
+		{
+			_mm_storeu_si128((__m128i *)block, _mm_packs_epi32(FSI4ITI1_Short(r0), FSI4ITI1_Short(r1)));
+			_mm_storeu_si128((__m128i *)(&block[8]), _mm_packs_epi32(FSI4ITI1_Short(r2), FSI4ITI1_Short(r3)));
+			return;
+		}//end if QuantOnly...
+	}//end else...
+
+	/// 1-D inverse IT in horiz direction on the cols of the transposed rows. The
+	/// results are stored as shorts by the scalar code.
+	FSI4ITI1_Transpose(r0, r1, r2, r3);
+	FSI4ITI1_Butterfly(r0, r1, r2, r3);
+	r0 = FSI4ITI1_Short(r0);
+	r1 = FSI4ITI1_Short(r1);
+	r2 = FSI4ITI1_Short(r2);
+	r3 = FSI4ITI1_Short(r3);
+
+	/// 1-D inverse IT in vert direction.
+	FSI4ITI1_Transpose(r0, r1, r2, r3);
+	FSI4ITI1_Butterfly(r0, r1, r2, r3);
+	__m128i rnd = _mm_set1_epi32(32);
+	r0 = _mm_srai_epi32(_mm_add_epi32(r0, rnd), 6);
+	r1 = _mm_srai_epi32(_mm_add_epi32(r1, rnd), 6);
+	r2 = _mm_srai_epi32(_mm_add_epi32(r2, rnd), 6);
+	r3 = _mm_srai_epi32(_mm_add_epi32(r3, rnd), 6);
+
+	_mm_storeu_si128((__m128i *)block, _mm_packs_epi32(r0, r1));
+	_mm_storeu_si128((__m128i *)(&block[8]), _mm_packs_epi32(r2, r3));
+#else
+	FastInverse4x4ITImpl1::InverseTransform(ptr);
+#endif
+}//end InverseTransform.
+
+/** Transfer inverse IT.
+The inverse IT is performed on the coeffs and are written to
+the output.
+@param pCoeff	: Input coeffs.
+@param pOut		: Output data.
+@return				:	none.
+*/
+void FastSimdInverse4x4ITImpl1::InverseTransform(void* pCoeff, void* pOut)
+{
+	/// Copy to output and then do in-place inverse transform.
+	memcpy(pOut, pCoeff, sizeof(short) * 16);
+	InverseTransform(pOut);
+}//end InverseTransform.
+
+/** Set scaling array.
+Each coefficient may be scaled before transforming and therefore
+requires setting up.
+@param	pScale:	Scale factor array.
+@return				:	none.
+*/
+void FastSimdInverse4x4ITImpl1::SetScale(void* pScale)
+{
+	FastInverse4x4ITImpl1::SetScale(pScale);
+	SetLevelScaleVector();
+}//end SetScale.
+
+/*
+---------------------------------------------------------------------------
+	Protected Methods.
+---------------------------------------------------------------------------
+*/
+/** Load the level scales as 16 bit values.
+The SSE2 code is only used when every level scale fits in 16 bits.
+@return: none.
+*/
+void FastSimdInverse4x4ITImpl1::SetLevelScaleVector(void)
+{
+	_simd = 1;
+	for(int qm = 0; qm < 6; qm++)
+		for(int i = 0; i < 16; i++)
+		{
+			if( (_levelScale[qm][i] < -32768)||(_levelScale[qm][i] > 32767) )
+				_simd = 0;
+			_levelScaleVec[qm][i] = (short)_levelScale[qm][i];
+		}//end for qm & i...
+}//end SetLevelScaleVector.
+
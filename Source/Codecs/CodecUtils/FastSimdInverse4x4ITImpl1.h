@@ -0,0 +1,91 @@
+/** @file
+
+MODULE				: FastSimdInverse4x4ITImpl1
+
+TAG						: FSI4ITI1
+
+FILE NAME			: FastSimdInverse4x4ITImpl1.h
+
+DESCRIPTION		: A class to implement a fast inverse 4x4 2-D integer
+								transform defined by the H.264 standard on the input
+								with SSE2 instructions. It is a drop in replacement for
+								FastInverse4x4ITImpl1 with the same modes, parameters
+								and results. The scalar code of FastInverse4x4ITImpl1
+								is used where SSE2 is not part of the target instruction
+								set.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifndef _FASTSIMDINVERSE4X4ITIMPL1_H
+#define _FASTSIMDINVERSE4X4ITIMPL1_H
+
+#pragma once
+
+#include "FastInverse4x4ITImpl1.h"
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class FastSimdInverse4x4ITImpl1 : public FastInverse4x4ITImpl1
+{
+	public:
+		FastSimdInverse4x4ITImpl1(void);
+		virtual ~FastSimdInverse4x4ITImpl1()	{ }
+
+	/// Interface implementation.
+	public:
+		/** In-place inverse IT.
+		The inverse IT is performed on the input and replaces it with the coeffs.
+		@param ptr	: Data to transform.
+		@return			:	none.
+		*/
+		virtual void InverseTransform(void* ptr);
+
+		/** Transfer inverse IT.
+		The inverse IT is performed on the coeffs and are written to
+		the output.
+		@param pCoeff	: Input coeffs.
+		@param pOut		: Output data.
+		@return				:	none.
+		*/
+		virtual void InverseTransform(void* pCoeff, void* pOut);
+
+		/** Set scaling array.
+		Each coefficient may be scaled before transforming and therefore
+		requires setting up.
+		@param	pScale:	Scale factor array.
+		@return				:	none.
+		*/
+		virtual void	SetScale(void* pScale);
+
+	protected:
+		/// Load the level scales as 16 bit values.
+		void SetLevelScaleVector(void);
+
+	protected:
+		short	_levelScaleVec[6][16];	///< 16 bit copy of _levelScale.
+		int		_simd;									///< All level scales fit in 16 bits.
+
+};// end class FastSimdInverse4x4ITImpl1.
+
+#endif	//_FASTSIMDINVERSE4X4ITIMPL1_H
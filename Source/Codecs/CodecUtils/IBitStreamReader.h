@@ -64,6 +64,29 @@ public:
 	*/
 	virtual int Peek(int bitLoc, int numBits) = 0;
 
+	/** Peek the next bits in the stream.
+	Read multiple bits from the current stream position without
+	disturbing it.
+	@param numBits	: No. of bits to read [0..32].
+	@return					: The code.
+	*/
+	virtual int PeekNext(int numBits) = 0;
+
+	/** Skip bits in the stream.
+	Move the current stream position on without reading.
+	@param numBits	: No. of bits to skip.
+	@return					: none.
+	*/
+	virtual void Skip(int numBits) = 0;
+
+	/** Count the leading zero bits.
+	Count the zero bits from the current stream position up to the next 1
+	bit without disturbing the current stream position.
+	@param maxBits	: Max no. of bits to count [1..32].
+	@return					: No. of zero bits limited to maxBits.
+	*/
+	virtual int CountLeadingZeros(int maxBits) = 0;
+
 	/** Set the stream to use.
 	Set the pointer to write the bits to and its length in
 	bits. Resets the current position to zero.
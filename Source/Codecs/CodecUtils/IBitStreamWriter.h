@@ -66,6 +66,15 @@ public:
 	*/
   virtual void Write(int numBits, int valH, int valL) = 0;
 
+	/** Write whole bytes to the stream.
+	Write a pre-encoded byte array into the current stream position
+	with the first byte written first.
+	@param pBytes		: Bytes to write.
+	@param numBytes	: No. of bytes to write.
+	@return					: none.
+	*/
+	virtual void WriteBytes(const void* pBytes, int numBytes) = 0;
+
 	/** Poke bits to the stream.
 	Write multiple bits from into the specified stream 
 	position without disturbing the	current stream position.
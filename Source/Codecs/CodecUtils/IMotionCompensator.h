@@ -104,6 +104,36 @@ class IMotionCompensator
 		virtual void PrepareForSingleVectorMode(void) = 0;
     virtual void Invalidate(void) {}
 
+		/** Motion compensate a single vector into a prediction buffer.
+		The ref is read directly and is not altered. It must remain unchanged
+		until all the vectors of the picture have been predicted. Use 
+		CommitPrediction() to write the predicted block to the ref.
+		@param tlx	: Top left x coord of block.
+		@param tly	: Top left y coord of block.
+		@param mvx	: X coord of the motion vector.
+		@param mvy	: Y coord of the motion vector.
+		@return			: None.
+		*/
+		virtual void Predict(int tlx, int tly, int mvx, int mvy) = 0;
+
+		/** Write a predicted block to the reference.
+		The same vector used in Predict() must be provided.
+		@param tlx	: Top left x coord of block.
+		@param tly	: Top left y coord of block.
+		@param mvx	: X coord of the motion vector.
+		@param mvy	: Y coord of the motion vector.
+		@return			: None.
+		*/
+		virtual void CommitPrediction(int tlx, int tly, int mvx, int mvy) = 0;
+
+		/** Attach a shared reference picture.
+		An optional precomputed representation of the ref that the implementation
+		may use instead of interpolating the ref itself. It is ignored by default.
+		@param pRefPicture	: Implementation specific ref picture.
+		@return							: none.
+		*/
+		virtual void SetRefPicture(void* pRefPicture) {}
+
 };//end IMotionEstimator.
 
 
@@ -84,6 +84,14 @@ class IMotionEstimator
 														long* avgDistortion) = 0;
 		virtual void* Estimate(long* avgDistortion) = 0;
 
+		/** Attach a shared reference picture.
+		An optional precomputed representation of the ref that the implementation
+		may use instead of interpolating the ref itself. It is ignored by default.
+		@param pRefPicture	: Implementation specific ref picture.
+		@return							: none.
+		*/
+		virtual void SetRefPicture(void* pRefPicture) {}
+
 };//end IMotionEstimator.
 
 
@@ -0,0 +1,272 @@
+/** @file
+
+MODULE				: LookaheadH264
+
+TAG						: LAH264
+
+FILE NAME			: LookaheadH264.cpp
+
+DESCRIPTION		: A class to decide the picture coding type from a 1/4 x 1/4
+								(level 2) subsampled copy of the lum input pictures before
+								any full resolution encoding. The inter search is a full
+								search of +-LAH264_RANGE level 2 pels clipped to the picture.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include "LookaheadH264.h"
+
+/// Level 2 search range in pels (x4 at full resolution).
+#define LAH264_RANGE					4
+/// Pictures with a mean inter abs diff below this per level 2 pel are never scene changes.
+#define LAH264_MIN_PEL_DIFF		2
+/// Default threshold percentage.
+#define LAH264_THRESHOLD			60
+
+/*
+---------------------------------------------------------------------------
+	Construction and destruction.
+---------------------------------------------------------------------------
+*/
+LookaheadH264::LookaheadH264(void)
+{
+	ResetMembers();
+}//end constructor.
+
+LookaheadH264::~LookaheadH264(void)
+{
+	Destroy();
+}//end destructor.
+
+void LookaheadH264::ResetMembers(void)
+{
+	_width			= 0;
+	_height			= 0;
+	_l2Width		= 0;
+	_l2Height		= 0;
+	_threshold	= LAH264_THRESHOLD;
+	_prevValid	= 0;
+	_interCost	= 0;
+	_intraCost	= 0;
+	_pMem				= NULL;
+	_pL2				= NULL;
+	_pPrevL2		= NULL;
+}//end ResetMembers.
+
+/*
+---------------------------------------------------------------------------
+	Interface Methods.
+---------------------------------------------------------------------------
+*/
+int LookaheadH264::Create(int width, int height)
+{
+	int threshold = _threshold;	///< May be set before creation.
+	Destroy();
+	_threshold	= threshold;
+
+	_width		= width;
+	_height		= height;
+	_l2Width	= width/4;
+	_l2Height	= height/4;
+
+	int size	= _l2Width * _l2Height;
+	_pMem			= new short[2 * size];
+	if(_pMem == NULL)
+	{
+		Destroy();
+		return(0);
+	}//end if !_pMem...
+	_pL2			= _pMem;
+	_pPrevL2	= &(_pMem[size]);
+
+	return(1);
+}//end Create.
+
+void LookaheadH264::Destroy(void)
+{
+	if(_pMem != NULL)
+		delete[] _pMem;
+	ResetMembers();
+}//end Destroy.
+
+int LookaheadH264::Analyse(const short* pLum)
+{
+	int sceneChange = 0;
+
+	Subsample(pLum, _pL2);
+
+	_interCost = 0;
+	_intraCost = 0;
+	if(_prevValid)
+	{
+		/// A block that is cheaper to predict from its neighbours is intra coded in either picture type.
+		for(int y = 0; y < _l2Height; y += 4)
+			for(int x = 0; x < _l2Width; x += 4)
+		{
+			int intra = IntraCost(x, y);
+			int inter = InterCost(x, y);
+			_intraCost += intra;
+			_interCost += (inter < intra) ? inter : intra;
+		}//end for y & x...
+
+		if( (_interCost >= (LAH264_MIN_PEL_DIFF * _l2Width * _l2Height))&&
+				(((double)_interCost * 100.0) > ((double)_threshold * (double)_intraCost)) )
+			sceneChange = 1;
+	}//end if _prevValid...
+
+	/// The current picture becomes the previous picture.
+	short* pTmp	= _pPrevL2;
+	_pPrevL2		= _pL2;
+	_pL2				= pTmp;
+	_prevValid	= 1;
+
+	return(sceneChange);
+}//end Analyse.
+
+/*
+---------------------------------------------------------------------------
+	Local Methods.
+---------------------------------------------------------------------------
+*/
+/// Each level 2 pel is the rounded mean of a 4x4 full resolution block.
+void LookaheadH264::Subsample(const short* pLum, short* pL2)
+{
+	for(int y = 0; y < _l2Height; y++, pLum += 4*_width)
+	{
+		const short* r0 = pLum;
+		const short* r1 = &(pLum[_width]);
+		const short* r2 = &(pLum[2*_width]);
+		const short* r3 = &(pLum[3*_width]);
+		for(int x = 0; x < _l2Width; x++, r0 += 4, r1 += 4, r2 += 4, r3 += 4)
+		{
+			int sum = r0[0] + r0[1] + r0[2] + r0[3] + r1[0] + r1[1] + r1[2] + r1[3] +
+								r2[0] + r2[1] + r2[2] + r2[3] + r3[0] + r3[1] + r3[2] + r3[3];
+			*pL2++ = (short)((sum + 8) >> 4);
+		}//end for x...
+	}//end for y...
+}//end Subsample.
+
+/// Min abs diff of the 4x4 block at (x,y) in the previous picture within the search range 
+/// and then at the 1/2 pel positions around the best vector.
+int LookaheadH264::InterCost(int x, int y)
+{
+	int minCost = 0x7FFFFFFF;
+	int bx = 0, by = 0;
+	int xl = (x - LAH264_RANGE < 0) ? -x : -LAH264_RANGE;
+	int xr = (x + 4 + LAH264_RANGE > _l2Width) ? (_l2Width - 4 - x) : LAH264_RANGE;
+	int yu = (y - LAH264_RANGE < 0) ? -y : -LAH264_RANGE;
+	int yd = (y + 4 + LAH264_RANGE > _l2Height) ? (_l2Height - 4 - y) : LAH264_RANGE;
+
+	const short* pCur = &(_pL2[y*_l2Width + x]);
+	for(int j = yu; j <= yd; j++)
+		for(int i = xl; i <= xr; i++)
+	{
+		const short* pC = pCur;
+		const short* pP = &(_pPrevL2[(y+j)*_l2Width + x + i]);
+		int cost = 0;
+		for(int row = 0; (row < 4)&&(cost < minCost); row++, pC += _l2Width, pP += _l2Width)
+			cost += abs(pC[0] - pP[0]) + abs(pC[1] - pP[1]) + abs(pC[2] - pP[2]) + abs(pC[3] - pP[3]);
+		if(cost < minCost)
+		{
+			minCost = cost;
+			bx = i;
+			by = j;
+		}//end if cost...
+	}//end for j & i...
+
+	/// The 1/2 pel positions are the rounded mean of the best and a neighbouring 
+	/// position where it is inside the picture.
+	for(int hy = -1; hy <= 1; hy++)
+		for(int hx = -1; hx <= 1; hx++)
+	{
+		int nx = x + bx + hx;
+		int ny = y + by + hy;
+		if( ((hx == 0)&&(hy == 0))||(nx < 0)||(ny < 0)||((nx + 4) > _l2Width)||((ny + 4) > _l2Height) )
+			continue;
+		const short* pC = pCur;
+		const short* pP = &(_pPrevL2[(y+by)*_l2Width + x + bx]);
+		const short* pN = &(_pPrevL2[ny*_l2Width + nx]);
+		int cost = 0;
+		for(int row = 0; (row < 4)&&(cost < minCost); row++, pC += _l2Width, pP += _l2Width, pN += _l2Width)
+		{
+			for(int col = 0; col < 4; col++)
+				cost += abs(pC[col] - ((pP[col] + pN[col] + 1) >> 1));
+		}//end for row...
+		if(cost < minCost)
+			minCost = cost;
+	}//end for hy & hx...
+
+	return(minCost);
+}//end InterCost.
+
+/// Min abs diff of the vertical, horizontal and DC predictions of the 4x4 block at (x,y).
+int LookaheadH264::IntraCost(int x, int y)
+{
+	int row, col;
+	const short* pCur		= &(_pL2[y*_l2Width + x]);
+	const short* pAbove	= pCur - _l2Width;
+	int dc = 0, dcCnt = 0;
+	int minCost = 0x7FFFFFFF;
+
+	if(y > 0)
+	{
+		int cost = 0;
+		for(row = 0; row < 4; row++)
+			for(col = 0; col < 4; col++)
+				cost += abs(pCur[row*_l2Width + col] - pAbove[col]);
+		minCost = cost;
+		dc		+= pAbove[0] + pAbove[1] + pAbove[2] + pAbove[3];
+		dcCnt += 4;
+	}//end if y...
+	if(x > 0)
+	{
+		int cost = 0;
+		for(row = 0; row < 4; row++)
+		{
+			int left = pCur[row*_l2Width - 1];
+			for(col = 0; col < 4; col++)
+				cost += abs(pCur[row*_l2Width + col] - left);
+			dc += left;
+		}//end for row...
+		if(cost < minCost)
+			minCost = cost;
+		dcCnt += 4;
+	}//end if x...
+
+	/// The DC pred is 128 without neighbours.
+	dc = dcCnt ? ((dc + (dcCnt/2))/dcCnt) : 128;
+	int cost = 0;
+	for(row = 0; row < 4; row++)
+		for(col = 0; col < 4; col++)
+			cost += abs(pCur[row*_l2Width + col] - dc);
+	if(cost < minCost)
+		minCost = cost;
+
+	return(minCost);
+}//end IntraCost.
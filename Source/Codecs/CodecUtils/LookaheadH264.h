@@ -0,0 +1,107 @@
+/** @file
+
+MODULE				: LookaheadH264
+
+TAG						: LAH264
+
+FILE NAME			: LookaheadH264.h
+
+DESCRIPTION		: A class to decide the picture coding type from a 1/4 x 1/4
+								(level 2) subsampled copy of the lum input pictures before
+								any full resolution encoding. Each 16x16 macroblock is a 4x4
+								block at level 2 and its inter cost is the min abs diff of a
+								small search in the previous level 2 picture. The intra cost
+								is the min abs diff of the vertical, horizontal and DC
+								predictions from the neighbouring level 2 pels. A scene
+								change is declared when the inter cost of the picture is too
+								close to its intra cost.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifndef _LOOKAHEADH264_H
+#define _LOOKAHEADH264_H
+
+#pragma once
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class LookaheadH264
+{
+	public:
+		LookaheadH264(void);
+		virtual ~LookaheadH264(void);
+
+	/// Interface.
+	public:
+		/** Create the level 2 picture mem.
+		@param width		: Lum picture width. Multiple of 16.
+		@param height		: Lum picture height. Multiple of 16.
+		@return					: 1 = success, 0 = failure.
+		*/
+		int		Create(int width, int height);
+		void	Destroy(void);
+
+		/** Analyse the next lum input picture.
+		The picture is subsampled to level 2 and its costs are measured against the
+		previously analysed picture. The picture then becomes the previous picture.
+		@param pLum	: Lum picture of width x height.
+		@return			: 1 = scene change, 0 = inter prediction is suitable.
+		*/
+		int		Analyse(const short* pLum);
+
+		/// The next picture has no previous picture to be measured against.
+		void	Reset(void)	{ _prevValid = 0; }
+
+		/// Scene change when (inter cost x 100) > (threshold x intra cost).
+		void	SetThreshold(int percent)	{ _threshold = percent; }
+		int		GetThreshold(void)				{ return(_threshold); }
+
+		/// Level 2 costs of the last analysed picture. Both are 0 without a previous picture.
+		int		GetInterCost(void)				{ return(_interCost); }
+		int		GetIntraCost(void)				{ return(_intraCost); }
+
+	protected:
+		void	ResetMembers(void);
+		/// Subsample the full resolution lum into a level 2 picture.
+		void	Subsample(const short* pLum, short* pL2);
+		/// Level 2 block costs of the block at (x,y).
+		int		InterCost(int x, int y);
+		int		IntraCost(int x, int y);
+
+	protected:
+		int			_width;					///< Full resolution dimensions.
+		int			_height;
+		int			_l2Width;				///< Level 2 dimensions.
+		int			_l2Height;
+		int			_threshold;			///< Percentage of the intra cost.
+		int			_prevValid;			///< The previous level 2 picture is valid.
+		int			_interCost;			///< Costs of the last picture.
+		int			_intraCost;
+
+		short*	_pMem;					///< Both level 2 pictures in one block.
+		short*	_pL2;						///< Current level 2 picture.
+		short*	_pPrevL2;				///< Previous level 2 picture.
+};// end class LookaheadH264.
+
+#endif	//_LOOKAHEADH264_H
@@ -719,10 +719,10 @@ bool MacroBlockH264::SkippedZeroMotionPredCondition(MacroBlockH264* mb)
 
   if( (mb->_leftMb == NULL)||(mb->_aboveMb == NULL) )
     ret = true;
-  else  ///< Both left and above exist.
+  else  ///< Both left and above exist. Intra neighbours have no ref and do not force the zero vector.
   {
-		if( ( (mb->_leftMb->_mvX[MacroBlockH264::_16x16] == 0) && (mb->_leftMb->_mvY[MacroBlockH264::_16x16] == 0)) ||
-        ( (mb->_aboveMb->_mvX[MacroBlockH264::_16x16] == 0) && (mb->_aboveMb->_mvY[MacroBlockH264::_16x16] == 0)) )
+		if( (!mb->_leftMb->_intraFlag && (mb->_leftMb->_mvX[MacroBlockH264::_16x16] == 0) && (mb->_leftMb->_mvY[MacroBlockH264::_16x16] == 0)) ||
+        (!mb->_aboveMb->_intraFlag && (mb->_aboveMb->_mvX[MacroBlockH264::_16x16] == 0) && (mb->_aboveMb->_mvY[MacroBlockH264::_16x16] == 0)) )
         ret = true;
   }//end else...
 
@@ -750,6 +750,10 @@ void MacroBlockH264::GetMbMotionMedianPred(MacroBlockH264* mb, int* mvpx, int* m
 	int By = 0;
 	int Cx = 0;
 	int Cy = 0;
+	/// Neighbours that are inter coded and therefore share the single ref.
+	int refA = 0;
+	int refB = 0;
+	int refC = 0;
 
 	/// All intra neighbours are set to have zero vectors.
 	if(mb->_leftMb != NULL)	///< A
@@ -758,6 +762,7 @@ void MacroBlockH264::GetMbMotionMedianPred(MacroBlockH264* mb, int* mvpx, int* m
 		{
 			Ax = (mb->_leftMb)->_mvX[MacroBlockH264::_16x16];
 			Ay = (mb->_leftMb)->_mvY[MacroBlockH264::_16x16];
+			refA = 1;
 		}//end if _intraFlag...
 	}//end if _leftMb...
 	if(mb->_aboveMb != NULL)	///< B
@@ -766,6 +771,7 @@ void MacroBlockH264::GetMbMotionMedianPred(MacroBlockH264* mb, int* mvpx, int* m
 		{
 			Bx = (mb->_aboveMb)->_mvX[MacroBlockH264::_16x16];
 			By = (mb->_aboveMb)->_mvY[MacroBlockH264::_16x16];
+			refB = 1;
 		}//end if _intraFlag...
 	}//end if _aboveMb...
 	if(mb->_aboveRightMb != NULL)	///< C
@@ -774,6 +780,7 @@ void MacroBlockH264::GetMbMotionMedianPred(MacroBlockH264* mb, int* mvpx, int* m
 		{
 			Cx = (mb->_aboveRightMb)->_mvX[MacroBlockH264::_16x16];
 			Cy = (mb->_aboveRightMb)->_mvY[MacroBlockH264::_16x16];
+			refC = 1;
 		}//end if _intraFlag...
 	}//end if _aboveRightMb...
 	else	///< Replace C with D (if D exists)
@@ -784,6 +791,7 @@ void MacroBlockH264::GetMbMotionMedianPred(MacroBlockH264* mb, int* mvpx, int* m
 			{
 				Cx = (mb->_aboveLeftMb)->_mvX[MacroBlockH264::_16x16];
 				Cy = (mb->_aboveLeftMb)->_mvY[MacroBlockH264::_16x16];
+				refC = 1;
 			}//end if _intraFlag...
 		}//end if D...
 	}//end else !C...
@@ -795,8 +803,18 @@ void MacroBlockH264::GetMbMotionMedianPred(MacroBlockH264* mb, int* mvpx, int* m
 		By = Ay;
 		Cx = Ax;
 		Cy = Ay;
+		refB = refA;
+		refC = refA;
 	}//end !B and !C...
 
+	/// When only one neighbour is inter coded its vector is the prediction.
+	if( (refA + refB + refC) == 1 )
+	{
+		*mvpx = Ax + Bx + Cx;
+		*mvpy = Ay + By + Cy;
+		return;
+	}//end if refA...
+
 	*mvpx = mb->Median(Ax, Bx, Cx);
 	*mvpy = mb->Median(Ay, By, Cy);
 }//end GetMbMotionMedianPred.
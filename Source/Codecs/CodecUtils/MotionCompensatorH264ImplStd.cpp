@@ -50,6 +50,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /// sub-pixel interpolations. Only required at level 0 resolution.
 #define MCH264IS_PADDING	4
 
+/// Pels read around the lum and chr block positions by the sub-pixel interpolations 
+/// with the full pel reflection of negative fractions included.
+#define MCH264IS_LUM_WIN_BORDER	3
+#define MCH264IS_CHR_WIN_BORDER	1
+
 /*
 --------------------------------------------------------------------------
   Macros. 
@@ -100,6 +105,13 @@ MotionCompensatorH264ImplStd::MotionCompensatorH264ImplStd(int range)
 	_pMBlk							= NULL;
 	_pMBlkOver					= NULL;
 
+	_pLumWin						= NULL;		///< Edge windows for prediction.
+	_pLumWinOver				= NULL;
+	_pChrWin						= NULL;
+	_pChrWinOver				= NULL;
+
+	_pRefPicture				= NULL;		///< Optional shared 1/2 pel planes.
+
 }//end constructor.
 
 MotionCompensatorH264ImplStd::~MotionCompensatorH264ImplStd(void)
@@ -247,6 +259,24 @@ int MotionCompensatorH264ImplStd::Create(	void* ref,
 	  return(0);
   }//end if !_pMBlk...
 
+	/// Edge windows for predictions that read across the ref boundary. The overlays 
+	/// are set to the block size at the window centre.
+	int lumWinWidth		= _macroBlkWidth + 2*MCH264IS_LUM_WIN_BORDER + 1;
+	int lumWinHeight	= _macroBlkHeight + 2*MCH264IS_LUM_WIN_BORDER + 1;
+	int chrWinWidth		= _chrMacroBlkWidth + 2*MCH264IS_CHR_WIN_BORDER + 1;
+	int chrWinHeight	= _chrMacroBlkHeight + 2*MCH264IS_CHR_WIN_BORDER + 1;
+	_pLumWin			= new short[lumWinWidth * lumWinHeight];
+	_pLumWinOver	= new OverlayMem2Dv2(_pLumWin, lumWinWidth, lumWinHeight, _macroBlkWidth, _macroBlkHeight);
+	_pChrWin			= new short[chrWinWidth * chrWinHeight];
+	_pChrWinOver	= new OverlayMem2Dv2(_pChrWin, chrWinWidth, chrWinHeight, _chrMacroBlkWidth, _chrMacroBlkHeight);
+	if( (_pLumWin == NULL)||(_pLumWinOver == NULL)||(_pChrWin == NULL)||(_pChrWinOver == NULL) )
+  {
+		Destroy();
+	  return(0);
+  }//end if !_pLumWin...
+	_pLumWinOver->SetOrigin(MCH264IS_LUM_WIN_BORDER, MCH264IS_LUM_WIN_BORDER);
+	_pChrWinOver->SetOrigin(MCH264IS_CHR_WIN_BORDER, MCH264IS_CHR_WIN_BORDER);
+
 	return(1);
 }//end Create.
 
@@ -302,6 +332,20 @@ void MotionCompensatorH264ImplStd::Destroy(void)
 	if(_pMBlk != NULL)
 		delete[] _pMBlk;
 	_pMBlk = NULL;
+
+	if(_pLumWinOver != NULL)
+		delete _pLumWinOver;
+	_pLumWinOver = NULL;
+	if(_pLumWin != NULL)
+		delete[] _pLumWin;
+	_pLumWin = NULL;
+
+	if(_pChrWinOver != NULL)
+		delete _pChrWinOver;
+	_pChrWinOver = NULL;
+	if(_pChrWin != NULL)
+		delete[] _pChrWin;
+	_pChrWin = NULL;
 }//end Destroy.
 
 /** Motion compensate to the reference.
@@ -420,7 +464,10 @@ void MotionCompensatorH264ImplStd::Compensate(int tlx, int tly, int mvx, int mvy
 		else
 		{
 			/// Read the compensated block into a work area.
-			_pExtTmpLumOver->QuarterRead(*_pMBlkOver, quarter_motion_x, quarter_motion_y);
+			if( (_pRefPicture != NULL) && _pRefPicture->IsLoaded() )
+				_pRefPicture->QuarterRead(_pMBlkOver, tlx+motion_x, tly+motion_y, quarter_motion_x, quarter_motion_y);
+			else
+				_pExtTmpLumOver->QuarterRead(*_pMBlkOver, quarter_motion_x, quarter_motion_y);
 			/// Write it to the ref.
 			_pRefLumOver->Write(*_pMBlkOver);
 		}//end else...
@@ -462,6 +509,162 @@ void MotionCompensatorH264ImplStd::Compensate(int tlx, int tly, int mvx, int mvy
 
 }//end Compensate.
 
+/** Motion compensate a single vector into a prediction buffer.
+The ref is read directly and the prediction is written to the centre of the 
+extended temp image. This avoids the copy of the entire ref that is required 
+by PrepareForSingleVectorMode() but the ref must remain unchanged until all the 
+vectors of the picture are predicted. A zero vector has the ref as its prediction
+and nothing is done. The vector coords are in quarter pel units.
+@param tlx	: Top left x coord of block.
+@param tly	: Top left y coord of block.
+@param mvx	: X coord of the motion vector in 1/4 pel units.
+@param mvy	: Y coord of the motion vector in 1/4 pel units.
+@return			: None.
+*/
+void MotionCompensatorH264ImplStd::Predict(int tlx, int tly, int mvx, int mvy)
+{
+	if( !mvx && !mvy )
+		return;
+
+	/// Lum first.
+	int motion_x					= mvx / 4;	///< Convert quarter pel units to full and quarter offsets.
+	int motion_y					= mvy / 4;
+	int quarter_motion_x	= mvx % 4;
+	int quarter_motion_y	= mvy % 4;
+
+	OverlayMem2Dv2* pSrc;
+	_pExtTmpLumOver->SetOverlayDim(_macroBlkWidth, _macroBlkHeight);
+	_pExtTmpLumOver->SetOrigin(tlx, tly);
+	if( (quarter_motion_x || quarter_motion_y) && (_pRefPicture != NULL) && _pRefPicture->IsLoaded() )
+		_pRefPicture->QuarterRead(_pExtTmpLumOver, tlx + motion_x, tly + motion_y, quarter_motion_x, quarter_motion_y);
+	else
+	{
+		_pRefLumOver->SetOverlayDim(_macroBlkWidth, _macroBlkHeight);
+		pSrc = GetPredictionSrc(_pRefLumOver, _pLumWinOver, MCH264IS_LUM_WIN_BORDER, tlx + motion_x, tly + motion_y, _imgWidth, _imgHeight);
+		if( !quarter_motion_x && !quarter_motion_y )	///< No quarter pel implies straight copy.
+			_pExtTmpLumOver->Write(*pSrc);
+		else
+			pSrc->QuarterRead(*_pExtTmpLumOver, quarter_motion_x, quarter_motion_y);
+	}//end else...
+
+	/// Chr second.
+	int offvecx					= tlx/2;
+	int offvecy					= tly/2;
+	int eighth_motion_x = mvx % 8;
+	int eighth_motion_y = mvy % 8;
+	motion_x = mvx / 8;
+	motion_y = mvy / 8;
+
+	_pRefChrUOver->SetOverlayDim(_chrMacroBlkWidth, _chrMacroBlkHeight);
+	_pRefChrVOver->SetOverlayDim(_chrMacroBlkWidth, _chrMacroBlkHeight);
+	_pExtTmpChrUOver->SetOverlayDim(_chrMacroBlkWidth, _chrMacroBlkHeight);
+	_pExtTmpChrUOver->SetOrigin(offvecx, offvecy);
+	_pExtTmpChrVOver->SetOverlayDim(_chrMacroBlkWidth, _chrMacroBlkHeight);
+	_pExtTmpChrVOver->SetOrigin(offvecx, offvecy);
+
+	/// The chr edge window is shared by both components and each is read before loading the next.
+	pSrc = GetPredictionSrc(_pRefChrUOver, _pChrWinOver, MCH264IS_CHR_WIN_BORDER, offvecx + motion_x, offvecy + motion_y, _chrWidth, _chrHeight);
+	if( !eighth_motion_x && !eighth_motion_y )	/// No eighth pel implies straight copy.
+		_pExtTmpChrUOver->Write(*pSrc);
+	else
+		pSrc->EighthRead(*_pExtTmpChrUOver, eighth_motion_x, eighth_motion_y);
+
+	pSrc = GetPredictionSrc(_pRefChrVOver, _pChrWinOver, MCH264IS_CHR_WIN_BORDER, offvecx + motion_x, offvecy + motion_y, _chrWidth, _chrHeight);
+	if( !eighth_motion_x && !eighth_motion_y )
+		_pExtTmpChrVOver->Write(*pSrc);
+	else
+		pSrc->EighthRead(*_pExtTmpChrVOver, eighth_motion_x, eighth_motion_y);
+
+}//end Predict.
+
+/** Write a predicted block to the reference.
+The prediction of a zero vector is the ref itself and is not written.
+@param tlx	: Top left x coord of block.
+@param tly	: Top left y coord of block.
+@param mvx	: X coord of the motion vector in 1/4 pel units.
+@param mvy	: Y coord of the motion vector in 1/4 pel units.
+@return			: None.
+*/
+void MotionCompensatorH264ImplStd::CommitPrediction(int tlx, int tly, int mvx, int mvy)
+{
+	if( !mvx && !mvy )
+		return;
+
+	_pRefLumOver->SetOverlayDim(_macroBlkWidth, _macroBlkHeight);
+	_pRefLumOver->SetOrigin(tlx, tly);
+	_pExtTmpLumOver->SetOverlayDim(_macroBlkWidth, _macroBlkHeight);
+	_pExtTmpLumOver->SetOrigin(tlx, tly);
+	_pRefLumOver->Write(*_pExtTmpLumOver);
+
+	_pRefChrUOver->SetOverlayDim(_chrMacroBlkWidth, _chrMacroBlkHeight);
+	_pRefChrUOver->SetOrigin(tlx/2, tly/2);
+	_pExtTmpChrUOver->SetOverlayDim(_chrMacroBlkWidth, _chrMacroBlkHeight);
+	_pExtTmpChrUOver->SetOrigin(tlx/2, tly/2);
+	_pRefChrUOver->Write(*_pExtTmpChrUOver);
+
+	_pRefChrVOver->SetOverlayDim(_chrMacroBlkWidth, _chrMacroBlkHeight);
+	_pRefChrVOver->SetOrigin(tlx/2, tly/2);
+	_pExtTmpChrVOver->SetOverlayDim(_chrMacroBlkWidth, _chrMacroBlkHeight);
+	_pExtTmpChrVOver->SetOrigin(tlx/2, tly/2);
+	_pRefChrVOver->Write(*_pExtTmpChrVOver);
+
+}//end CommitPrediction.
+
+/*
+--------------------------------------------------------------------------
+  Protected methods. 
+--------------------------------------------------------------------------
+*/
+
+/** Get the source overlay for a prediction read at a full pel position.
+When all the pels required by the sub-pixel interpolation lie inside the ref,
+the ref overlay is positioned and returned. Otherwise the pels are loaded into 
+the edge window with the ref boundary pels repeated in the same way as the 
+extended boundary of the temp image.
+@param ref		: Ref overlay with the block dimensions.
+@param win		: Edge window overlay positioned at its centre block.
+@param border	: Pels read around the block by the interpolation.
+@param x			: Full pel col of the block in the ref.
+@param y			: Full pel row of the block in the ref.
+@param width	: Ref width.
+@param height	: Ref height.
+@return				: Overlay to read from.
+*/
+OverlayMem2Dv2* MotionCompensatorH264ImplStd::GetPredictionSrc(OverlayMem2Dv2* ref, OverlayMem2Dv2* win, int border, int x, int y, int width, int height)
+{
+	int blkWidth	= ref->GetWidth();
+	int blkHeight	= ref->GetHeight();
+
+	if( ((x - border) >= 0)&&((x + blkWidth + border) < width)&&((y - border) >= 0)&&((y + blkHeight + border) < height) )
+	{
+		ref->SetOrigin(x, y);
+		return(ref);
+	}//end if x...
+
+	short** pRef = ref->Get2DSrcPtr();
+	short** pWin = win->Get2DSrcPtr();
+	for(int row = 0; row < (blkHeight + 2*border + 1); row++)
+	{
+		int refRow = y - border + row;
+		if(refRow < 0)
+			refRow = 0;
+		else if(refRow >= height)
+			refRow = height - 1;
+		for(int col = 0; col < (blkWidth + 2*border + 1); col++)
+		{
+			int refCol = x - border + col;
+			if(refCol < 0)
+				refCol = 0;
+			else if(refCol >= width)
+				refCol = width - 1;
+			pWin[row][col] = pRef[refRow][refCol];
+		}//end for col...
+	}//end for row...
+
+	return(win);
+}//end GetPredictionSrc.
+
+
 /*
 --------------------------------------------------------------------------------------
 	Redundant code.
@@ -38,6 +38,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "VectorStructList.h"
 #include "OverlayMem2Dv2.h"
 #include "OverlayExtMem2Dv2.h"
+#include "RefPictureH264.h"
 
 /*
 ---------------------------------------------------------------------------
@@ -93,11 +94,37 @@ class MotionCompensatorH264ImplStd : public IMotionCompensator
 		virtual void PrepareForSingleVectorMode(void);
     virtual void Invalidate(void) { _invalid = 1; }
 
+		/** Motion compensate a single vector into a prediction buffer.
+		The ref is read directly and the prediction is written to the centre
+		of the extended temp image, which is not required in this mode. Blocks 
+		that read across the ref boundary are read through an edge window. The
+		vector coords are in quarter pel units for this implementation.
+		@param tlx	: Top left x coord of block.
+		@param tly	: Top left y coord of block.
+		@param mvx	: X coord of the motion vector.
+		@param mvy	: Y coord of the motion vector.
+		@return			: None.
+		*/
+		virtual void Predict(int tlx, int tly, int mvx, int mvy);
+
+		/** Write a predicted block to the reference.
+		@param tlx	: Top left x coord of block.
+		@param tly	: Top left y coord of block.
+		@param mvx	: X coord of the motion vector.
+		@param mvy	: Y coord of the motion vector.
+		@return			: None.
+		*/
+		virtual void CommitPrediction(int tlx, int tly, int mvx, int mvy);
+
+		/// The lum 1/4 pel reads use the 1/2 pel planes when they hold the current ref.
+		virtual void SetRefPicture(void* pRefPicture) { _pRefPicture = (RefPictureH264 *)pRefPicture; }
+
 	/// Local methods.
 	protected:
 	void LoadHalfQuartPelWindow(OverlayMem2Dv2* qPelWin, OverlayMem2Dv2* extRef);
 	void LoadQuartPelWindow(OverlayMem2Dv2* qPelWin, int hPelColOff, int hPelRowOff);
 	void QuarterRead(OverlayMem2Dv2* dstBlock, OverlayMem2Dv2* qPelWin, int qPelColOff, int qPelRowOff);
+	OverlayMem2Dv2* GetPredictionSrc(OverlayMem2Dv2* ref, OverlayMem2Dv2* win, int border, int x, int y, int width, int height);
 
 	/// Local methods.
 	protected:
@@ -141,6 +168,16 @@ class MotionCompensatorH264ImplStd : public IMotionCompensator
 		/// A work block.
 		short*					_pMBlk;
 		OverlayMem2Dv2* _pMBlkOver;
+
+		/// Edge windows with the ref boundary pels repeated for predictions that 
+		/// read outside of the ref.
+		short*					_pLumWin;
+		OverlayMem2Dv2* _pLumWinOver;
+		short*					_pChrWin;
+		OverlayMem2Dv2* _pChrWinOver;
+
+		/// Optional shared 1/2 pel planes of the ref. Not owned.
+		RefPictureH264*	_pRefPicture;
 };//end MotionCompensatorH264ImplStd.
 
 
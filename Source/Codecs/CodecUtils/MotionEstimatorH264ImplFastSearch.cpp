@@ -0,0 +1,709 @@
+/** @file
+
+MODULE				: MotionEstimatorH264ImplFastSearch
+
+TAG						: MEH264IFS
+
+FILE NAME			: MotionEstimatorH264ImplFastSearch.cpp
+
+DESCRIPTION		: A fast unrestricted motion estimator implementation for
+								Recommendation H.264 (03/2005) with a square error measure.
+								Access is via an IMotionEstimator interface. The full pel
+								search is a small diamond, large diamond, hexagon or
+								predictive zonal (EPZS) pattern search selected by the mode
+								and is followed by a 1/2 and 1/4 pel refinement. The
+								boundary is extended to accomodate the selected motion range.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include	"MotionEstimatorH264ImplFastSearch.h"
+
+/*
+--------------------------------------------------------------------------
+  Constants.
+--------------------------------------------------------------------------
+*/
+/// Calc = ((16[vec dim] * 16[vec dim]) * 2.
+#define MEH264IFS_FULL_MOTION_NOISE_FLOOR					512
+
+/// Boundary padding past the motion vector extremes. Required for calculating
+/// sub-pixel interpolations.
+#define MEH264IFS_PADDING													3
+
+/// Search patterns around the centre vector.
+#define MEH264IFS_SMALL_DIAMOND_LENGTH	4
+static const MEH264IFS_COORD MEH264IFS_SmallDiamond[MEH264IFS_SMALL_DIAMOND_LENGTH] =
+{
+	{-1,0},{1,0},{0,-1},{0,1}
+};
+
+#define MEH264IFS_LARGE_DIAMOND_LENGTH	8
+static const MEH264IFS_COORD MEH264IFS_LargeDiamond[MEH264IFS_LARGE_DIAMOND_LENGTH] =
+{
+	{-2,0},{2,0},{0,-2},{0,2},{-1,-1},{1,-1},{-1,1},{1,1}
+};
+
+#define MEH264IFS_HEXAGON_LENGTH				6
+static const MEH264IFS_COORD MEH264IFS_Hexagon[MEH264IFS_HEXAGON_LENGTH] =
+{
+	{-2,0},{2,0},{-1,-2},{1,-2},{-1,2},{1,2}
+};
+
+/// Sub pel positions around the centre vector.
+#define MEH264IFS_SUB_POS_LENGTH				8
+static const MEH264IFS_COORD MEH264IFS_SubPos[MEH264IFS_SUB_POS_LENGTH] =
+{
+	{-1,-1},{0,-1},{1,-1},{-1,0},{1,0},{-1,1},{0,1},{1,1}
+};
+
+/*
+--------------------------------------------------------------------------
+  Construction.
+--------------------------------------------------------------------------
+*/
+
+MotionEstimatorH264ImplFastSearch::MotionEstimatorH264ImplFastSearch(	const void*							pSrc,
+																																			const void*							pRef,
+																																			int											imgWidth,
+																																			int											imgHeight,
+																																			int											motionRange,
+																																			IMotionVectorPredictor*	pMVPred)
+{
+	ResetMembers();
+
+	/// Parameters must remain const for the life time of this instantiation.
+	_imgWidth				= imgWidth;					///< Width of the src and ref images.
+	_imgHeight			= imgHeight;				///< Height of the src and ref images.
+	_macroBlkWidth	= 16;								///< Width of the motion block = 16 for H.264.
+	_macroBlkHeight	= 16;								///< Height of the motion block = 16 for H.264.
+	_motionRange		= motionRange;			///< (4x,4y) range of the motion vectors. _motionRange in 1/4 pel units.
+	_pInput					= pSrc;
+	_pRef						= pRef;
+	_pMVPred				= pMVPred;
+
+}//end constructor.
+
+MotionEstimatorH264ImplFastSearch::MotionEstimatorH264ImplFastSearch(	const void*							pSrc,
+																																			const void*							pRef,
+																																			int											imgWidth,
+																																			int											imgHeight,
+																																			int											motionRange,
+																																			IMotionVectorPredictor*	pMVPred,
+																																			void*										pDistortionIncluded)
+{
+	ResetMembers();
+
+	/// Parameters must remain const for the life time of this instantiation.
+	_imgWidth							= imgWidth;					///< Width of the src and ref images.
+	_imgHeight						= imgHeight;				///< Height of the src and ref images.
+	_macroBlkWidth				= 16;								///< Width of the motion block = 16 for H.264.
+	_macroBlkHeight				= 16;								///< Height of the motion block = 16 for H.264.
+	_motionRange					= motionRange;			///< (4x,4y) range of the motion vectors. _motionRange in 1/4 pel units.
+	_pInput								= pSrc;
+	_pRef									= pRef;
+	_pMVPred							= pMVPred;
+	_pDistortionIncluded	= (bool *)pDistortionIncluded;
+
+}//end constructor.
+
+void MotionEstimatorH264ImplFastSearch::ResetMembers(void)
+{
+	_ready						= 0;	///< Ready to estimate.
+	_mode							= 4;	///< Search pattern. Default to EPZS.
+	_prevResultValid	= 0;
+
+	/// Parameters must remain const for the life time of this instantiation.
+	_imgWidth				= 0;					///< Width of the src and ref images.
+	_imgHeight			= 0;					///< Height of the src and ref images.
+	_macroBlkWidth	= 16;					///< Width of the motion block = 16 for H.264.
+	_macroBlkHeight	= 16;					///< Height of the motion block = 16 for H.264.
+	_motionRange		= 64;					///< (4x,4y) range of the motion vectors.
+	_pInput					= NULL;
+	_pRef						= NULL;
+
+	/// Input mem overlay members.
+	_pInOver					= NULL;			///< Input overlay with motion block dim.
+
+	/// Ref mem overlay members.
+	_pRefOver					= NULL;			///< Ref overlay with whole block dim.
+	_pExtRef					= NULL;			///< Extended ref mem created by ExtendBoundary() call.
+	_extWidth					= 0;
+	_extHeight				= 0;
+	_extBoundary			= 0;
+	_pExtRefOver			= NULL;			///< Extended ref overlay with motion block dim.
+
+	/// Full pel search window of the current macroblock.
+	_xlRng						= 0;
+	_xrRng						= 0;
+	_yuRng						= 0;
+	_ydRng						= 0;
+	_searchPoints			= 0;
+
+	/// Temp working block and its overlay.
+	_pMBlk						= NULL;			///< Motion block temp mem.
+	_pMBlkOver				= NULL;			///< Motion block overlay of temp mem.
+
+	/// Hold the resulting motion vectors in a byte array.
+	_pMotionVectorStruct = NULL;
+	/// Attached motion vector predictor on construction.
+	_pMVPred						 = NULL;
+	/// Optional shared 1/2 pel planes of the ref.
+	_pRefPicture				 = NULL;
+
+	/// A flag per macroblock to include it in the distortion accumulation.
+	_pDistortionIncluded = NULL;
+}//end ResetMembers.
+
+MotionEstimatorH264ImplFastSearch::~MotionEstimatorH264ImplFastSearch(void)
+{
+	Destroy();
+}//end destructor.
+
+/*
+--------------------------------------------------------------------------
+  Public IMotionEstimator Interface.
+--------------------------------------------------------------------------
+*/
+
+int MotionEstimatorH264ImplFastSearch::Create(void)
+{
+	/// Clean out old mem.
+	Destroy();
+
+	/// --------------- Configure input overlays --------------------------------
+	/// Put an overlay on the input with the block size set to the vector dim. This
+	/// is used to access input vectors.
+	_pInOver = new OverlayMem2Dv2((void *)_pInput,_imgWidth,_imgHeight,_macroBlkWidth,_macroBlkHeight);
+	if(_pInOver == NULL)
+	{
+		Destroy();
+		return(0);
+	}//end _pInOver...
+
+	/// --------------- Configure ref overlays --------------------------------
+	/// Overlay the whole reference. The reference will have an extended boundary
+	/// for motion estimation and must therefore have its own mem.
+	_pRefOver = new OverlayMem2Dv2((void *)_pRef, _imgWidth, _imgHeight, _imgWidth, _imgHeight);
+	if(_pRefOver == NULL)
+	{
+		Destroy();
+		return(0);
+	}//end if !_pRefOver...
+
+	/// Create the new extended boundary ref into _pExtRef. The boundary is extended by
+	/// the max dimension of the macroblock.
+	_extBoundary = _macroBlkWidth + MEH264IFS_PADDING;
+	if(_macroBlkHeight > _macroBlkWidth)
+		_extBoundary = _macroBlkHeight + MEH264IFS_PADDING;
+	if(!OverlayExtMem2Dv2::ExtendBoundary((void *)_pRef,
+																				_imgWidth,
+																				_imgHeight,
+																				_extBoundary,	///< Extend left and right by...
+																				_extBoundary,	///< Extend top and bottom by...
+																				(void **)(&_pExtRef)) )	///< Created in the method and returned.
+	{
+		Destroy();
+		return(0);
+	}//end if !ExtendBoundary...
+	_extWidth	 = _imgWidth + (2 * _extBoundary);
+	_extHeight = _imgHeight + (2 * _extBoundary);
+
+	/// Place an overlay on the extended boundary ref with block size set to the motion vec dim.
+	_pExtRefOver = new OverlayExtMem2Dv2(	_pExtRef,				///< Src description.
+																				_extWidth,
+																				_extHeight,
+																				_macroBlkWidth,	///< Block size description.
+																				_macroBlkHeight,
+																				_extBoundary,		///< Boundary size for both left and right.
+																				_extBoundary  );
+	if(_pExtRefOver == NULL)
+	{
+		Destroy();
+		return(0);
+	}//end if !_pExtRefOver...
+
+	/// --------------- Configure temp overlays --------------------------------
+	/// Alloc some temp mem and overlay it to use for sub pel motion estimation. The
+	/// block size is the same as the mem size.
+	_pMBlk = new short[_macroBlkWidth * _macroBlkHeight];
+	_pMBlkOver = new OverlayMem2Dv2(_pMBlk, _macroBlkWidth, _macroBlkHeight,
+																					_macroBlkWidth, _macroBlkHeight);
+	if( (_pMBlk == NULL)||(_pMBlkOver == NULL) )
+	{
+		Destroy();
+		return(0);
+	}//end if !_pMBlk...
+
+	/// --------------- Configure result ---------------------------------------
+	/// The structure container for the motion vectors.
+	_pMotionVectorStruct = new VectorStructList(VectorStructList::SIMPLE2D);
+	if(_pMotionVectorStruct != NULL)
+	{
+		/// How many motion vectors will there be at the block dim.
+		int numVecs = (_imgWidth/_macroBlkWidth) * (_imgHeight/_macroBlkHeight);
+		if(!_pMotionVectorStruct->SetLength(numVecs))
+		{
+			Destroy();
+			return(0);
+		}//end _pMotionVectorStruct...
+	}//end if _pMotionVectorStruct...
+	else
+	{
+		Destroy();
+		return(0);
+	}//end if else...
+
+	_ready = 1;
+	return(1);
+}//end Create.
+
+void	MotionEstimatorH264ImplFastSearch::Reset(void)
+{
+	/// The previous vectors are no longer candidates.
+	_prevResultValid = 0;
+}//end Reset.
+
+/** Set the search pattern mode.
+Mode = 1 is an iterated small diamond search from the best of the zero and
+predicted vectors. Mode = 2 and mode = 3 iterate a large diamond and a hexagon
+respectively and complete with a small diamond. Mode = 4 is the EPZS mode that
+seeds the search with the best of the predicted vector, the previous result and
+the neighbouring macroblock vectors. Mode = 0 is auto mode and selects EPZS.
+@param mode	: Mode to set.
+@return			: none.
+*/
+void	MotionEstimatorH264ImplFastSearch::SetMode(int mode)
+{
+	if( (mode < 1)||(mode > 4) )	///< Auto mode.
+		_mode = 4;
+	else
+		_mode = mode;
+}//end SetMode.
+
+/** Motion estimate the source within the reference.
+Do the estimation with the block sizes and image sizes defined in
+the implementation. The returned type holds the vectors. This is a
+pattern search algorithm with extended boundaries and a square error
+criterion. The mode setting (_mode) determines the search pattern.
+@param avgDistortion	: Returned avg distortion of the selected vectors.
+@return								: The list of motion vectors.
+*/
+void* MotionEstimatorH264ImplFastSearch::Estimate(long* avgDistortion)
+{
+	int		m,n,x;
+	int		included = 0;
+	long	totalDifference = 0;
+
+	/// Set the motion vector struct storage structure.
+	int		maxLength	= _pMotionVectorStruct->GetLength();
+	int		vecPos		= 0;
+	int		vecRange	= _motionRange/4;	///< Full pel units.
+
+	_searchPoints = 0;
+
+	/// Write the ref and fill its extended boundary. The centre part of _pExtRefOver
+	/// is copied from _pRefOver before filling the boundary.
+	_pExtRefOver->SetOrigin(0, 0);
+	_pExtRefOver->SetOverlayDim(_imgWidth, _imgHeight);
+	_pExtRefOver->Write(*_pRefOver);	///< _pRefOver dimensions are always set to the whole image.
+	_pExtRefOver->FillBoundaryProxy();
+	_pExtRefOver->SetOverlayDim(_macroBlkWidth, _macroBlkHeight);
+
+	for(m = 0; m < _imgHeight; m += _macroBlkHeight)
+		for(n = 0; n < _imgWidth; n += _macroBlkWidth)
+	{
+		int mx	= 0;	///< Full pel grid.
+		int my	= 0;
+		int hmx	= 0;	///< 1/2 pel on 1/4 pel grid.
+		int hmy	= 0;
+		int qmx	= 0;	///< 1/4 pel grid.
+		int qmy	= 0;
+
+		/// The full pel search window is limited by the max vector range and the extended
+		/// boundary less the sub pel interpolation padding.
+		int boundary = _extBoundary - MEH264IFS_PADDING;
+		_xlRng = ( (n - (vecRange-1)) >= -boundary )? -(vecRange-1) : -(n + boundary);
+		_xrRng = ( (n + (vecRange-1)) < _imgWidth )? (vecRange-1) : (_imgWidth - n);
+		_yuRng = ( (m - (vecRange-1)) >= -boundary )? -(vecRange-1) : -(m + boundary);
+		_ydRng = ( (m + (vecRange-1)) < _imgHeight )? (vecRange-1) : (_imgHeight - m);
+
+		/// The predicted vector is the most likely candidate.
+		int predX, predY, predX0Rnd, predY0Rnd;
+		_pMVPred->Get16x16Prediction(NULL, vecPos, &predX, &predY);
+		int predXQuart	= predX % 4;
+		int predYQuart	= predY % 4;
+		int predX0			= predX / 4;
+		int predY0			= predY / 4;
+		predX0Rnd = (predX < 0)? (predX - 2)/4 : (predX + 2)/4;	///< Nearest full pel pred motion vector.
+		predY0Rnd = (predY < 0)? (predY - 2)/4 : (predY + 2)/4;
+
+		/// Set the input and ref blocks to work with.
+		_pInOver->SetOrigin(n,m);
+		_pExtRefOver->SetOrigin(n,m);
+
+		int zeroVecDiff = _pInOver->Tsd16x16(*_pExtRefOver);
+		int minDiff			= zeroVecDiff;	///< Best so far.
+		_searchPoints++;
+
+		///----------------------- Full pel search ----------------------------------------
+		/// Static macroblocks with a distortion in the order of the noise are not searched.
+		int search = (zeroVecDiff >= MVCL_EARLY_EXIT_THRESHOLD);
+		if(search)
+		{
+			if(_mode == 4)	///< EPZS.
+			{
+				minDiff = GetBestCandidate(n, m, vecPos, predX0Rnd, predY0Rnd, zeroVecDiff, &mx, &my);
+				if(minDiff >= MVCL_EARLY_EXIT_THRESHOLD)
+				{
+					/// Poor candidates are searched over a wider area first.
+					if(minDiff >= MVCL_SEED_THRESHOLD)
+						minDiff = PatternSearch(MEH264IFS_LargeDiamond, MEH264IFS_LARGE_DIAMOND_LENGTH, n, m, &mx, &my, minDiff);
+					minDiff = PatternSearch(MEH264IFS_SmallDiamond, MEH264IFS_SMALL_DIAMOND_LENGTH, n, m, &mx, &my, minDiff);
+				}//end if minDiff...
+				else
+					search = 0;
+			}//end if _mode...
+			else
+			{
+				/// Start from the better of the zero and the predicted vectors.
+				if( (predX0Rnd||predY0Rnd) &&
+						(predX0Rnd >= _xlRng)&&(predX0Rnd <= _xrRng)&&(predY0Rnd >= _yuRng)&&(predY0Rnd <= _ydRng) )
+				{
+					_pExtRefOver->SetOrigin(n+predX0Rnd, m+predY0Rnd);
+					int blkDiff = _pInOver->Tsd16x16LessThan(*_pExtRefOver, minDiff);
+					_searchPoints++;
+					if(blkDiff < minDiff)
+					{
+						minDiff = blkDiff;
+						mx			= predX0Rnd;
+						my			= predY0Rnd;
+					}//end if blkDiff...
+				}//end if predX0Rnd...
+
+				if(_mode == 2)
+					minDiff = PatternSearch(MEH264IFS_LargeDiamond, MEH264IFS_LARGE_DIAMOND_LENGTH, n, m, &mx, &my, minDiff);
+				else if(_mode == 3)
+					minDiff = PatternSearch(MEH264IFS_Hexagon, MEH264IFS_HEXAGON_LENGTH, n, m, &mx, &my, minDiff);
+				minDiff = PatternSearch(MEH264IFS_SmallDiamond, MEH264IFS_SMALL_DIAMOND_LENGTH, n, m, &mx, &my, minDiff);
+			}//end else...
+		}//end if search...
+
+		int mvx = mx << 2;	///< Convert to 1/4 pel units.
+		int mvy = my << 2;
+
+		///----------------------- Quarter pel refined search ------------------------------
+		/// Search around the min diff full pel motion vector on the 1/2 pel positions and
+		/// then refine the winner on the 1/4 pel positions.
+		if(search)
+		{
+			for(x = 0; x < MEH264IFS_SUB_POS_LENGTH; x++)
+			{
+				int qOffX = 2 * MEH264IFS_SubPos[x].x;
+				int qOffY = 2 * MEH264IFS_SubPos[x].y;
+				int blkDiff = _pInOver->Tsd16x16LessThan(*SubPelBlock(n, m, mx, my, qOffX, qOffY), minDiff);
+				_searchPoints++;
+				if(blkDiff < minDiff)
+				{
+					minDiff = blkDiff;
+					hmx = qOffX;
+					hmy = qOffY;
+				}//end if blkDiff...
+			}//end for x...
+
+			qmx = hmx;
+			qmy = hmy;
+			for(x = 0; x < MEH264IFS_SUB_POS_LENGTH; x++)
+			{
+				int qOffX = hmx + MEH264IFS_SubPos[x].x;
+				int qOffY = hmy + MEH264IFS_SubPos[x].y;
+				int blkDiff = _pInOver->Tsd16x16LessThan(*SubPelBlock(n, m, mx, my, qOffX, qOffY), minDiff);
+				_searchPoints++;
+				if(blkDiff < minDiff)
+				{
+					minDiff = blkDiff;
+					qmx = qOffX;
+					qmy = qOffY;
+				}//end if blkDiff...
+			}//end for x...
+
+			/// Add the refinement in 1/4 pel units.
+			mvx += qmx;
+			mvy += qmy;
+		}//end if search...
+
+		///----------------------- Quarter pel pred vector ---------------------------------
+		/// Compare this winning vector with the predicted mv but truncate it if it
+		/// falls outside of one mb width or height outside the img boundaries.
+		if( (predX0+n) > _imgWidth)
+			predX0 = _macroBlkWidth;
+		if( (predX0+n) < -_macroBlkWidth)
+			predX0 = -_macroBlkWidth;
+		if( (predY0+m) > _imgHeight)
+			predY0 = _macroBlkHeight;
+		if( (predY0+m) < -_macroBlkHeight)
+			predY0 = -_macroBlkHeight;
+		predX = (predX0 * 4) + predXQuart;
+		predY = (predY0 * 4) + predYQuart;
+
+		/// Get distortion at pred mv.
+		int predVecDiff = _pInOver->Tsd16x16(*SubPelBlock(n, m, predX0, predY0, predXQuart, predYQuart));
+
+		/// Selection of the final motion vector is weighted with non-linear factors. The
+		/// zero vector will be modified to the best of either the predicted mv or the zero mv.
+		int zeromvx, zeromvy;
+		if(predVecDiff <= zeroVecDiff)
+		{
+			zeroVecDiff = predVecDiff;
+			zeromvx			= predX;
+			zeromvy			= predY;
+		}//end if predVecDiff...
+		else
+		{
+			zeromvx			= 0;
+			zeromvy			= 0;
+		}//end else...
+
+		int diffWithZeroDiff	= zeroVecDiff - minDiff;
+		int weight						= 0;
+		int magSqr						= (mvx * mvx) + (mvy * mvy);
+
+		/// Contribute if motion vector is small.
+		if(diffWithZeroDiff < magSqr)
+			weight++;
+		/// Contribute if same order as the noise.
+		if(zeroVecDiff < MEH264IFS_FULL_MOTION_NOISE_FLOOR)
+			weight++;
+		/// Contribute if the zero vector and min energy vector are similar.
+		if((diffWithZeroDiff * 10) < minDiff)
+			weight++;
+
+		/// Check for inclusion in the distortion calculation.
+		bool doIt = true;
+		if(_pDistortionIncluded != NULL)
+			doIt = _pDistortionIncluded[vecPos];
+		if(doIt)
+			included++;
+
+		/// Decide whether or not to accept the final motion vector or revert to the zero/pred motion vector.
+		if((minDiff < zeroVecDiff)&&(weight < 2))
+		{
+			if(doIt)
+				totalDifference += minDiff;
+		}//end if minDiff...
+		else
+		{
+			mvx = zeromvx;
+			mvy = zeromvy;
+			if(doIt)
+				totalDifference += zeroVecDiff;
+		}//end else...
+
+		/// Load the selected vector coord.
+		if(vecPos < maxLength)
+		{
+			_pMotionVectorStruct->SetSimpleElement(vecPos, 0, mvx);
+			_pMotionVectorStruct->SetSimpleElement(vecPos, 1, mvy);
+			/// Set macroblock vector for future predictions.
+			_pMVPred->Set16x16MotionVector(vecPos, mvx, mvy);
+			vecPos++;
+		}//end if vecPos...
+
+	}//end for m & n...
+
+	/// The vectors are candidates for the next estimation.
+	_prevResultValid = 1;
+
+	/// In this context avg distortion is actually avg difference.
+	if(included)	///< Prevent divide by zero error.
+		*avgDistortion = totalDifference/included;
+	else
+		*avgDistortion = 0;
+	return((void *)_pMotionVectorStruct);
+
+}//end Estimate.
+
+/*
+--------------------------------------------------------------------------
+  Private methods.
+--------------------------------------------------------------------------
+*/
+
+void MotionEstimatorH264ImplFastSearch::Destroy(void)
+{
+	_ready = 0;
+
+	if(_pInOver != NULL)
+		delete _pInOver;
+	_pInOver = NULL;
+
+	if(_pRefOver != NULL)
+		delete _pRefOver;
+	_pRefOver	= NULL;
+
+	if(_pExtRef != NULL)
+		delete[] _pExtRef;
+	_pExtRef = NULL;
+
+	if(_pExtRefOver != NULL)
+		delete _pExtRefOver;
+	_pExtRefOver = NULL;
+
+	if(_pMBlk != NULL)
+		delete[] _pMBlk;
+	_pMBlk = NULL;
+
+	if(_pMBlkOver != NULL)
+		delete _pMBlkOver;
+	_pMBlkOver = NULL;
+
+	if(_pMotionVectorStruct != NULL)
+		delete _pMotionVectorStruct;
+	_pMotionVectorStruct = NULL;
+
+}//end Destroy.
+
+/** Iterate a full pel search pattern.
+The pattern is moved to its best point until the centre is the best point. Points
+outside of the search window of the macroblock are not checked. The number of
+iterations is limited by the motion range.
+@param pattern	: Offsets from the centre.
+@param len			: Number of offsets.
+@param n				: X coord of the macroblock.
+@param m				: Y coord of the macroblock.
+@param mx				: Start and returned best x coord of the full pel vector.
+@param my				: Start and returned best y coord of the full pel vector.
+@param minDiff	: Distortion at the start vector.
+@return					: Distortion at the best vector.
+*/
+int MotionEstimatorH264ImplFastSearch::PatternSearch(const MEH264IFS_COORD* pattern, int len, int n, int m, int* mx, int* my, int minDiff)
+{
+	int cx = *mx;
+	int cy = *my;
+
+	for(int iter = (_motionRange/4); iter > 0; iter--)
+	{
+		int bx = cx;
+		int by = cy;
+		for(int i = 0; i < len; i++)
+		{
+			int x = cx + pattern[i].x;
+			int y = cy + pattern[i].y;
+			if( (x < _xlRng)||(x > _xrRng)||(y < _yuRng)||(y > _ydRng) )
+				continue;
+
+			_pExtRefOver->SetOrigin(n+x, m+y);
+			int blkDiff = _pInOver->Tsd16x16LessThan(*_pExtRefOver, minDiff);
+			_searchPoints++;
+			if(blkDiff < minDiff)
+			{
+				minDiff = blkDiff;
+				bx			= x;
+				by			= y;
+			}//end if blkDiff...
+		}//end for i...
+
+		/// Converged when the centre remains the best.
+		if( (bx == cx)&&(by == cy) )
+			break;
+		cx = bx;
+		cy = by;
+	}//end for iter...
+
+	*mx = cx;
+	*my = cy;
+	return(minDiff);
+}//end PatternSearch.
+
+/** Get the best full pel candidate vector for the EPZS mode.
+The candidates within the search window are listed by a MotionVectorCandidateList. The
+motion vector struct still holds the previous result from vecPos onwards.
+@param n						: X coord of the macroblock.
+@param m						: Y coord of the macroblock.
+@param vecPos				: Macroblock position in the motion vector struct.
+@param predX				: X coord of the nearest full pel predicted vector.
+@param predY				: Y coord of the nearest full pel predicted vector.
+@param zeroVecDiff	: Distortion of the zero vector.
+@param bestX				: Returned x coord of the best candidate. Zero if none are better.
+@param bestY				: Returned y coord of the best candidate.
+@return							: Distortion of the best candidate.
+*/
+int MotionEstimatorH264ImplFastSearch::GetBestCandidate(int n, int m, int vecPos, int predX, int predY, int zeroVecDiff, int* bestX, int* bestY)
+{
+	MotionVectorCandidateList cand;
+	cand.Load(_pMotionVectorStruct, _prevResultValid, vecPos, n, m, _imgWidth, _imgHeight, predX, predY, _xlRng, _xrRng, _yuRng, _ydRng);
+
+	int minDiff = zeroVecDiff;
+	*bestX = 0;
+	*bestY = 0;
+	for(int i = 0; i < cand.GetLength(); i++)
+	{
+		int x = cand.GetX(i);
+		int y = cand.GetY(i);
+
+		_pExtRefOver->SetOrigin(n+x, m+y);
+		int blkDiff = _pInOver->Tsd16x16LessThan(*_pExtRefOver, minDiff);
+		_searchPoints++;
+		if(blkDiff < minDiff)
+		{
+			minDiff = blkDiff;
+			*bestX	= x;
+			*bestY	= y;
+		}//end if blkDiff...
+	}//end for i...
+
+	return(minDiff);
+}//end GetBestCandidate.
+
+/** Get the ref block at a sub pel vector.
+The block at the full pel vector (mx,my) is read at the 1/4 pel offset (qx,qy)
+from the 1/2 pel planes when loaded or else from the extended ref.
+@param n				: X coord of the macroblock.
+@param m				: Y coord of the macroblock.
+@param mx				: X coord of the full pel vector.
+@param my				: Y coord of the full pel vector.
+@param qx				: 1/4 pel x offset in the range [-3..3].
+@param qy				: 1/4 pel y offset in the range [-3..3].
+@return					: The extended ref overlay at a full pel vector or else the temp block.
+*/
+OverlayMem2Dv2* MotionEstimatorH264ImplFastSearch::SubPelBlock(int n, int m, int mx, int my, int qx, int qy)
+{
+	_pExtRefOver->SetOrigin(n+mx, m+my);
+	if( !(qx||qy) )
+		return(_pExtRefOver);
+
+	if( (_pRefPicture != NULL) && _pRefPicture->IsLoaded() )
+		_pRefPicture->QuarterRead(_pMBlkOver, n+mx, m+my, qx, qy);
+	else
+		_pExtRefOver->QuarterRead(*_pMBlkOver, qx, qy);
+	return(_pMBlkOver);
+}//end SubPelBlock.
+
@@ -0,0 +1,176 @@
+/** @file
+
+MODULE				: MotionEstimatorH264ImplFastSearch
+
+TAG						: MEH264IFS
+
+FILE NAME			: MotionEstimatorH264ImplFastSearch.h
+
+DESCRIPTION		: A fast unrestricted motion estimator implementation for
+								Recommendation H.264 (03/2005) with a square error measure.
+								Access is via an IMotionEstimator interface. The full pel
+								search is a small diamond, large diamond, hexagon or
+								predictive zonal (EPZS) pattern search selected by the mode
+								and is followed by a 1/2 and 1/4 pel refinement. The
+								boundary is extended to accomodate the selected motion range.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifndef _MOTIONESTIMATORH264IMPLFASTSEARCH_H
+#define _MOTIONESTIMATORH264IMPLFASTSEARCH_H
+
+#include "IMotionEstimator.h"
+#include "IMotionVectorPredictor.h"
+#include "VectorStructList.h"
+#include "MotionVectorCandidateList.h"
+#include "OverlayMem2Dv2.h"
+#include "OverlayExtMem2Dv2.h"
+#include "RefPictureH264.h"
+
+/*
+---------------------------------------------------------------------------
+	Struct definition.
+---------------------------------------------------------------------------
+*/
+typedef struct _MEH264IFS_COORD
+{
+	short int x;
+	short int y;
+} MEH264IFS_COORD;
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class MotionEstimatorH264ImplFastSearch : public IMotionEstimator
+{
+/// Construction.
+public:
+
+	MotionEstimatorH264ImplFastSearch(const void*							pSrc,
+																		const void*							pRef,
+																		int											imgWidth,
+																		int											imgHeight,
+																		int											motionRange,
+																		IMotionVectorPredictor*	pMVPred);
+
+	MotionEstimatorH264ImplFastSearch(const void*							pSrc,
+																		const void*							pRef,
+																		int											imgWidth,
+																		int											imgHeight,
+																		int											motionRange,
+																		IMotionVectorPredictor*	pMVPred,
+																		void*										pDistortionIncluded);
+
+	virtual ~MotionEstimatorH264ImplFastSearch(void);
+
+/// IMotionEstimator Interface.
+public:
+	virtual int		Create(void);
+	virtual void	Reset(void);
+	virtual int		Ready(void)		{ return(_ready); }
+	virtual void	SetMode(int mode);
+	virtual int		GetMode(void) { return(_mode); }
+
+	/** Motion estimate the source within the reference.
+	Do the estimation with the block sizes and image sizes defined in
+	the implementation. The returned type holds the vectors.
+	@param pSrc		: Input image to estimate.
+	@param pRef		: Ref to estimate with.
+	@return				: The list of motion vectors.
+	*/
+	virtual void* Estimate(const void* pSrc, const void* pRef, long* avgDistortion)
+		{ return(Estimate(avgDistortion)); }
+	virtual void* Estimate(long* avgDistortion);
+
+	/// The 1/2 pel planes are used for the sub pel search when they hold the current ref.
+	virtual void	SetRefPicture(void* pRefPicture) { _pRefPicture = (RefPictureH264 *)pRefPicture; }
+
+	/// Number of block distortions calculated in the last estimation.
+	int		GetSearchPoints(void) { return(_searchPoints); }
+
+/// Local methods.
+protected:
+
+	/// Used by constructors to reset every member.
+	void ResetMembers(void);
+	/// Clear alloc mem.
+	void Destroy(void);
+
+	/// Iterate a full pel search pattern from (mx,my) until the centre is the best point.
+	int	 PatternSearch(const MEH264IFS_COORD* pattern, int len, int n, int m, int* mx, int* my, int minDiff);
+	/// Best full pel candidate vector of the EPZS mode and its distortion.
+	int	 GetBestCandidate(int n, int m, int vecPos, int predX, int predY, int zeroVecDiff, int* bestX, int* bestY);
+	/// Ref block at a full pel vector with a 1/4 pel offset.
+	OverlayMem2Dv2* SubPelBlock(int n, int m, int mx, int my, int qx, int qy);
+
+protected:
+
+	int _ready;	///< Ready to estimate.
+	int _mode;	///< Search pattern. [ 1 = small diamond, 2 = large diamond, 3 = hexagon, 4 = EPZS.]
+	int _prevResultValid;	///< The motion vector struct holds the previous estimation.
+
+	/// Parameters must remain const for the life time of this instantiation.
+	int	_imgWidth;				///< Width of the src and ref images.
+	int	_imgHeight;				///< Height of the src and ref images.
+	int	_macroBlkWidth;		///< Width of the motion block.
+	int	_macroBlkHeight;	///< Height of the motion block.
+	int	_motionRange;			///< (4x,4y) range of the motion vectors in 1/4 pel units.
+
+	const void*	_pInput;	///< References to the images at construction.
+	const void* _pRef;
+
+	/// Input mem overlay members.
+	OverlayMem2Dv2*		_pInOver;					///< Input overlay with motion block dim.
+
+	/// Ref mem overlay members.
+	OverlayMem2Dv2*			_pRefOver;				///< Ref overlay with whole block dim.
+	short*							_pExtRef;					///< Extended ref mem created by ExtendBoundary() call.
+	int									_extWidth;
+	int									_extHeight;
+	int									_extBoundary;			///< Extended boundary for left, right, up and down.
+	OverlayExtMem2Dv2*	_pExtRefOver;			///< Extended ref overlay with motion block dim.
+
+	/// Full pel search window of the current macroblock.
+	int									_xlRng;						///< Allowed vector range from the macroblock position.
+	int									_xrRng;
+	int									_yuRng;
+	int									_ydRng;
+	int									_searchPoints;		///< Block distortions calculated in the last estimation.
+
+	/// Temp working block and its overlay.
+	short*							_pMBlk;						///< Motion block temp mem.
+	OverlayMem2Dv2*			_pMBlkOver;				///< Motion block overlay of temp mem.
+
+	/// Hold the resulting motion vectors in a byte array.
+	VectorStructList*	_pMotionVectorStruct;
+	/// Attached motion vector predictor on construction.
+	IMotionVectorPredictor* _pMVPred;
+	/// Optional shared 1/2 pel planes of the ref. Not owned.
+	RefPictureH264*					_pRefPicture;
+
+	/// A flag per macroblock to include it in the distortion accumulation.
+	bool*							_pDistortionIncluded;
+};//end MotionEstimatorH264ImplFastSearch.
+
+
+#endif // !_MOTIONESTIMATORH264IMPLFASTSEARCH_H
@@ -132,6 +132,29 @@ MotionEstimatorH264ImplMultires::MotionEstimatorH264ImplMultires(	const void* pS
 
 }//end constructor.
 
+MotionEstimatorH264ImplMultires::MotionEstimatorH264ImplMultires(	const void*							pSrc, 
+																																	const void*							pRef, 
+																																	int											imgWidth, 
+																																	int											imgHeight,
+																																	int											motionRange,
+																																	IMotionVectorPredictor*	pMVPred,
+																																	void*										pDistortionIncluded)
+{
+	ResetMembers();
+
+	/// Parameters must remain const for the life time of this instantiation.
+	_imgWidth							= imgWidth;					///< Width of the src and ref images. 
+	_imgHeight						= imgHeight;				///< Height of the src and ref images.
+	_macroBlkWidth				= 16;								///< Width of the motion block = 16 for H.263.
+	_macroBlkHeight				= 16;								///< Height of the motion block = 16 for H.263.
+	_motionRange					= motionRange;			///< (4x,4y) range of the motion vectors. _motionRange in 1/4 pel units.
+	_pInput								= pSrc;
+	_pRef									= pRef;
+	_pMVPred							= pMVPred;
+	_pDistortionIncluded	= (bool *)pDistortionIncluded;
+
+}//end constructor.
+
 void MotionEstimatorH264ImplMultires::ResetMembers(void)
 {
 	_ready	= 0;	///< Ready to estimate.
@@ -198,6 +221,7 @@ void MotionEstimatorH264ImplMultires::ResetMembers(void)
 
 	/// Hold the resulting motion vectors in a byte array.
 	_pMotionVectorStruct = NULL;
+	_pMVPred						 = NULL;
 
 	/// A flag per macroblock to include it in the distortion accumulation.
 	_pDistortionIncluded = NULL;
@@ -609,6 +633,18 @@ void* MotionEstimatorH264ImplMultires::Estimate(long* avgDistortion)
 #endif
 		int minDiff			= zeroVecDiff;	///< Best so far.
 
+		/// The full searches at the lower levels are prone to distant aliased matches. With a
+		/// predictor the nearest full pel predicted vector at each level is an alternative 
+		/// centre to refine around.
+		int predX = 0;
+		int predY = 0;
+		if(_pMVPred != NULL)
+			_pMVPred->Get16x16Prediction(NULL, vecPos, &predX, &predY);
+		int predX0Rnd = (predX < 0)? (predX - 2)/4 : (predX + 2)/4;	///< Nearest level 0 pred motion vector.
+		int predY0Rnd = (predY < 0)? (predY - 2)/4 : (predY + 2)/4;
+		int predX1		= predX0Rnd / 2;	///< Nearest level 1 pred motion vector.
+		int predY1		= predY0Rnd / 2;
+
 		///----------------------- Level 2 full pel search --------------------------------
 		if(_mode == 2)
 		{
@@ -680,6 +716,27 @@ void* MotionEstimatorH264ImplMultires::Estimate(long* avgDistortion)
 		int minDiffL1 = _pInL1Over->Tsd8x8(*_pExtRefL1Over);
 #endif
 
+		/// Refine around the level 1 pred motion vector instead if it is a better match.
+		if( (_mode == 2)&&(_pMVPred != NULL)&&((predX1 != mx)||(predY1 != my)) )
+		{
+			GetMotionRange(q, p, &xlRng, &xrRng, &yuRng, &ydRng, _l1MotionRange-1, 1);
+			if( (predX1 >= xlRng)&&(predX1 <= xrRng)&&(predY1 >= yuRng)&&(predY1 <= ydRng) )
+			{
+				_pExtRefL1Over->SetOrigin(predX1+q,predY1+p);
+#ifdef MEH264IM_ABS_DIFF
+				int predDiffL1 = _pInL1Over->Tad8x8(*_pExtRefL1Over);
+#else
+				int predDiffL1 = _pInL1Over->Tsd8x8(*_pExtRefL1Over);
+#endif
+				if(predDiffL1 < minDiffL1)
+				{
+					minDiffL1 = predDiffL1;
+					mx = predX1;
+					my = predY1;
+				}//end if predDiffL1...
+			}//end if predX1...
+		}//end if _mode...
+
     /// Level 1: Search on a full pel grid over the defined L1 motion range. The
 		///					range is a refinement if Level 2 was done (_mode = 2).
 		rmx = 0;	///< Refinement motion vector centre.
@@ -738,6 +795,27 @@ void* MotionEstimatorH264ImplMultires::Estimate(long* avgDistortion)
 		minDiff = _pInOver->Tsd16x16(*_pExtRefOver);
 #endif
 
+		/// Refine around the level 0 pred motion vector instead if it is a better match.
+		if( (_pMVPred != NULL)&&((predX0Rnd != mx)||(predY0Rnd != my)) )
+		{
+			GetMotionRange(n, m, &xlRng, &xrRng, &yuRng, &ydRng, (_motionRange/4)-1, 0);
+			if( (predX0Rnd >= xlRng)&&(predX0Rnd <= xrRng)&&(predY0Rnd >= yuRng)&&(predY0Rnd <= ydRng) )
+			{
+				_pExtRefOver->SetOrigin(n+predX0Rnd,m+predY0Rnd);
+#ifdef MEH264IM_ABS_DIFF
+				int predDiff = _pInOver->Tad16x16(*_pExtRefOver);
+#else
+				int predDiff = _pInOver->Tsd16x16(*_pExtRefOver);
+#endif
+				if(predDiff < minDiff)
+				{
+					minDiff = predDiff;
+					mx = predX0Rnd;
+					my = predY0Rnd;
+				}//end if predDiff...
+			}//end if predX0Rnd...
+		}//end if _pMVPred...
+
 		/// Look for an improvement on the motion vector calc above within the refined range.
 		rmx = 0;	///< Refinement motion vector centre.
 		rmy = 0;
@@ -860,6 +938,54 @@ void* MotionEstimatorH264ImplMultires::Estimate(long* avgDistortion)
 		//else if(mvy >= _motionRange)
 		//	mvy = (_motionRange-1);
 
+		/// The vector to revert to is the better of the zero and the predicted motion vectors. The
+		/// predicted vector is truncated if it falls more than one macroblock outside of the img.
+		int zeromvx = 0;
+		int zeromvy = 0;
+		if(_pMVPred != NULL)
+		{
+			int predXQuart	= predX % 4;
+			int predYQuart	= predY % 4;
+			int predX0			= predX / 4;
+			int predY0			= predY / 4;
+			if( (predX0+n) > _imgWidth)
+				predX0 = _macroBlkWidth;
+			if( (predX0+n) < -_macroBlkWidth)
+				predX0 = -_macroBlkWidth;
+			if( (predY0+m) > _imgHeight)
+				predY0 = _macroBlkHeight;
+			if( (predY0+m) < -_macroBlkHeight)
+				predY0 = -_macroBlkHeight;
+
+			/// Quarter read first if necessary.
+			_pExtRefOver->SetOrigin(predX0+n,predY0+m);
+			int predVecDiff;
+			if(predXQuart || predYQuart)
+			{
+				_pExtRefOver->QuarterRead(*_pMBlkOver, predXQuart, predYQuart);
+#ifdef MEH264IM_ABS_DIFF
+				predVecDiff = _pInOver->Tad16x16(*_pMBlkOver);
+#else
+				predVecDiff = _pInOver->Tsd16x16(*_pMBlkOver);
+#endif
+			}//end if predXQuart...
+			else
+			{
+#ifdef MEH264IM_ABS_DIFF
+				predVecDiff = _pInOver->Tad16x16(*_pExtRefOver);
+#else
+				predVecDiff = _pInOver->Tsd16x16(*_pExtRefOver);
+#endif
+			}//end else...
+
+			if(predVecDiff <= zeroVecDiff)
+			{
+				zeroVecDiff = predVecDiff;
+				zeromvx			= (predX0 * 4) + predXQuart;
+				zeromvy			= (predY0 * 4) + predYQuart;
+			}//end if predVecDiff...
+		}//end if _pMVPred...
+
 		/// Validity of the motion vector is weighted with non-linear factors.
 		int weight						= 0;
 		int diffWithZeroDiff	= zeroVecDiff - minDiff;
@@ -902,8 +1028,8 @@ void* MotionEstimatorH264ImplMultires::Estimate(long* avgDistortion)
     }//end if min_energy...
     else
 		{
-			mvx = 0;
-			mvy = 0;
+			mvx = zeromvx;
+			mvy = zeromvy;
 			if(doIt)
 				totalDifference += zeroVecDiff;
 		}//end else...
@@ -913,6 +1039,9 @@ void* MotionEstimatorH264ImplMultires::Estimate(long* avgDistortion)
 		{
 			_pMotionVectorStruct->SetSimpleElement(vecPos, 0, mvx);
 			_pMotionVectorStruct->SetSimpleElement(vecPos, 1, mvy);
+			/// Set macroblock vector for future predictions.
+			if(_pMVPred != NULL)
+				_pMVPred->Set16x16MotionVector(vecPos, mvx, mvy);
 			vecPos++;
 		}//end if vecPos...
 
@@ -36,6 +36,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define _MOTIONESTIMATORH264IMPLMULTIRES_H
 
 #include "IMotionEstimator.h"
+#include "IMotionVectorPredictor.h"
 #include "VectorStructList.h"
 #include "OverlayMem2Dv2.h"
 #include "OverlayExtMem2Dv2.h"
@@ -74,6 +75,14 @@ public:
 																		int					motionRange,
 																		void*				pDistortionIncluded);
 
+	MotionEstimatorH264ImplMultires(	const void*							pSrc, 
+																		const void*							pRef, 
+																		int											imgWidth, 
+																		int											imgHeight,
+																		int											motionRange,
+																		IMotionVectorPredictor*	pMVPred,
+																		void*										pDistortionIncluded);
+
 	virtual ~MotionEstimatorH264ImplMultires(void);
 
 /// IMotionEstimator Interface.
@@ -185,6 +194,9 @@ protected:
 
 	/// Hold the resulting motion vectors in a byte array.
 	VectorStructList*	_pMotionVectorStruct;
+	/// Optional motion vector predictor attached on construction. The full search levels
+	/// are prone to distant aliased matches and the predicted vector anchors the search.
+	IMotionVectorPredictor* _pMVPred;
 
 	/// A flag per macroblock to include it in the distortion accumulation.
 	bool*							_pDistortionIncluded;
@@ -48,6 +48,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdlib.h>
 
 #include	"MotionEstimatorH264ImplMultiresCrossVer2.h"
+#include	"SimdDefs.h"
 
 /*
 --------------------------------------------------------------------------
@@ -69,6 +70,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /// Choose between sqr err distortion or abs diff metric.
 #undef MEH264IMCV2_ABS_DIFF
 
+/// Predictive mode thresholds. The search ends at a candidate vector with a distortion
+/// below the noise floor and only the level 0 refinement is done below the seed threshold.
+#ifdef MEH264IMCV2_ABS_DIFF
+#define MEH264IMCV2_EARLY_EXIT_THRESHOLD						MEH264IMCV2_MOTION_NOISE_FLOOR
+#define MEH264IMCV2_SEED_THRESHOLD									(4 * MEH264IMCV2_MOTION_NOISE_FLOOR)
+#else
+#define MEH264IMCV2_EARLY_EXIT_THRESHOLD						MVCL_EARLY_EXIT_THRESHOLD
+#define MEH264IMCV2_SEED_THRESHOLD									MVCL_SEED_THRESHOLD
+#endif
+
 /// Search range coords for centre motion vectors.
 #define MEH264IMCV2_MOTION_SUB_POS_LENGTH 	8
 MEH264IMCV2_COORD MEH264IMCV2_SubPos[MEH264IMCV2_MOTION_SUB_POS_LENGTH]	= 
@@ -89,6 +100,268 @@ MEH264IMCV2_COORD MEH264IMCV2_CrossPos[MEH264IMCV2_MOTION_CROSS_POS_LENGTH]	=
 */
 #define MEH264IMCV2_CLIP255(x)	( (((x) <= 255)&&((x) >= 0))? (x) : ( ((x) < 0)? 0:255 ) )
 
+/*
+--------------------------------------------------------------------------
+  8-bit plane helpers. 
+--------------------------------------------------------------------------
+*/
+/// Partial square error phase order of OverlayMem2Dv2::Tsd16x16PartialLessThan().
+static const int MEH264IMCV2_Sp[17] = {0, 0, 2, 2, 0, 1, 3, 3, 1, 1, 3, 0, 2, 3, 1, 2, 0};
+static const int MEH264IMCV2_Tp[17] = {0, 0, 2, 0, 2, 1, 3, 1, 3, 0, 2, 1, 3, 0, 2, 1, 3};
+
+#ifdef RTVC_SIMD
+static inline int MEH264IMCV2_HSum32(__m128i v)
+{
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0x4E));
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0xB1));
+	return(_mm_cvtsi128_si32(v));
+}//end MEH264IMCV2_HSum32.
+#endif
+
+/** Copy a 16-bit plane into an 8-bit plane.
+@param pSrc, srcStride	: Top left and row stride of the 16-bit src.
+@param width, height		: Dimensions to copy.
+@param pDst, dstStride	: Top left and row stride of the 8-bit dst.
+@return									: none.
+*/
+static void MEH264IMCV2_Pack(const short* pSrc, int srcStride, int width, int height, unsigned char* pDst, int dstStride)
+{
+	for(int row = 0; row < height; row++, pSrc += srcStride, pDst += dstStride)
+	{
+		int col = 0;
+#ifdef RTVC_SIMD
+		for(; (col + 16) <= width; col += 16)
+			_mm_storeu_si128((__m128i *)(&pDst[col]), _mm_packus_epi16(_mm_loadu_si128((const __m128i *)(&pSrc[col])), 
+																																 _mm_loadu_si128((const __m128i *)(&pSrc[col + 8]))));
+#endif
+		for(; col < width; col++)
+			pDst[col] = (unsigned char)MEH264IMCV2_CLIP255(pSrc[col]);
+	}//end for row...
+}//end MEH264IMCV2_Pack.
+
+/** Sub sample an 8-bit src by half into an 8-bit dst.
+Rounded in the same way as OverlayMem2Dv2::Half().
+@param pSrc, srcStride	: Top left and row stride of the src.
+@param width, height		: Src dimensions.
+@param pDst, dstStride	: Top left and row stride of the dst.
+@return									: none.
+*/
+static void MEH264IMCV2_Half(const unsigned char* pSrc, int srcStride, int width, int height, unsigned char* pDst, int dstStride)
+{
+	for(int row = 0; row < height; row += 2, pSrc += 2*srcStride, pDst += dstStride)
+	{
+		const unsigned char* pSrc1 = pSrc + srcStride;
+		int col = 0;
+		int x		= 0;
+#ifdef RTVC_SIMD
+		__m128i even	= _mm_set1_epi16(0x00FF);
+		__m128i two		= _mm_set1_epi16(2);
+		for(; (col + 16) <= width; col += 16, x += 8)
+		{
+			__m128i r0 = _mm_loadu_si128((const __m128i *)(&pSrc[col]));
+			__m128i r1 = _mm_loadu_si128((const __m128i *)(&pSrc1[col]));
+			__m128i s  = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(r0, even), _mm_srli_epi16(r0, 8)),
+																 _mm_add_epi16(_mm_and_si128(r1, even), _mm_srli_epi16(r1, 8)));
+			s = _mm_srli_epi16(_mm_add_epi16(s, two), 2);
+			_mm_storel_epi64((__m128i *)(&pDst[x]), _mm_packus_epi16(s, s));
+		}//end for col...
+#endif
+		for(; col < width; col += 2, x++)
+			pDst[x] = (unsigned char)(((int)pSrc[col] + (int)pSrc[col+1] + (int)pSrc1[col] + (int)pSrc1[col+1] + 2) >> 2);
+	}//end for row...
+}//end MEH264IMCV2_Half.
+
+/** Sub sample a 16-bit src by half into an 8-bit dst.
+Rounded in the same way as OverlayMem2Dv2::Half().
+@param pSrc, srcStride	: Top left and row stride of the 16-bit src.
+@param width, height		: Src dimensions.
+@param pDst, dstStride	: Top left and row stride of the dst.
+@return									: none.
+*/
+static void MEH264IMCV2_Half(const short* pSrc, int srcStride, int width, int height, unsigned char* pDst, int dstStride)
+{
+	for(int row = 0; row < height; row += 2, pSrc += 2*srcStride, pDst += dstStride)
+	{
+		const short* pSrc1 = pSrc + srcStride;
+		int col = 0;
+		int x		= 0;
+#ifdef RTVC_SIMD
+		__m128i one		= _mm_set1_epi16(1);
+		__m128i two		= _mm_set1_epi32(2);
+		for(; (col + 16) <= width; col += 16, x += 8)
+		{
+			/// Col pairs of both rows are summed as 32-bit values.
+			__m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_loadu_si128((const __m128i *)(&pSrc[col])), one),
+																 _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(&pSrc1[col])), one));
+			__m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_loadu_si128((const __m128i *)(&pSrc[col + 8])), one),
+																 _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(&pSrc1[col + 8])), one));
+			lo = _mm_srai_epi32(_mm_add_epi32(lo, two), 2);
+			hi = _mm_srai_epi32(_mm_add_epi32(hi, two), 2);
+			__m128i s = _mm_packs_epi32(lo, hi);
+			_mm_storel_epi64((__m128i *)(&pDst[x]), _mm_packus_epi16(s, s));
+		}//end for col...
+#endif
+		for(; col < width; col += 2, x++)
+			pDst[x] = (unsigned char)MEH264IMCV2_CLIP255((pSrc[col] + pSrc[col+1] + pSrc1[col] + pSrc1[col+1] + 2) >> 2);
+	}//end for row...
+}//end MEH264IMCV2_Half.
+
+/** Fill the boundary of an 8-bit extended plane from its centre.
+The same fill as OverlayExtMem2Dv2::FillBoundary().
+@param pMem						: Extended mem.
+@param width, height	: Extended dimensions.
+@param boundary				: Boundary for left, right, up and down.
+@return								: none.
+*/
+static void MEH264IMCV2_FillBoundary(unsigned char* pMem, int width, int height, int boundary)
+{
+	int row;
+	/// Left and right.
+	for(row = boundary; row < (height - boundary); row++)
+	{
+		unsigned char* p = &(pMem[row * width]);
+		memset((void *)p, p[boundary], boundary);
+		memset((void *)(&p[width - boundary]), p[width - boundary - 1], boundary);
+	}//end for row...
+	/// Top and bottom including the corners.
+	for(row = 0; row < boundary; row++)
+	{
+		memcpy((void *)(&pMem[row * width]), (const void *)(&pMem[boundary * width]), width);
+		memcpy((void *)(&pMem[(height - row - 1) * width]), (const void *)(&pMem[(height - boundary - 1) * width]), width);
+	}//end for row...
+}//end MEH264IMCV2_FillBoundary.
+
+/** Total square or absolute difference of square 8-bit blocks.
+@param pA, aStride	: Top left and row stride of the first block.
+@param pB, bStride	: Top left and row stride of the second block.
+@param size					: Block width and height of 4, 8 or 16.
+@param absDiff			: 1 = absolute diff, 0 = square diff.
+@param min					: Early exit value when earlyExit is set.
+@param earlyExit		: Exit when min is exceeded.
+@return							: Total diff to the point of early exit.
+*/
+static int MEH264IMCV2_Td(const unsigned char* pA, int aStride, const unsigned char* pB, int bStride, 
+													int size, int absDiff, int min, int earlyExit)
+{
+	int row;
+	int acc = 0;
+#ifdef RTVC_SIMD
+	if(size > 4)
+	{
+		__m128i sum		= _mm_setzero_si128();
+		__m128i zero	= _mm_setzero_si128();
+		for(row = 0; row < size; row++, pA += aStride, pB += bStride)
+		{
+			__m128i x, y;
+			if(size == 16)
+			{
+				x = _mm_loadu_si128((const __m128i *)pA);
+				y = _mm_loadu_si128((const __m128i *)pB);
+			}//end if size...
+			else
+			{
+				x = _mm_loadl_epi64((const __m128i *)pA);
+				y = _mm_loadl_epi64((const __m128i *)pB);
+			}//end else...
+			if(absDiff)
+				sum = _mm_add_epi32(sum, _mm_sad_epu8(x, y));
+			else
+			{
+				__m128i d = _mm_sub_epi16(_mm_unpacklo_epi8(x, zero), _mm_unpacklo_epi8(y, zero));
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(d, d));
+				if(size == 16)
+				{
+					d		= _mm_sub_epi16(_mm_unpackhi_epi8(x, zero), _mm_unpackhi_epi8(y, zero));
+					sum = _mm_add_epi32(sum, _mm_madd_epi16(d, d));
+				}//end if size...
+			}//end else...
+
+			if( earlyExit && ((row & 3) == 3) )
+			{
+				acc = MEH264IMCV2_HSum32(sum);
+				if(acc > min)
+					return(acc);
+			}//end if earlyExit...
+		}//end for row...
+
+		return(MEH264IMCV2_HSum32(sum));
+	}//end if size...
+#endif
+
+	for(row = 0; row < size; row++, pA += aStride, pB += bStride)
+	{
+		for(int col = 0; col < size; col++)
+		{
+			int diff = (int)pA[col] - (int)pB[col];
+			acc += absDiff ? abs(diff) : (diff * diff);
+		}//end for col...
+
+		if( earlyExit && (acc > min) )
+			return(acc);
+	}//end for row...
+
+	return(acc);
+}//end MEH264IMCV2_Td.
+
+/** Partial square difference of square 8-bit blocks.
+The 16 sub-sampled partials are accumulated in the (Sp[p],Tp[p]) phase order
+with the same early exit as OverlayMem2Dv2::Tsd16x16PartialLessThan().
+@param size	: 8 or 16.
+@return			: Total square diff to the point of early exit.
+*/
+static int MEH264IMCV2_TsdPartial(const unsigned char* pA, int aStride, const unsigned char* pB, int bStride, 
+																	int size, int min)
+{
+	int ps[4][4];	///< [row phase][col phase] partials.
+	int done[4]	= {0, 0, 0, 0};
+	int Dp			= 0;
+
+	for(int p = 1; p <= 16; p++)
+	{
+		int t = MEH264IMCV2_Tp[p];
+		if(!done[t])
+		{
+			/// All 4 col phases of a row phase are summed together when first required.
+#ifdef RTVC_SIMD
+			__m128i acc		= _mm_setzero_si128();
+			__m128i zero	= _mm_setzero_si128();
+			for(int row = t; row < size; row += 4)
+			{
+				const unsigned char* a = &(pA[row * aStride]);
+				const unsigned char* b = &(pB[row * bStride]);
+				for(int col = 0; col < size; col += 8)
+				{
+					__m128i d = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(&a[col])), zero), 
+																		_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(&b[col])), zero));
+					/// Pair cols of the same phase: d0,d4,d1,d5,d2,d6,d3,d7.
+					d		= _mm_unpacklo_epi16(d, _mm_srli_si128(d, 8));
+					acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+				}//end for col...
+			}//end for row...
+			_mm_storeu_si128((__m128i *)ps[t], acc);
+#else
+			for(int s = 0; s < 4; s++)
+			{
+				ps[t][s] = 0;
+				for(int row = t; row < size; row += 4)
+					for(int col = s; col < size; col += 4)
+					{
+						int diff = (int)pA[(row * aStride) + col] - (int)pB[(row * bStride) + col];
+						ps[t][s] += (diff * diff);
+					}//end for row & col...
+			}//end for s...
+#endif
+			done[t] = 1;
+		}//end if !done...
+
+		Dp += ps[t][MEH264IMCV2_Sp[p]];
+		if( (Dp << 4) > (p * min) )
+			return( Dp << 4 );	///< Early exit because exceeded min.
+	}//end for p...
+
+	return(Dp);
+}//end MEH264IMCV2_TsdPartial.
+
 /*
 --------------------------------------------------------------------------
   Construction. 
@@ -155,22 +428,21 @@ void MotionEstimatorH264ImplMultiresCrossVer2::ResetMembers(void)
 
 	/// Level 0: Input mem overlay members.
 	_pInOver					= NULL;			///< Input overlay with motion block dim.
+	_pInBlk8					= NULL;			///< 8-bit input block at (_macroBlkWidth * _macroBlkHeight).
 	/// Level 1: Subsampled input by 2.
-	_pInL1						= NULL;			///< Input mem at (_l1Width * _l1Height).
+	_pInL1						= NULL;			///< 8-bit input mem at (_l1Width * _l1Height).
 	_l1Width					= 0;
 	_l1Height					= 0;
 	_l1MacroBlkWidth	= 0;
 	_l1MacroBlkHeight = 0;
 	_l1MotionRange		= 0;
-	_pInL1Over				= NULL;			///< Input overlay with level 1 motion block dim.
 	/// Level 2: Subsampled input by 4.
-	_pInL2						= NULL;			///< Input mem at (_l2Width * _l2Height).
+	_pInL2						= NULL;			///< 8-bit input mem at (_l2Width * _l2Height).
 	_l2Width					= 0;
 	_l2Height					= 0;
 	_l2MacroBlkWidth	= 0;
 	_l2MacroBlkHeight = 0;
 	_l2MotionRange		= 0;
-	_pInL2Over				= NULL;			///< Input overlay with level 2 motion block dim.
 
 	/// Level 0: Ref mem overlay members.
 	_pRefOver					= NULL;			///< Ref overlay with whole block dim.
@@ -179,22 +451,17 @@ void MotionEstimatorH264ImplMultiresCrossVer2::ResetMembers(void)
 	_extHeight				= 0;
 	_extBoundary			= 0;
 	_pExtRefOver			= NULL;			///< Extended ref overlay with motion block dim.
+	_pExtRef8					= NULL;			///< 8-bit extended ref mem.
 	/// Level 1: Subsampled ref by 2.
-	_pRefL1						= NULL;			///< Ref mem at (_l1Width * _l1Height).
-	_pRefL1Over				= NULL; 		///< Ref overlay with whole level 1 block dim.
-	_pExtRefL1				= NULL;			///< Extended ref mem create by ExtendBoundary() call.
+	_pExtRefL1				= NULL;			///< 8-bit extended ref mem with the subsampled ref in the centre.
 	_extL1Width				= 0;
 	_extL1Height			= 0;
 	_extL1Boundary		= 0;
-	_pExtRefL1Over		= NULL;			///< Ref overlay with level 1 motion block dim.
 	/// Level 2: Subsampled ref by 4.
-	_pRefL2						= NULL;			///< Ref mem at (_l2Width * _l2Height).
-	_pRefL2Over				= NULL; 		///< Ref overlay with whole level 2 block dim.
-	_pExtRefL2				= NULL;			///< Extended ref mem create by ExtendBoundary() call.
+	_pExtRefL2				= NULL;			///< 8-bit extended ref mem with the subsampled ref in the centre.
 	_extL2Width				= 0;
 	_extL2Height			= 0;
 	_extL2Boundary		= 0;
-	_pExtRefL2Over		= NULL;			///< Ref overlay with level 2 motion block dim.
 	/// A 1/4 pel refinement window.
 	_pWin							= NULL;
 	_Win							= NULL;
@@ -207,6 +474,11 @@ void MotionEstimatorH264ImplMultiresCrossVer2::ResetMembers(void)
 	_pMotionVectorStruct = NULL;
   /// Attached motion vector predictor on construction.
   _pMVPred             = NULL;
+	/// Predictive search mode and its previous result state.
+	_predictive					 = 0;
+	_prevResultValid		 = 0;
+	/// Optional shared 1/2 pel planes of the ref.
+	_pRefPicture				 = NULL;
 
 	/// A flag per macroblock to include it in the distortion accumulation.
 	_pDistortionIncluded = NULL;
@@ -238,6 +510,14 @@ int MotionEstimatorH264ImplMultiresCrossVer2::Create(void)
 		return(0);
 	}//end _pInOver...
 
+	/// Level 0: 8-bit copy of the current input block for the full pel search.
+	_pInBlk8 = new unsigned char[_macroBlkWidth * _macroBlkHeight];
+	if(_pInBlk8 == NULL)
+	{
+		Destroy();
+		return(0);
+	}//end if !_pInBlk8...
+
 	/// Level 1 is Level 0 sub sampled by 2.
 	_l1Width					= _imgWidth/2;
 	_l1Height					= _imgHeight/2;
@@ -246,23 +526,12 @@ int MotionEstimatorH264ImplMultiresCrossVer2::Create(void)
 	_l1MotionRange		= _motionRange/8;	///< _motionRange is in 1/4 pel units. Convert to full level 1 pel units.
 
 	/// Level 1: Input mem at (_l1Width * _l1Height) must be alloc.
-	_pInL1 = new short[_l1Width * _l1Height];
-
-	/// Level 1: Input overlay with level 1 motion block dim.
-	if(_pInL1 != NULL)
-	{
-		_pInL1Over = new OverlayMem2Dv2(_pInL1,_l1Width,_l1Height,_l1MacroBlkWidth,_l1MacroBlkHeight);
-		if(_pInL1Over == NULL)
-		{
-			Destroy();
-			return(0);
-		}//end if !_pInL1Over...
-	}//end if ...
-	else
+	_pInL1 = new unsigned char[_l1Width * _l1Height];
+	if(_pInL1 == NULL)
 	{
 		Destroy();
 		return(0);
-	}//end else...
+	}//end if !_pInL1...
 
 	/// Level 2 is Level 1 sub sampled by 2.
 	_l2Width					= _l1Width/2;
@@ -272,23 +541,12 @@ int MotionEstimatorH264ImplMultiresCrossVer2::Create(void)
 	_l2MotionRange		= _l1MotionRange/2;
 
 	/// Level 2: Input mem at (_l2Width * _l2Height) must be alloc.
-	_pInL2 = new short[_l2Width * _l2Height];
-
-	/// Level 2: Input overlay with level 2 motion block dim.
-	if(_pInL2 != NULL)
-	{
-		_pInL2Over = new OverlayMem2Dv2(_pInL2,_l2Width,_l2Height,_l2MacroBlkWidth,_l2MacroBlkHeight);
-		if(_pInL2Over == NULL)
-		{
-			Destroy();
-			return(0);
-		}//end if !_pInL2Over...
-	}//end if ...
-	else
+	_pInL2 = new unsigned char[_l2Width * _l2Height];
+	if(_pInL2 == NULL)
 	{
 		Destroy();
 		return(0);
-	}//end else...
+	}//end if !_pInL2...
 
 	/// --------------- Configure ref overlays --------------------------------
 	/// Level 0: Overlay the whole reference. The reference will have an extended 
@@ -300,138 +558,82 @@ int MotionEstimatorH264ImplMultiresCrossVer2::Create(void)
 	  return(0);
   }//end if !_pRefOver...
 
-	/// Create the new extended boundary ref into _pExtRef. The boundary is extended by
-	/// the max dimension of the macroblock.
+	/// The boundary of the extended refs is the max dimension of the macroblock.
 	_extBoundary = _macroBlkWidth + MEH264IMCV2_PADDING;
 	if(_macroBlkHeight > _macroBlkWidth)
 		_extBoundary = _macroBlkHeight + MEH264IMCV2_PADDING;
-	if(!OverlayExtMem2Dv2::ExtendBoundary((void *)_pRef, 
-																				_imgWidth,						
-																				_imgHeight, 
-																				_extBoundary,	///< Extend left and right by...
-																				_extBoundary,	///< Extend top and bottom by...
-																				(void **)(&_pExtRef)) )	///< Created in the method and returned.
-  {
-		Destroy();
-	  return(0);
-  }//end if !ExtendBoundary...
 	_extWidth	 = _imgWidth + (2 * _extBoundary);
 	_extHeight = _imgHeight + (2 * _extBoundary);
 
-	/// Level 0: Place an overlay on the extended boundary ref with block 
-	/// size set to the motion vec dim..
-	_pExtRefOver = new OverlayExtMem2Dv2(	_pExtRef,				///< Src description. 
-																				_extWidth, 
-																				_extHeight,
-																				_macroBlkWidth,	///< Block size description.
-																				_macroBlkHeight,
-																				_extBoundary,		///< Boundary size for both left and right.
-																				_extBoundary  );
-	if(_pExtRefOver == NULL)
-  {
-		Destroy();
-	  return(0);
-  }//end if !_pExtRefOver...
-
-	/// Level 1: Ref mem at (_l1Width * _l1Height).
-	_pRefL1 = new short[_l1Width * _l1Height];
-
-	/// Level 1: Ref overlay with whole level 1 block dim.
-	if(_pRefL1 != NULL)
+	/// The 16-bit extended ref is only required to interpolate the sub pel positions when
+	/// there is no attached ref picture with 1/2 pel planes.
+	if(_pRefPicture == NULL)
 	{
-		_pRefL1Over = new OverlayMem2Dv2(_pRefL1, _l1Width, _l1Height, _l1Width, _l1Height);
-		if(_pRefL1Over == NULL)
+		/// Create the new extended boundary ref into _pExtRef.
+		if(!OverlayExtMem2Dv2::ExtendBoundary((void *)_pRef, 
+																					_imgWidth,						
+																					_imgHeight, 
+																					_extBoundary,	///< Extend left and right by...
+																					_extBoundary,	///< Extend top and bottom by...
+																					(void **)(&_pExtRef)) )	///< Created in the method and returned.
 		{
 			Destroy();
 			return(0);
-		}//end if _pRefL1Over...
-	}//end if _pRefL1...
-	else
-	{
+		}//end if !ExtendBoundary...
+
+		/// Level 0: Place an overlay on the extended boundary ref with block 
+		/// size set to the motion vec dim..
+		_pExtRefOver = new OverlayExtMem2Dv2(	_pExtRef,				///< Src description. 
+																					_extWidth, 
+																					_extHeight,
+																					_macroBlkWidth,	///< Block size description.
+																					_macroBlkHeight,
+																					_extBoundary,		///< Boundary size for both left and right.
+																					_extBoundary  );
+		if(_pExtRefOver == NULL)
+		{
+			Destroy();
+			return(0);
+		}//end if !_pExtRefOver...
+	}//end if !_pRefPicture...
+
+	/// Level 0: 8-bit copy of the extended ref for the full pel search.
+	_pExtRef8 = new unsigned char[_extWidth * _extHeight];
+	if(_pExtRef8 == NULL)
+  {
 		Destroy();
-		return(0);
-	}//end else...
+	  return(0);
+  }//end if !_pExtRef8...
 
-	/// Level 1: Extended ref mem _pExtRefL1 created by ExtendBoundary() call.
+	/// Level 1: Extended ref mem _pExtRefL1.
 	_extL1Boundary = _l1MacroBlkWidth + MEH264IMCV2_L1_PADDING;
 	if(_l1MacroBlkHeight > _l1MacroBlkWidth)
 		_extL1Boundary = _l1MacroBlkHeight + MEH264IMCV2_L1_PADDING;
-	if(!OverlayExtMem2Dv2::ExtendBoundary((void *)_pRefL1, 
-																				_l1Width,						
-																				_l1Height, 
-																				_extL1Boundary,
-																				_extL1Boundary,
-																				(void **)(&_pExtRefL1)) )
-  {
-    Destroy();
-	  return(0);
-  }//end if !ExtendBoundary...
 	_extL1Width		= _l1Width + (2 * _extL1Boundary);
 	_extL1Height	= _l1Height + (2 * _extL1Boundary);
-
-	// Level 1: Ref overlay with level 1 motion block dim.
-	_pExtRefL1Over = new OverlayExtMem2Dv2(	_pExtRefL1, 
-																					_extL1Width,				///< new mem width.
-																					_extL1Height,				///< new mem height.
-																					_l1MacroBlkWidth,		///< block width.
-																					_l1MacroBlkHeight,	///< block height.
-																					_extL1Boundary,			///< boundary width.
-																					_extL1Boundary);		///< boundary height.
-	if(_pExtRefL1Over == NULL)
+	/// The subsampled ref is written directly into the centre of the extended mem
+	/// on each Estimate() call and therefore there is no unextended copy.
+	_pExtRefL1 = new unsigned char[_extL1Width * _extL1Height];
+	if(_pExtRefL1 == NULL)
   {
     Destroy();
 	  return(0);
-  }//end if !_pExtRefL1Over...
+  }//end if !_pExtRefL1...
 
-	/// Level 2: Ref mem at (_l2Width * _l2Height).
-	_pRefL2 = new short[_l2Width * _l2Height];
-
-	/// Level 2: Ref overlay with whole level 2 block dim.
-	if(_pRefL2 != NULL)
-	{
-		_pRefL2Over = new OverlayMem2Dv2(_pRefL2, _l2Width, _l2Height, _l2Width, _l2Height);
-		if(_pRefL2Over == NULL)
-		{
-			Destroy();
-			return(0);
-		}//end if _pRefL2Over...
-	}//end if _pRefL2...
-	else
-	{
-		Destroy();
-		return(0);
-	}//end else...
-
-	/// Level 2: Extended ref mem _pExtRefL2 created by ExtendBoundary() call.
+	/// Level 2: Extended ref mem _pExtRefL2.
 	_extL2Boundary = _l2MacroBlkWidth + MEH264IMCV2_L2_PADDING;
 	if(_l2MacroBlkHeight > _l2MacroBlkWidth)
 		_extL2Boundary = _l2MacroBlkHeight + MEH264IMCV2_L2_PADDING;
-	if(!OverlayExtMem2Dv2::ExtendBoundary((void *)_pRefL2, 
-																				_l2Width,						
-																				_l2Height, 
-																				_extL2Boundary,
-																				_extL2Boundary,
-																				(void **)(&_pExtRefL2)) )
-  {
-    Destroy();
-	  return(0);
-  }//end if !ExtendBoundary...
 	_extL2Width		= _l2Width + (2 * _extL2Boundary);
 	_extL2Height	= _l2Height + (2 * _extL2Boundary);
-
-	/// Level 2: Ref overlay with level 2 motion block dim.
-	_pExtRefL2Over = new OverlayExtMem2Dv2(	_pExtRefL2, 
-																					_extL2Width,				///< new mem width.
-																					_extL2Height,				///< new mem height.
-																					_l2MacroBlkWidth,		///< block width.
-																					_l2MacroBlkHeight,	///< block height.
-																					_extL2Boundary,			///< boundary width.
-																					_extL2Boundary);		///< boundary height.
-	if(_pExtRefL2Over == NULL)
+	/// The subsampled ref is written directly into the centre of the extended mem
+	/// on each Estimate() call and therefore there is no unextended copy.
+	_pExtRefL2 = new unsigned char[_extL2Width * _extL2Height];
+	if(_pExtRefL2 == NULL)
   {
     Destroy();
 	  return(0);
-  }//end if !_pExtRefL2Over...
+  }//end if !_pExtRefL2...
 
 	/// --------------- Configure temp overlays --------------------------------
 	/// Alloc some temp mem and overlay it to use for half pel motion estimation and 
@@ -482,6 +684,8 @@ int MotionEstimatorH264ImplMultiresCrossVer2::Create(void)
 
 void	MotionEstimatorH264ImplMultiresCrossVer2::Reset(void)
 {
+	/// The previous vectors are no longer candidates.
+	_prevResultValid = 0;
 }//end Reset.
 
 /** Set the speed mode.
@@ -489,13 +693,23 @@ This is a multresolution algorithm and the speed is increased by estimating
 at lower levels but it is less accurate. Mode = 1 implies level 1 and mode = 2
 for level 2. Mode = 0 is auto mode that selects an appropriate mode depending
 on the resolution of the image. The selection is set to 2 if the image has
-an area larger than 200x200.
+an area larger than 200x200. Mode = 3 is the predictive mode with the auto
+level selection. The search is seeded with candidate vectors from the
+previous result and the neighbouring macroblocks and ends early on static
+macroblocks.
 
 @param pRef		: Ref to estimate with.
 @return				: The list of motion vectors.
 */
 void	MotionEstimatorH264ImplMultiresCrossVer2::SetMode(int mode)
 {
+	_predictive = 0;
+	if(mode == 3)	///< Predictive mode.
+	{
+		_predictive = 1;
+		mode				= 0;
+	}//end if mode...
+
 	if(mode == 0)	///< Auto mode.
 	{
 		int area = _imgWidth * _imgHeight;
@@ -534,54 +748,48 @@ void* MotionEstimatorH264ImplMultiresCrossVer2::Estimate(long* avgDistortion)
 	if(_mode == 2)
 		lclL1MotionRange = MEH264IMCV2_L1_MOTION_VECTOR_REFINED_RANGE;
 
-	/// Write the level 0 ref and fill its extended boundary. The centre part of
-	/// _pExtRefOver is copied from _pRefOver before filling the boundary.
-	_pExtRefOver->SetOrigin(0, 0);
-	_pExtRefOver->SetOverlayDim(_imgWidth, _imgHeight);
-	_pExtRefOver->Write(*_pRefOver);	///< _pRefOver dimensions are always set to the whole image.
-	_pExtRefOver->FillBoundaryProxy();
-	_pExtRefOver->SetOverlayDim(_macroBlkWidth, _macroBlkHeight);
-
-	/// Subsample level 0 ref (_pRefOver) to produce level 1 ref (_pRefL1Over).
-	OverlayMem2Dv2::Half( (void **)(_pRefOver->Get2DSrcPtr()),			///< Src 2D ptr.
-												_imgWidth, 																///< Src width.
-												_imgHeight, 															///< Src height.
-												(void **)(_pRefL1Over->Get2DSrcPtr()) );	///< Dest 2D ptr.
-	/// Write the level 1 extended ref and fill its boundary.
-	_pExtRefL1Over->SetOrigin(0, 0);
-	_pExtRefL1Over->SetOverlayDim(_l1Width, _l1Height);
-	_pExtRefL1Over->Write(*_pRefL1Over);		///< _pRefL1Over is always set to the whole image.
-	_pExtRefL1Over->FillBoundaryProxy();
-	_pExtRefL1Over->SetOverlayDim(_l1MacroBlkWidth, _l1MacroBlkHeight);
+	/// Pack the ref into the centre of its 8-bit extended copy before filling the boundary. 
+	MEH264IMCV2_Pack((const short *)_pRef, _imgWidth, _imgWidth, _imgHeight, 
+									 &(_pExtRef8[(_extBoundary * _extWidth) + _extBoundary]), _extWidth);
+	MEH264IMCV2_FillBoundary(_pExtRef8, _extWidth, _extHeight, _extBoundary);
+
+	/// The sub pel positions are interpolated from the 1/2 pel planes of an attached ref 
+	/// picture and otherwise from the 16-bit extended ref. The centre part of _pExtRefOver 
+	/// is copied from _pRefOver before filling the boundary.
+	int refPicLoaded = (_pRefPicture != NULL);
+	if(refPicLoaded && !_pRefPicture->IsLoaded())
+		_pRefPicture->Load((const short *)_pRef);
+	if(!refPicLoaded)
+	{
+		_pExtRefOver->SetOrigin(0, 0);
+		_pExtRefOver->SetOverlayDim(_imgWidth, _imgHeight);
+		_pExtRefOver->Write(*_pRefOver);	///< _pRefOver dimensions are always set to the whole image.
+		_pExtRefOver->FillBoundaryProxy();
+		_pExtRefOver->SetOverlayDim(_macroBlkWidth, _macroBlkHeight);
+	}//end if !refPicLoaded...
+
+	/// Subsample the level 0 ref directly into the centre of the level 1 extended ref 
+	/// and fill its boundary.
+	MEH264IMCV2_Half(&(_pExtRef8[(_extBoundary * _extWidth) + _extBoundary]), _extWidth, _imgWidth, _imgHeight,
+									 &(_pExtRefL1[(_extL1Boundary * _extL1Width) + _extL1Boundary]), _extL1Width);
+	MEH264IMCV2_FillBoundary(_pExtRefL1, _extL1Width, _extL1Height, _extL1Boundary);
 
 	if(_mode == 2)
 	{
-		/// Subsample level 1 ref (_pRefL1Over) to produce level 2 ref (_pRefL2Over).
-		OverlayMem2Dv2::Half( (void **)(_pRefL1Over->Get2DSrcPtr()),		///< Src 2D ptr.
-													_l1Width, 																///< Src width.
-													_l1Height, 																///< Src height.
-													(void **)(_pRefL2Over->Get2DSrcPtr()) );	///< Dest 2D ptr.
-		/// Write the level 2 extended ref and fill its boundary.
-		_pExtRefL2Over->SetOrigin(0, 0);
-		_pExtRefL2Over->SetOverlayDim(_l2Width, _l2Height);
-		_pExtRefL2Over->Write(*_pRefL2Over);	///< _pRefL2Over is always set to the whole image.
-		_pExtRefL2Over->FillBoundaryProxy();
-		_pExtRefL2Over->SetOverlayDim(_l2MacroBlkWidth, _l2MacroBlkHeight);
+		/// Subsample the centre of the level 1 extended ref directly into the centre
+		/// of the level 2 extended ref and fill its boundary.
+		MEH264IMCV2_Half(&(_pExtRefL1[(_extL1Boundary * _extL1Width) + _extL1Boundary]), _extL1Width, _l1Width, _l1Height,
+										 &(_pExtRefL2[(_extL2Boundary * _extL2Width) + _extL2Boundary]), _extL2Width);
+		MEH264IMCV2_FillBoundary(_pExtRefL2, _extL2Width, _extL2Height, _extL2Boundary);
 	}//end if _mode...
 
-	/// Subsample level 0 input (_pInOver) to produce level 1 input (_pInL1Over).
-	OverlayMem2Dv2::Half( (void **)(_pInOver->Get2DSrcPtr()),			///< Src 2D ptr.
-												_imgWidth, 															///< Src width.
-												_imgHeight, 														///< Src height.
-												(void **)(_pInL1Over->Get2DSrcPtr()) ); ///< Dest 2D ptr.
+	/// Subsample level 0 input to produce level 1 input.
+	MEH264IMCV2_Half((const short *)_pInput, _imgWidth, _imgWidth, _imgHeight, _pInL1, _l1Width);
 
 	if(_mode == 2)
 	{
-		/// Subsample level 1 input (_pInL1Over) to produce level 2 input (_pInL2Over).
-		OverlayMem2Dv2::Half( (void **)(_pInL1Over->Get2DSrcPtr()),		///< Src 2D ptr.
-													_l1Width, 															///< Src width.
-													_l1Height, 															///< Src height.
-													(void **)(_pInL2Over->Get2DSrcPtr()) ); ///< Dest 2D ptr.
+		/// Subsample level 1 input to produce level 2 input.
+		MEH264IMCV2_Half(_pInL1, _l1Width, _l1Width, _l1Height, _pInL2, _l2Width);
 	}//end if _mode...
 
 	/// Gather the motion vector absolute differnce/square error data and choose the vector.
@@ -627,353 +835,388 @@ void* MotionEstimatorH264ImplMultiresCrossVer2::Estimate(long* avgDistortion)
 
 		/// Level 0: Set the input and ref blocks to work with.
 		_pInOver->SetOrigin(n,m);
-		_pExtRefOver->SetOrigin(n,m);
+		MEH264IMCV2_Pack(&(((const short *)_pInput)[(m * _imgWidth) + n]), _imgWidth, _macroBlkWidth, _macroBlkHeight, _pInBlk8, _macroBlkWidth);
+		const unsigned char* pIn	= _pInBlk8;
+		const unsigned char* pRef	= &(_pExtRef8[((m + _extBoundary) * _extWidth) + n + _extBoundary]);	///< Zero vector.
 
 		/// Absolute diff comparison method.
 #ifdef MEH264IMCV2_ABS_DIFF
-		int zeroVecDiff = _pInOver->Tad16x16(*_pExtRefOver);
+		int zeroVecDiff = MEH264IMCV2_Td(pIn, _macroBlkWidth, pRef, _extWidth, 16, 1, 0, 0);
 #else
-		int zeroVecDiff = _pInOver->Tsd16x16(*_pExtRefOver);
+		int zeroVecDiff = MEH264IMCV2_Td(pIn, _macroBlkWidth, pRef, _extWidth, 16, 0, 0, 0);
 #endif
 		int minDiff			= zeroVecDiff;	///< Best so far at level 0.
 
-		///----------------------- Level 2 full pel search --------------------------------
-		if(_mode == 2)
+		///----------------------- Predictive candidates ---------------------------------
+		/// In predictive mode the search is seeded with the best candidate vector and the
+		/// multiresolution levels are skipped if it is good enough. The search ends at the
+		/// candidate if its distortion is in the order of the noise.
+		int candX			= 0;
+		int candY			= 0;
+		int candDiff	= zeroVecDiff;
+		int searchLevel = 2;	///< 2 = all levels, 1 = level 0 only, 0 = no search.
+		if(_predictive)
+		{
+			if(zeroVecDiff >= MEH264IMCV2_EARLY_EXIT_THRESHOLD)
+				candDiff = GetBestCandidate(n, m, vecPos, predX0Rnd, predY0Rnd, zeroVecDiff, &candX, &candY);
+			if(candDiff < MEH264IMCV2_EARLY_EXIT_THRESHOLD)
+			{
+				searchLevel = 0;
+				minDiff			= candDiff;
+			}//end if candDiff...
+			else if(candDiff < MEH264IMCV2_SEED_THRESHOLD)
+				searchLevel = 1;
+		}//end if _predictive...
+		int mvx = candX << 2;	///< 1/4 pel units.
+		int mvy = candY << 2;
+
+		if(searchLevel > 1)
 		{
-			/// Level 2: Set the input and ref blocks.
-			_pInL2Over->SetOrigin(l,k);
-			_pExtRefL2Over->SetOrigin(l,k);
+			///----------------------- Level 2 full pel search --------------------------------
+			if(_mode == 2)
+			{
+				/// Level 2: Set the input and ref blocks.
+				const unsigned char* pInL2	= &(_pInL2[(k * _l2Width) + l]);
+				const unsigned char* pRefL2	= &(_pExtRefL2[((k + _extL2Boundary) * _extL2Width) + l + _extL2Boundary]);
 
-			/// Compiler directed distortion comparison method (absolute difference or square difference).
+				/// Compiler directed distortion comparison method (absolute difference or square difference).
 #ifdef MEH264IMCV2_ABS_DIFF
-			int minDiffL2 = _pInL2Over->Tad4x4(*_pExtRefL2Over);
+				int minDiffL2 = MEH264IMCV2_Td(pInL2, _l2Width, pRefL2, _extL2Width, 4, 1, 0, 0);
 #else
-			int minDiffL2 = _pInL2Over->Tsd4x4(*_pExtRefL2Over);
+				int minDiffL2 = MEH264IMCV2_Td(pInL2, _l2Width, pRefL2, _extL2Width, 4, 0, 0, 0);
 #endif
 			
-    	/// Level 2: Search on a full pel grid over the defined L2 motion range.
-
-			/// Cross search loop.
-			for(int w = _l2MotionRange/2 ;w > 0; w = w/2)	///< Start at half the motion range and then converge by 2 every iteration.
-			{
-				/// The winning centre is readjusted on every loop therefore the ranges must be recalculated.
-				GetMotionRange(l, k, 0, 0, &xlRng, &xrRng, &yuRng, &ydRng, _l2MotionRange-1, 2);
+				/// Level 2: Search on a full pel grid over the defined L2 motion range.
 
-				/// Reset the offset from (mx,my);
-				rmx = 0;
-				rmy = 0;
-				for(int x = 0; x < MEH264IMCV2_MOTION_CROSS_POS_LENGTH; x++)
+				/// Cross search loop.
+				for(int w = _l2MotionRange/2 ;w > 0; w = w/2)	///< Start at half the motion range and then converge by 2 every iteration.
 				{
-					i = w * MEH264IMCV2_CrossPos[x].y;
-					j = w * MEH264IMCV2_CrossPos[x].x;
+					/// The winning centre is readjusted on every loop therefore the ranges must be recalculated.
+					GetMotionRange(l, k, 0, 0, &xlRng, &xrRng, &yuRng, &ydRng, _l2MotionRange-1, 2);
 
-					/// Check that this offset is within the range of the image boundaries. If not then skip.
-					if( ((i+my) < yuRng)||((i+my) > ydRng)||((j+mx) < xlRng)||((j+mx) > xrRng) )
-						goto MEH264IMCV2_LEVEL2_BREAK;
+					/// Reset the offset from (mx,my);
+					rmx = 0;
+					rmy = 0;
+					for(int x = 0; x < MEH264IMCV2_MOTION_CROSS_POS_LENGTH; x++)
+					{
+						i = w * MEH264IMCV2_CrossPos[x].y;
+						j = w * MEH264IMCV2_CrossPos[x].x;
 
-					/// Set the block to the (j,i) offset motion vector from the (mx,my) motion vector
-					/// around the (l,k) reference location.
-					_pExtRefL2Over->SetOrigin(j+l+mx, i+k+my);
+						/// Check that this offset is within the range of the image boundaries. If not then skip.
+						if( ((i+my) < yuRng)||((i+my) > ydRng)||((j+mx) < xlRng)||((j+mx) > xrRng) )
+							goto MEH264IMCV2_LEVEL2_BREAK;
 
+						/// Compare with the block at the (j,i) offset motion vector from the (mx,my) motion vector
+						/// around the (l,k) reference location.
+						int blkDiff;
 #ifdef MEH263IMC_ABS_DIFF
-					int blkDiff = _pInL2Over->Tad4x4LessThan(*_pExtRefL2Over, minDiffL2);
+						blkDiff = MEH264IMCV2_Td(pInL2, _l2Width, pRefL2 + ((i+my) * _extL2Width) + (j+mx), _extL2Width, 4, 1, minDiffL2, 1);
 #else
-//					int blkDiff = _pInL2Over->Tsd4x4PartialLessThan(*_pExtRefL2Over, minDiffL2);
-					int blkDiff = _pInL2Over->Tsd4x4LessThan(*_pExtRefL2Over, minDiffL2);
+						blkDiff = MEH264IMCV2_Td(pInL2, _l2Width, pRefL2 + ((i+my) * _extL2Width) + (j+mx), _extL2Width, 4, 0, minDiffL2, 1);
 #endif
 
-					if(blkDiff <= minDiffL2)
-					{
-						/// Weight the equal diff with the smallest mv magnitude from the 
-            /// predicted mv. 
-						if(blkDiff == minDiffL2)
+						if(blkDiff <= minDiffL2)
 						{
-//							int vecDistDiff = ( (my*my)+(mx*mx) )-( (i*i)+(j*j) );
-              int currX = mx + rmx - predX2;
-              int currY = my + rmy - predY2;
-              int newX  = mx + j - predX2;
-              int newY  = my + i + predY2;
-							int vecDistDiff = ( (currY*currY)+(currX*currX) )-( (newY*newY)+(newX*newX) );
-							if(vecDistDiff < 0)
-								goto MEH264IMCV2_LEVEL2_BREAK;
-						}//end if blkDiff...
+							/// Weight the equal diff with the smallest mv magnitude from the 
+							/// predicted mv. 
+							if(blkDiff == minDiffL2)
+							{
+	//							int vecDistDiff = ( (my*my)+(mx*mx) )-( (i*i)+(j*j) );
+								int currX = mx + rmx - predX2;
+								int currY = my + rmy - predY2;
+								int newX  = mx + j - predX2;
+								int newY  = my + i + predY2;
+								int vecDistDiff = ( (currY*currY)+(currX*currX) )-( (newY*newY)+(newX*newX) );
+								if(vecDistDiff < 0)
+									goto MEH264IMCV2_LEVEL2_BREAK;
+							}//end if blkDiff...
 			
-						minDiffL2 = blkDiff;
-						rmx = j;
-						rmy = i;
-					}//end if blkDiff...
+							minDiffL2 = blkDiff;
+							rmx = j;
+							rmy = i;
+						}//end if blkDiff...
 			
-					MEH264IMCV2_LEVEL2_BREAK: ; ///< null.
+						MEH264IMCV2_LEVEL2_BREAK: ; ///< null.
 
-				}//end for x...
+					}//end for x...
 
-				/// Update new centre of winning vector.
-				mx += rmx;
-				my += rmy;
-			}//end for w...
+					/// Update new centre of winning vector.
+					mx += rmx;
+					my += rmy;
+				}//end for w...
 			
-			mx = mx << 1; ///< Convert level 2 full pel units to level 1 full pel units ( x2 ).
-			my = my << 1;
-		}//end if _mode...
+				mx = mx << 1; ///< Convert level 2 full pel units to level 1 full pel units ( x2 ).
+				my = my << 1;
+			}//end if _mode...
 
-		///----------------------- Level 1 full pel search --------------------------------
-		/// Level 1: Set the input and ref blocks.
-		_pInL1Over->SetOrigin(q,p);
-		_pExtRefL1Over->SetOrigin(mx+q,my+p);
+			///----------------------- Level 1 full pel search --------------------------------
+			/// Level 1: Set the input and ref blocks.
+			const unsigned char* pInL1	= &(_pInL1[(p * _l1Width) + q]);
+			const unsigned char* pRefL1	= &(_pExtRefL1[((p + _extL1Boundary) * _extL1Width) + q + _extL1Boundary]);
 
-		/// Absolute/square diff comparison method.
+			/// Absolute/square diff comparison method.
 #ifdef MEH264IMCV2_ABS_DIFF
-		int minDiffL1 = _pInL1Over->Tad8x8(*_pExtRefL1Over);
+			int minDiffL1 = MEH264IMCV2_Td(pInL1, _l1Width, pRefL1 + (my * _extL1Width) + mx, _extL1Width, 8, 1, 0, 0);
 #else
-		int minDiffL1 = _pInL1Over->Tsd8x8(*_pExtRefL1Over);
+			int minDiffL1 = MEH264IMCV2_Td(pInL1, _l1Width, pRefL1 + (my * _extL1Width) + mx, _extL1Width, 8, 0, 0, 0);
 #endif
 
-    /// Level 1: Search on a cross pel grid over the defined L1 motion range if mode != 2. Otherwise
-		///					 the range is a refinement if Level 2 was done (_mode = 2).
-		rmx = 0;	///< Refinement motion vector centre.
-		rmy = 0;
+			/// Level 1: Search on a cross pel grid over the defined L1 motion range if mode != 2. Otherwise
+			///					 the range is a refinement if Level 2 was done (_mode = 2).
+			rmx = 0;	///< Refinement motion vector centre.
+			rmy = 0;
 
-		/// For mode = 2 (level 2 search has been done) do a refinement search.
-		if(_mode == 2)
-		{
-			GetMotionRange(q, p, mx, my, &xlRng, &xrRng, &yuRng, &ydRng, lclL1MotionRange, 1);
-
-			for(i = yuRng; i <= ydRng; i++)
+			/// For mode = 2 (level 2 search has been done) do a refinement search.
+			if(_mode == 2)
 			{
-				for(j = xlRng; j <= xrRng; j++)
-				{
-					/// Early exit because zero (centre) motion vec already checked.
-					if( !(i||j) )	goto MEH264IMCV2_LEVEL1_BREAK;
+				GetMotionRange(q, p, mx, my, &xlRng, &xrRng, &yuRng, &ydRng, lclL1MotionRange, 1);
 
-					/// Set the block to the [j,i] motion vector around the [mx+p,my+q] reference location.
-					_pExtRefL1Over->SetOrigin(j+mx+q, i+my+p);
+				for(i = yuRng; i <= ydRng; i++)
+				{
+					for(j = xlRng; j <= xrRng; j++)
+					{
+						/// Early exit because zero (centre) motion vec already checked.
+						if( !(i||j) )	goto MEH264IMCV2_LEVEL1_BREAK;
 
+						/// Compare with the block at the [j,i] motion vector around the [mx+p,my+q] reference location.
+						int blkDiff;
 #ifdef MEH264IMCV2_ABS_DIFF
-					int blkDiff = _pInL1Over->Tad8x8LessThan(*_pExtRefL1Over, minDiffL1);
+						blkDiff = MEH264IMCV2_Td(pInL1, _l1Width, pRefL1 + ((i+my) * _extL1Width) + (j+mx), _extL1Width, 8, 1, minDiffL1, 1);
 #else
-					int blkDiff = _pInL1Over->Tsd8x8PartialLessThan(*_pExtRefL1Over, minDiffL1);
-//					int blkDiff = _pInL1Over->Tsd8x8LessThan(*_pExtRefL1Over, minDiffL1);
+						blkDiff = MEH264IMCV2_TsdPartial(pInL1, _l1Width, pRefL1 + ((i+my) * _extL1Width) + (j+mx), _extL1Width, 8, minDiffL1);
 #endif
-					if(blkDiff <= minDiffL1)
-					{
-						/// Weight the equal diff with the smallest mv magnitude from the predicted mv. 
-						if(blkDiff == minDiffL1)
+						if(blkDiff <= minDiffL1)
 						{
-              int currX = mx + rmx - predX1;
-              int currY = my + rmy - predY1;
-              int newX  = mx + j - predX1;
-              int newY  = my + i + predY1;
-							int vecDistDiff = ( (currY*currY)+(currX*currX) )-( (newY*newY)+(newX*newX) );
-//							int vecDistDiff = ( ((my+rmy)*(my+rmy))+((mx+rmx)*(mx+rmx)) )-( ((my+i)*(my+i))+((mx+j)*(mx+j)) );
-							if(vecDistDiff < 0)
-								goto MEH264IMCV2_LEVEL1_BREAK;
+							/// Weight the equal diff with the smallest mv magnitude from the predicted mv. 
+							if(blkDiff == minDiffL1)
+							{
+								int currX = mx + rmx - predX1;
+								int currY = my + rmy - predY1;
+								int newX  = mx + j - predX1;
+								int newY  = my + i + predY1;
+								int vecDistDiff = ( (currY*currY)+(currX*currX) )-( (newY*newY)+(newX*newX) );
+	//							int vecDistDiff = ( ((my+rmy)*(my+rmy))+((mx+rmx)*(mx+rmx)) )-( ((my+i)*(my+i))+((mx+j)*(mx+j)) );
+								if(vecDistDiff < 0)
+									goto MEH264IMCV2_LEVEL1_BREAK;
+							}//end if blkDiff...
+
+							minDiffL1 = blkDiff;
+							rmx = j;
+							rmy = i;
 						}//end if blkDiff...
 
-						minDiffL1 = blkDiff;
-						rmx = j;
-						rmy = i;
-					}//end if blkDiff...
-
-					MEH264IMCV2_LEVEL1_BREAK: ; ///< null.
-				}//end for j...
-			}//end for i...
-		}//end if mode == 2...
-		else	///< Do a cross search.
-		{
-			/// For this case, this is the first entry point of the search i.e. (mx,my) = (0,0).
-
-			for(int w = _l1MotionRange/2 ;w > 0; w = w/2)	///< Start at half the motion range and then converge by 2 every iteration.
+						MEH264IMCV2_LEVEL1_BREAK: ; ///< null.
+					}//end for j...
+				}//end for i...
+			}//end if mode == 2...
+			else	///< Do a cross search.
 			{
-				/// The winning centre is readjusted on every loop therefore the ranges must be recalculated.
-				GetMotionRange(q, p, mx, my, &xlRng, &xrRng, &yuRng, &ydRng, lclL1MotionRange-1, 1);
+				/// For this case, this is the first entry point of the search i.e. (mx,my) = (0,0).
 
-				/// Reset the offset from (mx,my);
-				rmx = 0;
-				rmy = 0;
-				for(int x = 0; x < MEH264IMCV2_MOTION_CROSS_POS_LENGTH; x++)
+				for(int w = _l1MotionRange/2 ;w > 0; w = w/2)	///< Start at half the motion range and then converge by 2 every iteration.
 				{
-					i = w * MEH264IMCV2_CrossPos[x].y;
-					j = w * MEH264IMCV2_CrossPos[x].x;
+					/// The winning centre is readjusted on every loop therefore the ranges must be recalculated.
+					GetMotionRange(q, p, mx, my, &xlRng, &xrRng, &yuRng, &ydRng, lclL1MotionRange-1, 1);
 
-					/// Check that this offset is within the range of the image boundaries. If not then skip.
-					if( ((i+my) < yuRng)||((i+my) > ydRng)||((j+mx) < xlRng)||((j+mx) > xrRng) )
-						goto MEH264IMCV2_LEVEL1_BREAK_C;
+					/// Reset the offset from (mx,my);
+					rmx = 0;
+					rmy = 0;
+					for(int x = 0; x < MEH264IMCV2_MOTION_CROSS_POS_LENGTH; x++)
+					{
+						i = w * MEH264IMCV2_CrossPos[x].y;
+						j = w * MEH264IMCV2_CrossPos[x].x;
 
-					/// Set the block to the (j,i) motion vector around the (mx+p,my+q) reference location.
-					_pExtRefL1Over->SetOrigin(j+mx+q, i+my+p);
+						/// Check that this offset is within the range of the image boundaries. If not then skip.
+						if( ((i+my) < yuRng)||((i+my) > ydRng)||((j+mx) < xlRng)||((j+mx) > xrRng) )
+							goto MEH264IMCV2_LEVEL1_BREAK_C;
 
+						/// Compare with the block at the (j,i) motion vector around the (mx+p,my+q) reference location.
+						int blkDiff;
 #ifdef MEH263IMC_ABS_DIFF
-					int blkDiff = _pInL1Over->Tad8x8LessThan(*_pExtRefL1Over, minDiffL1);
+						blkDiff = MEH264IMCV2_Td(pInL1, _l1Width, pRefL1 + ((i+my) * _extL1Width) + (j+mx), _extL1Width, 8, 1, minDiffL1, 1);
 #else
-					int blkDiff = _pInL1Over->Tsd8x8PartialLessThan(*_pExtRefL1Over, minDiffL1);
-//					int blkDiff = _pInL1Over->Tsd8x8LessThan(*_pExtRefL1Over, minDiffL1);
+						blkDiff = MEH264IMCV2_TsdPartial(pInL1, _l1Width, pRefL1 + ((i+my) * _extL1Width) + (j+mx), _extL1Width, 8, minDiffL1);
 #endif
 
-					if(blkDiff <= minDiffL1)
-					{
-						/// Weight the equal diff with the smallest motion vector magnitude. 
-						if(blkDiff == minDiffL1)
+						if(blkDiff <= minDiffL1)
 						{
-//							int vecDistDiff = ( ((my+rmy)*(my+rmy))+((mx+rmx)*(mx+rmx)) )-( ((my+i)*(my+i))+((mx+j)*(mx+j)) );
-              int currX = mx + rmx - predX1;
-              int currY = my + rmy - predY1;
-              int newX  = mx + j - predX1;
-              int newY  = my + i + predY1;
-							int vecDistDiff = ( (currY*currY)+(currX*currX) )-( (newY*newY)+(newX*newX) );
-							if(vecDistDiff < 0)
-								goto MEH264IMCV2_LEVEL1_BREAK_C;
+							/// Weight the equal diff with the smallest motion vector magnitude. 
+							if(blkDiff == minDiffL1)
+							{
+	//							int vecDistDiff = ( ((my+rmy)*(my+rmy))+((mx+rmx)*(mx+rmx)) )-( ((my+i)*(my+i))+((mx+j)*(mx+j)) );
+								int currX = mx + rmx - predX1;
+								int currY = my + rmy - predY1;
+								int newX  = mx + j - predX1;
+								int newY  = my + i + predY1;
+								int vecDistDiff = ( (currY*currY)+(currX*currX) )-( (newY*newY)+(newX*newX) );
+								if(vecDistDiff < 0)
+									goto MEH264IMCV2_LEVEL1_BREAK_C;
+							}//end if blkDiff...
+
+							minDiffL1 = blkDiff;
+							rmx = j;
+							rmy = i;
 						}//end if blkDiff...
 
-						minDiffL1 = blkDiff;
-						rmx = j;
-						rmy = i;
-					}//end if blkDiff...
+						MEH264IMCV2_LEVEL1_BREAK_C: ; ///< null.
 
-					MEH264IMCV2_LEVEL1_BREAK_C: ; ///< null.
+					}//end for x...
 
-				}//end for x...
+					/// Update new centre of winning vector.
+					mx += rmx;
+					my += rmy;
+				}//end for w...
 
-				/// Update new centre of winning vector.
-				mx += rmx;
-				my += rmy;
-			}//end for w...
-
-		}//end else...
+			}//end else...
 
-		mx = (mx+rmx) * 2; ///< Convert level 1 full pel units to level 0 full pel units ( x2 ) after adding the L1 refinement.
-		my = (my+rmy) * 2;
+			mx = (mx+rmx) * 2; ///< Convert level 1 full pel units to level 0 full pel units ( x2 ) after adding the L1 refinement.
+			my = (my+rmy) * 2;
+		}//end if searchLevel...
 
-		///----------------------- Level 0 full pel refined search ------------------------
-    /// Level 0: Search on a full pel grid over the defined L0 refined motion range.
-
-		/// Get the min diff at this location in level 0 grid units only if (mx,my) is not the zero mv because minDiff
-    /// was initialised to zeroVecDiff at the start.
-		_pExtRefOver->SetOrigin(n+mx,m+my);
+		if(searchLevel > 0)
+		{
+			///----------------------- Level 0 full pel refined search ------------------------
+			/// Level 0: Search on a full pel grid over the defined L0 refined motion range.
 
-    if(mx||my)
-    {
+			/// Get the min diff at this location in level 0 grid units only if (mx,my) is not the zero mv because minDiff
+			/// was initialised to zeroVecDiff at the start.
+			if(mx||my)
+			{
 #ifdef MEH264IMCV2_ABS_DIFF
-		  minDiff = _pInOver->Tad16x16(*_pExtRefOver);
+				minDiff = MEH264IMCV2_Td(pIn, _macroBlkWidth, pRef + (my * _extWidth) + mx, _extWidth, 16, 1, 0, 0);
 #else
-		  minDiff = _pInOver->Tsd16x16(*_pExtRefOver);
+				minDiff = MEH264IMCV2_Td(pIn, _macroBlkWidth, pRef + (my * _extWidth) + mx, _extWidth, 16, 0, 0, 0);
 #endif
-    }//end if mx...
-
-		/// Look for an improvement on the motion vector calc above within the refined range.
-		rmx = 0;	///< Refinement motion vector centre.
-		rmy = 0;
-		GetMotionRange(n, m, mx, my, &xlRng, &xrRng, &yuRng, &ydRng, MEH264IMCV2_L0_MOTION_VECTOR_REFINED_RANGE, 0);
+			}//end if mx...
 
-    for(i = yuRng; i <= ydRng; i++)
-    {
-			for(j = xlRng; j <= xrRng; j++)
+			/// Refine around the best candidate if it is better than the multiresolution result.
+			if(_predictive && (candDiff < minDiff))
 			{
-				/// Early exit because zero motion vec already checked.
-				if( !(i||j) )	goto MEH264IMCV2_LEVEL0_BREAK;
+				mx			= candX;
+				my			= candY;
+				minDiff = candDiff;
+			}//end if _predictive...
+
+			/// Look for an improvement on the motion vector calc above within the refined range.
+			rmx = 0;	///< Refinement motion vector centre.
+			rmy = 0;
+			GetMotionRange(n, m, mx, my, &xlRng, &xrRng, &yuRng, &ydRng, MEH264IMCV2_L0_MOTION_VECTOR_REFINED_RANGE, 0);
 
-				/// Set the block to the [j,i] motion vector around the [n+mx,m+my] reference location.
-				_pExtRefOver->SetOrigin(n+mx+j, m+my+i);
+			for(i = yuRng; i <= ydRng; i++)
+			{
+				for(j = xlRng; j <= xrRng; j++)
+				{
+					/// Early exit because zero motion vec already checked.
+					if( !(i||j) )	goto MEH264IMCV2_LEVEL0_BREAK;
 
+					/// Compare with the block at the [j,i] motion vector around the [n+mx,m+my] reference location.
+					int blkDiff;
 #ifdef MEH264IMCV2_ABS_DIFF
-				int blkDiff = _pInOver->Tad16x16LessThan(*_pExtRefOver, minDiff);
+					blkDiff = MEH264IMCV2_Td(pIn, _macroBlkWidth, pRef + ((my+i) * _extWidth) + (mx+j), _extWidth, 16, 1, minDiff, 1);
 #else
-//				int blkDiff = _pInOver->Tsd16x16LessThan(*_pExtRefOver, minDiff);
-				int blkDiff = _pInOver->Tsd16x16PartialLessThan(*_pExtRefOver, minDiff);
+					blkDiff = MEH264IMCV2_TsdPartial(pIn, _macroBlkWidth, pRef + ((my+i) * _extWidth) + (mx+j), _extWidth, 16, minDiff);
 #endif
-				if(blkDiff <= minDiff)
-				{
-					/// Weight the equal diff with the smallest global mv magnitude from the pred mv. 
-					if(blkDiff == minDiff)
+					if(blkDiff <= minDiff)
 					{
-//						int vecDistDiff = ( ((my+rmy)*(my+rmy))+((mx+rmx)*(mx+rmx)) )-( ((my+i)*(my+i))+((mx+j)*(mx+j)) );
-            int currX = mx + rmx - predX0Rnd;
-            int currY = my + rmy - predY0Rnd;
-            int newX  = mx + j - predX0Rnd;
-            int newY  = my + i + predY0Rnd;
-						int vecDistDiff = ( (currY*currY)+(currX*currX) )-( (newY*newY)+(newX*newX) );
-						if(vecDistDiff < 0)
-							goto MEH264IMCV2_LEVEL0_BREAK;
-					}//end if blkDiff...
-
-					minDiff = blkDiff;
-					rmx = j;
-					rmy = i;
-				}//end if blkDiff...
+						/// Weight the equal diff with the smallest global mv magnitude from the pred mv. 
+						if(blkDiff == minDiff)
+						{
+	//						int vecDistDiff = ( ((my+rmy)*(my+rmy))+((mx+rmx)*(mx+rmx)) )-( ((my+i)*(my+i))+((mx+j)*(mx+j)) );
+							int currX = mx + rmx - predX0Rnd;
+							int currY = my + rmy - predY0Rnd;
+							int newX  = mx + j - predX0Rnd;
+							int newY  = my + i + predY0Rnd;
+							int vecDistDiff = ( (currY*currY)+(currX*currX) )-( (newY*newY)+(newX*newX) );
+							if(vecDistDiff < 0)
+								goto MEH264IMCV2_LEVEL0_BREAK;
+						}//end if blkDiff...
 
-				MEH264IMCV2_LEVEL0_BREAK: ; ///< null.
-			}//end for j...
-    }//end for i...
+						minDiff = blkDiff;
+						rmx = j;
+						rmy = i;
+					}//end if blkDiff...
 
-		/// Add the refinement in full pixel units.
-		mx += rmx;
-		my += rmy;
+					MEH264IMCV2_LEVEL0_BREAK: ; ///< null.
+				}//end for j...
+			}//end for i...
 
-		///----------------------- Level 0 quarter pel refined search ------------------------
-    /// Search around the min diff full pel motion vector on a 1/4 pel grid firstly on the
-		/// 1/2 pel positions and then refine the winner on the 1/4 pel positions. 
+			/// Add the refinement in full pixel units.
+			mx += rmx;
+			my += rmy;
 
-		int mvx = mx << 2;	///< Convert to 1/4 pel units.
-		int mvy = my << 2;
+			///----------------------- Level 0 quarter pel refined search ------------------------
+			/// Search around the min diff full pel motion vector on a 1/4 pel grid firstly on the
+			/// 1/2 pel positions and then refine the winner on the 1/4 pel positions. 
 
-		/// Set the location to the min diff motion vector (mx,my).
-		_pExtRefOver->SetOrigin(n+mx, m+my);
+			mvx = mx << 2;	///< Convert to 1/4 pel units.
+			mvy = my << 2;
 
-		/// Fill the 1/4 pel window with valid values only in the 1/2 pel positions.
-		LoadHalfQuartPelWindow(_Win, _pExtRefOver); 
+			/// Fill the 1/4 pel window with valid values only in the 1/2 pel positions at the 
+			/// location of the min diff motion vector (mx,my).
+			if(refPicLoaded)
+				LoadHalfQuartPelWindow(_Win, _pRefPicture, n+mx, m+my);
+			else
+			{
+				_pExtRefOver->SetOrigin(n+mx, m+my);
+				LoadHalfQuartPelWindow(_Win, _pExtRefOver); 
+			}//end else...
 
-    for(int x = 0; x < MEH264IMCV2_MOTION_SUB_POS_LENGTH; x++)
-    {
-			int qOffX = 2 * MEH264IMCV2_SubPos[x].x;
-			int qOffY = 2 * MEH264IMCV2_SubPos[x].y;
+			for(int x = 0; x < MEH264IMCV2_MOTION_SUB_POS_LENGTH; x++)
+			{
+				int qOffX = 2 * MEH264IMCV2_SubPos[x].x;
+				int qOffY = 2 * MEH264IMCV2_SubPos[x].y;
 
-			/// Read the half grid pels into temp.
-			QuarterRead(_pMBlkOver, _Win, qOffX, qOffY);
+				/// Read the half grid pels into temp.
+				QuarterRead(_pMBlkOver, _Win, qOffX, qOffY);
 
+				int blkDiff;
 #ifdef MEH264IMCV2_ABS_DIFF
-			int blkDiff = _pInOver->Tad16x16LessThan(*_pMBlkOver, minDiff);
+				blkDiff = _pInOver->Tad16x16LessThan(*_pMBlkOver, minDiff);
 #else
-//			int blkDiff = _pInOver->Tsd16x16LessThan(*_pMBlkOver, minDiff);
-		int blkDiff = _pInOver->Tsd16x16PartialLessThan(*_pMBlkOver, minDiff);
+	//			int blkDiff = _pInOver->Tsd16x16LessThan(*_pMBlkOver, minDiff);
+			blkDiff = _pInOver->Tsd16x16PartialLessThan(*_pMBlkOver, minDiff);
 #endif
-			if(blkDiff < minDiff)
-			{
-				minDiff = blkDiff;
-				hmx = qOffX;
-				hmy = qOffY;
-			}//end if blkDiff...
-    }//end for x...
+				if(blkDiff < minDiff)
+				{
+					minDiff = blkDiff;
+					hmx = qOffX;
+					hmy = qOffY;
+				}//end if blkDiff...
+			}//end for x...
 
-		qmx = hmx;
-		qmy = hmy;
+			qmx = hmx;
+			qmy = hmy;
 
-		/// Fill the 1/4 pel positions around the winning 1/2 pel position (hmx,hmy).
-		LoadQuartPelWindow(_Win, hmx, hmy); 
+			/// Fill the 1/4 pel positions around the winning 1/2 pel position (hmx,hmy).
+			LoadQuartPelWindow(_Win, hmx, hmy); 
 
-    for(int x = 0; x < MEH264IMCV2_MOTION_SUB_POS_LENGTH; x++)
-    {
-			int qOffX = hmx + MEH264IMCV2_SubPos[x].x;
-			int qOffY = hmy + MEH264IMCV2_SubPos[x].y;
+			for(int x = 0; x < MEH264IMCV2_MOTION_SUB_POS_LENGTH; x++)
+			{
+				int qOffX = hmx + MEH264IMCV2_SubPos[x].x;
+				int qOffY = hmy + MEH264IMCV2_SubPos[x].y;
 
-			/// Read the quarter grid pels into temp.
-			QuarterRead(_pMBlkOver, _Win, qOffX, qOffY);
+				/// Read the quarter grid pels into temp.
+				QuarterRead(_pMBlkOver, _Win, qOffX, qOffY);
 
+				int blkDiff;
 #ifdef MEH264IMCV2_ABS_DIFF
-			int blkDiff = _pInOver->Tad16x16LessThan(*_pMBlkOver, minDiff);
+				blkDiff = _pInOver->Tad16x16LessThan(*_pMBlkOver, minDiff);
 #else
-//			int blkDiff = _pInOver->Tsd16x16LessThan(*_pMBlkOver, minDiff);
-			int blkDiff = _pInOver->Tsd16x16PartialLessThan(*_pMBlkOver, minDiff);
+	//			int blkDiff = _pInOver->Tsd16x16LessThan(*_pMBlkOver, minDiff);
+				blkDiff = _pInOver->Tsd16x16PartialLessThan(*_pMBlkOver, minDiff);
 #endif
-			if(blkDiff < minDiff)
-			{
-				minDiff = blkDiff;
-				qmx = qOffX;
-				qmy = qOffY;
-			}//end if blkDiff...
-    }//end for x...
+				if(blkDiff < minDiff)
+				{
+					minDiff = blkDiff;
+					qmx = qOffX;
+					qmy = qOffY;
+				}//end if blkDiff...
+			}//end for x...
 
-		/// Add the refinement in 1/4 pel units.
-		mvx += qmx;
-		mvy += qmy;
+			/// Add the refinement in 1/4 pel units.
+			mvx += qmx;
+			mvy += qmy;
+		}//end if searchLevel...
 
 		/// Bounds check used for debugging only as the minDiff will not be correct.
 		//if(mvx < -_motionRange) 
@@ -999,15 +1242,19 @@ void* MotionEstimatorH264ImplMultiresCrossVer2::Estimate(long* avgDistortion)
     predX = (predX0 * 4) + predXQuart;
     predY = (predY0 * 4) + predYQuart;
 
-		_pExtRefOver->SetOrigin(predX0+n,predY0+m);
-
     /// Get distortion at pred mv.
     int predVecDiff = 0;
     /// Quarter read first if necessary.
     if(predXQuart || predYQuart)
     {
 			/// Read the quarter grid pels into temp.
-			_pExtRefOver->QuarterRead(*_pMBlkOver, predXQuart, predYQuart);
+			if(refPicLoaded)
+				_pRefPicture->QuarterRead(_pMBlkOver, predX0+n, predY0+m, predXQuart, predYQuart);
+			else
+			{
+				_pExtRefOver->SetOrigin(predX0+n,predY0+m);
+				_pExtRefOver->QuarterRead(*_pMBlkOver, predXQuart, predYQuart);
+			}//end else...
 		/// Absolute/square diff comparison method.
 #ifdef MEH264IMCV2_ABS_DIFF
 		  predVecDiff = _pInOver->Tad16x16(*_pMBlkOver);
@@ -1018,9 +1265,9 @@ void* MotionEstimatorH264ImplMultiresCrossVer2::Estimate(long* avgDistortion)
     else
     {
 #ifdef MEH264IMCV2_ABS_DIFF
-		  predVecDiff = _pInOver->Tad16x16(*_pExtRefOver);
+		  predVecDiff = MEH264IMCV2_Td(pIn, _macroBlkWidth, pRef + (predY0 * _extWidth) + predX0, _extWidth, 16, 1, 0, 0);
 #else
-		  predVecDiff = _pInOver->Tsd16x16(*_pExtRefOver);
+		  predVecDiff = MEH264IMCV2_Td(pIn, _macroBlkWidth, pRef + (predY0 * _extWidth) + predX0, _extWidth, 16, 0, 0, 0);
 #endif
     }//end else...
 
@@ -1098,6 +1345,9 @@ void* MotionEstimatorH264ImplMultiresCrossVer2::Estimate(long* avgDistortion)
 
   }//end for m & n...
 
+	/// The vectors are candidates for the next estimation.
+	_prevResultValid = 1;
+
 	/// In this context avg distortion is actually avg difference.
 //	*avgDistortion = totalDifference/maxLength;
 	if(included)	///< Prevent divide by zero error.
@@ -1129,22 +1379,18 @@ void MotionEstimatorH264ImplMultiresCrossVer2::Destroy(void)
 		delete _pInOver;
 	_pInOver = NULL;
 
+	if(_pInBlk8 != NULL)
+		delete[] _pInBlk8;
+	_pInBlk8 = NULL;
+
 	if(_pInL1 != NULL)
 		delete[] _pInL1;
 	_pInL1 = NULL;
 
-	if(_pInL1Over != NULL)
-		delete _pInL1Over;
-	_pInL1Over = NULL;
-
 	if(_pInL2 != NULL)
 		delete[] _pInL2;
 	_pInL2 = NULL;
 
-	if(_pInL2Over != NULL)
-		delete _pInL2Over;
-	_pInL2Over = NULL;
-
 	if(_pRefOver != NULL)
 		delete _pRefOver;
 	_pRefOver	= NULL;
@@ -1157,38 +1403,18 @@ void MotionEstimatorH264ImplMultiresCrossVer2::Destroy(void)
 		delete _pExtRefOver;
 	_pExtRefOver = NULL;
 
-	if(_pRefL1 != NULL)
-		delete[] _pRefL1;
-	_pRefL1	= NULL;
-
-	if(_pRefL1Over != NULL)
-		delete _pRefL1Over;
-	_pRefL1Over	= NULL;
+	if(_pExtRef8 != NULL)
+		delete[] _pExtRef8;
+	_pExtRef8 = NULL;
 
 	if(_pExtRefL1 != NULL)
 		delete[] _pExtRefL1;
 	_pExtRefL1 = NULL;
 
-	if(_pExtRefL1Over != NULL)
-		delete _pExtRefL1Over;
-	_pExtRefL1Over = NULL;
-
-	if(_pRefL2 != NULL)
-		delete[] _pRefL2;
-	_pRefL2	= NULL;
-
-	if(_pRefL2Over != NULL)
-		delete _pRefL2Over;
-	_pRefL2Over	= NULL;
-
 	if(_pExtRefL2 != NULL)
 		delete[] _pExtRefL2;
 	_pExtRefL2 = NULL;
 
-	if(_pExtRefL2Over != NULL)
-		delete _pExtRefL2Over;
-	_pExtRefL2Over = NULL;
-
 	if(_pMBlk != NULL)
 		delete[] _pMBlk;
 	_pMBlk = NULL;
@@ -1356,6 +1582,55 @@ void MotionEstimatorH264ImplMultiresCrossVer2::GetMotionRange(	int  xpos,	int  y
 
 }//end GetMotionRange.
 
+/** Get the best full pel candidate vector for the predictive mode.
+The candidates within the motion range are listed by a MotionVectorCandidateList. The 
+motion vector struct still holds the previous result from vecPos onwards.
+@param n						: X coord of the macroblock.
+@param m						: Y coord of the macroblock.
+@param vecPos				: Macroblock position in the motion vector struct.
+@param predX				: X coord of the nearest full pel predicted vector.
+@param predY				: Y coord of the nearest full pel predicted vector.
+@param zeroVecDiff	: Distortion of the zero vector.
+@param bestX				: Returned x coord of the best candidate. Zero if none are better.
+@param bestY				: Returned y coord of the best candidate.
+@return							: Distortion of the best candidate.
+*/
+int MotionEstimatorH264ImplMultiresCrossVer2::GetBestCandidate(int n, int m, int vecPos, int predX, int predY, int zeroVecDiff, int* bestX, int* bestY)
+{
+	int xlRng, xrRng, yuRng, ydRng;
+	GetMotionRange(n, m, &xlRng, &xrRng, &yuRng, &ydRng, (_motionRange/4)-1, 0);
+
+	MotionVectorCandidateList cand;
+	cand.Load(_pMotionVectorStruct, _prevResultValid, vecPos, n, m, _imgWidth, _imgHeight, predX, predY, xlRng, xrRng, yuRng, ydRng);
+
+	const unsigned char* pIn	= _pInBlk8;	///< Packed by the caller.
+	const unsigned char* pRef	= &(_pExtRef8[((m + _extBoundary) * _extWidth) + n + _extBoundary]);	///< Zero vector.
+
+	int minDiff = zeroVecDiff;
+	*bestX = 0;
+	*bestY = 0;
+	for(int i = 0; i < cand.GetLength(); i++)
+	{
+		int x = cand.GetX(i);
+		int y = cand.GetY(i);
+
+		int blkDiff;
+#ifdef MEH264IMCV2_ABS_DIFF
+		blkDiff = MEH264IMCV2_Td(pIn, _macroBlkWidth, pRef + (y * _extWidth) + x, _extWidth, 16, 1, minDiff, 1);
+#else
+		blkDiff = MEH264IMCV2_TsdPartial(pIn, _macroBlkWidth, pRef + (y * _extWidth) + x, _extWidth, 16, minDiff);
+#endif
+		if(blkDiff < minDiff)
+		{
+			minDiff = blkDiff;
+			*bestX	= x;
+			*bestY	= y;
+		}//end if blkDiff...
+	}//end for i...
+
+	return(minDiff);
+}//end GetBestCandidate.
+
 /** Load a 1/4 pel window with 1/2 pel values.
 The 1/4 pel window must be the macroblock size with a boundary of 3 extra pels on all sides. Only the inner
 macroblock size plus 1 extra pel boundary are filled with valid values. This window is used in a cascading 
@@ -1457,6 +1732,42 @@ void MotionEstimatorH264ImplMultiresCrossVer2::LoadHalfQuartPelWindow(OverlayMem
 
 }//end LoadHalfQuartPelWindow.
 
+/** Load a 1/4 pel window with 1/2 pel values from precomputed planes.
+The same window positions as in LoadHalfQuartPelWindow() are filled but the values are 
+copied from the 1/2 pel planes of the ref picture instead of being interpolated.
+@param qPelWin	: Window of size (4 * (_macroBlkHeight+6)) x (4 * (_macroBlkWidth+6))
+@param pRefPic	: Ref picture holding the 1/2 pel planes.
+@param x				: Full pel col of the ref aligned with the full pel (3,3) window position.
+@param y				: Full pel row of the ref aligned with the full pel (3,3) window position.
+@return					: none.
+*/
+void MotionEstimatorH264ImplMultiresCrossVer2::LoadHalfQuartPelWindow(OverlayMem2Dv2* qPelWin, RefPictureH264* pRefPic, int x, int y)
+{
+	short** window	= qPelWin->Get2DSrcPtr();
+	short** g				= pRefPic->GetPlane(RefPictureH264::FULL_PEL);
+	short** b				= pRefPic->GetPlane(RefPictureH264::HALF_H);
+	short** h				= pRefPic->GetPlane(RefPictureH264::HALF_V);
+	short** j				= pRefPic->GetPlane(RefPictureH264::HALF_HV);
+
+	for(int fullRow = 2, quartRow = 8, refRow = y - 1; fullRow <= (_macroBlkHeight + 3); fullRow++, quartRow += 4, refRow++)
+	{
+		short* pG = &(g[refRow][x - 1]);
+		short* pB = &(b[refRow][x - 1]);
+		short* pH = &(h[refRow][x - 1]);
+		short* pJ = &(j[refRow][x - 1]);
+		short* pW = &(window[quartRow][8]);
+		short* pWh = &(window[quartRow + 2][8]);
+		for(int fullCol = 2; fullCol <= (_macroBlkWidth + 3); fullCol++, pW += 4, pWh += 4)
+		{
+			pW[0]		= *pG++;
+			pW[2]		= *pB++;
+			pWh[0]	= *pH++;
+			pWh[2]	= *pJ++;
+		}//end for fullCol...
+	}//end for fullRow...
+
+}//end LoadHalfQuartPelWindow.
+
 /** Load a 1/4 pel window with 1/4 pel values not in 1/2 pel positions.
 The 1/4 pel window must be the macroblock size with a boundary of 3 extra pels on all sides. Only the inner
 macroblock size plus 1 extra pel boundary are filled with valid values. This window is used in a cascading 
@@ -41,8 +41,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IMotionEstimator.h"
 #include "IMotionVectorPredictor.h"
 #include "VectorStructList.h"
+#include "MotionVectorCandidateList.h"
 #include "OverlayMem2Dv2.h"
 #include "OverlayExtMem2Dv2.h"
+#include "RefPictureH264.h"
 
 /*
 ---------------------------------------------------------------------------
@@ -88,7 +90,7 @@ public:
 	virtual void	Reset(void);
 	virtual int		Ready(void)		{ return(_ready); }
 	virtual void	SetMode(int mode);
-	virtual int		GetMode(void) { return(_mode); }
+	virtual int		GetMode(void) { return(_predictive ? 3 : _mode); }
 
 	/** Motion estimate the source within the reference.
 	Do the estimation with the block sizes and image sizes defined in
@@ -101,6 +103,10 @@ public:
 		{ return(Estimate(avgDistortion)); }
 	virtual void* Estimate(long* avgDistortion);
 
+	/// The 1/2 pel planes are used for the sub pel search and are loaded with the ref if they
+	/// are stale. Attach before Create() to do without the 16-bit extended ref.
+	virtual void	SetRefPicture(void* pRefPicture) { _pRefPicture = (RefPictureH264 *)pRefPicture; }
+
 /// Local methods.
 protected:
 
@@ -120,7 +126,11 @@ protected:
 											int*	yur,		int*	ydr, 
 											int		range,	int		level); 
 
+	/// Best full pel candidate vector of the predictive mode and its distortion.
+	int	 GetBestCandidate(int n, int m, int vecPos, int predX, int predY, int zeroVecDiff, int* bestX, int* bestY);
+
 	void LoadHalfQuartPelWindow(OverlayMem2Dv2* qPelWin, OverlayMem2Dv2* extRef);
+	void LoadHalfQuartPelWindow(OverlayMem2Dv2* qPelWin, RefPictureH264* pRefPic, int x, int y);
 	void LoadQuartPelWindow(OverlayMem2Dv2* qPelWin, int hPelColOff, int hPelRowOff);
 	void QuarterRead(OverlayMem2Dv2* dstBlock, OverlayMem2Dv2* qPelWin, int qPelColOff, int qPelRowOff);
 
@@ -128,6 +138,8 @@ protected:
 
 	int _ready;	///< Ready to estimate.
 	int _mode;	///< Speed mode or whatever. [ 0 = auto, 1 = level 1, 2 = level 2.]
+	int _predictive;			///< Seed the search with candidate vectors. [mode = 3]
+	int _prevResultValid;	///< The motion vector struct holds the previous estimation.
 
 	/// Parameters must remain const for the life time of this instantiation.
 	int	_imgWidth;				///< Width of the src and ref images. 
@@ -139,48 +151,45 @@ protected:
 	const void*	_pInput;	///< References to the images at construction.
 	const void* _pRef;
 
+	/// The full pel searches use 8-bit copies of the input and ref. The 16-bit input is
+	/// used for the sub pel search.
+
 	/// Level 0: Input mem overlay members.
 	OverlayMem2Dv2*		_pInOver;					///< Input overlay with motion block dim.
+	unsigned char*		_pInBlk8;					///< 8-bit input block at (_macroBlkWidth * _macroBlkHeight).
 	/// Level 1: Subsampled input by 2. [_mode == 1]
-	short*						_pInL1;						///< Input mem at (_l1Width * _l1Height).
+	unsigned char*		_pInL1;						///< 8-bit input mem at (_l1Width * _l1Height).
 	int								_l1Width;
 	int								_l1Height;
 	int								_l1MacroBlkWidth;
 	int								_l1MacroBlkHeight;
 	int								_l1MotionRange;		///< Full pel level 1 units.
-	OverlayMem2Dv2*		_pInL1Over;				///< Input overlay with level 1 motion block dim.
 	/// Level 2: Subsampled input by 4.	[_mode == 2]
-	short*						_pInL2;						///< Input mem at (_l2Width * _l2Height).
+	unsigned char*		_pInL2;						///< 8-bit input mem at (_l2Width * _l2Height).
 	int								_l2Width;
 	int								_l2Height;
 	int								_l2MacroBlkWidth;
 	int								_l2MacroBlkHeight;
 	int								_l2MotionRange;		///< Full pel level 2 units.
-	OverlayMem2Dv2*		_pInL2Over;				///< Input overlay with level 2 motion block dim.
 
 	/// Level 0: Ref mem overlay members.
 	OverlayMem2Dv2*			_pRefOver;				///< Ref overlay with whole block dim.
-	short*							_pExtRef;					///< Extended ref mem created by ExtendBoundary() call.
+	short*							_pExtRef;					///< Extended ref mem created by ExtendBoundary() call without a ref picture.
 	int									_extWidth;
 	int									_extHeight;
 	int									_extBoundary;			///< Extended boundary for left, right, up and down.
 	OverlayExtMem2Dv2*	_pExtRefOver;			///< Extended ref overlay with motion block dim.
+	unsigned char*			_pExtRef8;				///< 8-bit extended ref mem at (_extWidth * _extHeight).
 	/// Level 1: Subsampled ref by 2.		[_mode == 1]
-	short*							_pRefL1;					///< Ref mem at (_l1Width * _l1Height).
-	OverlayMem2Dv2*			_pRefL1Over; 			///< Ref overlay with whole level 1 block dim.
-	short*							_pExtRefL1;				///< Extended ref mem create by ExtendBoundary() call.
+	unsigned char*			_pExtRefL1;				///< 8-bit extended ref mem with the subsampled ref in the centre.
 	int									_extL1Width;
 	int									_extL1Height;
 	int									_extL1Boundary;		///< Extended boundary for left, right, up and down.
-	OverlayExtMem2Dv2*	_pExtRefL1Over;		///< Ref overlay with level 1 motion block dim.
 	/// Level 2: Subsampled ref by 4.		[_mode == 2]
-	short*							_pRefL2;					///< Ref mem at (_l2Width * _l2Height).
-	OverlayMem2Dv2*			_pRefL2Over; 			///< Ref overlay with whole level 2 block dim.
-	short*							_pExtRefL2;				///< Extended ref mem create by ExtendBoundary() call.
+	unsigned char*			_pExtRefL2;				///< 8-bit extended ref mem with the subsampled ref in the centre.
 	int									_extL2Width;
 	int									_extL2Height;
 	int									_extL2Boundary;		///< Extended boundary for left, right, up and down.
-	OverlayExtMem2Dv2*	_pExtRefL2Over;		///< Ref overlay with level 2 motion block dim.
 	/// A 1/4 pel refinement window.
 	short*							_pWin;
 	OverlayMem2Dv2*			_Win;
@@ -193,6 +202,8 @@ protected:
 	VectorStructList*	_pMotionVectorStruct;
   /// Attached motion vector predictor on construction.
   IMotionVectorPredictor* _pMVPred;
+	/// Optional shared 1/2 pel planes of the ref. Not owned.
+	RefPictureH264*					_pRefPicture;
 
 	/// A flag per macroblock to include it in the distortion accumulation.
 	bool*							_pDistortionIncluded;
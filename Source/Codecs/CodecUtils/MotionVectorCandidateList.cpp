@@ -0,0 +1,99 @@
+/** @file
+
+MODULE				: MotionVectorCandidateList
+
+TAG						: MVCL
+
+FILE NAME			: MotionVectorCandidateList.cpp
+
+DESCRIPTION		: A list of full pel candidate vectors that seed the predictive
+								motion searches of a 16x16 macroblock. The candidates are the
+								predicted vector, the co-located, right and below vectors of
+								the previous estimation and the left and above vectors of the
+								current estimation. Only unique candidates that are not the
+								zero vector and lie within the search range are listed.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#include "MotionVectorCandidateList.h"
+
+/*
+---------------------------------------------------------------------------
+	Interface methods.
+---------------------------------------------------------------------------
+*/
+int MotionVectorCandidateList::Load(VectorStructList* pMotionVectorStruct, int prevValid, int vecPos,
+																		int x, int y, int width, int height, int predX, int predY,
+																		int xlRng, int xrRng, int yuRng, int ydRng)
+{
+	int cand[MVCL_MAX_CANDIDATES][2];
+	int vec[MVCL_MAX_CANDIDATES];
+	int i, j, len = 0;
+	int mbWidth = width/16;
+
+	/// Candidates held in the vector struct are listed by position and then converted.
+	if(prevValid)
+	{
+		vec[len++] = vecPos;																				///< Co-located.
+		if( (x + 16) < width )
+			vec[len++] = vecPos + 1;																	///< Right.
+		if( (y + 16) < height )
+			vec[len++] = vecPos + mbWidth;														///< Below.
+	}//end if prevValid...
+	if(x > 0)
+		vec[len++] = vecPos - 1;																		///< Left.
+	if(y > 0)
+		vec[len++] = vecPos - mbWidth;															///< Above.
+	for(i = 0; i < len; i++)
+	{
+		int mvx = pMotionVectorStruct->GetSimpleElement(vec[i], 0);
+		int mvy = pMotionVectorStruct->GetSimpleElement(vec[i], 1);
+		/// Nearest full pel vector.
+		cand[i+1][0] = (mvx < 0)? (mvx - 2)/4 : (mvx + 2)/4;
+		cand[i+1][1] = (mvy < 0)? (mvy - 2)/4 : (mvy + 2)/4;
+	}//end for i...
+	cand[0][0] = predX;
+	cand[0][1] = predY;
+	len++;
+
+	/// Keep the unique candidates within the range in their listed order.
+	_length = 0;
+	for(i = 0; i < len; i++)
+	{
+		int mvx = cand[i][0];
+		int mvy = cand[i][1];
+		if( !(mvx||mvy) || (mvx < xlRng) || (mvx > xrRng) || (mvy < yuRng) || (mvy > ydRng) )
+			continue;
+		for(j = 0; j < _length; j++)
+		{
+			if( (_cand[j][0] == mvx)&&(_cand[j][1] == mvy) )
+				break;
+		}//end for j...
+		if(j < _length)	///< Already listed.
+			continue;
+
+		_cand[_length][0] = mvx;
+		_cand[_length][1] = mvy;
+		_length++;
+	}//end for i...
+
+	return(_length);
+}//end Load.
@@ -0,0 +1,95 @@
+/** @file
+
+MODULE				: MotionVectorCandidateList
+
+TAG						: MVCL
+
+FILE NAME			: MotionVectorCandidateList.h
+
+DESCRIPTION		: A list of full pel candidate vectors that seed the predictive
+								motion searches of a 16x16 macroblock. The candidates are the
+								predicted vector, the co-located, right and below vectors of
+								the previous estimation and the left and above vectors of the
+								current estimation. Only unique candidates that are not the
+								zero vector and lie within the search range are listed.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifndef _MOTIONVECTORCANDIDATELIST_H
+#define _MOTIONVECTORCANDIDATELIST_H
+
+#pragma once
+
+#include "VectorStructList.h"
+
+/// Square error distortion thresholds of the predictive searches. The search ends at a
+/// candidate below the noise floor and only refines a candidate below the seed threshold.
+#define MVCL_EARLY_EXIT_THRESHOLD		512		///< ((16[vec dim] * 16[vec dim]) * 2).
+#define MVCL_SEED_THRESHOLD					(4 * MVCL_EARLY_EXIT_THRESHOLD)
+
+/// Max number of candidate vectors.
+#define MVCL_MAX_CANDIDATES					6
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class MotionVectorCandidateList
+{
+	public:
+		MotionVectorCandidateList(void)						{ _length = 0; }
+		virtual ~MotionVectorCandidateList(void)	{ }
+
+	/// Interface.
+	public:
+		/** Load the candidates of the macroblock at (x,y).
+		The vectors of the previous estimation are read from the motion vector struct
+		and must be loaded before they are overwritten.
+		@param pMotionVectorStruct	: 1/4 pel (x,y) vectors in macroblock raster order.
+		@param prevValid						: The struct holds the previous estimation.
+		@param vecPos								: Macroblock position in the struct.
+		@param x										: Macroblock location in pels.
+		@param y										:
+		@param width								: Picture dimensions in pels.
+		@param height								:
+		@param predX								: Full pel predicted vector.
+		@param predY								:
+		@param xlRng								: Full pel search range inclusive of the limits.
+		@param xrRng								:
+		@param yuRng								:
+		@param ydRng								:
+		@return											: Number of candidates listed.
+		*/
+		int Load(	VectorStructList* pMotionVectorStruct, int prevValid, int vecPos,
+							int x, int y, int width, int height, int predX, int predY,
+							int xlRng, int xrRng, int yuRng, int ydRng);
+
+		int	GetLength(void)	{ return(_length); }
+		int	GetX(int i)			{ return(_cand[i][0]); }
+		int	GetY(int i)			{ return(_cand[i][1]); }
+
+	protected:
+		int	_length;
+		int	_cand[MVCL_MAX_CANDIDATES][2];	///< Full pel (x,y) vectors.
+};// end class MotionVectorCandidateList.
+
+#endif	//_MOTIONVECTORCANDIDATELIST_H
@@ -61,9 +61,8 @@ public:
 	*/
 	int Decode(IBitStreamReader* bsr) 
 	{ 
-		int symbol = 0;
-		while(0 == bsr->Read())
-			symbol++;
+		int symbol = bsr->CountLeadingZeros(32);
+		bsr->Skip(symbol + 1);
 		_numCodeBits = symbol + 1;
 		return(symbol);
 	}//end Decode. 
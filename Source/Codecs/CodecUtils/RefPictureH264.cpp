@@ -0,0 +1,367 @@
+/** @file
+
+MODULE				: RefPictureH264
+
+TAG						: RPH264
+
+FILE NAME			: RefPictureH264.cpp
+
+DESCRIPTION		: A class to hold a lum reference picture with an extended
+								boundary and its three 1/2 pel interpolated planes as
+								defined by the H.264 standard. The 6-tap filters are 
+								applied to whole rows with SSE2 instructions where 
+								available. The "j" plane is filtered vertically from the
+								unscaled "b" values held in a temp plane.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include <string.h>
+#include "RefPictureH264.h"
+#include "OverlayExtMem2Dv2.h"
+#include "SimdDefs.h"
+
+/// The unscaled "b" and "h" values lie in [-2550..10710] and fit in 16 bits. Only the 
+/// "j" filter is widened to 32 bits.
+
+/// Pels around the extended boundary edge where the 6-tap filters are not applied.
+#define RPH264_FILTER_MARGIN	3
+
+/*
+---------------------------------------------------------------------------
+	Local helpers.
+---------------------------------------------------------------------------
+*/
+#define RPH264_CLIP255(x)	( (((x) <= 255)&&((x) >= 0))? (x) : ( ((x) < 0)? 0:255 ) )
+
+/// The two plane samples averaged for each 1/4 pel position indexed by (xFrac | (yFrac << 2)). 
+/// Each sample is {plane, col offset, row offset}.
+static const int RPH264_QuarterSamples[16][2][3] =
+{
+	{ {RefPictureH264::FULL_PEL, 0, 0},	{RefPictureH264::FULL_PEL, 0, 0} },	///< G.
+	{ {RefPictureH264::FULL_PEL, 0, 0},	{RefPictureH264::HALF_H, 0, 0} },		///< a.
+	{ {RefPictureH264::HALF_H, 0, 0},		{RefPictureH264::HALF_H, 0, 0} },		///< b.
+	{ {RefPictureH264::FULL_PEL, 1, 0},	{RefPictureH264::HALF_H, 0, 0} },		///< c.
+	{ {RefPictureH264::FULL_PEL, 0, 0},	{RefPictureH264::HALF_V, 0, 0} },		///< d.
+	{ {RefPictureH264::HALF_H, 0, 0},		{RefPictureH264::HALF_V, 0, 0} },		///< e.
+	{ {RefPictureH264::HALF_H, 0, 0},		{RefPictureH264::HALF_HV, 0, 0} },	///< f.
+	{ {RefPictureH264::HALF_H, 0, 0},		{RefPictureH264::HALF_V, 1, 0} },		///< g.
+	{ {RefPictureH264::HALF_V, 0, 0},		{RefPictureH264::HALF_V, 0, 0} },		///< h.
+	{ {RefPictureH264::HALF_V, 0, 0},		{RefPictureH264::HALF_HV, 0, 0} },	///< i.
+	{ {RefPictureH264::HALF_HV, 0, 0},	{RefPictureH264::HALF_HV, 0, 0} },	///< j.
+	{ {RefPictureH264::HALF_V, 1, 0},		{RefPictureH264::HALF_HV, 0, 0} },	///< k.
+	{ {RefPictureH264::FULL_PEL, 0, 1},	{RefPictureH264::HALF_V, 0, 0} },		///< n.
+	{ {RefPictureH264::HALF_V, 0, 0},		{RefPictureH264::HALF_H, 0, 1} },		///< p.
+	{ {RefPictureH264::HALF_H, 0, 1},		{RefPictureH264::HALF_HV, 0, 0} },	///< q.
+	{ {RefPictureH264::HALF_V, 1, 0},		{RefPictureH264::HALF_H, 0, 1} }		///< r.
+};
+
+/// Horizontal 6-tap filter of a row into unscaled and scaled "b" values.
+static void RPH264_HorizRow(const short* g, short* tmp, short* b, int len)
+{
+	int i = 0;
+#ifdef RTVC_SIMD
+	__m128i c16		= _mm_set1_epi16(16);
+	__m128i zero	= _mm_setzero_si128();
+	__m128i max		= _mm_set1_epi16(255);
+	for(; (i + 8) <= len; i += 8)
+	{
+		__m128i s05 = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(&g[i-2])), _mm_loadu_si128((const __m128i *)(&g[i+3])));
+		__m128i s14 = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(&g[i-1])), _mm_loadu_si128((const __m128i *)(&g[i+2])));
+		__m128i s23 = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(&g[i])), _mm_loadu_si128((const __m128i *)(&g[i+1])));
+		/// s05 - 5*s14 + 20*s23.
+		__m128i t = _mm_add_epi16(s05, _mm_sub_epi16(_mm_add_epi16(_mm_slli_epi16(s23, 4), _mm_slli_epi16(s23, 2)),
+																								 _mm_add_epi16(_mm_slli_epi16(s14, 2), s14)));
+		_mm_storeu_si128((__m128i *)(&tmp[i]), t);
+		t = _mm_srai_epi16(_mm_add_epi16(t, c16), 5);
+		_mm_storeu_si128((__m128i *)(&b[i]), _mm_min_epi16(_mm_max_epi16(t, zero), max));
+	}//end for i...
+#endif
+	for(; i < len; i++)
+	{
+		int t = (int)g[i-2] - 5*(int)g[i-1] + 20*(int)g[i] + 20*(int)g[i+1] - 5*(int)g[i+2] + (int)g[i+3];
+		tmp[i]	= (short)t;
+		t				= (t + 16) >> 5;
+		b[i]		= (short)RPH264_CLIP255(t);
+	}//end for i...
+}//end RPH264_HorizRow.
+
+/// Vertical 6-tap filter of 6 full pel rows into "h" values.
+static void RPH264_VertRow(const short** g, short* h, int len)
+{
+	int i = 0;
+#ifdef RTVC_SIMD
+	__m128i c16		= _mm_set1_epi16(16);
+	__m128i zero	= _mm_setzero_si128();
+	__m128i max		= _mm_set1_epi16(255);
+	for(; (i + 8) <= len; i += 8)
+	{
+		__m128i s05 = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(&g[0][i])), _mm_loadu_si128((const __m128i *)(&g[5][i])));
+		__m128i s14 = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(&g[1][i])), _mm_loadu_si128((const __m128i *)(&g[4][i])));
+		__m128i s23 = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(&g[2][i])), _mm_loadu_si128((const __m128i *)(&g[3][i])));
+		__m128i t = _mm_add_epi16(s05, _mm_sub_epi16(_mm_add_epi16(_mm_slli_epi16(s23, 4), _mm_slli_epi16(s23, 2)),
+																								 _mm_add_epi16(_mm_slli_epi16(s14, 2), s14)));
+		t = _mm_srai_epi16(_mm_add_epi16(t, c16), 5);
+		_mm_storeu_si128((__m128i *)(&h[i]), _mm_min_epi16(_mm_max_epi16(t, zero), max));
+	}//end for i...
+#endif
+	for(; i < len; i++)
+	{
+		int t = (int)g[0][i] - 5*(int)g[1][i] + 20*(int)g[2][i] + 20*(int)g[3][i] - 5*(int)g[4][i] + (int)g[5][i];
+		t			= (t + 16) >> 5;
+		h[i]	= (short)RPH264_CLIP255(t);
+	}//end for i...
+}//end RPH264_VertRow.
+
+/// Vertical 6-tap filter of 6 unscaled "b" rows into "j" values with 32 bit sums.
+static void RPH264_VertRow32(const short** tmp, short* j, int len)
+{
+	int i = 0;
+#ifdef RTVC_SIMD
+	__m128i c512	= _mm_set1_epi32(512);
+	__m128i k1		= _mm_set1_epi16(1);
+	__m128i k5		= _mm_set1_epi16(-5);
+	__m128i k20		= _mm_set1_epi16(20);
+	__m128i zero	= _mm_setzero_si128();
+	__m128i max		= _mm_set1_epi16(255);
+	for(; (i + 8) <= len; i += 8)
+	{
+		__m128i t0 = _mm_loadu_si128((const __m128i *)(&tmp[0][i]));
+		__m128i t1 = _mm_loadu_si128((const __m128i *)(&tmp[1][i]));
+		__m128i t2 = _mm_loadu_si128((const __m128i *)(&tmp[2][i]));
+		__m128i t3 = _mm_loadu_si128((const __m128i *)(&tmp[3][i]));
+		__m128i t4 = _mm_loadu_si128((const __m128i *)(&tmp[4][i]));
+		__m128i t5 = _mm_loadu_si128((const __m128i *)(&tmp[5][i]));
+		/// Pairs of taps with equal coeffs are multiplied and summed into 32 bits.
+		__m128i lo = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(t0, t5), k1),
+																						 _mm_madd_epi16(_mm_unpacklo_epi16(t1, t4), k5)),
+																						 _mm_madd_epi16(_mm_unpacklo_epi16(t2, t3), k20));
+		__m128i hi = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(t0, t5), k1),
+																						 _mm_madd_epi16(_mm_unpackhi_epi16(t1, t4), k5)),
+																						 _mm_madd_epi16(_mm_unpackhi_epi16(t2, t3), k20));
+		lo = _mm_srai_epi32(_mm_add_epi32(lo, c512), 10);
+		hi = _mm_srai_epi32(_mm_add_epi32(hi, c512), 10);
+		_mm_storeu_si128((__m128i *)(&j[i]), _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(lo, hi), zero), max));
+	}//end for i...
+#endif
+	for(; i < len; i++)
+	{
+		int t = (int)tmp[0][i] - 5*(int)tmp[1][i] + 20*(int)tmp[2][i] + 20*(int)tmp[3][i] - 5*(int)tmp[4][i] + (int)tmp[5][i];
+		t			= (t + 512) >> 10;
+		j[i]	= (short)RPH264_CLIP255(t);
+	}//end for i...
+}//end RPH264_VertRow32.
+
+/*
+---------------------------------------------------------------------------
+	Construction.
+---------------------------------------------------------------------------
+*/
+RefPictureH264::RefPictureH264(void)
+{
+	ResetMembers();
+}//end constructor.
+
+RefPictureH264::~RefPictureH264(void)
+{
+	Destroy();
+}//end destructor.
+
+void RefPictureH264::ResetMembers(void)
+{
+	_width			= 0;
+	_height			= 0;
+	_boundary		= 0;
+	_extWidth		= 0;
+	_extHeight	= 0;
+	_loaded			= 0;
+	_pMem				= NULL;
+	_pRowMem		= NULL;
+	for(int p = 0; p <= PLANES; p++)
+		_pPlaneRows[p] = NULL;
+}//end ResetMembers.
+
+/*
+---------------------------------------------------------------------------
+	Interface Methods.
+---------------------------------------------------------------------------
+*/
+/** Create the plane mem.
+All planes and a temp plane for the unscaled "b" values are held in one mem block.
+@param width		: Lum picture width.
+@param height		: Lum picture height.
+@param boundary	: Extended boundary on all sides in full pel units.
+@return					: 1 = success, 0 = failure.
+*/
+int RefPictureH264::Create(int width, int height, int boundary)
+{
+	Destroy();
+
+	_width			= width;
+	_height			= height;
+	_boundary		= boundary;
+	_extWidth		= width + 2*boundary;
+	_extHeight	= height + 2*boundary;
+
+	int planeSize = _extWidth * _extHeight;
+	_pMem			= new short[(PLANES + 1) * planeSize];
+	_pRowMem	= new short*[(PLANES + 1) * _extHeight];
+	if( (_pMem == NULL)||(_pRowMem == NULL) )
+	{
+		Destroy();
+		return(0);
+	}//end if !_pMem...
+	memset((void *)_pMem, 0, (PLANES + 1) * planeSize * sizeof(short));
+
+	for(int p = 0; p <= PLANES; p++)
+	{
+		short** pRows = &(_pRowMem[p * _extHeight]);
+		for(int row = 0; row < _extHeight; row++)
+			pRows[row] = &(_pMem[(p * planeSize) + (row * _extWidth) + boundary]);
+		_pPlaneRows[p] = &(pRows[boundary]);
+	}//end for p...
+
+	return(1);
+}//end Create.
+
+void RefPictureH264::Destroy(void)
+{
+	if(_pRowMem != NULL)
+		delete[] _pRowMem;
+	if(_pMem != NULL)
+		delete[] _pMem;
+	ResetMembers();
+}//end Destroy.
+
+/** Load a reference picture and build the 1/2 pel planes.
+The picture is copied into the centre of the full pel plane and its boundary is
+filled. The 1/2 pel planes are filtered everywhere except for a margin at the 
+outer edge of the boundary.
+@param pRef	: Lum picture of width x height.
+@return			: none.
+*/
+void RefPictureH264::Load(const short* pRef)
+{
+	int row;
+	short** g		= _pPlaneRows[FULL_PEL];
+	short** b		= _pPlaneRows[HALF_H];
+	short** h		= _pPlaneRows[HALF_V];
+	short** j		= _pPlaneRows[HALF_HV];
+	short** tmp	= _pPlaneRows[PLANES];
+
+	for(row = 0; row < _height; row++)
+		memcpy((void *)g[row], (const void *)(&(pRef[row * _width])), _width * sizeof(short));
+	OverlayExtMem2Dv2::FillBoundary((void *)_pMem, _extWidth, _extHeight, _boundary, _boundary);
+
+	int first = RPH264_FILTER_MARGIN - _boundary;							///< First filtered row/col.
+	int len		= _extWidth - 2*RPH264_FILTER_MARGIN;						///< Filtered cols.
+
+	/// "b" on every row.
+	for(row = -_boundary; row < (_height + _boundary); row++)
+		RPH264_HorizRow(&(g[row][first]), &(tmp[row][first]), &(b[row][first]), len);
+
+	/// "h" and "j" on the rows with 6 rows available for the filters.
+	for(row = first; row < (_height + _boundary - RPH264_FILTER_MARGIN); row++)
+	{
+		const short* gRows[6]		= { &(g[row-2][-_boundary]), &(g[row-1][-_boundary]), &(g[row][-_boundary]), 
+																&(g[row+1][-_boundary]), &(g[row+2][-_boundary]), &(g[row+3][-_boundary]) };
+		const short* tmpRows[6] = { &(tmp[row-2][first]), &(tmp[row-1][first]), &(tmp[row][first]), 
+																&(tmp[row+1][first]), &(tmp[row+2][first]), &(tmp[row+3][first]) };
+		RPH264_VertRow(gRows, &(h[row][-_boundary]), _extWidth);
+		RPH264_VertRow32(tmpRows, &(j[row][first]), len);
+	}//end for row...
+
+	_loaded = 1;
+}//end Load.
+
+/** Read a block at a 1/4 pel location.
+Negative 1/4 pel offsets are reflected to full pel locations to the left or above
+in the same way as OverlayMem2Dv2::QuarterRead(). All plane values are equal along
+a row (col) more than 3 pels outside of the picture and the location is clamped to the
+filtered area of the planes without changing the values read.
+@param dstBlock	: Destination block and its dimensions.
+@param x				: Full pel col of the block.
+@param y				: Full pel row of the block.
+@param qx				: 1/4 pel col offset in the range [-3..3].
+@param qy				: 1/4 pel row offset in the range [-3..3].
+@return					: none.
+*/
+void RefPictureH264::QuarterRead(OverlayMem2Dv2* dstBlock, int x, int y, int qx, int qy)
+{
+	int width		= dstBlock->GetWidth();
+	int height	= dstBlock->GetHeight();
+
+	if(qx < 0)
+	{
+		x--;
+		qx += 4;
+	}//end if qx...
+	if(qy < 0)
+	{
+		y--;
+		qy += 4;
+	}//end if qy...
+
+	int lim = _boundary - RPH264_FILTER_MARGIN - 1;
+	if(x < -lim)
+		x = -lim;
+	else if(x > (_width + lim - width - 1))
+		x = _width + lim - width - 1;
+	if(y < -lim)
+		y = -lim;
+	else if(y > (_height + lim - height - 1))
+		y = _height + lim - height - 1;
+
+	const int (*s)[3] = RPH264_QuarterSamples[(qx & 3) | ((qy & 3) << 2)];
+	short** pA	= _pPlaneRows[s[0][0]];
+	short** pB	= _pPlaneRows[s[1][0]];
+	int xA			= x + s[0][1];
+	int yA			= y + s[0][2];
+	int xB			= x + s[1][1];
+	int yB			= y + s[1][2];
+
+	short**	dst		= dstBlock->Get2DSrcPtr();
+	int			dstX	= dstBlock->GetOriginX();
+	int			dstY	= dstBlock->GetOriginY();
+	for(int row = 0; row < height; row++)
+	{
+		const short*	a = &(pA[yA + row][xA]);
+		const short*	b = &(pB[yB + row][xB]);
+		short*				d = &(dst[dstY + row][dstX]);
+		int col = 0;
+#ifdef RTVC_SIMD
+		/// All plane values are in [0..255] and the unsigned average is the rounded average.
+		for(; (col + 8) <= width; col += 8)
+			_mm_storeu_si128((__m128i *)(&d[col]), _mm_avg_epu16(_mm_loadu_si128((const __m128i *)(&a[col])), 
+																														_mm_loadu_si128((const __m128i *)(&b[col]))));
+#endif
+		for(; col < width; col++)
+			d[col] = (short)(((int)a[col] + (int)b[col] + 1) >> 1);
+	}//end for row...
+
+}//end QuarterRead.
+
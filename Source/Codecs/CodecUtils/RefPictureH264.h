@@ -0,0 +1,119 @@
+/** @file
+
+MODULE				: RefPictureH264
+
+TAG						: RPH264
+
+FILE NAME			: RefPictureH264.h
+
+DESCRIPTION		: A class to hold a lum reference picture with an extended
+								boundary and its three 1/2 pel interpolated planes as
+								defined by the H.264 standard. The planes are built once
+								per reference picture and any 1/4 pel position is then
+								the rounded average of two plane values. Motion estimators
+								and compensators may share the same object.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifndef _REFPICTUREH264_H
+#define _REFPICTUREH264_H
+
+#pragma once
+
+#include "OverlayMem2Dv2.h"
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class RefPictureH264
+{
+	public:
+		RefPictureH264(void);
+		virtual ~RefPictureH264(void);
+
+		/// Plane indices.
+		static const int FULL_PEL	= 0;	///< "G" full pel values.
+		static const int HALF_H		= 1;	///< "b" 1/2 pel values to the right of G.
+		static const int HALF_V		= 2;	///< "h" 1/2 pel values below G.
+		static const int HALF_HV	= 3;	///< "j" 1/2 pel values to the right of h.
+		static const int PLANES		= 4;
+
+	/// Interface.
+	public:
+		/** Create the plane mem.
+		@param width		: Lum picture width.
+		@param height		: Lum picture height.
+		@param boundary	: Extended boundary on all sides in full pel units.
+		@return					: 1 = success, 0 = failure.
+		*/
+		int		Create(int width, int height, int boundary);
+		void	Destroy(void);
+
+		/** Load a reference picture and build the 1/2 pel planes.
+		@param pRef	: Lum picture of width x height.
+		@return			: none.
+		*/
+		void	Load(const short* pRef);
+
+		/// The planes are only valid for the picture that was last loaded.
+		int		IsCreated(void)		{ return(_pMem != NULL); }
+		int		IsLoaded(void)		{ return(_loaded); }
+		void	Invalidate(void)	{ _loaded = 0; }
+
+		/** Get a plane.
+		@param plane	: Plane index.
+		@return				: Row addresses offset by the boundary such that [0][0] is the top left picture pel.
+		*/
+		short**	GetPlane(int plane)	{ return(_pPlaneRows[plane]); }
+		int			GetBoundary(void)		{ return(_boundary); }
+
+		/** Read a block at a 1/4 pel location.
+		Bit exact with OverlayMem2Dv2::QuarterRead() on a reference with any extended boundary
+		for block dimensions of up to (boundary - 7). Locations further out are clamped onto 
+		the boundary where the plane values repeat.
+		@param dstBlock	: Destination block and its dimensions.
+		@param x				: Full pel col of the block.
+		@param y				: Full pel row of the block.
+		@param qx				: 1/4 pel col offset in the range [-3..3].
+		@param qy				: 1/4 pel row offset in the range [-3..3].
+		@return					: none.
+		*/
+		void	QuarterRead(OverlayMem2Dv2* dstBlock, int x, int y, int qx, int qy);
+
+	protected:
+		void	ResetMembers(void);
+
+	protected:
+		int			_width;				///< Picture dimensions.
+		int			_height;
+		int			_boundary;		///< Extended boundary on all sides.
+		int			_extWidth;		///< Plane dimensions.
+		int			_extHeight;
+		int			_loaded;			///< Planes hold the last loaded picture.
+
+		short*	_pMem;													///< All planes and the temp plane in one block.
+		short**	_pPlaneRows[PLANES + 1];				///< Row addresses at the picture origin of each plane.
+		short**	_pRowMem;												///< Row address mem for all planes.
+};// end class RefPictureH264.
+
+#endif	//_REFPICTUREH264_H
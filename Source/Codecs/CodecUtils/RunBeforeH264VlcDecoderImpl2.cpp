@@ -0,0 +1,109 @@
+/** @file
+
+MODULE				: RunBeforeH264VlcDecoderImpl2
+
+TAG						: RBH264VDI2
+
+FILE NAME			: RunBeforeH264VlcDecoderImpl2.cpp
+
+DESCRIPTION		: A run before Vlc decoder implementation as defined in
+								H.264 Recommendation (03/2005) Table 9.10 page 202 that
+								resolves the run before with table lookups instead of a
+								code tree. The tables are built from the 
+								RunBeforeH264VlcEncoder tables and decode identically to
+								RunBeforeH264VlcDecoder. This implementation is 
+								implemented with an IVlcDecoder Interface.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include "RunBeforeH264VlcDecoderImpl2.h"
+#include "RunBeforeH264VlcEncoder.h"
+
+/*
+---------------------------------------------------------------------------
+	Construction and destruction.
+---------------------------------------------------------------------------
+*/
+RunBeforeH264VlcDecoderImpl2::RunBeforeH264VlcDecoderImpl2(void)
+{
+	_numCodeBits	= 0;
+
+	/// Build the tables from the encoder code words.
+	RunBeforeH264VlcEncoder enc;
+	int numBits[15];
+	int codeWord[15];
+	int symbol[15];
+
+	for(int zerosLeft = 1; zerosLeft < 8; zerosLeft++)
+	{
+		for(int runBefore = 0; runBefore < 15; runBefore++)
+		{
+			numBits[runBefore]	= enc.Encode2(runBefore, zerosLeft);
+			codeWord[runBefore]	= enc.GetCode();
+			symbol[runBefore]		= runBefore;
+		}//end for runBefore...
+		_table[zerosLeft].Create(numBits, codeWord, symbol, 15, 8);
+	}//end for zerosLeft...
+}//end constructor.
+
+RunBeforeH264VlcDecoderImpl2::~RunBeforeH264VlcDecoderImpl2(void)
+{
+}//end destructor.
+
+/*
+---------------------------------------------------------------------------
+	Interface Methods.
+---------------------------------------------------------------------------
+*/
+/** Decode run before - zeros left symbols from the bit stream.
+The first 2 param symbols represent run before and zeros left, respectively. The 
+zeros left is an input that selects the appropriate lookup table for the run before
+decoding.
+@param bsr			: Bit stream to get from.
+@param symbol1	: Returned run before for this coeff.
+@param symbol2	: Zeros left for this block.
+@return					: Num of bits extracted.
+*/
+int	RunBeforeH264VlcDecoderImpl2::Decode2(IBitStreamReader* bsr, int* symbol1, int* symbol2)
+{
+	int zerosLeft	= *symbol2;	///< Used as an input.
+	int rB				= 0;
+
+	/// Select the table depending on the zeros left.
+	if(zerosLeft > 6)	///< Use the last table for all greater than 6.
+		zerosLeft = 7;
+	else if(zerosLeft < 1)	///< Invalid input.
+		zerosLeft = 0;
+	_numCodeBits = _table[zerosLeft].Decode(bsr, &rB);
+
+	/// Load 'em up.
+	*symbol1 = rB;
+
+  return(_numCodeBits);
+}//end Decode2.
+
@@ -0,0 +1,165 @@
+/** @file
+
+MODULE				: ThreadPool
+
+TAG						: TP
+
+FILE NAME			: ThreadPool.cpp
+
+DESCRIPTION		: A fixed size pool of worker threads that runs a set of
+								independent indexed tasks and blocks until they are all
+								complete. Without USE_MULTI_THREADED defined the tasks
+								are run serially in the calling thread.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include "ThreadPool.h"
+
+#ifdef USE_MULTI_THREADED
+#include <boost/bind.hpp>
+#endif
+
+/*
+--------------------------------------------------------------------------
+  Construction.
+--------------------------------------------------------------------------
+*/
+ThreadPool::ThreadPool(void)
+{
+	_numThreads		= 1;
+#ifdef USE_MULTI_THREADED
+	_pIoService		= NULL;
+	_pWork				= NULL;
+	_tasksPending	= 0;
+#endif
+}//end constructor.
+
+ThreadPool::~ThreadPool(void)
+{
+	Destroy();
+}//end destructor.
+
+/*
+--------------------------------------------------------------------------
+  Interface.
+--------------------------------------------------------------------------
+*/
+int ThreadPool::Create(int numThreads)
+{
+	/// Clean up first.
+	Destroy();
+
+	if(numThreads < 1)
+		numThreads = 1;
+
+#ifdef USE_MULTI_THREADED
+	if(numThreads > 1)
+	{
+		_pIoService = new boost::asio::io_service();
+		if(_pIoService == NULL)
+			return(0);
+		/// Keep the io service running between calls to Run().
+		_pWork = new boost::asio::io_service::work(*_pIoService);
+		if(_pWork == NULL)
+		{
+			Destroy();
+			return(0);
+		}//end if !_pWork...
+
+		for(int i = 0; i < numThreads; i++)
+			_threads.create_thread(boost::bind(&boost::asio::io_service::run, _pIoService));
+	}//end if numThreads...
+	_numThreads = numThreads;
+#else
+	_numThreads = 1;	///< Serial execution only.
+#endif
+
+	return(1);
+}//end Create.
+
+void ThreadPool::Destroy(void)
+{
+#ifdef USE_MULTI_THREADED
+	if(_pIoService != NULL)
+	{
+		if(_pWork != NULL)
+			delete _pWork;
+		_pWork = NULL;
+		_pIoService->stop();
+		_threads.join_all();
+		delete _pIoService;
+	}//end if _pIoService...
+	_pIoService		= NULL;
+	_tasksPending	= 0;
+#endif
+	_numThreads = 1;
+}//end Destroy.
+
+void ThreadPool::Run(TaskFunction task, void* pParam, int numTasks)
+{
+	int i;
+
+	/// Nothing to gain from the pool for single tasks or a single thread.
+	if( (numTasks < 2)||(_numThreads < 2) )
+	{
+		for(i = 0; i < numTasks; i++)
+			task(pParam, i);
+		return;
+	}//end if numTasks...
+
+#ifdef USE_MULTI_THREADED
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		_tasksPending = numTasks;
+	}
+	for(i = 0; i < numTasks; i++)
+		_pIoService->post(boost::bind(&ThreadPool::DoTask, this, task, pParam, i));
+
+	/// Wait for all the posted tasks to complete.
+	boost::mutex::scoped_lock lock(_mutex);
+	while(_tasksPending > 0)
+		_condvar.wait(lock);
+#endif
+}//end Run.
+
+/*
+--------------------------------------------------------------------------
+  Protected methods.
+--------------------------------------------------------------------------
+*/
+void ThreadPool::DoTask(TaskFunction task, void* pParam, int index)
+{
+	task(pParam, index);
+
+#ifdef USE_MULTI_THREADED
+	boost::mutex::scoped_lock lock(_mutex);
+	_tasksPending--;
+	if(_tasksPending == 0)
+		_condvar.notify_one();
+#endif
+}//end DoTask.
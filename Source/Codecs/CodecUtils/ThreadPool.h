@@ -0,0 +1,101 @@
+/** @file
+
+MODULE				: ThreadPool
+
+TAG						: TP
+
+FILE NAME			: ThreadPool.h
+
+DESCRIPTION		: A fixed size pool of worker threads that runs a set of
+								independent indexed tasks and blocks until they are all
+								complete. Without USE_MULTI_THREADED defined the tasks
+								are run serially in the calling thread.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+#ifndef _THREADPOOL_H
+#define _THREADPOOL_H
+
+#ifdef USE_MULTI_THREADED
+#ifdef _WINDOWS
+#include <Winsock2.h>
+#endif
+#include <boost/asio/io_service.hpp>
+#include <boost/thread.hpp>
+#endif
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class ThreadPool
+{
+	public:
+		/// Task signature. The param is passed through from Run() and the
+		/// index identifies the task in the range [0..numTasks-1].
+		typedef void (*TaskFunction)(void* pParam, int index);
+
+	// Construction.
+	public:
+		ThreadPool(void);
+		virtual ~ThreadPool(void);
+
+	// Interface.
+	public:
+		/** Create the worker threads.
+		@param numThreads	: Num of threads. Values < 2 imply serial execution.
+		@return						: 1 = success, 0 = failure.
+		*/
+		int		Create(int numThreads);
+		void	Destroy(void);
+
+		/** Run a set of tasks.
+		Each task index in [0..numTasks-1] is run once and the call blocks
+		until all of them have completed. Tasks must be independent of each
+		other. The method is not re-entrant and must only be called from one
+		thread at a time.
+		@param task			: Function to call for each index.
+		@param pParam		: Passed through to the task.
+		@param numTasks	: Num of task indices.
+		@return					: none.
+		*/
+		void	Run(TaskFunction task, void* pParam, int numTasks);
+
+		int		GetNumThreads(void) { return(_numThreads); }
+
+	protected:
+		void	DoTask(TaskFunction task, void* pParam, int index);
+
+		int		_numThreads;
+
+#ifdef USE_MULTI_THREADED
+		boost::asio::io_service*				_pIoService;
+		boost::asio::io_service::work*	_pWork;
+		boost::thread_group							_threads;
+
+		int															_tasksPending;
+		boost::condition_variable				_condvar;
+		boost::mutex										_mutex;
+#endif
+
+};//end ThreadPool.
+
+#endif	// _THREADPOOL_H
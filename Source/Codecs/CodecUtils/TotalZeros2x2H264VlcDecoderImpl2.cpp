@@ -0,0 +1,106 @@
+/** @file
+
+MODULE				: TotalZeros2x2H264VlcDecoderImpl2
+
+TAG						: TZ2H264VDI2
+
+FILE NAME			: TotalZeros2x2H264VlcDecoderImpl2.cpp
+
+DESCRIPTION		: A total zeros Vlc decoder implementation as defined in
+								H.264 Recommendation (03/2005) Table 9.9a page 202 for 2x2
+								chroma DC blocks that resolves the total zeros with table
+								lookups instead of a code tree. The tables are built from
+								the TotalZeros2x2H264VlcEncoder tables and decode 
+								identically to TotalZeros2x2H264VlcDecoder. This 
+								implementation is implemented with an IVlcDecoder Interface.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include "TotalZeros2x2H264VlcDecoderImpl2.h"
+#include "TotalZeros2x2H264VlcEncoder.h"
+
+/*
+---------------------------------------------------------------------------
+	Construction and destruction.
+---------------------------------------------------------------------------
+*/
+TotalZeros2x2H264VlcDecoderImpl2::TotalZeros2x2H264VlcDecoderImpl2(void)
+{
+	_numCodeBits	= 0;
+
+	/// Build the tables from the encoder code words.
+	TotalZeros2x2H264VlcEncoder enc;
+	int numBits[4];
+	int codeWord[4];
+	int symbol[4];
+
+	for(int totalCoeffs = 1; totalCoeffs < 4; totalCoeffs++)
+	{
+		for(int totalZeros = 0; totalZeros < 4; totalZeros++)
+		{
+			numBits[totalZeros]	= enc.Encode2(totalZeros, totalCoeffs);
+			codeWord[totalZeros]	= enc.GetCode();
+			symbol[totalZeros]		= totalZeros;
+		}//end for totalZeros...
+		_table[totalCoeffs].Create(numBits, codeWord, symbol, 4, 3);
+	}//end for totalCoeffs...
+}//end constructor.
+
+TotalZeros2x2H264VlcDecoderImpl2::~TotalZeros2x2H264VlcDecoderImpl2(void)
+{
+}//end destructor.
+
+/*
+---------------------------------------------------------------------------
+	Interface Methods.
+---------------------------------------------------------------------------
+*/
+/** Decode total zeros - total coeffs symbols from the bit stream.
+The first 2 param symbols represent total zeros and total coeffs. The total coeffs is an 
+input that selects the appropriate lookup table for the total zero decoding.
+@param bsr			: Bit stream to get from.
+@param symbol1	: Returned total zeros for this block
+@param symbol2	: Total num of coeffs in this block
+@return					: Num of bits extracted.
+*/
+int	TotalZeros2x2H264VlcDecoderImpl2::Decode2(IBitStreamReader* bsr, int* symbol1, int* symbol2)
+{
+	int totalCoeffs	= *symbol2;	///< Used as an input.
+	int tZ				= 0;
+
+	/// Select the table depending on the total number of coeffs.
+	if( (totalCoeffs < 1)||(totalCoeffs > 3) )	///< Invalid input.
+		totalCoeffs = 0;
+	_numCodeBits = _table[totalCoeffs].Decode(bsr, &tZ);
+
+	/// Load 'em up.
+	*symbol1 = tZ;
+
+  return(_numCodeBits);
+}//end Decode2.
+
@@ -0,0 +1,75 @@
+/** @file
+
+MODULE				: TotalZeros2x2H264VlcDecoderImpl2
+
+TAG						: TZ2H264VDI2
+
+FILE NAME			: TotalZeros2x2H264VlcDecoderImpl2.h
+
+DESCRIPTION		: A total zeros Vlc decoder implementation as defined in
+								H.264 Recommendation (03/2005) Table 9.9a page 202 for 2x2
+								chroma DC blocks that resolves the total zeros with table
+								lookups instead of a code tree. The tables are built from
+								the TotalZeros2x2H264VlcEncoder tables and decode 
+								identically to TotalZeros2x2H264VlcDecoder. This 
+								implementation is implemented with an IVlcDecoder Interface.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifndef _TOTALZEROS2X2H264VLCDECODERIMPL2_H
+#define _TOTALZEROS2X2H264VLCDECODERIMPL2_H
+
+#pragma once
+
+#include "IVlcDecoder.h"
+#include "VlcDecodeTable.h"
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class TotalZeros2x2H264VlcDecoderImpl2 : public IVlcDecoder
+{
+public:
+	TotalZeros2x2H264VlcDecoderImpl2();
+	virtual ~TotalZeros2x2H264VlcDecoderImpl2();
+
+public:
+	/// Interface implementation.
+	int GetNumDecodedBits(void)	{ return(_numCodeBits); }
+	int Marker(void)						{ return(0); }	///< No markers for this decoder.
+	/// A single symbol has no meaning for combined multi symbol encoding.
+	virtual int Decode(IBitStreamReader* bsr) { _numCodeBits = 0; return(0); } 
+
+	/// Optional interface implementation.
+	/// The 2 symbols represent total zeros (output) and total coeffs (input), respectively.
+	virtual int	Decode2(IBitStreamReader* bsr, int* symbol1, int* symbol2);
+
+protected:
+	int _numCodeBits;	///< Number of coded bits for this symbol.
+
+	/// One table per total coeffs [1..3]. Table 0 is empty.
+	VlcDecodeTable	_table[4];
+
+};// end class TotalZeros2x2H264VlcDecoderImpl2.
+
+#endif	// _TOTALZEROS2X2H264VLCDECODERIMPL2_H
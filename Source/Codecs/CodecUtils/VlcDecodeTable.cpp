@@ -0,0 +1,196 @@
+/** @file
+
+MODULE				: VlcDecodeTable
+
+TAG						: VDT
+
+FILE NAME			: VlcDecodeTable.cpp
+
+DESCRIPTION		: A two level lookup table for decoding a prefix (variable
+								length) code. The next bits of the stream are peeked and
+								the symbol and code length are resolved with one lookup
+								into a primary table or, for codes longer than the primary
+								table index, a second lookup into a sub table.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include <string.h>
+
+#include "VlcDecodeTable.h"
+
+VDT_EntryType	VlcDecodeTable::EMPTY_TABLE[1] = { {0, 0, 0} };
+
+/*
+---------------------------------------------------------------------------
+	Construction and destruction.
+---------------------------------------------------------------------------
+*/
+VlcDecodeTable::VlcDecodeTable(void)
+{
+	_pTable				= EMPTY_TABLE;
+	_maxBits			= 0;
+	_primaryShift	= 0;
+}//end constructor.
+
+VlcDecodeTable::~VlcDecodeTable(void)
+{
+	Destroy();
+}//end destructor.
+
+/*
+---------------------------------------------------------------------------
+	Interface Methods.
+---------------------------------------------------------------------------
+*/
+/** Build the table from a list of codes.
+The codes must form a prefix code. Each primary table entry that is the prefix
+of longer codes points to a sub table that is indexed by as many following bits
+as the longest of those codes requires. Every index that starts with a code is
+filled with that code's entry and all remaining entries are not recognised.
+@param pNumBits			: [numCodes] Code lengths [1..16]. Zero length entries are ignored.
+@param pCodeWord		: [numCodes] Code words right aligned.
+@param pSymbol			: [numCodes] Symbols [0..65535].
+@param numCodes			: Length of the lists.
+@param primaryBits	: Bits in the primary table index [1..16].
+@return							: 1 = success, 0 = failure.
+*/
+int VlcDecodeTable::Create(const int* pNumBits, const int* pCodeWord, const int* pSymbol, int numCodes, int primaryBits)
+{
+	int i, j;
+
+	/// Clean up first.
+	Destroy();
+
+	int maxBits = 0;
+	for(i = 0; i < numCodes; i++)
+	{
+		if( (pNumBits[i] < 0)||(pNumBits[i] > 16) )
+			return(0);
+		if(pNumBits[i] > maxBits)
+			maxBits = pNumBits[i];
+	}//end for i...
+	if( (maxBits == 0)||(primaryBits < 1) )
+		return(0);
+	if(primaryBits > maxBits)
+		primaryBits = maxBits;
+	int primaryLen = 1 << primaryBits;
+
+	/// Size the sub tables from the longest code under each primary entry.
+	int* pSubBits = new int[primaryLen];
+	if(pSubBits == NULL)
+		return(0);
+	memset((void *)pSubBits, 0, primaryLen * sizeof(int));
+	for(i = 0; i < numCodes; i++)
+	{
+		int extraBits = pNumBits[i] - primaryBits;
+		if(extraBits > 0)
+		{
+			int p = pCodeWord[i] >> extraBits;
+			if(extraBits > pSubBits[p])
+				pSubBits[p] = extraBits;
+		}//end if extraBits...
+	}//end for i...
+	int tableLen = primaryLen;
+	for(i = 0; i < primaryLen; i++)
+	{
+		if(pSubBits[i])
+			tableLen += (1 << pSubBits[i]);
+	}//end for i...
+	if(tableLen > 65536)	///< Sub table offsets must fit the entry value.
+	{
+		delete[] pSubBits;
+		return(0);
+	}//end if tableLen...
+
+	_pTable = new VDT_EntryType[tableLen];
+	if(_pTable == NULL)
+	{
+		_pTable = EMPTY_TABLE;
+		delete[] pSubBits;
+		return(0);
+	}//end if !_pTable...
+	memset((void *)_pTable, 0, tableLen * sizeof(VDT_EntryType));
+
+	/// Link the sub tables.
+	int offset = primaryLen;
+	for(i = 0; i < primaryLen; i++)
+	{
+		if(pSubBits[i])
+		{
+			_pTable[i].subBits	= (unsigned char)pSubBits[i];
+			_pTable[i].value		= (unsigned short)offset;
+			offset += (1 << pSubBits[i]);
+		}//end if pSubBits...
+	}//end for i...
+	delete[] pSubBits;
+
+	/// Fill the entries of every index that starts with each code.
+	for(i = 0; i < numCodes; i++)
+	{
+		int numBits = pNumBits[i];
+		if(numBits == 0)
+			continue;
+
+		VDT_EntryType* pT;
+		int unusedBits;
+		int extraBits = numBits - primaryBits;
+		if(extraBits > 0)
+		{
+			VDT_EntryType* pP = &(_pTable[pCodeWord[i] >> extraBits]);
+			unusedBits	= pP->subBits - extraBits;
+			pT					= &(_pTable[pP->value + ((pCodeWord[i] & ((1 << extraBits) - 1)) << unusedBits)]);
+		}//end if extraBits...
+		else
+		{
+			unusedBits	= -extraBits;
+			pT					= &(_pTable[pCodeWord[i] << unusedBits]);
+		}//end else...
+
+		for(j = 0; j < (1 << unusedBits); j++)
+		{
+			pT[j].numBits	= (unsigned char)numBits;
+			pT[j].subBits	= 0;
+			pT[j].value		= (unsigned short)pSymbol[i];
+		}//end for j...
+	}//end for i...
+
+	_maxBits			= maxBits;
+	_primaryShift	= maxBits - primaryBits;
+
+	return(1);
+}//end Create.
+
+void VlcDecodeTable::Destroy(void)
+{
+	if(_pTable != EMPTY_TABLE)
+		delete[] _pTable;
+	_pTable				= EMPTY_TABLE;
+	_maxBits			= 0;
+	_primaryShift	= 0;
+}//end Destroy.
+
@@ -0,0 +1,119 @@
+/** @file
+
+MODULE				: VlcDecodeTable
+
+TAG						: VDT
+
+FILE NAME			: VlcDecodeTable.h
+
+DESCRIPTION		: A two level lookup table for decoding a prefix (variable
+								length) code. The next bits of the stream are peeked and
+								the symbol and code length are resolved with one lookup
+								into a primary table or, for codes longer than the primary
+								table index, a second lookup into a sub table. The bit
+								stream reader must allow peeking the longest code length
+								past the end of the stream (e.g. FastBitStreamReaderMSB).
+								Basic operation:
+									VlcDecodeTable* pT = new VlcDecodeTable();
+									pT->Create(pNumBits, pCodeWord, pSymbol, numCodes, 8);
+									numBits = pT->Decode(bsr, &symbol);
+									.
+									.
+									delete pT;
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifndef _VLCDECODETABLE_H
+#define _VLCDECODETABLE_H
+
+#pragma once
+
+#include "IBitStreamReader.h"
+
+/*
+---------------------------------------------------------------------------
+	Type definitions.
+---------------------------------------------------------------------------
+*/
+/// A leaf entry has subBits = 0 and holds the symbol with its code length where
+/// numBits = 0 marks a code that is not recognised. A sub table entry has subBits
+/// > 0 and value is the table offset of its 2^subBits entries.
+typedef struct _VDT_EntryType
+{
+	unsigned char		numBits;
+	unsigned char		subBits;
+	unsigned short	value;
+} VDT_EntryType;
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class VlcDecodeTable
+{
+public:
+	VlcDecodeTable();
+	virtual ~VlcDecodeTable();
+
+public:
+	/** Build the table from a list of codes.
+	@param pNumBits			: [numCodes] Code lengths [1..16]. Zero length entries are ignored.
+	@param pCodeWord		: [numCodes] Code words right aligned.
+	@param pSymbol			: [numCodes] Symbols [0..65535].
+	@param numCodes			: Length of the lists.
+	@param primaryBits	: Bits in the primary table index [1..16].
+	@return							: 1 = success, 0 = failure.
+	*/
+	int		Create(const int* pNumBits, const int* pCodeWord, const int* pSymbol, int numCodes, int primaryBits);
+	void	Destroy(void);
+
+	/** Decode the next symbol from the bit stream.
+	The stream is only moved on by the code length when the code is recognised.
+	@param bsr			: Bit stream to read from.
+	@param symbol		: Returned symbol.
+	@return					: Num of bits extracted, 0 = not recognised.
+	*/
+	int Decode(IBitStreamReader* bsr, int* symbol)
+	{
+		int bits = bsr->PeekNext(_maxBits);
+		const VDT_EntryType* pE = &(_pTable[bits >> _primaryShift]);
+		if(pE->subBits)
+			pE = &(_pTable[pE->value + ((bits >> (_primaryShift - pE->subBits)) & ((1 << pE->subBits) - 1))]);
+		if(pE->numBits)
+		{
+			bsr->Skip(pE->numBits);
+			*symbol = pE->value;
+		}//end if numBits...
+		return(pE->numBits);
+	}//end Decode.
+
+protected:
+	VDT_EntryType*	_pTable;				///< Primary table followed by the sub tables.
+	int							_maxBits;				///< Longest code length.
+	int							_primaryShift;	///< _maxBits - primary table index bits.
+
+	/// An empty table decodes every code as not recognised.
+	static VDT_EntryType	EMPTY_TABLE[1];
+
+};// end class VlcDecodeTable.
+
+#endif	// _VLCDECODETABLE_H
@@ -0,0 +1,126 @@
+/** @file
+
+MODULE				: WavefrontSync
+
+TAG						: WFS
+
+FILE NAME			: WavefrontSync.cpp
+
+DESCRIPTION		: Row progress counters for wavefront processing of a grid
+								of blocks. A block in a row may be processed once the row
+								above has progressed far enough to the right. Without
+								USE_MULTI_THREADED defined the rows must be processed in
+								order and waiting does nothing.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+#ifdef _WINDOWS
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#include "WavefrontSync.h"
+
+/*
+--------------------------------------------------------------------------
+  Construction.
+--------------------------------------------------------------------------
+*/
+WavefrontSync::WavefrontSync(void)
+{
+	_numRows		= 0;
+	_pProgress	= NULL;
+}//end constructor.
+
+WavefrontSync::~WavefrontSync(void)
+{
+	Destroy();
+}//end destructor.
+
+/*
+--------------------------------------------------------------------------
+  Interface.
+--------------------------------------------------------------------------
+*/
+int WavefrontSync::Create(int numRows)
+{
+	/// Clean up first.
+	Destroy();
+
+	if(numRows < 1)
+		return(0);
+
+	_pProgress = new int[numRows];
+	if(_pProgress == NULL)
+		return(0);
+	_numRows = numRows;
+	Reset();
+
+	return(1);
+}//end Create.
+
+void WavefrontSync::Destroy(void)
+{
+	if(_pProgress != NULL)
+		delete[] _pProgress;
+	_pProgress	= NULL;
+	_numRows		= 0;
+}//end Destroy.
+
+void WavefrontSync::Reset(void)
+{
+#ifdef USE_MULTI_THREADED
+	boost::mutex::scoped_lock lock(_mutex);
+#endif
+	for(int i = 0; i < _numRows; i++)
+		_pProgress[i] = 0;
+}//end Reset.
+
+void WavefrontSync::SetProgress(int row, int count)
+{
+	if( (row < 0)||(row >= _numRows) )
+		return;
+
+#ifdef USE_MULTI_THREADED
+	boost::mutex::scoped_lock lock(_mutex);
+	_pProgress[row] = count;
+	_condvar.notify_all();
+#else
+	_pProgress[row] = count;
+#endif
+}//end SetProgress.
+
+void WavefrontSync::WaitForProgress(int row, int count)
+{
+	if( (row < 0)||(row >= _numRows) )
+		return;
+
+#ifdef USE_MULTI_THREADED
+	boost::mutex::scoped_lock lock(_mutex);
+	while(_pProgress[row] < count)
+		_condvar.wait(lock);
+#else
+	(void)count;	///< Serial rows are always complete.
+#endif
+}//end WaitForProgress.
+
@@ -0,0 +1,93 @@
+/** @file
+
+MODULE				: WavefrontSync
+
+TAG						: WFS
+
+FILE NAME			: WavefrontSync.h
+
+DESCRIPTION		: Row progress counters for wavefront processing of a grid
+								of blocks. A block in a row may be processed once the row
+								above has progressed far enough to the right. Without
+								USE_MULTI_THREADED defined the rows must be processed in
+								order and waiting does nothing.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+#ifndef _WAVEFRONTSYNC_H
+#define _WAVEFRONTSYNC_H
+
+#ifdef USE_MULTI_THREADED
+#include <boost/thread.hpp>
+#endif
+
+/*
+---------------------------------------------------------------------------
+	Class definition.
+---------------------------------------------------------------------------
+*/
+class WavefrontSync
+{
+	// Construction.
+	public:
+		WavefrontSync(void);
+		virtual ~WavefrontSync(void);
+
+	// Interface.
+	public:
+		/** Create the row progress counters.
+		@param numRows	: Num of rows in the grid.
+		@return					: 1 = success, 0 = failure.
+		*/
+		int		Create(int numRows);
+		void	Destroy(void);
+
+		/// Clear the progress of all rows before each pass over the grid.
+		void	Reset(void);
+
+		/** Post the progress of a row.
+		@param row		: Row index.
+		@param count	: Num of blocks completed in the row so far.
+		@return				: none.
+		*/
+		void	SetProgress(int row, int count);
+
+		/** Block until a row has completed at least count blocks.
+		Rows outside of [0..numRows-1] are treated as complete.
+		@param row		: Row index.
+		@param count	: Num of blocks required.
+		@return				: none.
+		*/
+		void	WaitForProgress(int row, int count);
+
+		int		GetNumRows(void) { return(_numRows); }
+
+	protected:
+		int		_numRows;
+		int*	_pProgress;	///< [_numRows] completed blocks per row.
+
+#ifdef USE_MULTI_THREADED
+		boost::condition_variable	_condvar;
+		boost::mutex							_mutex;
+#endif
+
+};//end WavefrontSync.
+
+#endif	// _WAVEFRONTSYNC_H
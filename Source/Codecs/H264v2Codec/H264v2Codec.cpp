@@ -36,6 +36,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <windows.h>
 #else
 #include <stdio.h>
+#include <strings.h>
+/// POSIX equivalents of the MSVC string functions. All conversions are radix 10.
+#define _strnicmp strncasecmp
+#define _itoa(v, s, r)	(sprintf((s), "%d", (v)), (s))
+#define itoa(v, s, r)		(sprintf((s), "%d", (v)), (s))
 #endif
 
 #include <cstdio>
@@ -47,13 +52,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "H264v2Codec.h"
 
 /// Implementations.
-#include "BitStreamWriterMSB.h"
-#include "BitStreamReaderMSB.h"
+#include "FastBitStreamWriterMSB.h"
+#include "FastBitStreamReaderMSB.h"
 
 #include "RealRGB24toYUV420CCIR601ConverterVer16.h"
 #include "RealYUV420toRGB24CCIR601ConverterVer16.h"	
 #include "RealRGB24toYUV420ConverterImpl2Ver16.h"
 #include "RealYUV420toRGB24ConverterImpl2Ver16.h"
+#include "SimdDefs.h"
 
 #include "FastForward4x4ITImpl2.h"
 #include "FastForward4x4ITImpl1.h"
@@ -64,12 +70,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "FastInverseDC2x2ITImpl1.h"
 #include "FastForward4x4On16x16ITImpl1.h"
 #include "FastInverse4x4On16x16ITImpl1.h"
+#include "FastSimdForward4x4ITImpl1.h"
+#include "FastSimdInverse4x4ITImpl1.h"
 #include "CAVLCH264Impl.h"
 #include "CAVLCH264Impl2.h"
 
 #include "MotionEstimatorH264ImplMultires.h"
 #include "MotionEstimatorH264ImplMultiresCross.h"
 #include "MotionEstimatorH264ImplMultiresCrossVer2.h"
+#include "MotionEstimatorH264ImplFastSearch.h"
 #include "MotionCompensatorH264ImplStd.h"
 #include "H264MotionVectorPredictorImpl1.h"
 
@@ -78,14 +87,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "PrefixH264VlcDecoderImpl1.h"
 #include "CoeffTokenH264VlcEncoder.h"
 #include "CoeffTokenH264VlcDecoder.h"
+#include "CoeffTokenH264VlcDecoderImpl2.h"
 #include "TotalZeros4x4H264VlcEncoder.h"
 #include "TotalZeros4x4H264VlcDecoder.h"
+#include "TotalZeros4x4H264VlcDecoderImpl2.h"
 #include "TotalZeros2x2H264VlcEncoder.h"
 #include "TotalZeros2x2H264VlcDecoder.h"
+#include "TotalZeros2x2H264VlcDecoderImpl2.h"
 #include "TotalZeros2x4H264VlcEncoder.h"
 #include "TotalZeros2x4H264VlcDecoder.h"
 #include "RunBeforeH264VlcEncoder.h"
 #include "RunBeforeH264VlcDecoder.h"
+#include "RunBeforeH264VlcDecoderImpl2.h"
 #include "ExpGolombUnsignedVlcEncoder.h"
 #include "ExpGolombUnsignedVlcDecoder.h"
 #include "ExpGolombSignedVlcEncoder.h"
@@ -117,6 +130,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define H264V2_MAX_EXT_QP	          71	///< Maximum extended QP value for Inter
 #define H264V2_I_MAX_EXT_QP	        85	///< Maximum extended QP value for Intra
 
+/// Unquantised Inter coeffs per mb in the coeff cache. 16 Lum and 8 Chr 4x4 blks in raster
+/// order with the Chr DC coeffs removed followed by the Chr DC coeffs of the Cb and Cr blks.
+#define H264V2_COEFF_CACHE_LEN			392
+
 #define H264V2_MAX_INTRA_ITERATIONS	5 	///< Default settings for a limit on optimisation iterations for slow convergence.
 #define H264V2_MAX_INTER_ITERATIONS	10 
 
@@ -151,7 +168,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
   Local constants. 
 --------------------------------------------------------------------------
 */
-const int		H264v2Codec::PARAMETER_LEN = 25;
+const int		H264v2Codec::PARAMETER_LEN = 43;
 const char*	H264v2Codec::PARAMETER_LIST[] = 
 {
 	"parameters",								            // 0
@@ -178,9 +195,234 @@ const char*	H264v2Codec::PARAMETER_LIST[] =
 	"start code emulation prevention",      // 21
   "idr frame number",                     // 22
   "p frame number",                       // 23
-  "seq param log2 max frame num minus 4"  // 24
+  "seq param log2 max frame num minus 4", // 24
+  "slices per picture",                   // 25
+  "wavefront threads",                    // 26
+  "pipelined motion estimation",          // 27
+  "in lum stride",                        // 28
+  "in chr stride",                        // 29
+  "table vlc decoders",                   // 30
+  "row loop filter",                      // 31
+  "predictive motion estimation",         // 32
+  "motion estimator",                     // 33
+  "motion estimation usec",               // 34
+  "motion estimation distortion",         // 35
+  "early termination",                    // 36
+  "scene change threshold",               // 37
+  "lookahead inter cost",                 // 38
+  "lookahead intra cost",                 // 39
+  "intra refresh",                        // 40
+  "intra refresh direction",              // 41
+  "max slice bytes"                       // 42
 };
 
+/*
+---------------------------------------------------------------------------
+  Input plane row helpers. 
+---------------------------------------------------------------------------
+*/
+/// The byte to short widening and the emulation prevention zero byte search use SSE2 
+/// where it is part of the target instruction set (see SimdDefs.h).
+
+/// Widen rows of 8 bit pels with a src stride into packed 16 bit rows.
+static void H264V2_WidenRows(const unsigned char* pSrc, int srcStride, short* pDst, int width, int height)
+{
+	for(int y = 0; y < height; y++, pSrc += srcStride, pDst += width)
+	{
+		int x = 0;
+#ifdef RTVC_SIMD
+		__m128i zero = _mm_setzero_si128();
+		for(; x <= (width - 16); x += 16)
+		{
+			__m128i s = _mm_loadu_si128((const __m128i *)(&pSrc[x]));
+			_mm_storeu_si128((__m128i *)(&pDst[x]), _mm_unpacklo_epi8(s, zero));
+			_mm_storeu_si128((__m128i *)(&pDst[x + 8]), _mm_unpackhi_epi8(s, zero));
+		}//end for x...
+#endif
+		for(; x < width; x++)
+			pDst[x] = (short)pSrc[x];
+	}//end for y...
+}//end H264V2_WidenRows.
+
+/// Copy rows of 16 bit pels with a src stride into packed 16 bit rows.
+static void H264V2_CopyRows(const short* pSrc, int srcStride, short* pDst, int width, int height)
+{
+	for(int y = 0; y < height; y++, pSrc += srcStride, pDst += width)
+		memcpy((void *)pDst, (const void *)pSrc, width * sizeof(short));
+}//end H264V2_CopyRows.
+
+/*
+---------------------------------------------------------------------------
+  Emulation prevention helpers. 
+---------------------------------------------------------------------------
+*/
+#define H264V2_EP_BATCH	256	///< Emulation prevention bytes moved into place together.
+
+/// Test 16 bytes for a zero byte. Runs of bytes without zeros need no emulation prevention.
+static inline int H264V2_AnyZero16(const unsigned char* p)
+{
+#ifdef RTVC_SIMD
+	return(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), _mm_setzero_si128())));
+#else
+	unsigned long long a, b;
+	memcpy((void *)(&a), (const void *)p, 8);
+	memcpy((void *)(&b), (const void *)(&p[8]), 8);
+	return( ((((a - 0x0101010101010101ULL) & ~a)|((b - 0x0101010101010101ULL) & ~b)) & 0x8080808080808080ULL) != 0 );
+#endif
+}//end H264V2_AnyZero16.
+
+/// Insert a batch of emulation prevention bytes in front of the ascending byte positions
+/// in pPos. The stream up to byte last is moved up in segments from the end backwards.
+static void H264V2_InsertEscapes(unsigned char* pStream, const int* pPos, int num, int last)
+{
+	int end = last + 1;
+	for(int k = num - 1; k >= 0; k--)
+	{
+		memmove((void *)&(pStream[pPos[k] + k + 1]), (const void *)&(pStream[pPos[k]]), end - pPos[k]);
+		pStream[pPos[k] + k] = 0x03;
+		end = pPos[k];
+	}//end for k...
+}//end H264V2_InsertEscapes.
+
+/*
+---------------------------------------------------------------------------
+  Loop filter helpers. 
+---------------------------------------------------------------------------
+*/
+#ifdef RTVC_SIMD
+
+/// Select the lanes of a where the mask is set and of b elsewhere.
+static inline __m128i H264V2_Select(__m128i mask, __m128i a, __m128i b)
+{
+	return(_mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)));
+}//end H264V2_Select.
+
+/// Absolute difference of 16 bit pels.
+static inline __m128i H264V2_AbsDiff(__m128i a, __m128i b)
+{
+	return(_mm_max_epi16(_mm_sub_epi16(a, b), _mm_sub_epi16(b, a)));
+}//end H264V2_AbsDiff.
+
+/// Transpose 8 rows of 8 x 16 bit pels in place.
+static inline void H264V2_Transpose8x8(__m128i* r)
+{
+	__m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+	__m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+	__m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+	__m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+	__m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+	__m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+	__m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+	__m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+	__m128i b0 = _mm_unpacklo_epi32(a0, a2);
+	__m128i b1 = _mm_unpackhi_epi32(a0, a2);
+	__m128i b2 = _mm_unpacklo_epi32(a1, a3);
+	__m128i b3 = _mm_unpackhi_epi32(a1, a3);
+	__m128i b4 = _mm_unpacklo_epi32(a4, a6);
+	__m128i b5 = _mm_unpackhi_epi32(a4, a6);
+	__m128i b6 = _mm_unpacklo_epi32(a5, a7);
+	__m128i b7 = _mm_unpackhi_epi32(a5, a7);
+	r[0] = _mm_unpacklo_epi64(b0, b4);
+	r[1] = _mm_unpackhi_epi64(b0, b4);
+	r[2] = _mm_unpacklo_epi64(b1, b5);
+	r[3] = _mm_unpackhi_epi64(b1, b5);
+	r[4] = _mm_unpacklo_epi64(b2, b6);
+	r[5] = _mm_unpackhi_epi64(b2, b6);
+	r[6] = _mm_unpacklo_epi64(b3, b7);
+	r[7] = _mm_unpackhi_epi64(b3, b7);
+}//end H264V2_Transpose8x8.
+
+/// Filter 8 lanes across an edge with the pels {p3, p2, p1, p0, q0, q1, q2, q3} in v[0..7].
+/// Each lane has its own boundary strength bS = {0..4} and tC0 while alpha, beta and the
+/// colour component are common to the edge. The operations match VerticalFilter() and
+/// HorizontalFilter() for the pel range [0..255].
+static void H264V2_FilterEdge8(__m128i* v, __m128i bS, __m128i tC0, int alpha, int beta, int lumFlag)
+{
+	__m128i zero	= _mm_setzero_si128();
+	__m128i one		= _mm_set1_epi16(1);
+	__m128i two		= _mm_set1_epi16(2);
+	__m128i four	= _mm_set1_epi16(4);
+	__m128i a			= _mm_set1_epi16((short)alpha);
+	__m128i b			= _mm_set1_epi16((short)beta);
+	__m128i p3 = v[0], p2 = v[1], p1 = v[2], p0 = v[3];
+	__m128i q0 = v[4], q1 = v[5], q2 = v[6], q3 = v[7];
+
+	/// Test boundary differences to switch the filtering on/off.
+	__m128i ad = H264V2_AbsDiff(p0, q0);
+	__m128i on = _mm_and_si128(_mm_cmplt_epi16(ad, a), _mm_and_si128(_mm_cmplt_epi16(H264V2_AbsDiff(p1, p0), b), _mm_cmplt_epi16(H264V2_AbsDiff(q1, q0), b)));
+	on = _mm_andnot_si128(_mm_cmpeq_epi16(bS, zero), on);
+	if(!_mm_movemask_epi8(on))
+		return;
+
+	__m128i ap = zero;
+	__m128i aq = zero;
+	if(lumFlag)
+	{
+		ap = _mm_cmplt_epi16(H264V2_AbsDiff(p2, p0), b);
+		aq = _mm_cmplt_epi16(H264V2_AbsDiff(q2, q0), b);
+	}//end if lumFlag...
+	__m128i strong	= _mm_cmpeq_epi16(bS, four);
+	__m128i onS			= _mm_and_si128(strong, on);
+	__m128i onN			= _mm_andnot_si128(strong, on);
+
+	if(_mm_movemask_epi8(onN))	///< bS = {1, 2, 3}.
+	{
+		/// The masks are -1 when set and subtracting them adds 1 to tC.
+		__m128i tC = lumFlag? _mm_sub_epi16(_mm_sub_epi16(tC0, ap), aq) : _mm_add_epi16(tC0, one);
+		__m128i delta = _mm_add_epi16(_mm_slli_epi16(_mm_sub_epi16(q0, p0), 2), _mm_sub_epi16(p1, q1));
+		delta = _mm_srai_epi16(_mm_add_epi16(delta, four), 3);
+		delta = _mm_min_epi16(_mm_max_epi16(delta, _mm_sub_epi16(zero, tC)), tC);
+		__m128i max = _mm_set1_epi16(255);
+		v[3] = H264V2_Select(onN, _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(p0, delta), zero), max), v[3]);	///< p0.
+		v[4] = H264V2_Select(onN, _mm_min_epi16(_mm_max_epi16(_mm_sub_epi16(q0, delta), zero), max), v[4]);	///< q0.
+
+		if(lumFlag)
+		{
+			__m128i avg		= _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(p0, q0), one), 1);
+			__m128i mtC0	= _mm_sub_epi16(zero, tC0);
+			delta = _mm_srai_epi16(_mm_sub_epi16(_mm_add_epi16(p2, avg), _mm_slli_epi16(p1, 1)), 1);
+			delta = _mm_min_epi16(_mm_max_epi16(delta, mtC0), tC0);
+			v[2] = H264V2_Select(_mm_and_si128(onN, ap), _mm_add_epi16(p1, delta), v[2]);	///< p1.
+			delta = _mm_srai_epi16(_mm_sub_epi16(_mm_add_epi16(q2, avg), _mm_slli_epi16(q1, 1)), 1);
+			delta = _mm_min_epi16(_mm_max_epi16(delta, mtC0), tC0);
+			v[5] = H264V2_Select(_mm_and_si128(onN, aq), _mm_add_epi16(q1, delta), v[5]);	///< q1.
+		}//end if lumFlag...
+	}//end if onN...
+
+	if(_mm_movemask_epi8(onS))	///< bS = 4.
+	{
+		__m128i small = _mm_cmplt_epi16(ad, _mm_set1_epi16((short)((alpha >> 2) + 2)));
+		__m128i apS		= _mm_and_si128(_mm_and_si128(ap, small), onS);
+		__m128i aqS		= _mm_and_si128(_mm_and_si128(aq, small), onS);
+		__m128i p0q0	= _mm_add_epi16(p0, q0);
+
+		/// p side.
+		__m128i s = _mm_add_epi16(_mm_add_epi16(p1, p0q0), two);	///< p1 + p0 + q0 + 2.
+		__m128i x = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(p2, _mm_slli_epi16(_mm_add_epi16(p1, p0q0), 1)), _mm_add_epi16(q1, four)), 3);
+		__m128i y = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(p1, 1), p0), _mm_add_epi16(q1, two)), 2);
+		__m128i nP0 = H264V2_Select(apS, x, y);
+		__m128i nP1 = _mm_srai_epi16(_mm_add_epi16(p2, s), 2);
+		__m128i nP2 = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(_mm_add_epi16(p3, p2), 1), p2), _mm_add_epi16(_mm_sub_epi16(s, two), four)), 3);
+		v[3] = H264V2_Select(onS, nP0, v[3]);
+		v[2] = H264V2_Select(apS, nP1, v[2]);
+		v[1] = H264V2_Select(apS, nP2, v[1]);
+
+		/// q side.
+		s = _mm_add_epi16(_mm_add_epi16(q1, p0q0), two);	///< q1 + q0 + p0 + 2.
+		x = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(q2, _mm_slli_epi16(_mm_add_epi16(q1, p0q0), 1)), _mm_add_epi16(p1, four)), 3);
+		y = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(q1, 1), q0), _mm_add_epi16(p1, two)), 2);
+		__m128i nQ0 = H264V2_Select(aqS, x, y);
+		__m128i nQ1 = _mm_srai_epi16(_mm_add_epi16(q2, s), 2);
+		__m128i nQ2 = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(_mm_add_epi16(q3, q2), 1), q2), _mm_add_epi16(_mm_sub_epi16(s, two), four)), 3);
+		v[4] = H264V2_Select(onS, nQ0, v[4]);
+		v[5] = H264V2_Select(aqS, nQ1, v[5]);
+		v[6] = H264V2_Select(aqS, nQ2, v[6]);
+	}//end if onS...
+
+}//end H264V2_FilterEdge8.
+
+#endif
+
 const int		H264v2Codec::MEMBER_LEN = 4;
 const char*	H264v2Codec::MEMBER_LIST[] = 
 {
@@ -302,8 +544,21 @@ const int H264v2Codec::indexAbS[3][52]	= { { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
         63, 63, 63, 63, 67, 68, 69, 70 
 	  };
 
-  /// CPU speed dependent high resolution timer.
-  double H264v2Codec::_cpuFreq = 0.0;
+/// Inter 4x4 quant norm factors of the zero residual test per (QP % 6) for the (even,even), 
+/// (odd,odd) and (even,odd) coeff positions.
+const int H264v2Codec::zeroResidualNorm[6][3] =
+	{	{13107, 5243, 8066 },
+		{11916, 4660, 7490 },
+		{10082, 4194, 6554 },
+		{ 9362, 3647, 5825 },
+		{ 8192, 3355, 5243 },
+		{ 7282, 2893, 4559 }
+	};
+
+  /// CPU speed dependent high resolution timer. Both are set once during static 
+  /// initialisation and are only read thereafter, including from the worker threads.
+  double H264v2Codec::_cpuFreq = double(MonotonicClock::GetFrequency())/1000.0;  ///< In ms
+  long long H264v2Codec::_counterOrigin = MonotonicClock::GetTicks();
 
 /*
 --------------------------------------------------------------------------
@@ -314,6 +569,12 @@ const int H264v2Codec::indexAbS[3][52]	= { { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 H264v2Codec::H264v2Codec()
 {
   ResetMembers();
+
+	/// The private distortion evaluation mb is a stand alone mb at the image origin. Its
+	/// temp blks are used in the feedback loop and must have the blk offsets too.
+	MacroBlockH264* pDistortionMbRow = &_distortionMb;
+	MacroBlockH264::Initialise(1, 1, 0, 0, 0, &pDistortionMbRow);
+	MacroBlockH264::CopyBlksToTmpBlks(&_distortionMb, 0, MBH264_NUM_BLKS - 1);
 }//end constructor.
 
 void H264v2Codec::ResetMembers(void)
@@ -365,6 +626,26 @@ void H264v2Codec::ResetMembers(void)
 
   _startCodeEmulationPrevention     = 1;  ///< Enable/disable start code emulation prevention in bit stream.
 
+  _slicesPerPicture                 = 1;  ///< Whole macroblock rows are evenly distributed between the slices.
+  _wavefrontThreads                 = 1;  ///< Single slice macroblock row threads. 0 or 1 = disabled.
+  _pipelinedMotionEstimation        = 0;  ///< Estimate against the prev input img concurrently with the loop filter.
+  _maxSliceBytes                    = 0;  ///< Slices are not bounded by size.
+  _inLumStride                      = 0;  ///< Packed YUV420P8/P16 input planes.
+  _inChrStride                      = 0;
+  _tableVlcDecoders                 = 1;  ///< Table lookup coeff token, total zeros and run before decoders.
+  _rowLoopFilter                    = 0;  ///< Loop filter each mb row as soon as the row below is reconstructed.
+  _predictiveMotionEstimation       = 0;  ///< Seed the motion search with candidate vectors.
+  _motionEstimator                  = 0;  ///< Multiresolution cross search.
+  _motionEstimationUsec             = 0;
+  _motionEstimationDistortion       = 0;
+  _earlyTermination                 = 1;  ///< Only residuals that are certain to quantise to zero.
+  _sceneChangeThreshold             = 60; ///< Lookahead inter cost as a percentage of the intra cost.
+  _lookaheadInterCost               = 0;
+  _lookaheadIntraCost               = 0;
+  _intraRefresh                     = 0;  ///< Off.
+  _intraRefreshDirection            = 0;  ///< Column band.
+  _intraRefreshPos                  = 0;
+
   /// Work input image.
   _lumWidth			= 0;
   _lumHeight		= 0;
@@ -417,6 +698,15 @@ void H264v2Codec::ResetMembers(void)
 	_pMotionCompensator				= NULL;
 	_pMotionVectors						= NULL;
   _pMotionPredictor         = NULL;
+	_pRefPicture							= NULL;
+	_pLookahead								= NULL;
+	_pPrevLum									= NULL;
+	_pMotionPredMb						= NULL;
+	_MotionPredMb							= NULL;
+	_loopFilterPending				= 0;
+	_pipelineMotionDistortion	= 0;
+	_loopFilterRowsDone				= -1;
+	_loopFilterFromCoeffs			= 0;
 
 	/// Vlc encoders and decoders for use with CAVLC.
 	_pPrefixVlcEnc						= NULL;
@@ -452,6 +742,8 @@ void H264v2Codec::ResetMembers(void)
 	/// Macroblock data objects.
 	_pMb				= NULL;
 	_Mb					= NULL;
+	_pCoeffCache			= NULL;
+	_pCoeffCacheValid	= NULL;
 
   /// Internal parameters.
 
@@ -472,6 +764,24 @@ void H264v2Codec::ResetMembers(void)
 	_slice._disable_deblocking_filter_idc = 0;
 	_mb_skip_run			= 0;				                    ///< For P-Slices a skip run preceeds each macroblock.
 
+	/// Multiple slice workers.
+	_numSlices					= 1;
+	_pSliceFirstMb			= NULL;
+	_sizedSliceBytes		= 0;
+	_numSizedSlices			= 1;
+	_pSizedSliceFirstMb	= NULL;
+	_sizedSliceHeaderBits	= 0;
+	_sizedSliceDataBits	= 0;
+	_sizedSliceSkipRun	= 0;
+	_numWorkers					= 1;
+	_pSliceWorker				= NULL;
+	_pSliceStreamMem		= NULL;
+	_sliceStreamByteLen	= 0;
+	_sliceAllowedBits		= 0;
+	_sliceErr						= 0;
+	_pThreadPool				= NULL;
+	_pWavefrontSync			= NULL;
+
 	/// Image plane encoders/decoders.
 	_pIntraImgPlaneEncoder	= NULL;
 	_pInterImgPlaneEncoder	= NULL;
@@ -553,6 +863,42 @@ int	H264v2Codec::GetParameter(const char* type, int*	length, void*	value)
 		_itoa(_startCodeEmulationPrevention,(char *)value,10);
 	else if( _strnicmp(p,"seq param log2 max frame num minus 4",len) == 0 )
 		_itoa(_seqParamSetLog2MaxFrameNumMinus4,(char *)value,10);
+	else if( _strnicmp(p,"slices per picture",len) == 0 )
+		_itoa(_slicesPerPicture,(char *)value,10);
+	else if( _strnicmp(p,"wavefront threads",len) == 0 )
+		_itoa(_wavefrontThreads,(char *)value,10);
+	else if( _strnicmp(p,"pipelined motion estimation",len) == 0 )
+		_itoa(_pipelinedMotionEstimation,(char *)value,10);
+	else if( _strnicmp(p,"in lum stride",len) == 0 )
+		_itoa(_inLumStride,(char *)value,10);
+	else if( _strnicmp(p,"in chr stride",len) == 0 )
+		_itoa(_inChrStride,(char *)value,10);
+	else if( _strnicmp(p,"table vlc decoders",len) == 0 )
+		_itoa(_tableVlcDecoders,(char *)value,10);
+	else if( _strnicmp(p,"row loop filter",len) == 0 )
+		_itoa(_rowLoopFilter,(char *)value,10);
+	else if( _strnicmp(p,"predictive motion estimation",len) == 0 )
+		_itoa(_predictiveMotionEstimation,(char *)value,10);
+	else if( _strnicmp(p,"motion estimator",len) == 0 )
+		_itoa(_motionEstimator,(char *)value,10);
+	else if( _strnicmp(p,"motion estimation usec",len) == 0 )
+		_itoa(_motionEstimationUsec,(char *)value,10);
+	else if( _strnicmp(p,"motion estimation distortion",len) == 0 )
+		_itoa(_motionEstimationDistortion,(char *)value,10);
+	else if( _strnicmp(p,"early termination",len) == 0 )
+		_itoa(_earlyTermination,(char *)value,10);
+	else if( _strnicmp(p,"scene change threshold",len) == 0 )
+		_itoa(_sceneChangeThreshold,(char *)value,10);
+	else if( _strnicmp(p,"lookahead inter cost",len) == 0 )
+		_itoa(_lookaheadInterCost,(char *)value,10);
+	else if( _strnicmp(p,"lookahead intra cost",len) == 0 )
+		_itoa(_lookaheadIntraCost,(char *)value,10);
+	else if( _strnicmp(p,"intra refresh",len) == 0 )
+		_itoa(_intraRefresh,(char *)value,10);
+	else if( _strnicmp(p,"intra refresh direction",len) == 0 )
+		_itoa(_intraRefreshDirection,(char *)value,10);
+	else if( _strnicmp(p,"max slice bytes",len) == 0 )
+		_itoa(_maxSliceBytes,(char *)value,10);
 	else if( _strnicmp(p,"parameters",len) == 0 )
 		_itoa(PARAMETER_LEN,(char *)value,10);
 	else
@@ -632,6 +978,38 @@ int H264v2Codec::SetParameter(const char* type, const char* value)
 		_startCodeEmulationPrevention = (int)(atoi(v));
 	else if( _strnicmp(p,"seq param log2 max frame num minus 4",len) == 0 )
 		_seqParamSetLog2MaxFrameNumMinus4 = (int)(atoi(v));
+	else if( _strnicmp(p,"slices per picture",len) == 0 )
+		_slicesPerPicture = (int)(atoi(v));
+	else if( _strnicmp(p,"wavefront threads",len) == 0 )
+		_wavefrontThreads = (int)(atoi(v));
+	else if( _strnicmp(p,"pipelined motion estimation",len) == 0 )
+		_pipelinedMotionEstimation = (int)(atoi(v));
+	else if( _strnicmp(p,"in lum stride",len) == 0 )
+		_inLumStride = (int)(atoi(v));
+	else if( _strnicmp(p,"in chr stride",len) == 0 )
+		_inChrStride = (int)(atoi(v));
+	else if( _strnicmp(p,"table vlc decoders",len) == 0 )
+		_tableVlcDecoders = (int)(atoi(v));
+	else if( _strnicmp(p,"row loop filter",len) == 0 )
+		_rowLoopFilter = (int)(atoi(v));
+	else if( _strnicmp(p,"predictive motion estimation",len) == 0 )
+		_predictiveMotionEstimation = (int)(atoi(v));
+	else if( _strnicmp(p,"motion estimator",len) == 0 )
+		_motionEstimator = (int)(atoi(v));
+	else if( _strnicmp(p,"early termination",len) == 0 )
+		_earlyTermination = (int)(atoi(v));
+	else if( _strnicmp(p,"scene change threshold",len) == 0 )
+	{
+		_sceneChangeThreshold = (int)(atoi(v));
+		if(_pLookahead != NULL)
+			_pLookahead->SetThreshold(_sceneChangeThreshold);
+	}
+	else if( _strnicmp(p,"intra refresh",len) == 0 )
+		_intraRefresh = (int)(atoi(v));
+	else if( _strnicmp(p,"intra refresh direction",len) == 0 )
+		_intraRefreshDirection = (int)(atoi(v));
+	else if( _strnicmp(p,"max slice bytes",len) == 0 )
+		_maxSliceBytes = (int)(atoi(v));
 	else
 	{
 		_errorStr = "[H264v2Codec::SetParameter] Write parameter not supported";
@@ -666,6 +1044,7 @@ void* H264v2Codec::GetMember(const char* type, int* length)
 	else if( _strnicmp(p,"reference",len) == 0 )
 	{
 		*length = (_lumWidth * _lumHeight) + 2*(_chrWidth * _chrHeight);
+		CompleteLoopFilter();
 		pRet		= (void *)_pRLum;
 	}
 	else if( _strnicmp(p,"members",len) == 0 )
@@ -882,15 +1261,87 @@ int H264v2Codec::Open(void)
 	for(i = 0; i < mbHeight; i++)	///< Load the address array.
 		_Mb[i] = &(_pMb[i * mbWidth]);
 
-	/// Load the macroblock image mem 2-D offsets, indices and neighbourhood variables. There
-	/// is only one slice (slice num = 0) and therefore extends from macroblock index 0..._mbLength-1.
-	MacroBlockH264::Initialise(mbHeight, mbWidth, 0, _mbLength-1, 0, _Mb);
+	/// Partition the picture into slices of whole macroblock rows that are as evenly 
+	/// distributed as possible. With one slice it extends from macroblock index 0..._mbLength-1.
+	/// Size bounded slices are found while the single slice is encoded in raster order and
+	/// are only implemented for the H264V2_OPEN mode of operation.
+	int sizedSlices = (_modeOfOperation == H264V2_OPEN)&&(_maxSliceBytes > 0);
+	_numSlices = _slicesPerPicture;
+	if( (_numSlices < 1)||sizedSlices )
+		_numSlices = 1;
+	if(_numSlices > mbHeight)
+		_numSlices = mbHeight;
+  /// Slice NAL units are only found by their start code prefix that is not unique in the stream 
+  /// without emulation prevention.
+  if( ((_numSlices > 1)||sizedSlices)&&!_startCodeEmulationPrevention )
+  {
+    _errorStr = "[H264Codec::Open] Multiple slices per picture require start code emulation prevention";
+    Close();
+	  return(0);
+  }//end if _numSlices...
+	_pSliceFirstMb = new int[_numSlices + 1];
+	if(_pSliceFirstMb == NULL)
+  {
+    _errorStr = "[H264Codec::Open] Cannot create slice partition list";
+    Close();
+	  return(0);
+  }//end if !_pSliceFirstMb...
+	for(i = 0; i < _numSlices; i++)
+		_pSliceFirstMb[i] = ((i * mbHeight)/_numSlices) * mbWidth;
+	_pSliceFirstMb[_numSlices] = _mbLength;
+
+	/// Load the macroblock image mem 2-D offsets, indices and neighbourhood variables for
+	/// each slice. Neighbours in different slices are marked as unavailable.
+	for(i = 0; i < _numSlices; i++)
+		MacroBlockH264::Initialise(mbHeight, mbWidth, _pSliceFirstMb[i], _pSliceFirstMb[i+1]-1, i, _Mb);
+
+	/// A size bounded slice may hold a single macroblock.
+	if(sizedSlices)
+	{
+		_pSizedSliceFirstMb = new int[_mbLength + 1];
+		if(_pSizedSliceFirstMb == NULL)
+		{
+			_errorStr = "[H264Codec::Open] Cannot create size bounded slice list";
+			Close();
+			return(0);
+		}//end if !_pSizedSliceFirstMb...
+		_sizedSliceBytes				= _maxSliceBytes;
+		_numSizedSlices					= 1;
+		_pSizedSliceFirstMb[0]	= 0;
+		_pSizedSliceFirstMb[1]	= _mbLength;
+	}//end if sizedSlices...
+
+	/// The loop filter is not applied across slice boundaries so that the slices remain 
+	/// independently decodable (disable_deblocking_filter_idc = 2).
+	_slice._disable_deblocking_filter_idc = 0;
+	if( (_numSlices > 1)||sizedSlices )
+		_slice._disable_deblocking_filter_idc = 2;
 
 	/// Load the flag for each macroblock that includes/excludes it from the 
 	/// auto I-frame test during motion estimation. Default to include all.
 	for(i = 0; i < _mbLength; i++)
 		_autoIFrameIncluded[i] = 1;
 
+	/// The pipelined motion estimation reference and predictor macroblocks with the
+	/// same slice partitioning as the picture.
+	if(_pipelinedMotionEstimation)
+	{
+		_pPrevLum				= new short[lumSize];
+		_pMotionPredMb	= new MacroBlockH264[_mbLength];
+		_MotionPredMb		= new MacroBlockH264*[mbHeight];
+		if( (_pPrevLum == NULL)||(_pMotionPredMb == NULL)||(_MotionPredMb == NULL) )
+		{
+			_errorStr = "[H264Codec::Open] Cannot create pipelined motion estimation objects";
+			Close();
+			return(0);
+		}//end if !_pPrevLum...
+		memset((void *)_pPrevLum, 0, lumSize * sizeof(short));
+		for(i = 0; i < mbHeight; i++)
+			_MotionPredMb[i] = &(_pMotionPredMb[i * mbWidth]);
+		for(i = 0; i < _numSlices; i++)
+			MacroBlockH264::Initialise(mbHeight, mbWidth, _pSliceFirstMb[i], _pSliceFirstMb[i+1]-1, i, _MotionPredMb);
+	}//end if _pPrevLum...
+
 	/// --------------- Configure colour converters ---------------------------------
 	if(_inColour == H264V2_RGB24)
 	{
@@ -934,124 +1385,24 @@ int H264v2Codec::Open(void)
   }//end if _outColour...
 
 	/// --------------- Instantiate IT filters ------------------------------------
-	/// Create Integer Transformers (IT) and their inverses for AC and DC coeffs. The
-	/// quantisers are included in the IT transform classes.
-	_pF4x4TLum  = new FastForward4x4ITImpl2();
-	_pF4x4TChr  = new FastForward4x4ITImpl2();
-	_pFDC4x4T   = new FastForwardDC4x4ITImpl1();
-	_pFDC2x2T   = new FastForwardDC2x2ITImpl1();
-	_pI4x4TLum  = new FastInverse4x4ITImpl1();
-	_pI4x4TChr  = new FastInverse4x4ITImpl1();
-	_pIDC4x4T   = new FastInverseDC4x4ITImpl1();
-	_pIDC2x2T   = new FastInverseDC2x2ITImpl1();
-
-	if( (_pF4x4TLum == NULL)||(_pF4x4TChr == NULL)||(_pFDC4x4T == NULL)||(_pFDC2x2T == NULL)||(_pI4x4TLum == NULL)||(_pI4x4TChr == NULL)||(_pIDC4x4T == NULL)||(_pIDC2x2T == NULL) )
+	if(!CreateITFilters())
   {
-    _errorStr = "[H264Codec::Open] Cannot instantiate Integer Transform filter objects";
+		/// Error string is set in the method.
     Close();
 	  return(0);
-  }//end if !_pF4x4TLum...
-
-	/// Set default modes and added scaling for IT filters.
-	_pF4x4TLum->SetMode(IForwardTransform::TransformOnly);
-	_pF4x4TChr->SetMode(IForwardTransform::TransformOnly);
-	_pFDC4x4T->SetMode(IForwardTransform::TransformAndQuant);
-	_pFDC2x2T->SetMode(IForwardTransform::TransformAndQuant);
-	_pI4x4TLum->SetMode(IInverseTransform::TransformOnly);
-	_pI4x4TChr->SetMode(IInverseTransform::TransformOnly);
-	_pIDC4x4T->SetMode(IInverseTransform::TransformAndQuant);
-	_pIDC2x2T->SetMode(IInverseTransform::TransformAndQuant);
+  }//end if !CreateITFilters...
 
 	// --------------- Create the Vlc encoders and decoders --------------------------
-	/// Create the vlc encoders and decoders for use with CAVLC.
-	_pPrefixVlcEnc					= new PrefixH264VlcEncoderImpl1();
-	_pPrefixVlcDec					= new PrefixH264VlcDecoderImpl1();
-	_pCoeffTokenVlcEnc			= new CoeffTokenH264VlcEncoder();
-	_pCoeffTokenVlcDec			= new CoeffTokenH264VlcDecoder();
-	_pTotalZeros4x4VlcEnc		= new TotalZeros4x4H264VlcEncoder();
-	_pTotalZeros4x4VlcDec		= new TotalZeros4x4H264VlcDecoder();
-	_pTotalZeros2x2VlcEnc		= new TotalZeros2x2H264VlcEncoder();
-	_pTotalZeros2x2VlcDec		= new TotalZeros2x2H264VlcDecoder();
-	_pRunBeforeVlcEnc				= new RunBeforeH264VlcEncoder();
-	_pRunBeforeVlcDec				= new RunBeforeH264VlcDecoder();
-
-	/// Vlc encoder and decoder for the coded block pattern.
-	_pBlkPattVlcEnc	= new CodedBlkPatternH264VlcEncoder();
-	_pBlkPattVlcDec	= new CodedBlkPatternH264VlcDecoder();
-
-	/// Vlc encoder and decoder for the delta QP.
-	_pDeltaQPVlcEnc	= new ExpGolombSignedVlcEncoder();
-	_pDeltaQPVlcDec	= new ExpGolombSignedVlcDecoder();
-
-	/// Vlc encoder and decoder for the macroblock type.
-	_pMbTypeVlcEnc	= new ExpGolombUnsignedVlcEncoder();
-	_pMbTypeVlcDec	= new ExpGolombUnsignedVlcDecoder();
-
-	/// Vlc encoder and decoder for intra chr pred mode. ExpGolomb codecs
-	/// are stateless therefore they can be reused.
-	_pMbIChrPredModeVlcEnc	= _pMbTypeVlcEnc;
-	_pMbIChrPredModeVlcDec	= _pMbTypeVlcDec;
-
-	/// Vlc encoder and decoder for motion vector differences. ExpGolomb codecs
-	/// are stateless therefore they can be reused.
-	_pMbMotionVecDiffVlcEnc	= _pDeltaQPVlcEnc;
-	_pMbMotionVecDiffVlcDec	= _pDeltaQPVlcDec;
-
-	/// Vlc encoder and decoder for general headers. ExpGolomb codecs
-	/// are stateless therefore they can be reused.
-	_pHeaderUnsignedVlcEnc	= _pMbTypeVlcEnc;	
-	_pHeaderUnsignedVlcDec	= _pMbTypeVlcDec;
-	_pHeaderSignedVlcEnc		= _pDeltaQPVlcEnc;
-	_pHeaderSignedVlcDec		= _pDeltaQPVlcDec;
-
-	if( (_pPrefixVlcEnc == NULL)||(_pPrefixVlcDec == NULL)||
-			(_pCoeffTokenVlcEnc == NULL)||(_pCoeffTokenVlcDec == NULL) ||
-			(_pTotalZeros4x4VlcEnc == NULL)||(_pTotalZeros4x4VlcDec == NULL) ||
-			(_pTotalZeros2x2VlcEnc == NULL)||(_pTotalZeros2x2VlcDec == NULL) ||
-			(_pRunBeforeVlcEnc == NULL)||(_pRunBeforeVlcDec == NULL) ||
-			(_pBlkPattVlcEnc == NULL)||(_pBlkPattVlcDec == NULL) ||
-			(_pDeltaQPVlcEnc == NULL)||(_pDeltaQPVlcDec == NULL) ||
-			(_pMbTypeVlcEnc == NULL)||(_pMbTypeVlcDec == NULL) )
-  {
-		_errorStr = "[H264Codec::Open] Cannot instantiate Vlc codec objects";
-    Close();
-	  return(0);
-  }//end if !_pPrefixVlcEnc...
-
-	/// Create a CAVLC encoder and decoder for each coeff block size.
-	_pCAVLC4x4 = new CAVLCH264Impl();
-	_pCAVLC2x2 = new CAVLCH264Impl();
-	if( (_pCAVLC4x4 == NULL)||(_pCAVLC2x2 == NULL) )
+	if(!CreateVlcCodecs())
   {
-    _errorStr = "[H264Codec::Open] Cannot instantiate CAVLC codec objects";
+		/// Error string is set in the method.
     Close();
 	  return(0);
-  }//end if !_pCAVLC4x4...
-
-	/// Attach the vlc encoders and decoders to the associated CAVLC.
-	_pCAVLC4x4->SetMode(CAVLCH264Impl::Mode4x4);
-	((CAVLCH264Impl *)_pCAVLC4x4)->SetTokenCoeffVlcEncoder(_pCoeffTokenVlcEnc);
-	((CAVLCH264Impl *)_pCAVLC4x4)->SetTokenCoeffVlcDecoder(_pCoeffTokenVlcDec);
-	((CAVLCH264Impl *)_pCAVLC4x4)->SetPrefixVlcEncoder(_pPrefixVlcEnc);
-	((CAVLCH264Impl *)_pCAVLC4x4)->SetPrefixVlcDecoder(_pPrefixVlcDec);
-	((CAVLCH264Impl *)_pCAVLC4x4)->SetRunBeforeVlcEncoder(_pRunBeforeVlcEnc);
-	((CAVLCH264Impl *)_pCAVLC4x4)->SetRunBeforeVlcDecoder(_pRunBeforeVlcDec);
-	((CAVLCH264Impl *)_pCAVLC4x4)->SetTotalZerosVlcEncoder(_pTotalZeros4x4VlcEnc);
-	((CAVLCH264Impl *)_pCAVLC4x4)->SetTotalZerosVlcDecoder(_pTotalZeros4x4VlcDec);
-
-	_pCAVLC2x2->SetMode(CAVLCH264Impl::Mode2x2);
-	((CAVLCH264Impl *)_pCAVLC2x2)->SetTokenCoeffVlcEncoder(_pCoeffTokenVlcEnc);
-	((CAVLCH264Impl *)_pCAVLC2x2)->SetTokenCoeffVlcDecoder(_pCoeffTokenVlcDec);
-	((CAVLCH264Impl *)_pCAVLC2x2)->SetPrefixVlcEncoder(_pPrefixVlcEnc);
-	((CAVLCH264Impl *)_pCAVLC2x2)->SetPrefixVlcDecoder(_pPrefixVlcDec);
-	((CAVLCH264Impl *)_pCAVLC2x2)->SetRunBeforeVlcEncoder(_pRunBeforeVlcEnc);
-	((CAVLCH264Impl *)_pCAVLC2x2)->SetRunBeforeVlcDecoder(_pRunBeforeVlcDec);
-	((CAVLCH264Impl *)_pCAVLC2x2)->SetTotalZerosVlcEncoder(_pTotalZeros2x2VlcEnc);
-	((CAVLCH264Impl *)_pCAVLC2x2)->SetTotalZerosVlcDecoder(_pTotalZeros2x2VlcDec);
+  }//end if !CreateVlcCodecs...
 
 	// --------------- Configure bit stream access -----------------------------------
-	_pBitStreamWriter = new BitStreamWriterMSB();
-	_pBitStreamReader = new BitStreamReaderMSB();
+	_pBitStreamWriter = new FastBitStreamWriterMSB();
+	_pBitStreamReader = new FastBitStreamReaderMSB();
 	if( (_pBitStreamWriter == NULL)||(_pBitStreamReader == NULL) )
   {
     _errorStr = "[H264Codec::Open] Cannot instantiate bit stream access objects";
@@ -1063,7 +1414,10 @@ int H264v2Codec::Open(void)
 	
   /// Create a motion vector predictor for the motion estimator to use in biasing towards
   /// the predicted vector when distortion choise is ambiguous.
-  _pMotionPredictor = new H264MotionVectorPredictorImpl1(_pMb);
+	if(_pipelinedMotionEstimation)
+		_pMotionPredictor = new H264MotionVectorPredictorImpl1(_pMotionPredMb);
+	else
+		_pMotionPredictor = new H264MotionVectorPredictorImpl1(_pMb);
 	if(!_pMotionPredictor)
   {
     _errorStr = "[H264Codec::Open] Cannot create motion vector predictor object";
@@ -1078,38 +1432,83 @@ int H264v2Codec::Open(void)
 	else
 		motionVectorRange = 1024;	///< [-256.00 ... 255.75]
 
-	/// Fast less accurate estimator.
-	_pMotionEstimator = new MotionEstimatorH264ImplMultiresCrossVer2(	(const void *)_pLum,	///< Multi res estimation.
-																																    (const void *)_pRLum,
-																																    _lumWidth,
-																																    _lumHeight,
-																																    motionVectorRange, ///< In 1/4 pel units.
-                                                                    _pMotionPredictor,
-																																    _autoIFrameIncluded);
-
-//	_pMotionEstimator = new MotionEstimatorH264ImplMultiresCross(	(const void *)_pLum,	///< Multi res estimation.
-//																																(const void *)_pRLum,
-//																																_lumWidth,
-//																																_lumHeight,
-//																																motionVectorRange, ///< In 1/4 pel units.
-//																																_autoIFrameIncluded);
-
-	/// Slow more accurate multiresolution estimator.
-//	_pMotionEstimator = new MotionEstimatorH264ImplMultires((const void *)_pLum,	///< Multi res estimation.
-//																													(const void *)_pRLum,
-//																													_lumWidth,
-//																													_lumHeight,
-//																													motionVectorRange, ///< In 1/4 pel units
-//																													_autoIFrameIncluded);
+	/// The estimation is against the reconstructed ref img or the previous input img when pipelined.
+	short* pMotionRef = _pRLum;
+	if(_pipelinedMotionEstimation)
+		pMotionRef = _pPrevLum;
+
+	/// The 1/2 pel planes of the ref are built once per picture for the estimator and the 
+	/// compensator. They are not used when the estimation ref is the prev input img. The
+	/// planes are only created on the first coded inter picture and a decoder never holds them.
+	if(!_pipelinedMotionEstimation)
+	{
+		_pRefPicture = new RefPictureH264();
+		if(_pRefPicture == NULL)
+		{
+			_errorStr = "[H264Codec::Open] Cannot instantiate reference picture object";
+			Close();
+			return(0);
+		}//end if !_pRefPicture...
+	}//end if !_pipelinedMotionEstimation...
+
+	switch(_motionEstimator)
+	{
+		case 1:	///< Slow full search multiresolution estimator. Its vectors are not rate constrained.
+			_pMotionEstimator = new MotionEstimatorH264ImplMultires((const void *)_pLum,	///< Multi res estimation.
+																															(const void *)pMotionRef,
+																															_lumWidth,
+																															_lumHeight,
+																															motionVectorRange, ///< In 1/4 pel units
+																															_pMotionPredictor,
+																															_autoIFrameIncluded);
+			break;
+		case 2:
+			_pMotionEstimator = new MotionEstimatorH264ImplMultiresCross(	(const void *)_pLum,	///< Multi res estimation.
+																																		(const void *)pMotionRef,
+																																		_lumWidth,
+																																		_lumHeight,
+																																		motionVectorRange, ///< In 1/4 pel units.
+																																		_autoIFrameIncluded);
+			break;
+		case 3:	///< Pattern searches with the mode selecting the pattern.
+		case 4:
+		case 5:
+		case 6:
+			_pMotionEstimator = new MotionEstimatorH264ImplFastSearch(	(const void *)_pLum,
+																																	(const void *)pMotionRef,
+																																	_lumWidth,
+																																	_lumHeight,
+																																	motionVectorRange, ///< In 1/4 pel units.
+																																	_pMotionPredictor,
+																																	_autoIFrameIncluded);
+			break;
+		case 0:	///< Fast less accurate estimator.
+		default:
+			_pMotionEstimator = new MotionEstimatorH264ImplMultiresCrossVer2(	(const void *)_pLum,	///< Multi res estimation.
+																																				(const void *)pMotionRef,
+																																				_lumWidth,
+																																				_lumHeight,
+																																				motionVectorRange, ///< In 1/4 pel units.
+																																				_pMotionPredictor,
+																																				_autoIFrameIncluded);
+			break;
+	}//end switch _motionEstimator...
 
 	if(_pMotionEstimator != NULL)
 	{
 		/// Implementation specific modes.
-		_pMotionEstimator->SetMode(0);	///< Auto mode.
+		if( (_motionEstimator >= 3)&&(_motionEstimator <= 6) )
+			_pMotionEstimator->SetMode(_motionEstimator - 2);	///< Search pattern.
+		else if( (_motionEstimator == 0) && _predictiveMotionEstimation )
+			_pMotionEstimator->SetMode(3);	///< Predictive mode with auto level.
+		else
+			_pMotionEstimator->SetMode(0);	///< Auto mode.
 
 		//_motionFactor = 2;	///< Abs diff algorithm.
 		_motionFactor = 4;	///< Sqr err algorithm.
 
+		/// Attached before Create() as the estimator may then do without its own extended ref.
+		_pMotionEstimator->SetRefPicture((void *)_pRefPicture);
 		if(!_pMotionEstimator->Create())
 		{
 			_errorStr = "[H264Codec::Open] Cannot create motion estimator";
@@ -1136,6 +1535,7 @@ int H264v2Codec::Open(void)
 			Close();
 			return(0);
 		}//end if !Create...
+		_pMotionCompensator->SetRefPicture((void *)_pRefPicture);
 	}//end if _pMotionCompensator...
 	else
   {
@@ -1144,6 +1544,18 @@ int H264v2Codec::Open(void)
 	  return(0);
   }//end if else...
 
+	/// The auto I-picture lookahead decides the picture coding type on a level 2 copy of
+	/// the input before the motion estimation. It is always created as "autoipicture" may 
+	/// be switched on between pictures.
+	_pLookahead = new LookaheadH264();
+	if( (_pLookahead == NULL)||(!_pLookahead->Create(_lumWidth, _lumHeight)) )
+	{
+		_errorStr = "[H264Codec::Open] Cannot create lookahead picture";
+		Close();
+		return(0);
+	}//end if !_pLookahead...
+	_pLookahead->SetThreshold(_sceneChangeThreshold);
+
 	/// Create a motion vector list to hold the decoded vectors for the compensation process.
 	_pMotionVectors = new VectorStructList(VectorStructList::SIMPLE2D);
 	if(!_pMotionVectors)
@@ -1176,6 +1588,16 @@ int H264v2Codec::Open(void)
     _pQuant = 26; ///< Start in the middle before adaptation of each mb QP value.
 		_pIntraImgPlaneEncoder = new IntraImgPlaneEncoderImplMinMax(this);
 		_pInterImgPlaneEncoder = new InterImgPlaneEncoderImplMinMax(this);
+
+		_pCoeffCache			= new short[_mbLength * H264V2_COEFF_CACHE_LEN];
+		_pCoeffCacheValid	= new unsigned char[_mbLength];
+		if( (_pCoeffCache == NULL)||(_pCoeffCacheValid == NULL) )
+		{
+			_errorStr = "[H264Codec::Open] Cannot create coeff cache";
+			Close();
+			return(0);
+		}//end if !_pCoeffCache...
+		memset((void *)_pCoeffCacheValid, 0, _mbLength);
 	}//end else...
 
 	if( (_pIntraImgPlaneEncoder == NULL)||(_pIntraImgPlaneDecoder == NULL)||
@@ -1192,6 +1614,107 @@ int H264v2Codec::Open(void)
     Close();
 	  return(0);
   }//end if !_pIntraImgPlaneEncoder...
+
+	/// --------------- Create slice and wavefront workers ----------------------------
+	/// Every slice after the first is coded by its own worker into its own stream mem
+	/// on the thread pool. With a single slice the workers, if requested, encode the 
+	/// macroblock rows as a wavefront. The workers share the image and macroblock mem.
+	_numWorkers = _numSlices;
+	if( (_numSlices == 1)&&(_wavefrontThreads > 1)&&(_pSizedSliceFirstMb == NULL) )
+	{
+		_numWorkers = _wavefrontThreads;
+		if(_numWorkers > mbHeight)
+			_numWorkers = mbHeight;
+	}//end if _numSlices...
+
+	if( (_numWorkers > 1)||_pipelinedMotionEstimation )
+	{
+		/// The pipelined mode runs two concurrent stages.
+		int numThreads = _numWorkers;
+		if( _pipelinedMotionEstimation && (numThreads < 2) )
+			numThreads = 2;
+
+		_pThreadPool = new ThreadPool();
+		if(_pThreadPool == NULL)
+		{
+			_errorStr = "[H264Codec::Open] Cannot instantiate slice worker objects";
+			Close();
+			return(0);
+		}//end if !_pThreadPool...
+		if(!_pThreadPool->Create(numThreads))
+		{
+			_errorStr = "[H264Codec::Open] Cannot create slice worker thread pool";
+			Close();
+			return(0);
+		}//end if !Create...
+
+		/// A wavefront requires a thread for every worker as the rows wait on each other. 
+		/// Fall back to a single worker when the pool is serial.
+		if( (_numSlices == 1)&&(_pThreadPool->GetNumThreads() < _numWorkers) )
+			_numWorkers = 1;
+	}//end if _numWorkers...
+
+	if(_numWorkers > 1)
+	{
+		_pSliceWorker = new H264v2Codec*[_numWorkers];
+		if(_pSliceWorker == NULL)
+		{
+			_errorStr = "[H264Codec::Open] Cannot instantiate slice worker objects";
+			Close();
+			return(0);
+		}//end if !_pSliceWorker...
+		_pSliceWorker[0] = this;
+		for(i = 1; i < _numWorkers; i++)
+			_pSliceWorker[i] = NULL;
+
+		if(_numSlices > 1)
+		{
+			int maxSliceMbs = 0;
+			for(i = 0; i < _numSlices; i++)
+			{
+				if((_pSliceFirstMb[i+1] - _pSliceFirstMb[i]) > maxSliceMbs)
+					maxSliceMbs = _pSliceFirstMb[i+1] - _pSliceFirstMb[i];
+			}//end for i...
+			/// Worst case CAVLC encoding at low QP plus the slice header overhead.
+			_sliceStreamByteLen = (maxSliceMbs * 768) + 1024;
+			_pSliceStreamMem		= new unsigned char[_numSlices * _sliceStreamByteLen];
+		}//end if _numSlices...
+		else
+			_pWavefrontSync = new WavefrontSync();
+		if( ((_numSlices > 1)&&(_pSliceStreamMem == NULL))||((_numSlices == 1)&&(_pWavefrontSync == NULL)) )
+		{
+			_errorStr = "[H264Codec::Open] Cannot instantiate slice worker objects";
+			Close();
+			return(0);
+		}//end if !_pSliceStreamMem...
+		if( (_pWavefrontSync != NULL)&&(!_pWavefrontSync->Create(mbHeight)) )
+		{
+			_errorStr = "[H264Codec::Open] Cannot create wavefront synchronisation";
+			Close();
+			return(0);
+		}//end if _pWavefrontSync...
+
+		for(i = 1; i < _numWorkers; i++)
+		{
+			_pSliceWorker[i] = new H264v2Codec();
+			if(_pSliceWorker[i] == NULL)
+			{
+				_errorStr = "[H264Codec::Open] Cannot instantiate slice worker objects";
+				Close();
+				return(0);
+			}//end if !_pSliceWorker...
+			/// Wavefront workers do not write to a stream.
+			unsigned char* pStream = NULL;
+			if(_pSliceStreamMem != NULL)
+				pStream = &(_pSliceStreamMem[i * _sliceStreamByteLen]);
+			if(!_pSliceWorker[i]->OpenSliceWorker(this, pStream, _sliceStreamByteLen))
+			{
+				_errorStr = _pSliceWorker[i]->GetErrorStr();
+				Close();
+				return(0);
+			}//end if !OpenSliceWorker...
+		}//end for i...
+	}//end if _numWorkers...
 	
 	/// Start at the beginning.
 	_lastPicCodingType		= H264V2_INTRA;
@@ -1253,33 +1776,75 @@ int	H264v2Codec::Code(void* pSrc, void* pCmp, int codeParameter)
 		return(0);
 	}//end if !H264V2_INTRA...
 
+	/// Keep the previous input image as the pipelined motion estimation reference. The
+	/// pipeline objects exist only if the parameter was set at Open().
+	if(_pPrevLum != NULL)
+		memcpy((void *)_pPrevLum, (const void *)_pLum, (_lumWidth * _lumHeight) * sizeof(short));
+
 	/// Convert the colour space of the input image.
-	if(_inColour == H264V2_YUV420P16)	      ///< The natural colour space of the encoder with type = short.
-		memcpy( (void *)_pLum, (const void *)pSrc, ((_lumWidth * _lumHeight) + 2*(_chrWidth * _chrHeight)) * sizeof(short));
-	else if(_inColour == H264V2_YUV420P8)  ///< ...type = byte.
-  {
-    int colLen = (_lumWidth * _lumHeight) + 2*(_chrWidth * _chrHeight);
-    for(int i = 0; i < colLen; i++)
-      _pLum[i] = (short) ((unsigned char *)pSrc)[i];
-  }//end if H264V2_YUV420P8...
+	LoadInputImage(pSrc);
+
+	/// The 1/2 pel planes are stale once the ref has been reconstructed.
+	if(_pRefPicture != NULL)
+		_pRefPicture->Invalidate();
+
+	/// The lookahead measures every input picture and a scene change is coded as an IDR
+	/// picture without any motion estimation. While off, the lookahead forgets its previous
+	/// picture so that switching it on does not measure against a stale picture.
+	if(_autoIPicture == 1)
+	{
+		if(_pLookahead->Analyse(_pLum) && (_prevMotionDistortion != -1))	///< Previous picture was not an I-Picture.
+			_pictureCodingType = H264V2_INTRA;
+		_lookaheadInterCost = _pLookahead->GetInterCost();
+		_lookaheadIntraCost = _pLookahead->GetIntraCost();
+	}//end if _autoIPicture...
 	else
-		_pInColourConverter->Convert((void *)pSrc, (void *)_pLum, (void *)_pChrU, (void *)_pChrV);
+		_pLookahead->Reset();
 
 	/// Motion estimation is used to determine if an IDR frame should be inserted.
 	if(_pictureCodingType == H264V2_INTER)
 	{
 		/// Motion estimation.
 		long motionDistortion  = 0;
+		double motionStartTime = GetCounter();
+
+		/// The estimator was chosen in Open() depending on the mode selected. In pipelined 
+		/// mode it runs concurrently with the deferred loop filter of the previous picture.
+		if(_pPrevLum != NULL)
+		{
+			/// The predictor neighbourhood must see the same intra macroblocks as in the non-pipelined case.
+			for(int mb = 0; mb < _mbLength; mb++)
+				_pMotionPredMb[mb]._intraFlag = _pMb[mb]._intraFlag;
+			_pThreadPool->Run(H264v2Codec::PipelineTask, (void *)this, 2);
+			motionDistortion = _pipelineMotionDistortion;
+		}//end if _pPrevLum...
+		else
+		{
+			/// The planes remain valid for the compensation until the ref is altered. The boundary
+			/// holds a 16x16 block beyond the picture edge with the 6-tap filter support.
+			if(_pRefPicture != NULL)
+			{
+				if( !_pRefPicture->IsCreated() && !_pRefPicture->Create(_lumWidth, _lumHeight, 16 + 8) )
+				{
+					_errorStr = "[H264v2Codec::Code] Cannot create reference picture planes";
+					return(0);
+				}//end if !IsCreated...
+				_pRefPicture->Load(_pRLum);
+			}//end if _pRefPicture...
+			_pMotionEstimationResult = (VectorStructList *)(_pMotionEstimator->Estimate(&motionDistortion));
+		}//end else...
 
-		/// The estimator was chosen in Open() depending on the mode selected.
-		_pMotionEstimationResult = (VectorStructList *)(_pMotionEstimator->Estimate(&motionDistortion));
+		/// Speed and quality of the selected estimator. The pipelined time includes the
+		/// concurrent loop filter stage.
+		_motionEstimationUsec				= (int)((GetCounter() - motionStartTime) * 1000.0);
+		_motionEstimationDistortion	= (int)motionDistortion;
 
 		/// The estimation results are processed into an encoded structure list. A 
 		/// decision is made on the type of encoding as predictive or basic and 
 		/// returns the selection. The _Motion member reflects the choice.
 			
-		/// Auto I-picture detection.
-		if(_autoIPicture && (_prevMotionDistortion != -1)) ///< Previous frame was not an I-Picture.
+		/// Auto I-picture detection from the motion distortion when there is no lookahead.
+		if( (_autoIPicture == 2) && (_prevMotionDistortion != -1) ) ///< Previous frame was not an I-Picture.
 		{
 			/// Test for an I-picture.
 			if( motionDistortion > (_motionFactor * _prevMotionDistortion) )
@@ -1297,6 +1862,12 @@ int	H264v2Codec::Code(void* pSrc, void* pCmp, int codeParameter)
 	/// The motion estimation process is used to determine if this picture
 	/// should rather be coded as an IDR picture. Therefore the INTRA 
 	/// picture type coding is done afterwards. 
+
+	/// A deferred loop filter must complete before the ref is used for prediction. The ref 
+	/// is reset for INTRA pictures.
+	if(_pictureCodingType == H264V2_INTER)
+		CompleteLoopFilter();
+	_loopFilterPending = 0;
 	
 	/// For INTRA pictures and before any encoding begins readjust the 
 	/// allowable bits based on the I-picture multiplier parameters.
@@ -1324,14 +1895,9 @@ int	H264v2Codec::Code(void* pSrc, void* pCmp, int codeParameter)
         return(0);
       }//end if allowedBits...
 
-      /// Write the pre-encoded SPS to the stream.
-      int i;
-      for(i = 0; i < _encSeqParamByteLen; i++)  ///< One byte at a time.
-        _pBitStreamWriter->Write(8,_pEncSeqParam[i]);
-
-      /// Write the pre-encoded PPS to the stream.
-      for(i = 0; i < _encPicParamByteLen; i++)  ///< One byte at a time.
-        _pBitStreamWriter->Write(8,_pEncPicParam[i]);
+      /// Write the pre-encoded SPS and PPS to the stream.
+      _pBitStreamWriter->WriteBytes((const void *)_pEncSeqParam, _encSeqParamByteLen);
+      _pBitStreamWriter->WriteBytes((const void *)_pEncPicParam, _encPicParamByteLen);
 
       _bitStreamSize += paramTotBitLen;
 
@@ -1391,14 +1957,46 @@ int	H264v2Codec::Code(void* pSrc, void* pCmp, int codeParameter)
   if(runOutOfBits) ///< or if(== 2) An error has occured.
     return(0);
 
+	/// The plane encoders start the size bounded slices that follow this first slice header.
+	if(_pSizedSliceFirstMb != NULL)
+		StartSizedSlices(bitsUsed);
+
 	/// Encode the entire picture. The plane encoders do not write to the stream
 	/// but do require to know the available bits. Allowance is made for the single
 	/// trailing bit.
 	allowedBits	= bitLimit - _bitStreamSize - 1;
+
+	/// The slice workers share the slice parameters and the NAL header and are
+	/// synchronised here. Every slice after the first has its own start code, NAL 
+	/// header, slice header and trailing bits that must be deducted from the bits 
+	/// available to the plane encoders.
+	for(int s = 1; s < _numWorkers; s++)
+	{
+		H264v2Codec* pWorker = _pSliceWorker[s];
+		pWorker->_slice											= _slice;
+		pWorker->_nal												= _nal;
+		pWorker->_pQuant										= _pQuant;
+		pWorker->_earlyTermination					= _earlyTermination;
+		if(s >= _numSlices)
+			continue;	///< Wavefront workers have no slice of their own.
+		pWorker->_slice._first_mb_in_slice	= _pSliceFirstMb[s];
+
+		if(pWorker->WriteSliceLayerHeader(NULL, allowedBits, &bitsUsed))
+		{
+			_errorStr = pWorker->GetErrorStr();
+			return(0);
+		}//end if WriteSliceLayerHeader...
+		allowedBits -= (32 + 8 + bitsUsed + 8);
+	}//end for s...
+
+	/// The StdVer1 plane encoders may loop filter the macroblock rows as they are reconstructed.
+	StartRowLoopFilter(1);
+
 	if(_pictureCodingType == H264V2_INTRA)
 	{
 		_prevMotionDistortion = -1;
     Restart(); ///< Reset the loop for I-picture.
+		_intraRefreshPos = 0;	///< The I-picture refreshes the whole picture.
 
 		/// The encoder was chosen in Open() depending on the mode selected. It
 		/// operates on the full list of slices and their macroblocks.
@@ -1411,11 +2009,18 @@ int	H264v2Codec::Code(void* pSrc, void* pCmp, int codeParameter)
 		/// operates on the list of macroblocks. Motion compensation is included.
 		if(!_pInterImgPlaneEncoder->Encode(allowedBits, &bitsUsed, 3))
 			return(0);	///< An error has occured.
+
+		/// Move the intra refresh band on for the next P-picture.
+		if(_intraRefresh > 0)
+			_intraRefreshPos = (_intraRefreshPos + 1) % _intraRefresh;
 	}//end else H264V2_INTER...
 
-	/// Write (concatinate) the macroblock layer (slice data) with its header 
-	/// flags to the stream.
-	runOutOfBits	= WriteSliceDataLayer(_pBitStreamWriter, allowedBits, &bitsUsed);
+	/// Write (concatinate) the macroblock layer (slice data) of the first slice 
+	/// with its header flags to the stream.
+	int firstSliceEndMb = _pSliceFirstMb[1];
+	if(_pSizedSliceFirstMb != NULL)
+		firstSliceEndMb = _pSizedSliceFirstMb[1];
+	runOutOfBits	= WriteSliceDataLayer(_pBitStreamWriter, 0, firstSliceEndMb - 1, allowedBits, &bitsUsed);
 
 	_bitStreamSize += bitsUsed;
   if(runOutOfBits) ///< or if(== 2) An error has occured.
@@ -1429,9 +2034,35 @@ int	H264v2Codec::Code(void* pSrc, void* pCmp, int codeParameter)
   if(runOutOfBits) ///< or if(== 2) An error has occured.
     return(0);
 
-	/// In-loop filter for 4x4 block boundaries to remove blocking artefacts.
-	if(_slice._disable_deblocking_filter_idc != 1)
-		ApplyLoopFilter();
+	/// The remaining slices are written as complete NAL units into the slice worker 
+	/// streams concurrently. Each may use all of the remaining bits and the total is 
+	/// checked when they are concatenated.
+	if(_numSlices > 1)
+	{
+		int s;
+		for(s = 1; s < _numSlices; s++)
+			_pSliceWorker[s]->_sliceAllowedBits = bitLimit - _bitStreamSize;
+		_pThreadPool->Run(H264v2Codec::WriteSliceNALUnitTask, (void *)this, _numSlices - 1);
+		for(s = 1; s < _numSlices; s++)
+		{
+			if(_pSliceWorker[s]->_sliceErr)
+			{
+				_errorStr = _pSliceWorker[s]->GetErrorStr();
+				return(0);
+			}//end if _sliceErr...
+		}//end for s...
+	}//end if _numSlices...
+
+	/// In-loop filter for 4x4 block boundaries to remove blocking artefacts. In row mode
+	/// only the last rows remain to be filtered. In pipelined mode it is deferred to 
+	/// overlap with the motion estimation of the next picture.
+	if( (_slice._disable_deblocking_filter_idc != 1)&&(!EndRowLoopFilter()) )
+	{
+		if(_pPrevLum != NULL)
+			_loopFilterPending = 1;
+		else
+			ApplyLoopFilter();
+	}//end if _disable_deblocking_filter_idc...
 
   /// Prevent start code emulation within the coded bit stream. The extra byte added
   /// to prevent the emulation is not counted as part of the bit written.
@@ -1444,6 +2075,31 @@ int	H264v2Codec::Code(void* pSrc, void* pCmp, int codeParameter)
     _bitStreamSize += InsertEmulationPrevention(_pBitStreamWriter, offset);
   }//end if _startCodeEmulationPrevention...
 
+	/// Concatenate the slice worker NAL units in slice order. Start code emulation 
+	/// prevention has already been applied to each of them. The trailing zero bits 
+	/// are not counted in the bit sizes and each NAL unit starts on a byte boundary.
+	if(_numSlices > 1)
+	{
+		unsigned char* pStream = (unsigned char *)_pBitStreamWriter->GetStream();
+		for(int s = 1; s < _numSlices; s++)
+		{
+			H264v2Codec* pWorker	= _pSliceWorker[s];
+			int bytePos						= (_bitStreamSize + 7)/8;
+			int sliceByteLen			= pWorker->GetCompressedByteLength();
+			if( (8*(bytePos + sliceByteLen)) > frameBitLimit )
+			{
+				_errorStr = "[H264V2Codec::Code] Bits required for slices exceeds max available for picture";
+				return(0);
+			}//end if bytePos...
+			memcpy((void *)&(pStream[bytePos]), (const void *)pWorker->_pSliceStreamMem, sliceByteLen);
+			_bitStreamSize = (8 * bytePos) + pWorker->_bitStreamSize;
+		}//end for s...
+	}//end if _numSlices...
+
+	/// The size bounded slices after the first follow as separate NAL units.
+	if( (_pSizedSliceFirstMb != NULL)&&!WriteSizedSliceNALUnits(bitLimit) )
+		return(0);
+
 	/// Any param changes required for the next picture encoding are done here.
   /// INTER pictures by default follow INTRA pictures.
   int tmpLastPicCodingType  = _lastPicCodingType;
@@ -1483,6 +2139,8 @@ int	H264v2Codec::Decode(void* pCmp, int bitLength, void* pDst)
 	int frameBitSize	= bitLength;
 	int bitsUsed			= 0;
 	int ret						= 1;
+	int streamByteLen, sliceCount, moreSlices, moreNonPicNALUnits;
+	int nextNalPos		= 0;
 
 	/// Set the bit stream access. The bit stream reader and related objects are instantiated within 
 	/// Open() and is therefore not available for non-picture NAL types. They are temporarily created 
@@ -1490,7 +2148,7 @@ int	H264v2Codec::Decode(void* pCmp, int bitLength, void* pDst)
   _bitStreamSize	= bitLength;
 	if(!_codecIsOpen)
   {
-		_pBitStreamReader				= new BitStreamReaderMSB();
+		_pBitStreamReader				= new FastBitStreamReaderMSB();
 		_pHeaderUnsignedVlcDec	= new ExpGolombUnsignedVlcDecoder();
 		_pHeaderSignedVlcDec		= new ExpGolombSignedVlcDecoder();
 		if( (_pBitStreamReader == NULL)||(_pHeaderUnsignedVlcDec == NULL)||(_pHeaderSignedVlcDec == NULL) )
@@ -1503,10 +2161,14 @@ int	H264v2Codec::Decode(void* pCmp, int bitLength, void* pDst)
 	/// Set the stream reader.
 	_pBitStreamReader->SetStream(pCmp, bitLength);
 
+	/// The decoded ref is compensated without the 1/2 pel planes.
+	if(_pRefPicture != NULL)
+		_pRefPicture->Invalidate();
+
   /// Typically in-band SPS and PPS are prepended to IDR frames. Therefore keep decoding until all
   /// non-picture NAL types are decoded. If the frameBitSize indicates at least 4 more bytes (32 bits)
   /// then we assume there is another NAL to be decoded.
-  int moreNonPicNALUnits = 1;
+  moreNonPicNALUnits = 1;
   while(moreNonPicNALUnits)
   {
     /// Extract the start code 0x00000001 from the stream.
@@ -1582,7 +2244,7 @@ int	H264v2Codec::Decode(void* pCmp, int bitLength, void* pDst)
             if(changed)
             {
               /// Preserve the bitstream
-	            IBitStreamReader* pTmpBitStreamReader = new BitStreamReaderMSB();
+	            IBitStreamReader* pTmpBitStreamReader = new FastBitStreamReaderMSB();
               pTmpBitStreamReader->Copy(_pBitStreamReader );
 
               int tmpPicCodingType = _pictureCodingType; ///< Store the coding type.
@@ -1649,52 +2311,159 @@ int	H264v2Codec::Decode(void* pCmp, int bitLength, void* pDst)
 		goto H264V2_D_CLEAN_MEM;
   }//end if !_codecIsOpen...
 
-  /// Remove prevention of start code emulation codes within the coded bit stream.
-  if(_startCodeEmulationPrevention)
-    frameBitSize -= RemoveEmulationPrevention(_pBitStreamReader);
-
-	/// Get the slice header encodings off the bit stream. As this implementation 
-	/// has only one slice, the slice header, slice data (macroblocks) and the 
-	/// slice trailing bits can be decoded in linear order.
-	runOutOfBits = ReadSliceLayerHeader(_pBitStreamReader, frameBitSize, &bitsUsed);
-	frameBitSize -= bitsUsed;
-  if(runOutOfBits > 0) ///< An error has occurred. 1 = run out of bits, 2 = vlc decode error.
-    return(0);
-	/// Load frame counter members from the decoded slice header.
-	_frameNum			= _slice._frame_num;
-	_idrFrameNum	= _slice._idr_pic_id;
-	/// Load the picture and sequence parameter set references.
-	_currPicParam = _slice._pic_parameter_set_id;
-	_currSeqParam = _picParam[_currPicParam]._seq_parameter_set_id;
-	/// There is only one slice so the quant parameter is picture quant + the delta slice quant.
-	_slice._qp		= _picParam[_currPicParam]._pic_init_qp_minus26 + 26 + _slice._qp_delta;
-	_pQuant				= _slice._qp;
+  /// Each slice of the picture is in its own NAL unit and they are decoded in stream order. The 
+  /// NAL unit extends to the next start code prefix or the end of the stream. Without start code 
+  /// emulation prevention the prefix cannot be searched for and only one slice per picture is 
+  /// supported.
+  streamByteLen	= (bitLength + 7)/8;
+  sliceCount		= 0;
+  moreSlices		= 1;
+  while(moreSlices)
+  {
+    unsigned char* pStream	= (unsigned char *)_pBitStreamReader->GetStream();
+    int nalStart	= _pBitStreamReader->GetStreamBytePos();
+    int nalEnd		= streamByteLen;
+    int pos;
+    if(_startCodeEmulationPrevention)
+    {
+      for(pos = nalStart + 2; pos < (streamByteLen - 1); pos++)
+      {
+        /// The next 15 positions cannot end a start code prefix when the 16 bytes from 2 
+        /// before hold no zeros.
+        if( ((pos + 14) < (streamByteLen - 1))&&!H264V2_AnyZero16(&(pStream[pos-2])) )
+        {
+          pos += 14;
+          continue;
+        }//end if pos...
+
+        if( (pStream[pos] == 1)&&(pStream[pos-1] == 0)&&(pStream[pos-2] == 0) )
+        {
+          nalEnd = pos - 2;
+          if( (nalEnd > nalStart)&&(pStream[nalEnd-1] == 0) )  ///< 32 bit start code.
+            nalEnd--;
+          break;
+        }//end if pStream...
+      }//end for pos...
+
+      /// Remove prevention of start code emulation codes within the NAL unit. The bytes
+      /// after the NAL unit are not moved.
+      nextNalPos = nalEnd;
+      nalEnd -= RemoveEmulationPrevention(_pBitStreamReader, nalStart, nalEnd - 1)/8;
+    }//end if _startCodeEmulationPrevention...
+
+    /// The slice bits extend up to the rbsp stop bit in the last non-zero byte.
+    int lastByte = nalEnd - 1;
+    while( (lastByte > nalStart)&&(pStream[lastByte] == 0) )
+      lastByte--;
+    int sliceBitSize = 8*(lastByte - nalStart);
+    for(pos = 0; (pos < 8)&&(((pStream[lastByte] >> pos) & 1) == 0); pos++);
+    sliceBitSize += (7 - pos);
+
+	  /// Get the slice header encodings off the bit stream.
+	  runOutOfBits = ReadSliceLayerHeader(_pBitStreamReader, sliceBitSize, &bitsUsed);
+	  sliceBitSize -= bitsUsed;
+    if(runOutOfBits > 0) ///< An error has occurred. 1 = run out of bits, 2 = vlc decode error.
+      return(0);
+	  /// Load frame counter members from the decoded slice header.
+	  _frameNum			= _slice._frame_num;
+	  _idrFrameNum	= _slice._idr_pic_id;
+	  /// Load the picture and sequence parameter set references.
+	  _currPicParam = _slice._pic_parameter_set_id;
+	  _currSeqParam = _picParam[_currPicParam]._seq_parameter_set_id;
+	  /// All slices use the same quant parameter as picture quant + the delta slice quant.
+	  _slice._qp		= _picParam[_currPicParam]._pic_init_qp_minus26 + 26 + _slice._qp_delta;
+	  _pQuant				= _slice._qp;
 
 #ifdef H264V2_DUMP_HEADERS
-  if(_headerTablePos < _headerTableLen)
-  {
-    _headerTable.WriteItem(0, _headerTablePos, _nal._unit_type);     /// "NALType"
-    _headerTable.WriteItem(1, _headerTablePos, _nal._ref_idc);       /// "NALRefIdc"
-    _headerTable.WriteItem(2, _headerTablePos, _slice._idr_pic_id);  ///  "IdrPicId"
-    _headerTable.WriteItem(3, _headerTablePos, _slice._frame_num);   ///  "FrmNum"
-    _headerTable.WriteItem(4, _headerTablePos, _slice._type);        ///  "SliceType"
-    _headerTable.WriteItem(5, _headerTablePos, _slice._qp);          ///  "Qp"
-
-    _headerTablePos++;
-  }//end if _headerTablePos...
+    if(_headerTablePos < _headerTableLen)
+    {
+      _headerTable.WriteItem(0, _headerTablePos, _nal._unit_type);     /// "NALType"
+      _headerTable.WriteItem(1, _headerTablePos, _nal._ref_idc);       /// "NALRefIdc"
+      _headerTable.WriteItem(2, _headerTablePos, _slice._idr_pic_id);  ///  "IdrPicId"
+      _headerTable.WriteItem(3, _headerTablePos, _slice._frame_num);   ///  "FrmNum"
+      _headerTable.WriteItem(4, _headerTablePos, _slice._type);        ///  "SliceType"
+      _headerTable.WriteItem(5, _headerTablePos, _slice._qp);          ///  "Qp"
+
+      _headerTablePos++;
+    }//end if _headerTablePos...
 #endif // H264V2_DUMP_HEADERS
 
-	/// Get the macroblock (slice data) encodings off the bit stream.
-	runOutOfBits = ReadSliceDataLayer(_pBitStreamReader, frameBitSize, &bitsUsed);
-	frameBitSize -= bitsUsed;
-  if(runOutOfBits > 0) ///< An error has occurred. 1 = run out of bits, 2 = vlc decode error.
-    return(0);
+    /// Re-partition the macroblocks from the first macroblock of this slice to the end of the 
+    /// picture. Subsequent slices overwrite their part. A single slice picture that matches
+    /// the current partition is left as is.
+    int firstMb = _slice._first_mb_in_slice;
+    if( (firstMb < 0)||(firstMb >= _mbLength) )
+    {
+		  _errorStr = "[H264Codec::Decode] Invalid first macroblock in slice";
+      return(0);
+    }//end if firstMb...
+    if( (firstMb != 0)&&!_startCodeEmulationPrevention )
+    {
+		  _errorStr = "[H264Codec::Decode] Multiple slices per picture require start code emulation prevention";
+      return(0);
+    }//end if firstMb...
+    if( (firstMb != 0)||(_pMb[_mbLength-1]._slice != 0) )
+    {
+      int mbWidth		= _lumWidth/16;
+      int mbHeight	= _lumHeight/16;
+      int rowEndMb	= ((firstMb/mbWidth) * mbWidth) + mbWidth - 1;
+      /// Initialise() only operates on whole column spans and a partial first row is done separately.
+      MacroBlockH264::Initialise(mbHeight, mbWidth, firstMb, rowEndMb, sliceCount, _Mb);
+      if(rowEndMb < (_mbLength - 1))
+        MacroBlockH264::Initialise(mbHeight, mbWidth, rowEndMb + 1, _mbLength - 1, sliceCount, _Mb);
+    }//end if firstMb...
+
+	  /// Get the macroblock (slice data) encodings off the bit stream.
+	  runOutOfBits = ReadSliceDataLayer(_pBitStreamReader, firstMb, sliceBitSize, &bitsUsed);
+	  frameBitSize -= bitsUsed;
+    if(runOutOfBits > 0) ///< An error has occurred. 1 = run out of bits, 2 = vlc decode error.
+      return(0);
 
-	/// Get the slice trailing bits off the bit stream. 
-	runOutOfBits = ReadTrailingBits(_pBitStreamReader, frameBitSize, &bitsUsed);
-	frameBitSize -= bitsUsed;
-  if(runOutOfBits > 0) ///< An error has occurred. 1 = run out of bits, 2 = vlc decode error.
-    return(0);
+	  /// Get the slice trailing bits off the bit stream. 
+	  runOutOfBits = ReadTrailingBits(_pBitStreamReader, 8, &bitsUsed);
+    if(runOutOfBits > 0) ///< An error has occurred. 1 = run out of bits, 2 = vlc decode error.
+      return(0);
+    sliceCount++;
+
+    /// Move on to the next slice NAL unit of the same picture if there is one.
+    moreSlices = 0;
+    if( (_startCodeEmulationPrevention)&&((nextNalPos + 4) < streamByteLen) )
+    {
+      int startCodeLen = 32;
+      if(pStream[nextNalPos + 2] == 1)
+        startCodeLen = 24;
+      _pBitStreamReader->Seek((nextNalPos << 3) + 7);  ///< MSB of the byte.
+      if(_pBitStreamReader->Read(startCodeLen) != 1)
+      {
+		    _errorStr = "[H264Codec::Decode] Cannot extract slice start code from stream";
+        return(0);
+      }//end if Read...
+
+      int unitType = _nal._unit_type;
+	    runOutOfBits = ReadNALHeader(_pBitStreamReader, 8, &bitsUsed);
+      if( (runOutOfBits > 0)||(_nal._unit_type != unitType) )
+      {
+		    _errorStr = "[H264Codec::Decode] Slice NAL unit type differs within picture";
+        return(0);
+      }//end if runOutOfBits...
+      moreSlices = 1;
+    }//end if _startCodeEmulationPrevention...
+    else if(!_startCodeEmulationPrevention)
+    {
+      /// The single slice NAL unit must extend to the end of the stream. A following start code 
+      /// prefix belongs to another slice that cannot be separated from this one.
+      int p = _pBitStreamReader->GetStreamBytePos();
+      if( ((p + 3) < streamByteLen)&&(pStream[p] == 0)&&(pStream[p+1] == 0)&&
+          ((pStream[p+2] == 1)||((pStream[p+2] == 0)&&(pStream[p+3] == 1))) )
+      {
+		    _errorStr = "[H264Codec::Decode] Multiple slices per picture require start code emulation prevention";
+        return(0);
+      }//end if p...
+    }//end else if !_startCodeEmulationPrevention...
+  }//end while moreSlices...
+
+  /// The plane decoders may loop filter the macroblock rows as they are reconstructed.
+	StartRowLoopFilter(0);
 
   /// INTRA frames require the reference images to be zeroed.
 	if(_pictureCodingType == H264V2_INTRA)
@@ -1715,8 +2484,9 @@ int	H264v2Codec::Decode(void* pCmp, int bitLength, void* pDst)
 			return(0);	///< An error has occured.
 	}//end else INTER...
 
-	/// In-loop filter for 4x4 block boundaries to remove blocking artefacts.
-	if(_slice._disable_deblocking_filter_idc != 1)
+	/// In-loop filter for 4x4 block boundaries to remove blocking artefacts. In row mode
+	/// only the last rows remain to be filtered.
+	if( (_slice._disable_deblocking_filter_idc != 1)&&(!EndRowLoopFilter()) )
 		ApplyLoopFilter();
 
   /// Convert to the output image depending on the output dimension settings. Set
@@ -1764,6 +2534,9 @@ int H264v2Codec::Close(void)
   _headerTablePos = 0;
 #endif // H264V2_DUMP_HEADERS
 
+	/// The slice workers share the image and macroblock mem and are closed first.
+	CloseSliceWorkers();
+
 	/// Free the image memory and associated overlays.
 	if(_Lum != NULL)
 		delete _Lum;
@@ -1935,6 +2708,24 @@ int H264v2Codec::Close(void)
 		delete[] _autoIFrameIncluded;
 	_autoIFrameIncluded = NULL;
 
+	if(_pCoeffCache != NULL)
+		delete[] _pCoeffCache;
+	_pCoeffCache = NULL;
+	if(_pCoeffCacheValid != NULL)
+		delete[] _pCoeffCacheValid;
+	_pCoeffCacheValid = NULL;
+
+	if(_pMotionPredMb != NULL)
+		delete[] _pMotionPredMb;
+	_pMotionPredMb = NULL;
+	if(_MotionPredMb != NULL)
+		delete[] _MotionPredMb;
+	_MotionPredMb = NULL;
+	if(_pPrevLum != NULL)
+		delete[] _pPrevLum;
+	_pPrevLum						= NULL;
+	_loopFilterPending	= 0;
+
 	/// Stream access.
 	if(_pBitStreamWriter != NULL)
 		delete _pBitStreamWriter;
@@ -1962,6 +2753,14 @@ int H264v2Codec::Close(void)
 		delete _pMotionPredictor;
 	_pMotionPredictor = NULL;
 
+	if(_pRefPicture != NULL)
+		delete _pRefPicture;
+	_pRefPicture = NULL;
+
+	if(_pLookahead != NULL)
+		delete _pLookahead;
+	_pLookahead = NULL;
+
 	/// Image plane encoders/decoders.
 	if(_pIntraImgPlaneEncoder != NULL)
 		delete _pIntraImgPlaneEncoder;
@@ -1993,6 +2792,7 @@ void H264v2Codec::Restart(void)
 	/// held in contiguous mem.
 	int imgSize = (_lumWidth * _lumHeight) + 2*(_chrWidth * _chrHeight);
 	memset(_pRLum, 0, imgSize * sizeof(short));
+	_loopFilterPending = 0;
 
 }//end Restart.
 
@@ -2001,6 +2801,594 @@ void H264v2Codec::Restart(void)
   Private Implementation.                                
 -----------------------------------------------------------------------
 */
+/** Instantiate the IT filters.
+Create Integer Transformers (IT) and their inverses for AC and DC coeffs with 
+their default modes. Factored out of Open() for use by the slice workers too.
+@return : 1 = success, 0 = failure.
+*/
+int H264v2Codec::CreateITFilters(void)
+{
+	/// Create Integer Transformers (IT) and their inverses for AC and DC coeffs. The
+	/// quantisers are included in the IT transform classes. The 4x4 AC transforms run
+	/// on every block and use the SSE2 classes where available.
+#ifdef RTVC_SIMD
+	_pF4x4TLum  = new FastSimdForward4x4ITImpl1();
+	_pF4x4TChr  = new FastSimdForward4x4ITImpl1();
+#else
+	_pF4x4TLum  = new FastForward4x4ITImpl2();
+	_pF4x4TChr  = new FastForward4x4ITImpl2();
+#endif
+	_pFDC4x4T   = new FastForwardDC4x4ITImpl1();
+	_pFDC2x2T   = new FastForwardDC2x2ITImpl1();
+#ifdef RTVC_SIMD
+	_pI4x4TLum  = new FastSimdInverse4x4ITImpl1();
+	_pI4x4TChr  = new FastSimdInverse4x4ITImpl1();
+#else
+	_pI4x4TLum  = new FastInverse4x4ITImpl1();
+	_pI4x4TChr  = new FastInverse4x4ITImpl1();
+#endif
+	_pIDC4x4T   = new FastInverseDC4x4ITImpl1();
+	_pIDC2x2T   = new FastInverseDC2x2ITImpl1();
+
+	if( (_pF4x4TLum == NULL)||(_pF4x4TChr == NULL)||(_pFDC4x4T == NULL)||(_pFDC2x2T == NULL)||(_pI4x4TLum == NULL)||(_pI4x4TChr == NULL)||(_pIDC4x4T == NULL)||(_pIDC2x2T == NULL) )
+  {
+    _errorStr = "[H264Codec::CreateITFilters] Cannot instantiate Integer Transform filter objects";
+	  return(0);
+  }//end if !_pF4x4TLum...
+
+	/// Set default modes and added scaling for IT filters.
+	_pF4x4TLum->SetMode(IForwardTransform::TransformOnly);
+	_pF4x4TChr->SetMode(IForwardTransform::TransformOnly);
+	_pFDC4x4T->SetMode(IForwardTransform::TransformAndQuant);
+	_pFDC2x2T->SetMode(IForwardTransform::TransformAndQuant);
+	_pI4x4TLum->SetMode(IInverseTransform::TransformOnly);
+	_pI4x4TChr->SetMode(IInverseTransform::TransformOnly);
+	_pIDC4x4T->SetMode(IInverseTransform::TransformAndQuant);
+	_pIDC2x2T->SetMode(IInverseTransform::TransformAndQuant);
+
+	return(1);
+}//end CreateITFilters.
+
+/** Instantiate the vlc encoders and decoders.
+Create the vlc codecs and attach them to the CAVLC codecs. Factored out of Open() 
+for use by the slice workers too.
+@return : 1 = success, 0 = failure.
+*/
+int H264v2Codec::CreateVlcCodecs(void)
+{
+	/// Create the vlc encoders and decoders for use with CAVLC.
+	_pPrefixVlcEnc					= new PrefixH264VlcEncoderImpl1();
+	_pPrefixVlcDec					= new PrefixH264VlcDecoderImpl1();
+	_pCoeffTokenVlcEnc			= new CoeffTokenH264VlcEncoder();
+	_pTotalZeros4x4VlcEnc		= new TotalZeros4x4H264VlcEncoder();
+	_pTotalZeros2x2VlcEnc		= new TotalZeros2x2H264VlcEncoder();
+	_pRunBeforeVlcEnc				= new RunBeforeH264VlcEncoder();
+	if(_tableVlcDecoders)	///< Resolve the symbols with table lookups.
+	{
+		_pCoeffTokenVlcDec		= new CoeffTokenH264VlcDecoderImpl2();
+		_pTotalZeros4x4VlcDec	= new TotalZeros4x4H264VlcDecoderImpl2();
+		_pTotalZeros2x2VlcDec	= new TotalZeros2x2H264VlcDecoderImpl2();
+		_pRunBeforeVlcDec			= new RunBeforeH264VlcDecoderImpl2();
+	}//end if _tableVlcDecoders...
+	else									///< Walk the code trees a bit at a time.
+	{
+		_pCoeffTokenVlcDec		= new CoeffTokenH264VlcDecoder();
+		_pTotalZeros4x4VlcDec	= new TotalZeros4x4H264VlcDecoder();
+		_pTotalZeros2x2VlcDec	= new TotalZeros2x2H264VlcDecoder();
+		_pRunBeforeVlcDec			= new RunBeforeH264VlcDecoder();
+	}//end else...
+
+	/// Vlc encoder and decoder for the coded block pattern.
+	_pBlkPattVlcEnc	= new CodedBlkPatternH264VlcEncoder();
+	_pBlkPattVlcDec	= new CodedBlkPatternH264VlcDecoder();
+
+	/// Vlc encoder and decoder for the delta QP.
+	_pDeltaQPVlcEnc	= new ExpGolombSignedVlcEncoder();
+	_pDeltaQPVlcDec	= new ExpGolombSignedVlcDecoder();
+
+	/// Vlc encoder and decoder for the macroblock type.
+	_pMbTypeVlcEnc	= new ExpGolombUnsignedVlcEncoder();
+	_pMbTypeVlcDec	= new ExpGolombUnsignedVlcDecoder();
+
+	/// Vlc encoder and decoder for intra chr pred mode. ExpGolomb codecs
+	/// are stateless therefore they can be reused.
+	_pMbIChrPredModeVlcEnc	= _pMbTypeVlcEnc;
+	_pMbIChrPredModeVlcDec	= _pMbTypeVlcDec;
+
+	/// Vlc encoder and decoder for motion vector differences. ExpGolomb codecs
+	/// are stateless therefore they can be reused.
+	_pMbMotionVecDiffVlcEnc	= _pDeltaQPVlcEnc;
+	_pMbMotionVecDiffVlcDec	= _pDeltaQPVlcDec;
+
+	/// Vlc encoder and decoder for general headers. ExpGolomb codecs
+	/// are stateless therefore they can be reused.
+	_pHeaderUnsignedVlcEnc	= _pMbTypeVlcEnc;	
+	_pHeaderUnsignedVlcDec	= _pMbTypeVlcDec;
+	_pHeaderSignedVlcEnc		= _pDeltaQPVlcEnc;
+	_pHeaderSignedVlcDec		= _pDeltaQPVlcDec;
+
+	if( (_pPrefixVlcEnc == NULL)||(_pPrefixVlcDec == NULL)||
+			(_pCoeffTokenVlcEnc == NULL)||(_pCoeffTokenVlcDec == NULL) ||
+			(_pTotalZeros4x4VlcEnc == NULL)||(_pTotalZeros4x4VlcDec == NULL) ||
+			(_pTotalZeros2x2VlcEnc == NULL)||(_pTotalZeros2x2VlcDec == NULL) ||
+			(_pRunBeforeVlcEnc == NULL)||(_pRunBeforeVlcDec == NULL) ||
+			(_pBlkPattVlcEnc == NULL)||(_pBlkPattVlcDec == NULL) ||
+			(_pDeltaQPVlcEnc == NULL)||(_pDeltaQPVlcDec == NULL) ||
+			(_pMbTypeVlcEnc == NULL)||(_pMbTypeVlcDec == NULL) )
+  {
+		_errorStr = "[H264Codec::CreateVlcCodecs] Cannot instantiate Vlc codec objects";
+	  return(0);
+  }//end if !_pPrefixVlcEnc...
+
+	/// Create a CAVLC encoder and decoder for each coeff block size.
+	_pCAVLC4x4 = new CAVLCH264Impl();
+	_pCAVLC2x2 = new CAVLCH264Impl();
+	if( (_pCAVLC4x4 == NULL)||(_pCAVLC2x2 == NULL) )
+  {
+    _errorStr = "[H264Codec::CreateVlcCodecs] Cannot instantiate CAVLC codec objects";
+	  return(0);
+  }//end if !_pCAVLC4x4...
+
+	/// Attach the vlc encoders and decoders to the associated CAVLC.
+	_pCAVLC4x4->SetMode(CAVLCH264Impl::Mode4x4);
+	((CAVLCH264Impl *)_pCAVLC4x4)->SetTokenCoeffVlcEncoder(_pCoeffTokenVlcEnc);
+	((CAVLCH264Impl *)_pCAVLC4x4)->SetTokenCoeffVlcDecoder(_pCoeffTokenVlcDec);
+	((CAVLCH264Impl *)_pCAVLC4x4)->SetPrefixVlcEncoder(_pPrefixVlcEnc);
+	((CAVLCH264Impl *)_pCAVLC4x4)->SetPrefixVlcDecoder(_pPrefixVlcDec);
+	((CAVLCH264Impl *)_pCAVLC4x4)->SetRunBeforeVlcEncoder(_pRunBeforeVlcEnc);
+	((CAVLCH264Impl *)_pCAVLC4x4)->SetRunBeforeVlcDecoder(_pRunBeforeVlcDec);
+	((CAVLCH264Impl *)_pCAVLC4x4)->SetTotalZerosVlcEncoder(_pTotalZeros4x4VlcEnc);
+	((CAVLCH264Impl *)_pCAVLC4x4)->SetTotalZerosVlcDecoder(_pTotalZeros4x4VlcDec);
+
+	_pCAVLC2x2->SetMode(CAVLCH264Impl::Mode2x2);
+	((CAVLCH264Impl *)_pCAVLC2x2)->SetTokenCoeffVlcEncoder(_pCoeffTokenVlcEnc);
+	((CAVLCH264Impl *)_pCAVLC2x2)->SetTokenCoeffVlcDecoder(_pCoeffTokenVlcDec);
+	((CAVLCH264Impl *)_pCAVLC2x2)->SetPrefixVlcEncoder(_pPrefixVlcEnc);
+	((CAVLCH264Impl *)_pCAVLC2x2)->SetPrefixVlcDecoder(_pPrefixVlcDec);
+	((CAVLCH264Impl *)_pCAVLC2x2)->SetRunBeforeVlcEncoder(_pRunBeforeVlcEnc);
+	((CAVLCH264Impl *)_pCAVLC2x2)->SetRunBeforeVlcDecoder(_pRunBeforeVlcDec);
+	((CAVLCH264Impl *)_pCAVLC2x2)->SetTotalZerosVlcEncoder(_pTotalZeros2x2VlcEnc);
+	((CAVLCH264Impl *)_pCAVLC2x2)->SetTotalZerosVlcDecoder(_pTotalZeros2x2VlcDec);
+
+	return(1);
+}//end CreateVlcCodecs.
+
+/** Open this codec as a slice worker of an open owner codec.
+The worker copies the coding parameters and param sets of the owner and shares its 
+image and macroblock mem. The overlays, temp blocks, IT filters, vlc codecs and the 
+bit stream writer are private to the worker so that slices may be coded concurrently.
+The worker is not open in the codec sense and must be closed by CloseSliceWorkers().
+@param pOwner					: Open owner codec.
+@param pStream				: Stream mem for this worker's slice NAL units.
+@param streamByteLen	: Byte length of pStream.
+@return								: 1 = success, 0 = failure.
+*/
+int H264v2Codec::OpenSliceWorker(H264v2Codec* pOwner, unsigned char* pStream, int streamByteLen)
+{
+	/// Coding parameters and the current param sets.
+	_width												= pOwner->_width;
+	_height												= pOwner->_height;
+	_modeOfOperation							= pOwner->_modeOfOperation;
+	_earlyTermination							= pOwner->_earlyTermination;
+	_pQuant												= pOwner->_pQuant;
+	_startCodeEmulationPrevention	= pOwner->_startCodeEmulationPrevention;
+	_currSeqParam									= pOwner->_currSeqParam;
+	_currPicParam									= pOwner->_currPicParam;
+	_seqParam[_currSeqParam].Copy(&(pOwner->_seqParam[_currSeqParam]));
+	_picParam[_currPicParam].Copy(&(pOwner->_picParam[_currPicParam]));
+	_slice												= pOwner->_slice;
+	_nal													= pOwner->_nal;
+
+	/// Shared image mem.
+	_lumWidth		= pOwner->_lumWidth;
+	_lumHeight	= pOwner->_lumHeight;
+	_chrWidth		= pOwner->_chrWidth;
+	_chrHeight	= pOwner->_chrHeight;
+	_pLum				= pOwner->_pLum;
+	_pChrU			= pOwner->_pChrU;
+	_pChrV			= pOwner->_pChrV;
+	_pRLum			= pOwner->_pRLum;
+	_pRChrU			= pOwner->_pRChrU;
+	_pRChrV			= pOwner->_pRChrV;
+
+	/// Shared macroblock data objects.
+	_pMb							= pOwner->_pMb;
+	_Mb								= pOwner->_Mb;
+	_mbLength					= pOwner->_mbLength;
+	_pCoeffCache			= pOwner->_pCoeffCache;
+	_pCoeffCacheValid	= pOwner->_pCoeffCacheValid;
+
+	/// Private overlays onto the shared img mem.
+	_Lum		= new OverlayMem2Dv2(_pLum, _lumWidth, _lumHeight, 16, 16);
+	_RefLum	= new OverlayMem2Dv2(_pRLum, _lumWidth, _lumHeight, 16, 16);
+	_Cb			= new OverlayMem2Dv2(_pChrU, _chrWidth, _chrHeight, 8, 8);
+	_RefCb	= new OverlayMem2Dv2(_pRChrU, _chrWidth, _chrHeight, 8, 8);
+	_Cr			= new OverlayMem2Dv2(_pChrV, _chrWidth, _chrHeight, 8, 8);
+	_RefCr	= new OverlayMem2Dv2(_pRChrV, _chrWidth, _chrHeight, 8, 8);
+	if( (_Lum == NULL)||(_RefLum == NULL)||(_Cb == NULL)||							
+			(_RefCb == NULL)||(_Cr == NULL)||(_RefCr == NULL) )
+  {
+    _errorStr = "[H264Codec::OpenSliceWorker] Cannot instantiate image and reference overlay objects";
+	  return(0);
+  }//end if !_Lum...
+
+	/// Private prediction mem.
+	_p16x16 = new short[256];
+	_16x16	= new OverlayMem2Dv2(_p16x16, 16, 16, 16, 16);
+	_p8x8_0 = new short[64];
+	_8x8_0	= new OverlayMem2Dv2(_p8x8_0, 8, 8, 8, 8);
+	_p8x8_1 = new short[64];
+	_8x8_1	= new OverlayMem2Dv2(_p8x8_1, 8, 8, 8, 8);
+  if( (_p16x16 == NULL)||(_16x16 == NULL) ||																
+			(_p8x8_0 == NULL)||(_8x8_0 == NULL) || 
+			(_p8x8_1 == NULL)||(_8x8_1 == NULL) )
+  {
+    _errorStr = "[H264Codec::OpenSliceWorker] Cannot create prediction memory objects";
+	  return(0);
+  }//end if !_p16x16...
+
+	if(!CreateITFilters())
+		return(0);	///< Error string is set in the method.
+	if(!CreateVlcCodecs())
+		return(0);
+
+	/// Private bit stream for the slice NAL units.
+	_pBitStreamWriter = new FastBitStreamWriterMSB();
+	if(_pBitStreamWriter == NULL)
+  {
+    _errorStr = "[H264Codec::OpenSliceWorker] Cannot instantiate bit stream access object";
+	  return(0);
+  }//end if !_pBitStreamWriter...
+	_pSliceStreamMem		= pStream;
+	_sliceStreamByteLen	= streamByteLen;
+
+	return(1);
+}//end OpenSliceWorker.
+
+/** Close and delete the slice workers.
+The shared mem references are removed from each worker before it is closed
+so that only the worker's private objects are deleted.
+@return : none.
+*/
+void H264v2Codec::CloseSliceWorkers(void)
+{
+	if(_pSliceWorker != NULL)
+	{
+		for(int i = 1; i < _numWorkers; i++)
+		{
+			H264v2Codec* pWorker = _pSliceWorker[i];
+			if(pWorker != NULL)
+			{
+				pWorker->_pLum						= NULL;
+				pWorker->_pChrU						= NULL;
+				pWorker->_pChrV						= NULL;
+				pWorker->_pRLum						= NULL;
+				pWorker->_pRChrU					= NULL;
+				pWorker->_pRChrV					= NULL;
+				pWorker->_pMb							= NULL;
+				pWorker->_Mb							= NULL;
+				pWorker->_pCoeffCache			= NULL;
+				pWorker->_pCoeffCacheValid	= NULL;
+				pWorker->_pSliceStreamMem	= NULL;
+				pWorker->Close();
+				delete pWorker;
+			}//end if pWorker...
+		}//end for i...
+		delete[] _pSliceWorker;
+	}//end if _pSliceWorker...
+	_pSliceWorker = NULL;
+
+	if(_pSliceStreamMem != NULL)
+		delete[] _pSliceStreamMem;
+	_pSliceStreamMem		= NULL;
+	_sliceStreamByteLen	= 0;
+
+	if(_pThreadPool != NULL)
+		delete _pThreadPool;
+	_pThreadPool = NULL;
+
+	if(_pWavefrontSync != NULL)
+		delete _pWavefrontSync;
+	_pWavefrontSync = NULL;
+
+	if(_pSliceFirstMb != NULL)
+		delete[] _pSliceFirstMb;
+	_pSliceFirstMb	= NULL;
+	_numSlices			= 1;
+
+	if(_pSizedSliceFirstMb != NULL)
+		delete[] _pSizedSliceFirstMb;
+	_pSizedSliceFirstMb	= NULL;
+	_numSizedSlices			= 1;
+	_numWorkers			= 1;
+}//end CloseSliceWorkers.
+
+/** Code one complete slice NAL unit in a slice worker.
+The start code, NAL header, slice header, slice data and trailing bits are written 
+to the worker's stream mem followed by start code emulation prevention. The _slice
+and _nal members must be set by the owner before calling this method. The total
+bits written is held in _bitStreamSize.
+@param firstMb			: First macroblock index of the slice.
+@param lastMb				: Last macroblock index of the slice.
+@param allowedBits	: Upper limit to the writable bits.
+@return							: 1 = success, 0 = failure.
+*/
+int H264v2Codec::WriteSliceNALUnit(int firstMb, int lastMb, int allowedBits)
+{
+	int bitsUsed;
+
+	/// Leave room in the stream mem for the emulation prevention bytes.
+	int maxBits = (_sliceStreamByteLen * 8 * 2)/3;
+	if(allowedBits > maxBits)
+		allowedBits = maxBits;
+
+	_bitStreamSize = 0;
+	_pBitStreamWriter->SetStream(_pSliceStreamMem, _sliceStreamByteLen * 8);
+
+	if(allowedBits < 32)
+  {
+		_errorStr = "[H264V2Codec::WriteSliceNALUnit] Cannot write start code to stream";
+    return(0);
+  }//end if allowedBits...
+  _pBitStreamWriter->Write(32,1);
+  _bitStreamSize += 32;
+
+	if(WriteNALHeader(_pBitStreamWriter, allowedBits - _bitStreamSize, &bitsUsed))
+		return(0);
+	_bitStreamSize += bitsUsed;
+
+	if(WriteSliceLayerHeader(_pBitStreamWriter, allowedBits - _bitStreamSize, &bitsUsed))
+		return(0);
+	_bitStreamSize += bitsUsed;
+
+	if(WriteSliceDataLayer(_pBitStreamWriter, firstMb, lastMb, allowedBits - _bitStreamSize - 1, &bitsUsed))
+		return(0);
+	_bitStreamSize += bitsUsed;
+
+	if(WriteTrailingBits(_pBitStreamWriter, allowedBits - _bitStreamSize, &bitsUsed))
+		return(0);
+	_bitStreamSize += bitsUsed;
+
+  if(_startCodeEmulationPrevention)
+    _bitStreamSize += InsertEmulationPrevention(_pBitStreamWriter, 0);
+
+	return(1);
+}//end WriteSliceNALUnit.
+
+/** Thread pool task to code the slice NAL unit of a slice worker.
+@param pParam	: The owner codec.
+@param index	: Slice worker index - 1.
+@return				: none.
+*/
+void H264v2Codec::WriteSliceNALUnitTask(void* pParam, int index)
+{
+	H264v2Codec*	pOwner	= (H264v2Codec *)pParam;
+	int						slice		= index + 1;
+	H264v2Codec*	pWorker	= pOwner->_pSliceWorker[slice];
+
+	pWorker->_sliceErr = 0;
+	if(!pWorker->WriteSliceNALUnit(pOwner->_pSliceFirstMb[slice], pOwner->_pSliceFirstMb[slice+1] - 1, pWorker->_sliceAllowedBits))
+		pWorker->_sliceErr = 1;
+}//end WriteSliceNALUnitTask.
+
+/** Start the size bounded slices of a picture.
+The picture begins as a single slice with the first slice header that has
+been written and the plane encoders start the next slices as they fit the
+macroblocks in raster order.
+@param headerBits	: Bits of the first slice header.
+@return						: none.
+*/
+void H264v2Codec::StartSizedSlices(int headerBits)
+{
+	/// Restore the single slice neighbourhood after the partition of the previous picture.
+	if(_numSizedSlices > 1)
+		MacroBlockH264::Initialise(_lumHeight/16, _lumWidth/16, 0, _mbLength - 1, 0, _Mb);
+
+	_numSizedSlices					= 1;
+	_pSizedSliceFirstMb[0]	= 0;
+	_pSizedSliceFirstMb[1]	= _mbLength;
+	_sizedSliceHeaderBits		= headerBits;
+	_sizedSliceDataBits			= 0;
+	_sizedSliceSkipRun			= 0;
+}//end StartSizedSlices.
+
+/** Fit a processed macroblock into the current size bounded slice.
+The macroblock is counted onto the slice if the NAL unit of the slice, 
+excluding the start code and emulation prevention bytes, remains within 
+"max slice bytes". Otherwise the next slice is started at the macroblock 
+and its neighbourhood is re-partitioned. The macroblock must then be coded 
+again with its new neighbours and fitted a second time. The first macroblock 
+of a slice always fits.
+@param mb	: Macroblock index in raster order.
+@return		: 1 = fitted, 0 = a new slice starts at the macroblock.
+*/
+int H264v2Codec::FitSizedSliceMb(int mb)
+{
+	MacroBlockH264* pMb = &(_pMb[mb]);
+	int dataBits	= _sizedSliceDataBits;
+	int skipRun		= 0;
+
+	if(pMb->_skip)
+	{
+		skipRun = _sizedSliceSkipRun + 1;
+		/// Ensure coeffs settings are synchronised for future use by neighbours.
+		for(int i = 0; i < MBH264_NUM_BLKS; i++)
+			pMb->_blkParam[i].pBlk->SetNumCoeffs(0);
+	}//end if _skip...
+	else
+	{
+		/// P-slices code the skip run before every non-skipped macroblock.
+		if(_pictureCodingType == H264V2_INTER)
+			dataBits += _pHeaderUnsignedVlcEnc->Encode(_sizedSliceSkipRun);
+		dataBits += MacroBlockLayerBitCounter(pMb);
+	}//end else...
+
+	/// NAL header, slice header, slice data with a final skip run and the rbsp stop bit 
+	/// up to the byte boundary.
+	int bits = 8 + _sizedSliceHeaderBits + dataBits + 1;
+	if(skipRun)
+		bits += _pHeaderUnsignedVlcEnc->Encode(skipRun);
+
+	if( (((bits + 7)/8) <= _sizedSliceBytes)||(mb == _pSizedSliceFirstMb[_numSizedSlices - 1]) )
+	{
+		_sizedSliceDataBits	= dataBits;
+		_sizedSliceSkipRun	= skipRun;
+		return(1);
+	}//end if bits...
+
+	/// Re-partition the macroblocks from this macroblock to the end of the picture as the 
+	/// next slice. Initialise() only operates on whole column spans and a partial first 
+	/// row is done separately.
+	int mbWidth		= _lumWidth/16;
+	int mbHeight	= _lumHeight/16;
+	int rowEndMb	= ((mb/mbWidth) * mbWidth) + mbWidth - 1;
+	MacroBlockH264::Initialise(mbHeight, mbWidth, mb, rowEndMb, _numSizedSlices, _Mb);
+	if(rowEndMb < (_mbLength - 1))
+		MacroBlockH264::Initialise(mbHeight, mbWidth, rowEndMb + 1, _mbLength - 1, _numSizedSlices, _Mb);
+
+	_pSizedSliceFirstMb[_numSizedSlices++]	= mb;
+	_pSizedSliceFirstMb[_numSizedSlices]		= _mbLength;
+
+	/// The slice headers differ only in their first macroblock.
+	int firstMbInSlice					= _slice._first_mb_in_slice;
+	_slice._first_mb_in_slice		= mb;
+	WriteSliceLayerHeader(NULL, 0x7FFFFFFF, &_sizedSliceHeaderBits);
+	_slice._first_mb_in_slice		= firstMbInSlice;
+	_sizedSliceDataBits					= 0;
+	_sizedSliceSkipRun					= 0;
+
+	return(0);
+}//end FitSizedSliceMb.
+
+/** Write the size bounded slices after the first slice to the stream.
+Each slice is a complete NAL unit with its own start code, NAL header, 
+slice header and trailing bits. The first slice must have been written 
+with its start code emulation prevention applied and the prevention is 
+applied to each of the following NAL units in turn.
+@param bitLimit	: Picture bit limit of the stream.
+@return					: 1 = success, 0 = failure.
+*/
+int H264v2Codec::WriteSizedSliceNALUnits(int bitLimit)
+{
+	int bitsUsed, ret;
+	int firstMbInSlice = _slice._first_mb_in_slice;
+
+	for(int s = 1; s < _numSizedSlices; s++)
+	{
+		/// Continue after any emulation prevention bytes of the previous NAL unit. The trailing 
+		/// zero bits are not counted in the bit size and each NAL unit starts on a byte boundary.
+		int bytePos			= (_bitStreamSize + 7)/8;
+		_bitStreamSize	= 8 * bytePos;
+		if( ((bitLimit - _bitStreamSize) < 32)||!_pBitStreamWriter->Seek((bytePos << 3) + 7) )	///< MSB of the byte.
+		{
+			_errorStr = "[H264V2Codec::WriteSizedSliceNALUnits] Bits required for slices exceeds max available for picture";
+			return(0);
+		}//end if bitLimit...
+		_pBitStreamWriter->Write(32,1);
+		_bitStreamSize += 32;
+
+		if(WriteNALHeader(_pBitStreamWriter, bitLimit - _bitStreamSize, &bitsUsed))
+			return(0);
+		_bitStreamSize += bitsUsed;
+
+		_slice._first_mb_in_slice = _pSizedSliceFirstMb[s];
+		ret = WriteSliceLayerHeader(_pBitStreamWriter, bitLimit - _bitStreamSize, &bitsUsed);
+		_slice._first_mb_in_slice = firstMbInSlice;
+		if(ret)
+			return(0);
+		_bitStreamSize += bitsUsed;
+
+		if(WriteSliceDataLayer(_pBitStreamWriter, _pSizedSliceFirstMb[s], _pSizedSliceFirstMb[s+1] - 1, bitLimit - _bitStreamSize - 1, &bitsUsed))
+			return(0);
+		_bitStreamSize += bitsUsed;
+
+		if(WriteTrailingBits(_pBitStreamWriter, bitLimit - _bitStreamSize, &bitsUsed))
+			return(0);
+		_bitStreamSize += bitsUsed;
+
+		if(_startCodeEmulationPrevention)
+			_bitStreamSize += InsertEmulationPrevention(_pBitStreamWriter, bytePos);
+	}//end for s...
+
+	return(1);
+}//end WriteSizedSliceNALUnits.
+
+/** Run one stage of the pipelined motion estimation.
+Index 0 estimates the motion of the current input img against the previous input img 
+and index 1 applies the deferred loop filter of the previous picture to the ref img.
+The stages share no img mem or macroblock vectors.
+@param pParam	: Owner codec.
+@param index	: Stage.
+@return				: none.
+*/
+void H264v2Codec::PipelineTask(void* pParam, int index)
+{
+	H264v2Codec* pCodec = (H264v2Codec *)pParam;
+
+	if(index == 0)
+		pCodec->_pMotionEstimationResult = (VectorStructList *)(pCodec->_pMotionEstimator->Estimate(&(pCodec->_pipelineMotionDistortion)));
+	else
+		pCodec->CompleteLoopFilter();
+}//end PipelineTask.
+
+/** Apply a deferred loop filter to the ref img.
+The deferred filter may be running as a pipeline task on the thread pool and 
+therefore filters the macroblock rows serially.
+@return : none.
+*/
+void H264v2Codec::CompleteLoopFilter(void)
+{
+	if(_loopFilterPending)
+		LoopFilterRows(0, _mbLength, 1, NULL);
+	_loopFilterPending = 0;
+}//end CompleteLoopFilter.
+
+/** Load the input image into the work input image.
+The YUV420P16 and YUV420P8 planes are read row by row with the "in lum stride" and
+"in chr stride" parameters so that padded caller buffers do not have to be packed
+first. All other colour spaces go through the input colour converter.
+@param pSrc	: Input raw pels of one complete frame.
+@return			: none.
+*/
+void H264v2Codec::LoadInputImage(void* pSrc)
+{
+	int lumStride = (_inLumStride > _lumWidth)? _inLumStride : _lumWidth;
+	int chrStride = (_inChrStride > _chrWidth)? _inChrStride : _chrWidth;
+	int packed		= (lumStride == _lumWidth)&&(chrStride == _chrWidth);
+	int imgLen		= (_lumWidth * _lumHeight) + 2*(_chrWidth * _chrHeight);
+
+	if(_inColour == H264V2_YUV420P16)	      ///< The natural colour space of the encoder with type = short.
+	{
+		short* pS = (short *)pSrc;
+		if(packed)
+			memcpy((void *)_pLum, (const void *)pS, imgLen * sizeof(short));
+		else
+		{
+			H264V2_CopyRows(pS, lumStride, _pLum, _lumWidth, _lumHeight);
+			pS += lumStride * _lumHeight;
+			H264V2_CopyRows(pS, chrStride, _pChrU, _chrWidth, _chrHeight);
+			pS += chrStride * _chrHeight;
+			H264V2_CopyRows(pS, chrStride, _pChrV, _chrWidth, _chrHeight);
+		}//end else...
+	}//end if H264V2_YUV420P16...
+	else if(_inColour == H264V2_YUV420P8)  ///< ...type = byte.
+	{
+		unsigned char* pS = (unsigned char *)pSrc;
+		if(packed)
+			H264V2_WidenRows(pS, imgLen, _pLum, imgLen, 1);
+		else
+		{
+			H264V2_WidenRows(pS, lumStride, _pLum, _lumWidth, _lumHeight);
+			pS += lumStride * _lumHeight;
+			H264V2_WidenRows(pS, chrStride, _pChrU, _chrWidth, _chrHeight);
+			pS += chrStride * _chrHeight;
+			H264V2_WidenRows(pS, chrStride, _pChrV, _chrWidth, _chrHeight);
+		}//end else...
+	}//end if H264V2_YUV420P8...
+	else
+		_pInColourConverter->Convert((void *)pSrc, (void *)_pLum, (void *)_pChrU, (void *)_pChrV);
+}//end LoadInputImage.
+
 /** Code non-picture nal types.
 This method operates independently and therefore all the coding objects must be
 instantiated and destroyed before and after the coding process. This is typically an 
@@ -2038,7 +3426,7 @@ int H264v2Codec::CodeNonPicNALTypes(void* pCmp, int frameBitLimit)
 	/// Instantiate the mem objects required for the encoding.
 
 	/// A stream writer.
-	_pBitStreamWriter = new BitStreamWriterMSB();
+	_pBitStreamWriter = new FastBitStreamWriterMSB();
 	if(_pBitStreamWriter == NULL)
 	{
 		_errorStr = "[H264Codec::CodeNonPicNALTypes] Cannot instantiate bit stream writer object";
@@ -2068,8 +3456,9 @@ int H264v2Codec::CodeNonPicNALTypes(void* pCmp, int frameBitLimit)
 	if(_pictureCodingType == H264V2_SEQ_PARAM)
 	{
 		_nal._unit_type = NalHeaderH264::SeqParamSet;
-		/// Sequence parameter set for Baseline profile.
-		if(!SetSeqParamSet(_currSeqParam))
+		/// Sequence parameter set for Baseline profile. Param sets that were extracted
+		/// from a stream are preserved.
+		if(_genParamSetOnOpen && !SetSeqParamSet(_currSeqParam))
 		{
 			_errorStr = "[H264Codec::CodeNonPicNALTypes] Cannot set sequence parameter set";
 			ret				= 0;
@@ -2080,7 +3469,7 @@ int H264v2Codec::CodeNonPicNALTypes(void* pCmp, int frameBitLimit)
 	{
 		_nal._unit_type = NalHeaderH264::PicParamSet;
 		/// Picture parameter set.
-		if(!SetPicParamSet(_currPicParam, _currSeqParam))
+		if(_genParamSetOnOpen && !SetPicParamSet(_currPicParam, _currSeqParam))
 		{
 			_errorStr = "[H264Codec::CodeNonPicNALTypes] Cannot set picture parameter set";
 			ret				= 0;
@@ -2498,6 +3887,7 @@ int H264v2Codec::ReadSeqParamSet(IBitStreamReader* bsr, int remainingBits, int*
 {
 	int bitsUsedSoFar = 0;
 	int numBits, i;
+	int pi, set0_flag, set1_flag, set2_flag, set3_flag, li, index;
   SeqParamSetH264 tmpParamSet;
 
 	/// Check existance of stream reader.
@@ -2515,7 +3905,7 @@ int H264v2Codec::ReadSeqParamSet(IBitStreamReader* bsr, int remainingBits, int*
 	/// Temporarily read up to the _seq_parameter_set_id that defines the index into the
 	/// _seqParam[] array.
 
-	int pi = bsr->Read(8);																		///< u(8):_profile_idc
+	pi = bsr->Read(8);																					///< u(8):_profile_idc
 	/// Only baseline profile is supported: _profile_idc = 66.
 	if(pi != 66)
 	{
@@ -2523,16 +3913,16 @@ int H264v2Codec::ReadSeqParamSet(IBitStreamReader* bsr, int remainingBits, int*
 		*bitsUsed = 8;
 		return(2);
 	}//end if pi not baseline...
-	int set0_flag = bsr->Read();															///< u(1):_constraint_set0_flag
-	int set1_flag = bsr->Read();															///< u(1):_constraint_set1_flag
-	int set2_flag = bsr->Read();															///< u(1):_constraint_set2_flag
-	int set3_flag = bsr->Read();															///< u(1):_constraint_set3_flag
+	set0_flag = bsr->Read();																		///< u(1):_constraint_set0_flag
+	set1_flag = bsr->Read();																		///< u(1):_constraint_set1_flag
+	set2_flag = bsr->Read();																		///< u(1):_constraint_set2_flag
+	set3_flag = bsr->Read();																		///< u(1):_constraint_set3_flag
 	bsr->Read(4);																							///< u(4), reserved_zero_4bits ignored.
-	int li = bsr->Read(8);																		///< u(8):_level_idc
+	li = bsr->Read(8);																					///< u(8):_level_idc
 	bitsUsedSoFar += 24;
 
 	/// _seq_parameter_set_id
-	int index = _pHeaderUnsignedVlcDec->Decode(bsr);
+	index = _pHeaderUnsignedVlcDec->Decode(bsr);
 	numBits = _pHeaderUnsignedVlcDec->GetNumDecodedBits();
 	if(numBits == 0)	///< Return = 0 implies no valid vlc code.
 		goto H264V2_RSPS_NOVLC_READ;
@@ -2805,6 +4195,8 @@ int H264v2Codec::SetPicParamSet(int index, int seqRef)
 	_picParam[index]._chroma_qp_index_offset									= 0;			///< Offset added to lum QP (and QS) for Cb chr QP values. Rng = [-12..12].
 	_picParam[index]._second_chroma_qp_index_offset						= 0;			///< For Cr chr QP. When not present = _chroma_qp_index_offset above.
 	_picParam[index]._deblocking_filter_control_present_flag	= 0;			///< Indicates presence of elements in slice header to change the characteristics of the deblocking filter.
+	if( (_slicesPerPicture > 1)||((_modeOfOperation == H264V2_OPEN)&&(_maxSliceBytes > 0)) )
+		_picParam[index]._deblocking_filter_control_present_flag = 1;	///< Required to disable filtering across slice boundaries.
 	_picParam[index]._constrained_intra_pred_flag							= 1;			///< = 1. Indicates that intra macroblock prediction can only be done from other intra macroblocks. 
 	_picParam[index]._redundant_pic_cnt_present_flag					= 0;			///< Indicates that redundant pic count elements are in the slice header.
 	_picParam[index]._transform_8x8_mode_flag									= 0;			///< = 0. Indicates 8x8 transform is used. When not present = 0.
@@ -3274,7 +4666,6 @@ int H264v2Codec::GetCodecParams(int picParamSet)
 			(_picParam[picParamSet]._num_ref_idx_l1_active_minus1 != 0) ||
 			(_picParam[picParamSet]._weighted_pred_flag != 0) ||
 			(_picParam[picParamSet]._weighted_bipred_idc != 0) ||
-			(_picParam[picParamSet]._constrained_intra_pred_flag != 1) ||
 			(_picParam[picParamSet]._redundant_pic_cnt_present_flag != 0) ||
 			(_picParam[picParamSet]._transform_8x8_mode_flag != 0) ||
 			(_picParam[picParamSet]._pic_scaling_matrix_present_flag != 0) )
@@ -4315,8 +5706,8 @@ int H264v2Codec::ReadSliceLayerHeader(IBitStreamReader* bsr, int remainingBits,
 	///-------------------------- Deblocking Filter Control -----------------------------------
 	if(_picParam[_slice._pic_parameter_set_id]._deblocking_filter_control_present_flag)
 	{
-		_slice._disable_deblocking_filter_idc = _pHeaderSignedVlcDec->Decode(bsr);
-		numBits = _pHeaderSignedVlcDec->GetNumDecodedBits();
+		_slice._disable_deblocking_filter_idc = _pHeaderUnsignedVlcDec->Decode(bsr);
+		numBits = _pHeaderUnsignedVlcDec->GetNumDecodedBits();
 		if(numBits == 0)	///< Return = 0 implies no valid vlc code.
 			goto H264V2_RSLH_NOVLC_READ;
 		bitsUsedSoFar += numBits;
@@ -4492,35 +5883,62 @@ int H264v2Codec::InsertEmulationPrevention(IBitStreamWriter* bsw, int startOffse
   int  endPos  = bsw->GetStreamBytePos() - 1 - startOffset;
   if(endPos < 2) return(0);
 
-  /// Find the occurrance of the start code emulation then shift down by copying backwards from the end. Note
-  /// that 1st 4 bytes are the start code 0x00000001.
-  for(int pos = 6; pos <= endPos; pos++)
+  /// Find the occurrences of the start code emulation in a single forward pass and then move
+  /// the stream up in batches from the end backwards. Note that the 1st 4 bytes are the start
+  /// code 0x00000001. The zero count restarts after every inserted 0x03.
+  int pos[H264V2_EP_BATCH];
+  int num   = 0;
+  int zeros = 0;
+  int i     = 4;
+  while(i <= endPos)
   {
-    if( (stream[pos] & 0xFC) == 0 ) ///< Check for 0, 1, 2 or 3.
+    /// Skip runs of 16 bytes without zeros when they cannot complete a 0x000000 - 0x000003 sequence.
+    if( (zeros < 2)&&((i + 16) <= (endPos + 1))&&!H264V2_AnyZero16(&(stream[i])) )
     {
-      if( (stream[pos-1] == 0)&&(stream[pos-2] == 0) ) ///< Check 2 preceeding bytes are zero.
-      {
-        for(int i = endPos; i >= pos; i--) ///< Shift down by 1 byte.
-          stream[i+1] = stream[i];
-        stream[pos] = 0x03; ///< Insert emulation prevention code.
-        pos++;              ///< Continue from new shifted position.
-        endPos++;           ///< Last byte is now shifted by 1 position.
-        count++;
-      }//end if stream...
-    }//end if stream...
-  }//end for pos...
+      zeros = 0;
+      i += 16;
+      continue;
+    }//end if zeros...
+
+    int b = stream[i];
+    if( (zeros >= 2)&&((b & 0xFC) == 0) ) ///< 2 preceding zero bytes then 0, 1, 2 or 3.
+    {
+      pos[num++]  = i;
+      zeros       = 0;
+    }//end if zeros...
+    zeros = (b == 0)? (zeros + 1) : 0;
+    i++;
+
+    if(num == H264V2_EP_BATCH)
+    {
+      H264V2_InsertEscapes(stream, pos, num, endPos);
+      i       += num; ///< Continue from the new shifted position.
+      endPos  += num; ///< Last byte is now shifted.
+      count   += num;
+      num     = 0;
+    }//end if num...
+  }//end while i...
+  if(num)
+  {
+    H264V2_InsertEscapes(stream, pos, num, endPos);
+    count += num;
+  }//end if num...
 
 	return(count * 8);
 }// end InsertEmulationPrevention.
 
 /** Remove start code emulation prevention codes.
-Scan the entire stream and check for 24 bit 0x000003 sequence
-and remove the 0x03 byte from the stream. This method should 
-only be called once before decoding the entire frame.
-@param bsr	: Stream to read from.
-@return			: Return the number of extra bits removed.
+Scan the byte range of a NAL unit in the stream and check for 24 bit 
+0x000003 sequence and remove the 0x03 byte from the stream. The bytes
+in the range are shifted down and the bytes after the range are not
+touched. This method should only be called once per NAL unit before 
+decoding it.
+@param bsr	          : Stream to read from.
+@param startBytePos   : First byte of the range.
+@param endBytePos     : Last byte of the range.
+@return			          : Return the number of extra bits removed.
 */
-int H264v2Codec::RemoveEmulationPrevention(IBitStreamReader* bsr)
+int H264v2Codec::RemoveEmulationPrevention(IBitStreamReader* bsr, int startBytePos, int endBytePos)
 {
   if(bsr == NULL)
     return(0);
@@ -4528,28 +5946,43 @@ int H264v2Codec::RemoveEmulationPrevention(IBitStreamReader* bsr)
 	int count = 0;
 
   unsigned char*  stream  = (unsigned char*)(bsr->GetStream());
-  int             bits    = bsr->GetStreamBitSize();
-  int             endPos  = (bits / 8) - 1;
-  if( (bits % 8) != 0 )
-    endPos++;
-
-  /// Find the 1st occurrence of the emulation prevention code.
-  int pos;
-  for(pos = 2; pos <= endPos; pos++)
+
+  /// Compact the range in a single forward pass. The runs of bytes between the emulation
+  /// prevention codes are moved down and the zero count restarts after every removed code.
+  int zeros     = 0;
+  int runStart  = startBytePos;
+  int wrPos     = startBytePos;
+  int pos       = startBytePos;
+  while(pos <= endBytePos)
   {
-    if(stream[pos] == 0x03) ///< Emulation prevention code = 0x03...
+    /// Skip runs of 16 bytes without zeros when they cannot complete a 0x000003 sequence.
+    if( (zeros < 2)&&((pos + 16) <= (endBytePos + 1))&&!H264V2_AnyZero16(&(stream[pos])) )
     {
-      if( (stream[pos-1] == 0) && (stream[pos-2] == 0) )  ///< ...and is preceeded by 2 zero bytes.
-      {
-        /// Shift remaining bytes up by 1 byte.
-        for(int i = pos; i < endPos; i++)
-          stream[i] = stream[i+1];
-        pos++;    ///< Skip one to prevent trapping a 0x00 followed by a 0x03 in the actual stream.
-        endPos--; ///< Last byte was shifted by 1.
-        count++;
-      }//end if stream...
-    }//end if stream...
-  }//end for pos...
+      zeros = 0;
+      pos += 16;
+      continue;
+    }//end if zeros...
+
+    int b = stream[pos];
+    if( (zeros >= 2)&&(b == 0x03) ) ///< Emulation prevention code preceded by 2 zero bytes.
+    {
+      if(wrPos != runStart)
+        memmove((void *)&(stream[wrPos]), (const void *)&(stream[runStart]), pos - runStart);
+      wrPos    += pos - runStart;
+      runStart  = pos + 1;
+      zeros     = 0;
+      count++;
+    }//end if zeros...
+    else
+      zeros = (b == 0)? (zeros + 1) : 0;
+    pos++;
+  }//end while pos...
+  if(count)
+    memmove((void *)&(stream[wrPos]), (const void *)&(stream[runStart]), endBytePos + 1 - runStart);
+
+  /// The reader may hold some of the moved bytes in its cache and must reload them.
+  if(count)
+    bsr->Seek(bsr->GetStreamBitPos());
 
 	return(count * 8);
 }// end RemoveEmulationPrevention.
@@ -4563,22 +5996,23 @@ before writing. The check is sufficiently frequent to warrant an early
 exit GOTO statement. If the input stream param is NULL then this method is 
 used to count the bits only.
 @param bsw					: Stream to write into.
+@param firstMb			: First macroblock index of the slice.
+@param lastMb				: Last macroblock index of the slice.
 @param allowedBits	: Upper limit to the writable bits.
 @param bitsUsed			: Return the actual bits used.
 @return							: Run out of bits = 1, more bits available = 0, Vlc error = 2.
 */
-int H264v2Codec::WriteSliceDataLayer(IBitStreamWriter* bsw, int allowedBits, int* bitsUsed)
+int H264v2Codec::WriteSliceDataLayer(IBitStreamWriter* bsw, int firstMb, int lastMb, int allowedBits, int* bitsUsed)
 {
 	int mb, i;
 	int	bitCount;
 	int bitsUsedSoFar = 0;
 
- 	/// All macroblocks are written in order.
-	int len				= _mbLength;
+ 	/// All macroblocks of the slice are written in order.
 	_mb_skip_run	= 0;
 
 	/// ------------------------ Code the slice data -----------------------------------
-	for(mb = 0; mb < len; mb++)
+	for(mb = firstMb; mb <= lastMb; mb++)
 	{
 		/// Short cut variables.
 		MacroBlockH264* pMb = &(_pMb[mb]);
@@ -4655,17 +6089,19 @@ int H264v2Codec::WriteSliceDataLayer(IBitStreamWriter* bsw, int allowedBits, int
 }//end WriteSliceDataLayer.
 
 /** Read the slice data layer from the global bit stream.
-This impementation reads every macroblock encoding in top-left to
-bottom-right order. Each read checks if a bit underflow will occur 
-after reading. Check for loss of vlc sync wherever possible. The 
-checks are sufficiently frequent to warrant an early exit GOTO 
-statement.
+This impementation reads every macroblock encoding of the slice in 
+top-left to bottom-right order. Each read checks if a bit underflow 
+will occur after reading. Check for loss of vlc sync wherever possible. 
+The checks are sufficiently frequent to warrant an early exit GOTO 
+statement. The slice ends when all of its data bits are consumed
+with no skip run pending or at the end of the picture.
 @param bsr						: Stream to read from.
-@param remainingBits	: Upper limit to the readable bits.
+@param firstMb				: First macroblock index of the slice.
+@param remainingBits	: Slice data bits up to the rbsp stop bit.
 @param bitsUsed				: Return the actual bits extracted.
 @return								: Run out of bits = 1, more bits available = 0, error = 2.
 */
-int H264v2Codec::ReadSliceDataLayer(IBitStreamReader* bsr, int remainingBits, int* bitsUsed)
+int H264v2Codec::ReadSliceDataLayer(IBitStreamReader* bsr, int firstMb, int remainingBits, int* bitsUsed)
 {
 	int mb, i;
 	int bitsUsedSoFar = 0;
@@ -4690,7 +6126,7 @@ int H264v2Codec::ReadSliceDataLayer(IBitStreamReader* bsr, int remainingBits, in
 			goto H264V2_RUNOUTOFBITS_READ;
 	}//end if !I_Slice...
 
-	for(mb = 0; mb < len; mb++)
+	for(mb = firstMb; mb < len; mb++)
 	{
 		/// Short cut variables.
 		MacroBlockH264* pMb = &(_pMb[mb]);
@@ -4779,6 +6215,10 @@ int H264v2Codec::ReadSliceDataLayer(IBitStreamReader* bsr, int remainingBits, in
 			{
 				// TODO: Implement Intra_8x8 and Intra_4x4 mode options.
 
+				/// Intra macroblocks have a zero vector for the vector prediction of their neighbours.
+				_pMb[mb]._mvX[MacroBlockH264::_16x16] = 0;
+				_pMb[mb]._mvY[MacroBlockH264::_16x16] = 0;
+
 				/// Get chr prediction mode.
 				_pMb[mb]._intraChrPredMode = _pMbIChrPredModeVlcDec->Decode(bsr);
 				numBits = _pMbIChrPredModeVlcDec->GetNumDecodedBits();
@@ -4892,7 +6332,8 @@ int H264v2Codec::ReadSliceDataLayer(IBitStreamReader* bsr, int remainingBits, in
 
 		/// If end of skipped macroblocks then get the next skip run from the stream.
 		if(!_mb_skip_run && !pMb->_skip && (_slice._type != SliceHeaderH264::I_Slice) && (_slice._type != SliceHeaderH264::SI_Slice) && 
-                                       (_slice._type != SliceHeaderH264::I_Slice_All) && (_slice._type != SliceHeaderH264::SI_Slice_All) && (mb != (len-1)))
+                                       (_slice._type != SliceHeaderH264::I_Slice_All) && (_slice._type != SliceHeaderH264::SI_Slice_All) && 
+                                       (mb != (len-1)) && (bitsUsedSoFar < remainingBits))
 		{
 			_mb_skip_run = _pHeaderUnsignedVlcDec->Decode(bsr);
 			numBits = _pHeaderUnsignedVlcDec->GetNumDecodedBits();
@@ -4904,6 +6345,10 @@ int H264v2Codec::ReadSliceDataLayer(IBitStreamReader* bsr, int remainingBits, in
 				goto H264V2_RUNOUTOFBITS_READ;
 		}//end if !_mb_skip_run...
 
+		/// End of the slice data.
+		if(!_mb_skip_run && (bitsUsedSoFar >= remainingBits))
+			break;
+
 	}//end for mb...
 
 	*bitsUsed = bitsUsedSoFar;
@@ -4940,7 +6385,7 @@ input stream param is NULL then this method is used to count the bits only.
 */
 int H264v2Codec::WriteMacroBlockLayer(IBitStreamWriter* bsw, MacroBlockH264* pMb, int allowedBits, int* bitsUsed)
 {
-	int	  bitCount, i;
+	int	  bitCount, i, dcSkip, startBlk;
 	int   bitsUsedSoFar = 0;
 
 	/// Encode the vlc blocks with the context of the neighborhood number of coeffs. Map
@@ -5037,8 +6482,8 @@ int H264v2Codec::WriteMacroBlockLayer(IBitStreamWriter* bsw, MacroBlockH264* pMb
 	}//end if _coded_blk_pattern...
 
 	/// ------------------ Code the macroblock data --------------------------------------------------------
-	int dcSkip	 = 0;
-	int startBlk = 1;
+	dcSkip	 = 0;
+	startBlk = 1;
 	if( (pMb->_intraFlag) && (pMb->_mbPartPredMode == MacroBlockH264::Intra_16x16) )
 	{
 		startBlk = 0;	///< Change starting block to include block num = -1;
@@ -5234,195 +6679,407 @@ int H264v2Codec::ReadMacroBlockLayer(IBitStreamReader* bsr, int remainingBits, i
 /** Apply the in-loop edge filter.
 Used in both the encoder and decoder to remove blocking artefacts on the 4x4 boundary
 edges. It is applied macroblock by macroblock in raster scan order to the reference
-images of both the Lum and Chr components.
+images of both the Lum and Chr components. In wavefront mode the macroblock rows are
+filtered concurrently by the workers with each row trailing the row above by two 
+macroblocks, which gives the same result as the raster scan order.
 @return	:	none.
 */
 void H264v2Codec::ApplyLoopFilter(void)
 {
-	int mb,i,j;
+	if(_pWavefrontSync != NULL)
+	{
+		_pWavefrontSync->Reset();
+		_pThreadPool->Run(H264v2Codec::LoopFilterTask, (void *)this, _numWorkers);
+	}//end if _pWavefrontSync...
+	else
+		LoopFilterRows(0, _mbLength, 1, NULL);
+}//end ApplyLoopFilter.
+
+/** Thread pool task to filter the macroblock rows of one wavefront worker.
+@param pParam	: The codec.
+@param index	: Worker index.
+@return				: none.
+*/
+void H264v2Codec::LoopFilterTask(void* pParam, int index)
+{
+	H264v2Codec* pCodec = (H264v2Codec *)pParam;
+	pCodec->LoopFilterRows(index, pCodec->_mbLength, pCodec->_numWorkers, pCodec->_pWavefrontSync);
+}//end LoopFilterTask.
+
+/** Apply the in-loop edge filter to every n-th macroblock row.
+Rows firstRow, firstRow + rowStep,... up to but excluding endRow are filtered 
+in raster scan order. With a row progress sync each macroblock waits for the 
+row above to complete its above and above right neighbours. The filtering of 
+a macroblock modifies its left and above neighbours up to 3 pels from the edge.
+@param firstRow	: First macroblock row.
+@param endRow		: Row to end before. Clipped to the image height.
+@param rowStep	: Step between the rows.
+@param pSync		: Row progress sync. NULL for serial filtering.
+@return					: none.
+*/
+void H264v2Codec::LoopFilterRows(int firstRow, int endRow, int rowStep, WavefrontSync* pSync)
+{
 	short** lumRef	= _RefLum->Get2DSrcPtr();	///< Image space to operate on.
 	short** cbRef		= _RefCb->Get2DSrcPtr();
 	short** crRef		= _RefCr->Get2DSrcPtr();
+	int mbWidth			= _lumWidth/16;
+	int mbHeight		= _mbLength/mbWidth;
+	if(endRow > mbHeight)
+		endRow = mbHeight;
 
-	for(mb = 0; mb < _mbLength; mb++)
+	for(int row = firstRow; row < endRow; row += rowStep)
 	{
-		MacroBlockH264* pMb			      = &(_pMb[mb]);
-		MacroBlockH264* aboveMb       = _pMb[mb]._aboveMb;
-		MacroBlockH264* leftMb	      = _pMb[mb]._leftMb;
-
-		/// All macroblock boundaries that have intra neighbours use
-		/// boundary strength = {3, 4}. Vertical filtering first.
-
-		///---------------- Vertical Edges --------------------------------------
-		if(leftMb != NULL)	///< Only look at macroblock boundary if there is a neighbour.
+		for(int col = 0; col < mbWidth; col++)
 		{
-			if(pMb->_intraFlag || leftMb->_intraFlag)	///< Left intra macroblock boundary (bS = 4).
-			{
-				for(i = 0; i < 16; i += 4)
-					VerticalFilter(pMb, lumRef, 1, i, 0, 4, 4);
-				for(i = 0; i < 8; i += 4)
-				{
-					VerticalFilter(pMb, cbRef, 0, i, 0, 4, 4);
-					VerticalFilter(pMb, crRef, 0, i, 0, 4, 4);
-				}//end for i...
-			}//end if _intraFlag...
-			else																	///< Left inter macroblock boundary.
+			if(pSync != NULL)
 			{
-				// TODO: For this current implementation only one 16x16 vector is used
-				// per macroblock and from the same single reference. Boundary 4x4 blocks 
-        // are compared with the neighbouring macroblock motion vectors.
-
-				int mvDiffersBy4 = 0;	///< Differ with neighbour by 4 quarter pel values.
-				if( (H264V2_FAST_ABS32(pMb->_mvX[0] - leftMb->_mvX[0]) >= 4) || (H264V2_FAST_ABS32(pMb->_mvY[0] - leftMb->_mvY[0]) >= 4) )
-					mvDiffersBy4 = 1;
-
-				for(i = 0; i < 4; i++)
-				{
-					int bS = mvDiffersBy4;
-					if(pMb->_lumBlk[i][0].GetNumCoeffs() || pMb->_lumBlk[i][0]._blkLeft->GetNumCoeffs() )	///< Coded coeffs in block with q or block with p.
-						bS = 2;
+				int aboveCnt = col + 2;
+				if(aboveCnt > mbWidth)
+					aboveCnt = mbWidth;
+				pSync->WaitForProgress(row - 1, aboveCnt);
+			}//end if pSync...
+
+			LoopFilterMb(&(_Mb[row][col]), lumRef, cbRef, crRef);
+
+			if(pSync != NULL)
+				pSync->SetProgress(row, col + 1);
+		}//end for col...
+	}//end for row...
+
+}//end LoopFilterRows.
+
+/** Start the row loop filter for a picture.
+Row mode is used when the "row loop filter" parameter is set, the picture is
+deblocked and the macroblocks are reconstructed in raster scan order by this 
+codec i.e. without slice or wavefront workers. The encoder only sets the num of
+coeffs of each block when the stream is written after reconstruction and therefore
+the coded blocks are found from the coeffs instead.
+@param fromCoeffs	: Find the coded blocks from the block coeffs.
+@return						: none.
+*/
+void H264v2Codec::StartRowLoopFilter(int fromCoeffs)
+{
+	_loopFilterRowsDone		= -1;
+	_loopFilterFromCoeffs	= 0;
+	if( _rowLoopFilter && (_slice._disable_deblocking_filter_idc != 1) && (_numWorkers == 1) )
+	{
+		_loopFilterRowsDone		= 0;
+		_loopFilterFromCoeffs	= fromCoeffs;
+	}//end if _rowLoopFilter...
+}//end StartRowLoopFilter.
+
+/** Filter the row above a reconstructed macroblock row.
+Called by the plane encoders/decoders after each macroblock is reconstructed. 
+When the last macroblock of a row completes, all rows before the row above are 
+already filtered and the row above is filtered now.
+@param mb	: Macroblock index that has been reconstructed.
+@return		: none.
+*/
+void H264v2Codec::RowLoopFilter(int mb)
+{
+	if(_loopFilterRowsDone < 0)
+		return;
 
-					if(bS)
-					{
-						/// Apply the filter to this macroblock block boundary.
-						VerticalFilter(pMb, lumRef, 1, i<<2, 0, 4, bS);	///< At (row = 4*i, col = 0) do iter = 4 rows.
+	int mbWidth = _lumWidth/16;
+	if( ((mb + 1) % mbWidth) == 0 )
+	{
+		int row = mb / mbWidth;
+		if(row > _loopFilterRowsDone)
+		{
+			LoopFilterRows(_loopFilterRowsDone, row, 1, NULL);
+			_loopFilterRowsDone = row;
+		}//end if row...
+	}//end if mb...
+}//end RowLoopFilter.
+
+/** Complete the row loop filter for a picture.
+The remaining rows are filtered. Plane encoders/decoders that do not filter 
+by rows leave all the rows to be filtered here.
+@return : 1 = the picture has been filtered, 0 = not in row mode.
+*/
+int H264v2Codec::EndRowLoopFilter(void)
+{
+	if(_loopFilterRowsDone < 0)
+		return(0);
 
-						/// Apply to the aligned chr edge assuming 4:2:0 here only.
-						VerticalFilter(pMb, cbRef, 0, i<<1, 0, 2, bS);	///< At (row = 2*i, col = 0) do iter = 2 rows.
-						VerticalFilter(pMb, crRef, 0, i<<1, 0, 2, bS);	///< At (row = 2*i, col = 0) do iter = 2 rows.
-					}//end if bS...
-				}//end for i...
+	LoopFilterRows(_loopFilterRowsDone, _mbLength, 1, NULL);
+	_loopFilterRowsDone		= -1;
+	_loopFilterFromCoeffs	= 0;
+	return(1);
+}//end EndRowLoopFilter.
+
+/** Apply the in-loop edge filter to one macroblock.
+The boundary strengths of all the edges are found first. The vertical edges are 
+then filtered from left to right followed by the horizontal edges from top to 
+bottom, each over its full length.
+@param pMb		: Macroblock to filter.
+@param lumRef	: Lum ref image.
+@param cbRef	: Cb ref image.
+@param crRef	: Cr ref image.
+@return				: none.
+*/
+void H264v2Codec::LoopFilterMb(MacroBlockH264* pMb, short** lumRef, short** cbRef, short** crRef)
+{
+	int bSV[4][4];	///< [edge col][4x4 block row].
+	int bSH[4][4];	///< [edge row][4x4 block col].
+	int e;
 
-			}//end else...
-		}//end if leftMb...
+	GetBoundaryStrengths(pMb, bSV, bSH);
 
-		if(pMb->_intraFlag)	///< Internal intra block edges.
+	///---------------- Vertical Edges --------------------------------------
+	for(e = 0; e < 4; e++)
+	{
+		VerticalEdgeFilter(pMb, lumRef, 1, e << 2, bSV[e]);
+		/// The chr edges are aligned with lum edges 0 and 2 assuming 4:2:0 here only.
+		if( !(e & 1) )
 		{
-			for(j = 4; j < 16; j += 4)
-				for(i = 0; i < 16; i += 4)	///< All rows first for each col.
-					VerticalFilter(pMb, lumRef, 1, i, j, 4, 3);
-			for(j = 4; j < 8; j += 4)
-				for(i = 0; i < 8; i += 4)
-				{
-					VerticalFilter(pMb, cbRef, 0, i, j, 4, 3);
-					VerticalFilter(pMb, crRef, 0, i, j, 4, 3);
-				}//end for j & i...
-		}//end if _intraFlag...
-		else										///< Internal inter block edges.
+			VerticalEdgeFilter(pMb, cbRef, 0, e << 1, bSV[e]);
+			VerticalEdgeFilter(pMb, crRef, 0, e << 1, bSV[e]);
+		}//end if e...
+	}//end for e...
+
+	///---------------- Horizontal Edges -------------------------------------
+	for(e = 0; e < 4; e++)
+	{
+		HorizontalEdgeFilter(pMb, lumRef, 1, e << 2, bSH[e]);
+		if( !(e & 1) )
 		{
-			// TODO: For this current implementation only one 16x16 motion vector is used
-			// per macroblock and from the same single reference. Therefore all internal
-			// blocks have the same motion vector i.e. difference = 0.
+			HorizontalEdgeFilter(pMb, cbRef, 0, e << 1, bSH[e]);
+			HorizontalEdgeFilter(pMb, crRef, 0, e << 1, bSH[e]);
+		}//end if e...
+	}//end for e...
+
+}//end LoopFilterMb.
+
+/** Get the boundary strengths of all the 4x4 block edges in a macroblock.
+All macroblock boundaries that have intra neighbours use boundary strength = {3, 4}.
+Macroblock edges without a neighbour are not filtered and have strength 0.
+@param pMb	: Macroblock to operate on.
+@param bSV	: Vertical edge strengths [edge col][4x4 block row] (returned).
+@param bSH	: Horizontal edge strengths [edge row][4x4 block col] (returned).
+@return			: none.
+*/
+void H264v2Codec::GetBoundaryStrengths(MacroBlockH264* pMb, int bSV[4][4], int bSH[4][4])
+{
+	MacroBlockH264* aboveMb	= pMb->_aboveMb;
+	MacroBlockH264* leftMb	= pMb->_leftMb;
+	int i,j;
 
+	if(pMb->_intraFlag)
+	{
+		for(i = 0; i < 4; i++)
+		{
+			bSV[0][i] = (leftMb != NULL)? 4 : 0;
+			bSH[0][i] = (aboveMb != NULL)? 4 : 0;
 			for(j = 1; j < 4; j++)
-				for(i = 0; i < 4; i++)
-				{
-					int bS = 0;
-					if(pMb->_lumBlk[i][j].GetNumCoeffs() || pMb->_lumBlk[i][j]._blkLeft->GetNumCoeffs() )	///< Coded coeffs in block with q or block with p.
-						bS = 2;
+			{
+				bSV[j][i] = 3;
+				bSH[j][i] = 3;
+			}//end for j...
+		}//end for i...
+		return;
+	}//end if _intraFlag...
 
-					if(bS)
-					{
-						/// Apply the filter to this block boundary.
-						VerticalFilter(pMb, lumRef, 1, i<<2, j<<2, 4, bS);	///< At (row = 4*i, col = 4*j) do iter = 4 rows.
+	// TODO: For this current implementation only one 16x16 vector is used per macroblock 
+	// and from the same single reference. Boundary 4x4 blocks are compared with the 
+	// neighbouring macroblock motion vectors and all internal blocks have the same motion
+	// vector i.e. difference = 0.
 
-						/// Apply to the aligned chr edge assuming 4:2:0 here only.
-						if(j == 2)
-						{
-							VerticalFilter(pMb, cbRef, 0, i<<1, j<<1, 2, bS);	///< At (row = 2*i, col = 2*j) do iter = 2 rows.
-							VerticalFilter(pMb, crRef, 0, i<<1, j<<1, 2, bS);	///< At (row = 2*i, col = 2*j) do iter = 2 rows.
-						}//end if j...
-					}//end if bS...
+	/// Blocks with coded coeffs.
+	int coded[4][4];
+	for(i = 0; i < 4; i++)
+		for(j = 0; j < 4; j++)
+			coded[i][j] = IsBlkCodedForLoopFilter(&(pMb->_lumBlk[i][j]));
+
+	/// Left macroblock edge.
+	if(leftMb == NULL)
+		bSV[0][0] = bSV[0][1] = bSV[0][2] = bSV[0][3] = 0;
+	else if(leftMb->_intraFlag)
+		bSV[0][0] = bSV[0][1] = bSV[0][2] = bSV[0][3] = 4;
+	else
+	{
+		int mvDiffersBy4 = 0;	///< Differ with neighbour by 4 quarter pel values.
+		if( (H264V2_FAST_ABS32(pMb->_mvX[0] - leftMb->_mvX[0]) >= 4) || (H264V2_FAST_ABS32(pMb->_mvY[0] - leftMb->_mvY[0]) >= 4) )
+			mvDiffersBy4 = 1;
+		for(i = 0; i < 4; i++)	///< Coded coeffs in block with q or block with p.
+			bSV[0][i] = (coded[i][0] || IsBlkCodedForLoopFilter(pMb->_lumBlk[i][0]._blkLeft))? 2 : mvDiffersBy4;
+	}//end else...
 
-				}//end for j & i...
-		}//end else...
+	/// Above macroblock edge.
+	if(aboveMb == NULL)
+		bSH[0][0] = bSH[0][1] = bSH[0][2] = bSH[0][3] = 0;
+	else if(aboveMb->_intraFlag)
+		bSH[0][0] = bSH[0][1] = bSH[0][2] = bSH[0][3] = 4;
+	else
+	{
+		int mvDiffersBy4 = 0;
+		if( (H264V2_FAST_ABS32(pMb->_mvX[0] - aboveMb->_mvX[0]) >= 4) || (H264V2_FAST_ABS32(pMb->_mvY[0] - aboveMb->_mvY[0]) >= 4) )
+			mvDiffersBy4 = 1;
+		for(j = 0; j < 4; j++)
+			bSH[0][j] = (coded[0][j] || IsBlkCodedForLoopFilter(pMb->_lumBlk[0][j]._blkAbove))? 2 : mvDiffersBy4;
+	}//end else...
 
-		///---------------- Horizontal Edges -------------------------------------
-		if(aboveMb != NULL)	///< Only look at macroblock boundary if there is a neighbour.
+	/// Internal block edges.
+	for(i = 0; i < 4; i++)
+		for(j = 1; j < 4; j++)
 		{
-			if(pMb->_intraFlag || aboveMb->_intraFlag)	///< Above intra macroblock boundary. (bS = 4)
-			{
-				for(j = 0; j < 16; j += 4)
-					HorizontalFilter(pMb, lumRef, 1, 0, j, 4, 4);
-				for(j = 0; j < 8; j += 4)
-				{
-					HorizontalFilter(pMb, cbRef, 0, 0, j, 4, 4);
-					HorizontalFilter(pMb, crRef, 0, 0, j, 4, 4);
-				}//end for j...
-			}//end if _intraFlag...
-			else																	///< Above inter macroblock boundary.
-			{
-				// TODO: For this current implementation only one 16x16 motion vector is used
-				// per macroblock and from the same single reference.
-
-				int mvDiffersBy4 = 0;	///< Differ with neighbour by 4 quarter pel values.
-				if( (H264V2_FAST_ABS32(pMb->_mvX[0] - aboveMb->_mvX[0]) >= 4) || (H264V2_FAST_ABS32(pMb->_mvY[0] - aboveMb->_mvY[0]) >= 4) )
-					mvDiffersBy4 = 1;
+			bSV[j][i] = (coded[i][j] || coded[i][j-1])? 2 : 0;
+			bSH[j][i] = (coded[j][i] || coded[j-1][i])? 2 : 0;
+		}//end for i & j...
 
-				for(j = 0; j < 4; j++)
-				{
-					int bS = mvDiffersBy4;
-					if(pMb->_lumBlk[0][j].GetNumCoeffs() || pMb->_lumBlk[0][j]._blkAbove->GetNumCoeffs() )	///< Coded coeffs in block with q or block with p.
-						bS = 2;
+}//end GetBoundaryStrengths.
 
-					if(bS)
-					{
-						/// Apply the filter to this macroblock block boundary.
-						HorizontalFilter(pMb, lumRef, 1, 0, j<<2, 4, bS);	///< At (row = 0, col = 4*j) do iter = 4 cols.
+/** Apply the in-loop deblocking filter to a whole vertical block edge.
+The 4 segments of the edge each have their own boundary strength. The SSE2
+implementation transposes 8 rows at a time so that the pels across the edge 
+are filtered in parallel down the column. Otherwise each segment is filtered 
+with VerticalFilter().
+@param pMb		: Macroblock to operate on.
+@param img		: Reference image to filter.
+@param lumFlag: Indicates the colour component of the ref image.
+@param colOff	: The column offset of the edge within the macroblock.
+@param bS			: Boundary strength of the 4 segments from the top.
+@return				: none.
+*/
+void H264v2Codec::VerticalEdgeFilter(MacroBlockH264* pMb, short** img, int lumFlag, int colOff, const int* bS)
+{
+	if( !(bS[0]|bS[1]|bS[2]|bS[3]) )
+		return;
 
-						/// Apply to the aligned chr edge assuming 4:2:0 here only.
-						HorizontalFilter(pMb, cbRef, 0, 0, j<<1, 2, bS);	///< At (row = 0, col = 2*j) do iter = 2 cols.
-						HorizontalFilter(pMb, crRef, 0, 0, j<<1, 2, bS);	///< At (row = 0, col = 2*j) do iter = 2 cols.
-					}//end if bS...
-				}//end for j...
+	int len = lumFlag? 16 : 8;
+	int seg = len >> 2;
+#ifdef RTVC_SIMD
+	int qPav, offX, offY;
+	if(lumFlag)
+	{
+		qPav	= pMb->_mbQP;
+		/// Modify to average qP with the neighbour if this is a mb edge.
+		if( (pMb->_leftMb != NULL) && (colOff == 0) )
+			qPav	= (qPav + pMb->_leftMb->_mbQP + 1) >> 1;
+		offX	= pMb->_offLumX + colOff;
+		offY	= pMb->_offLumY;
+	}//end if lumFlag...
+	else
+	{
+		qPav	= MacroBlockH264::GetQPc(pMb->_mbQP);
+		if( (pMb->_leftMb != NULL) && (colOff == 0) )
+		  qPav	= (qPav + MacroBlockH264::GetQPc(pMb->_leftMb->_mbQP) + 1) >> 1;
+		offX	= pMb->_offChrX + colOff;
+		offY	= pMb->_offChrY;
+	}//end else...
 
-			}//end else...
-		}//end aboveMb...
+	int a = H264v2Codec::alpha[qPav];
+	if(a == 0)
+		return;	///< No pels can pass the boundary difference test.
 
-		if(pMb->_intraFlag)	///< Internal intra block edges.
-		{
-			for(i = 4; i < 16; i += 4)
-				for(j = 0; j < 16; j += 4)
-					HorizontalFilter(pMb, lumRef, 1, i, j, 4, 3);
-			for(i = 4; i < 8; i += 4)
-				for(j = 0; j < 8; j += 4)
-				{
-					HorizontalFilter(pMb, cbRef, 0, i, j, 4, 3);
-					HorizontalFilter(pMb, crRef, 0, i, j, 4, 3);
-				}//end for i & j...
-		}//end if _intraFlag...
-		else										///< Internal inter block edges.
-		{
-			// TODO: For this current implementation only one 16x16 motion vector is used
-			// per macroblock and from the same single reference. Therefore all internal
-			// blocks have the same motion vector i.e. difference = 0.
+	short laneBS[16];
+	short laneTC0[16];
+	GetEdgeLanes(bS, seg, len, qPav, laneBS, laneTC0);
 
-			for(i = 1; i < 4; i++)
-				for(j = 0; j < 4; j++)
-				{
-					int bS = 0;
-					if(pMb->_lumBlk[i][j].GetNumCoeffs() || pMb->_lumBlk[i][j]._blkAbove->GetNumCoeffs() )	///< Coded coeffs in block with q or block with p.
-						bS = 2;
+	for(int r = 0; r < len; r += 8)
+	{
+		__m128i v[8];
+		int i;
+		for(i = 0; i < 8; i++)
+			v[i] = _mm_loadu_si128((const __m128i *)(&img[offY + r + i][offX - 4]));
+		H264V2_Transpose8x8(v);
+		H264V2_FilterEdge8(v, _mm_loadu_si128((const __m128i *)(&laneBS[r])), _mm_loadu_si128((const __m128i *)(&laneTC0[r])), a, H264v2Codec::beta[qPav], lumFlag);
+		H264V2_Transpose8x8(v);
+		for(i = 0; i < 8; i++)
+			_mm_storeu_si128((__m128i *)(&img[offY + r + i][offX - 4]), v[i]);
+	}//end for r...
+#else
+	for(int k = 0; k < 4; k++)
+	{
+		if(bS[k])
+			VerticalFilter(pMb, img, lumFlag, k * seg, colOff, seg, bS[k]);
+	}//end for k...
+#endif
+}//end VerticalEdgeFilter.
 
-					if(bS)
-					{
-						/// Apply the filter to this block boundary.
-						HorizontalFilter(pMb, lumRef, 1, i<<2, j<<2, 4, bS);	///< At (row = 4*i, col = 4*j) do iter = 4 cols.
+/** Apply the in-loop deblocking filter to a whole horizontal block edge.
+The 4 segments of the edge each have their own boundary strength. The SSE2
+implementation filters 8 pels along the row in parallel. Otherwise each 
+segment is filtered with HorizontalFilter().
+@param pMb		: Macroblock to operate on.
+@param img		: Reference image to filter.
+@param lumFlag: Indicates the colour component of the ref image.
+@param rowOff	: The row offset of the edge within the macroblock.
+@param bS			: Boundary strength of the 4 segments from the left.
+@return				: none.
+*/
+void H264v2Codec::HorizontalEdgeFilter(MacroBlockH264* pMb, short** img, int lumFlag, int rowOff, const int* bS)
+{
+	if( !(bS[0]|bS[1]|bS[2]|bS[3]) )
+		return;
 
-						/// Apply to the aligned chr edge assuming 4:2:0 here only.
-						if(i == 2)
-						{
-							HorizontalFilter(pMb, cbRef, 0, i<<1, j<<1, 2, bS);	///< At (row = 2*i, col = 2*j) do iter = 2 cols.
-							HorizontalFilter(pMb, crRef, 0, i<<1, j<<1, 2, bS);	///< At (row = 2*i, col = 2*j) do iter = 2 cols.
-						}//end if i...
-					}//end if bS...
+	int len = lumFlag? 16 : 8;
+	int seg = len >> 2;
+#ifdef RTVC_SIMD
+	int qPav, offX, offY;
+	if(lumFlag)
+	{
+		qPav	= pMb->_mbQP;
+		/// Modify to average qP with the neighbour if this is a mb edge.
+		if( (pMb->_aboveMb != NULL) && (rowOff == 0) )
+			qPav	= (qPav + pMb->_aboveMb->_mbQP + 1) >> 1;
+		offX	= pMb->_offLumX;
+		offY	= pMb->_offLumY + rowOff;
+	}//end if lumFlag...
+	else
+	{
+		qPav	= MacroBlockH264::GetQPc(pMb->_mbQP);
+		if( (pMb->_aboveMb != NULL) && (rowOff == 0) )
+			qPav	= (qPav + MacroBlockH264::GetQPc(pMb->_aboveMb->_mbQP) + 1) >> 1;
+		offX	= pMb->_offChrX;
+		offY	= pMb->_offChrY + rowOff;
+	}//end else...
 
-				}//end for i & j...
-		}//end else...
+	int a = H264v2Codec::alpha[qPav];
+	if(a == 0)
+		return;	///< No pels can pass the boundary difference test.
 
-	}//end for mb...
+	short laneBS[16];
+	short laneTC0[16];
+	GetEdgeLanes(bS, seg, len, qPav, laneBS, laneTC0);
 
-}//end ApplyLoopFilter.
+	for(int c = 0; c < len; c += 8)
+	{
+		__m128i v[8];
+		int i;
+		for(i = 0; i < 8; i++)
+			v[i] = _mm_loadu_si128((const __m128i *)(&img[offY - 4 + i][offX + c]));
+		H264V2_FilterEdge8(v, _mm_loadu_si128((const __m128i *)(&laneBS[c])), _mm_loadu_si128((const __m128i *)(&laneTC0[c])), a, H264v2Codec::beta[qPav], lumFlag);
+		for(i = 1; i < 7; i++)
+			_mm_storeu_si128((__m128i *)(&img[offY - 4 + i][offX + c]), v[i]);
+	}//end for c...
+#else
+	for(int k = 0; k < 4; k++)
+	{
+		if(bS[k])
+			HorizontalFilter(pMb, img, lumFlag, rowOff, k * seg, seg, bS[k]);
+	}//end for k...
+#endif
+}//end HorizontalEdgeFilter.
+
+/** Expand the segment boundary strengths of an edge to one per pel.
+@param bS			: Boundary strength of the 4 segments.
+@param seg		: Pels per segment.
+@param len		: Pels along the edge.
+@param qPav		: Average qP across the edge.
+@param pBS		: Boundary strength per pel (returned).
+@param pTC0		: Clipping threshold tC0 per pel for bS < 4 (returned).
+@return				: none.
+*/
+void H264v2Codec::GetEdgeLanes(const int* bS, int seg, int len, int qPav, short* pBS, short* pTC0)
+{
+	for(int k = 0; k < len; k++)
+	{
+		int s = bS[k / seg];
+		pBS[k]	= (short)s;
+		pTC0[k] = ((s > 0)&&(s < 4))? (short)indexAbS[s-1][qPav] : 0;
+	}//end for k...
+}//end GetEdgeLanes.
 
 /** Apply the in-loop deblocking filter to vertical block edges.
 The deblocking filter is applied only after the image has been fully
@@ -5990,6 +7647,196 @@ void H264v2Codec::TransAndQuantInter16x16MBlk(MacroBlockH264* pMb)
 
 }//end TransAndQuantInter16x16MBlk.
 
+/** Transform and Quantise an Inter_16x16 macroblock via the coeff cache.
+The transform is separated from the quantisation with identical results to
+TransAndQuantInter16x16MBlk(). If the macroblock residual is not in the cache 
+then it is transformed from the blocks and the unquantised coeffs are stored 
+in the cache. The coeffs are then loaded from the cache into the blocks and 
+quantised with the current mb QP.
+@param pMb		: Macroblock to transform.
+@param pCache	: Cache mem for this macroblock of H264V2_COEFF_CACHE_LEN coeffs.
+@param cached	: The cache holds the coeffs of the mb residual.
+@return				: none
+*/
+void H264v2Codec::TransAndQuantInter16x16MBlkCached(MacroBlockH264* pMb, short* pCache, int cached)
+{
+	int i;
+	int mbLumQP	= pMb->_mbQP;
+	int mbChrQP = MacroBlockH264::GetQPc(pMb->_mbQP);
+
+	BlockH264*	pLumBlk		= &(pMb->_lumBlk[0][0]);	///< Assume these are linear arrays that wrap in raster scan order.
+	BlockH264*	pCbBlk		= &(pMb->_cbBlk[0][0]);
+	BlockH264*	pCrBlk		= &(pMb->_crBlk[0][0]);
+	short*			pLumC			= pCache;
+	short*			pCbC			= &(pCache[256]);
+	short*			pCrC			= &(pCache[320]);
+	short*			pDcCbC		= &(pCache[384]);
+	short*			pDcCrC		= &(pCache[388]);
+
+	if(!cached)
+	{
+		/// Forward 4x4 transform without scaling or quantisation. The chr DC terms are pulled
+		/// out in raster scan order to align with the spatial location in the DC blocks.
+		_pF4x4TLum->SetMode(IForwardTransform::TransformOnly);
+		_pF4x4TChr->SetMode(IForwardTransform::TransformOnly);
+		for(i = 0; i < 16; i++)
+		{
+			pLumBlk[i].ForwardTransform(_pF4x4TLum);
+			memcpy((void *)&(pLumC[i << 4]), (const void *)pLumBlk[i].GetBlk(), 16 * sizeof(short));
+		}//end for i...
+		for(i = 0; i < 4; i++)
+		{
+			pCbBlk[i].ForwardTransform(_pF4x4TChr);
+			pDcCbC[i] = pCbBlk[i].GetDC();
+			pCbBlk[i].SetDC(0);
+			memcpy((void *)&(pCbC[i << 4]), (const void *)pCbBlk[i].GetBlk(), 16 * sizeof(short));
+
+			pCrBlk[i].ForwardTransform(_pF4x4TChr);
+			pDcCrC[i] = pCrBlk[i].GetDC();
+			pCrBlk[i].SetDC(0);
+			memcpy((void *)&(pCrC[i << 4]), (const void *)pCrBlk[i].GetBlk(), 16 * sizeof(short));
+		}//end for i...
+	}//end if !cached...
+	else
+	{
+		for(i = 0; i < 16; i++)
+			memcpy((void *)pLumBlk[i].GetBlk(), (const void *)&(pLumC[i << 4]), 16 * sizeof(short));
+		for(i = 0; i < 4; i++)
+		{
+			memcpy((void *)pCbBlk[i].GetBlk(), (const void *)&(pCbC[i << 4]), 16 * sizeof(short));
+			memcpy((void *)pCrBlk[i].GetBlk(), (const void *)&(pCrC[i << 4]), 16 * sizeof(short));
+		}//end for i...
+	}//end else...
+	memcpy((void *)pMb->_cbDcBlk.GetBlk(), (const void *)pDcCbC, 4 * sizeof(short));
+	memcpy((void *)pMb->_crDcBlk.GetBlk(), (const void *)pDcCrC, 4 * sizeof(short));
+
+	/// Scale and quant.
+	_pF4x4TLum->SetParameter(IForwardTransform::QUANT_ID, mbLumQP);
+	_pF4x4TChr->SetParameter(IForwardTransform::QUANT_ID, mbChrQP);
+	_pFDC2x2T->SetParameter(IForwardTransform::QUANT_ID, mbChrQP);
+	_pF4x4TLum->SetMode(IForwardTransform::QuantOnly);
+	_pF4x4TChr->SetMode(IForwardTransform::QuantOnly);
+	for(i = 0; i < 16; i++)
+		pLumBlk[i].Quantise(_pF4x4TLum);
+	for(i = 0; i < 4; i++)
+	{
+		pCbBlk[i].Quantise(_pF4x4TChr);
+		pCrBlk[i].Quantise(_pF4x4TChr);
+	}//end for i...
+
+	/// Transform and quant the DC blocks.
+	pMb->_cbDcBlk.ForwardTransform(_pFDC2x2T);
+	pMb->_crDcBlk.ForwardTransform(_pFDC2x2T);
+
+	/// Leave the modes as TransAndQuantInter16x16MBlk() does.
+	_pF4x4TLum->SetMode(IForwardTransform::TransformAndQuant);
+
+}//end TransAndQuantInter16x16MBlkCached.
+
+/** Test if the residual of an Inter_16x16 macroblock quantises to zero.
+The residual must be loaded into the blks. Mode 1 only accepts a residual where
+every quantised coeff is certain to be zero and the result is then identical to
+the transform and quantisation. Mode 2 relaxes the AC coeff bounds and drops
+small residuals that are not certain to quantise to zero. The blks are cleared when the residual is accepted.
+@param pMb	: Macroblock to test.
+@param mode	: 1 = exact, 2 = relaxed AC bounds.
+@return			: 1 = all coeffs are zero, 0 = transform required.
+*/
+int H264v2Codec::ZeroResidualInter16x16MBlk(MacroBlockH264* pMb, int mode)
+{
+	int blk;
+	int sum[4];
+
+	/// A quantised coeff is zero when |coeff| x norm < (2^scale - f) with f = 2^scale/6 for the Inter
+	/// 4x4 coeffs and f = 2^(scale+1)/3 for the Chr DC coeffs.
+	int lumQP		= pMb->_mbQP;
+	int chrQP		= MacroBlockH264::GetQPc(lumQP);
+	int lumLim	= (1 << (15 + lumQP/6)) - ((1 << (15 + lumQP/6))/6);
+	int chrLim	= (1 << (15 + chrQP/6)) - ((1 << (15 + chrQP/6))/6);
+	int dcLim		= (1 << (16 + chrQP/6)) - 2*((1 << (15 + chrQP/6))/3);
+	const int* pLumNorm = zeroResidualNorm[lumQP % 6];
+	const int* pChrNorm = zeroResidualNorm[chrQP % 6];
+
+	/// Lum blks including the DC coeff.
+	BlockH264* pBlk = &(pMb->_lumBlk[0][0]);	///< Linear array in raster scan order.
+	for(blk = 0; blk < 16; blk++, pBlk++)
+	{
+		if(!ZeroResidual4x4(pBlk->GetBlk(), pLumNorm, lumLim, mode, &(sum[0])))
+			return(0);	///< Early exit.
+	}//end for blk...
+
+	/// Cb and Cr blks with the 2x2 transform of the blk sums for the DC coeffs.
+	for(int c = 0; c < 2; c++)
+	{
+		pBlk = (c == 0) ? &(pMb->_cbBlk[0][0]) : &(pMb->_crBlk[0][0]);
+		for(blk = 0; blk < 4; blk++, pBlk++)
+		{
+			if(!ZeroResidual4x4(pBlk->GetBlk(), pChrNorm, chrLim, mode, &(sum[blk])))
+				return(0);
+		}//end for blk...
+
+		if( ((abs(sum[0] + sum[1] + sum[2] + sum[3]) * pChrNorm[0]) >= dcLim)||
+				((abs(sum[0] - sum[1] + sum[2] - sum[3]) * pChrNorm[0]) >= dcLim)||
+				((abs(sum[0] + sum[1] - sum[2] - sum[3]) * pChrNorm[0]) >= dcLim)||
+				((abs(sum[0] - sum[1] - sum[2] + sum[3]) * pChrNorm[0]) >= dcLim) )
+			return(0);
+	}//end for c...
+
+	/// Clear the residual from the coded blks and the Chr DC blks.
+	for(blk = MBH264_LUM_0_0; blk < MBH264_NUM_BLKS; blk++)
+		pMb->_blkParam[blk].pBlk->Zero();
+
+	return(1);
+}//end ZeroResidualInter16x16MBlk.
+
+/** Test if the quantised 4x4 coeffs of a residual blk are zero.
+The abs residual is summed over the outer (0,3) and inner (1,2) rows and cols 
+of the blk. The transform basis magnitudes are 1 for the even and (2,1,1,2) or 
+(1,2,2,1) for the odd basis functions and the weighted sums then bound each coeff.
+The relaxed mode tests the DC coeff with the blk sum and all the AC coeffs with
+the sum of abs differences at the (even,odd) norm. The blk sum is the unscaled
+DC coeff and is returned for the Chr DC test.
+@param pB			: Residual blk in raster order.
+@param pNorm	: Quant norm factors of the (even,even), (odd,odd) and (even,odd) positions.
+@param lim		: Zero limit of |coeff| x norm.
+@param mode		: 1 = exact, 2 = relaxed AC bounds.
+@param pSum		: Returned blk sum.
+@return				: 1 = all zero, 0 = non-zero coeffs possible.
+*/
+int H264v2Codec::ZeroResidual4x4(const short* pB, const int* pNorm, int lim, int mode, int* pSum)
+{
+	int oo = abs(pB[0]) + abs(pB[3]) + abs(pB[12]) + abs(pB[15]);	///< Outer row, outer col.
+	int oi = abs(pB[1]) + abs(pB[2]) + abs(pB[13]) + abs(pB[14]);	///< Outer row, inner col.
+	int io = abs(pB[4]) + abs(pB[7]) + abs(pB[8])  + abs(pB[11]);
+	int ii = abs(pB[5]) + abs(pB[6]) + abs(pB[9])  + abs(pB[10]);
+	int sad = oo + oi + io + ii;
+
+	*pSum = pB[0] + pB[1] + pB[2]  + pB[3]  + pB[4]  + pB[5]  + pB[6]  + pB[7] + 
+					pB[8] + pB[9] + pB[10] + pB[11] + pB[12] + pB[13] + pB[14] + pB[15];
+
+	if(mode != 1)	///< DC coeff and the AC coeffs bounded with the mid gain.
+		return( ((abs(*pSum) * pNorm[0]) < lim)&&((sad * pNorm[2]) < lim) );
+	if( (sad * pNorm[0]) >= lim )	///< (even,even) coeffs.
+		return(0);
+
+	/// (even,odd) and (odd,even) coeffs.
+	int colOuter = oo + io;
+	int rowOuter = oo + oi;
+	int eo = sad + ((colOuter > (sad - colOuter)) ? colOuter : (sad - colOuter));
+	int oe = sad + ((rowOuter > (sad - rowOuter)) ? rowOuter : (sad - rowOuter));
+	if( (((eo > oe) ? eo : oe) * pNorm[2]) >= lim )
+		return(0);
+
+	/// (odd,odd) coeffs with the 4 basis magnitude products.
+	int a = 4*oo + 2*oi + 2*io +   ii;
+	int b = 2*oo + 4*oi +   io + 2*ii;
+	int c = 2*oo +   oi + 4*io + 2*ii;
+	int d =   oo + 2*oi + 2*io + 4*ii;
+	if(b > a) a = b;
+	if(d > c) c = d;
+	return( (((a > c) ? a : c) * pNorm[1]) < lim );
+}//end ZeroResidual4x4.
+
 /** Inverse Transform and Quantise an Inter_16x16 macroblock
 This method provides a speed improvement for macroblock processing and code refactoring.
 @param pMb				: Macroblock to inverse transform.
@@ -6088,6 +7935,9 @@ intra_16x16 prediction mode.
 */
 int H264v2Codec::GetIntra16x16LumPredAndMode(MacroBlockH264* pMb, OverlayMem2Dv2* in, OverlayMem2Dv2* ref, OverlayMem2Dv2* pred)
 {
+	MacroBlockH264* aboveMb			= GetIntraPredMb(pMb->_aboveMb);
+	MacroBlockH264* aboveLeftMb	= GetIntraPredMb(pMb->_aboveLeftMb);
+	MacroBlockH264* leftMb			= GetIntraPredMb(pMb->_leftMb);
 	int i,j;
 	int a,b,c;	///< Plane mode intermediates.
 	int predDC;	///< Other mode intermediates.
@@ -6108,10 +7958,10 @@ int H264v2Codec::GetIntra16x16LumPredAndMode(MacroBlockH264* pMb, OverlayMem2Dv2
 	/// Every mode has intermediate values that the predictions are based on and
 	/// these must be prepared first. The values are further dependent on the 
 	/// availability of the neighbourhood.
-	bool all						= (pMb->_aboveMb != NULL)&&(pMb->_aboveLeftMb != NULL)&&(pMb->_leftMb != NULL);
-	bool aboveOnly			= (pMb->_aboveMb != NULL)&&(pMb->_leftMb == NULL);	///< Don't care about above left.
-	bool leftOnly				= (pMb->_aboveMb == NULL)&&(pMb->_leftMb != NULL);	///< Don't care about above left.
-	bool aboveAndLeft		= (pMb->_aboveMb != NULL)&&(pMb->_leftMb != NULL);	///< Don't care about above left.
+	bool all						= (aboveMb != NULL)&&(aboveLeftMb != NULL)&&(leftMb != NULL);
+	bool aboveOnly			= (aboveMb != NULL)&&(leftMb == NULL);	///< Don't care about above left.
+	bool leftOnly				= (aboveMb == NULL)&&(leftMb != NULL);	///< Don't care about above left.
+	bool aboveAndLeft		= (aboveMb != NULL)&&(leftMb != NULL);	///< Don't care about above left.
 
 	/// The selection process uses a patial sum of the distortion method where a grid of sampling points
 	/// is tested with new sets of points at each iteration. If there is no change in the winning mode
@@ -6498,6 +8348,9 @@ parameter. Used by the decoder.
 */
 int H264v2Codec::GetIntra16x16LumPred(MacroBlockH264* pMb, OverlayMem2Dv2* ref, OverlayMem2Dv2* pred, int predMode)
 {
+	MacroBlockH264* aboveMb			= GetIntraPredMb(pMb->_aboveMb);
+	MacroBlockH264* aboveLeftMb	= GetIntraPredMb(pMb->_aboveLeftMb);
+	MacroBlockH264* leftMb			= GetIntraPredMb(pMb->_leftMb);
 	int i,j;
 
 	short**	ref2D		= ref->Get2DSrcPtr();
@@ -6512,7 +8365,7 @@ int H264v2Codec::GetIntra16x16LumPred(MacroBlockH264* pMb, OverlayMem2Dv2* ref,
 	{
 		case MacroBlockH264::Intra_16x16_Vert:
 			{
-				if(pMb->_aboveMb != NULL)	///< Vert prediction only cares about the macroblock above.
+				if(aboveMb != NULL)	///< Vert prediction only cares about the macroblock above.
 				{
 					for(i = 0; i < 16; i++)
 						for(j = 0; j < 16; j++)
@@ -6528,7 +8381,7 @@ int H264v2Codec::GetIntra16x16LumPred(MacroBlockH264* pMb, OverlayMem2Dv2* ref,
 			break;
 		case MacroBlockH264::Intra_16x16_Horiz:
 			{
-				if(pMb->_leftMb != NULL)	///< Horiz prediction only cares about the macroblock to the left.
+				if(leftMb != NULL)	///< Horiz prediction only cares about the macroblock to the left.
 				{
 					for(i = 0; i < 16; i++)
 						for(j = 0; j < 16; j++)
@@ -6544,9 +8397,9 @@ int H264v2Codec::GetIntra16x16LumPred(MacroBlockH264* pMb, OverlayMem2Dv2* ref,
 			break;
 		case MacroBlockH264::Intra_16x16_DC:
 			{
-				bool aboveAndLeft		= (pMb->_aboveMb != NULL)&&(pMb->_leftMb != NULL);
-				bool aboveOnly			= (pMb->_aboveMb != NULL)&&(pMb->_leftMb == NULL);
-				bool leftOnly				= (pMb->_aboveMb == NULL)&&(pMb->_leftMb != NULL);
+				bool aboveAndLeft		= (aboveMb != NULL)&&(leftMb != NULL);
+				bool aboveOnly			= (aboveMb != NULL)&&(leftMb == NULL);
+				bool leftOnly				= (aboveMb == NULL)&&(leftMb != NULL);
 
 				int predDC = 0;
 				if(aboveAndLeft)
@@ -6577,7 +8430,7 @@ int H264v2Codec::GetIntra16x16LumPred(MacroBlockH264* pMb, OverlayMem2Dv2* ref,
 			break;
 		case MacroBlockH264::Intra_16x16_Plane:
 			{
-				bool all = (pMb->_aboveMb != NULL)&&(pMb->_aboveLeftMb != NULL)&&(pMb->_leftMb != NULL);
+				bool all = (aboveMb != NULL)&&(aboveLeftMb != NULL)&&(leftMb != NULL);
 
 				if(all)	///< All the neighbouring macroblocks must be available for prediction.
 				{
@@ -6620,28 +8473,30 @@ max Lum value (128) as the prediction.
 */
 void H264v2Codec::GetIntra16x16LumDCPred(MacroBlockH264* pMb, OverlayMem2Dv2* lum, OverlayMem2Dv2* pred)
 {
+	MacroBlockH264* aboveMb			= GetIntraPredMb(pMb->_aboveMb);
+	MacroBlockH264* leftMb			= GetIntraPredMb(pMb->_leftMb);
 	int offX, offY, i;
 	int dirCnt		= 0;
 	int predValue	= 0;
 
 	short** img = lum->Get2DSrcPtr();
 
-	if(pMb->_aboveMb != NULL)
+	if(aboveMb != NULL)
 	{
 		dirCnt++;
 		/// The last row of the macroblock above.
-		offX = pMb->_aboveMb->_offLumX;
-		offY = pMb->_aboveMb->_offLumY + 15;
+		offX = aboveMb->_offLumX;
+		offY = aboveMb->_offLumY + 15;
 		for(i = 0; i < 16; i++)
 			predValue += img[offY][offX + i];
 	}//end if _aboveMb...
 
-	if(pMb->_leftMb != NULL)
+	if(leftMb != NULL)
 	{
 		dirCnt++;
 		/// The last col of the macroblock to the left.
-		offX = pMb->_leftMb->_offLumX + 15;
-		offY = pMb->_leftMb->_offLumY;
+		offX = leftMb->_offLumX + 15;
+		offY = leftMb->_offLumY;
 		for(i = 0; i < 16; i++)
 			predValue += img[offY + i][offX];
 	}//end if _leftMb...
@@ -6670,9 +8525,12 @@ this last case for Plane pred.
 */
 int H264v2Codec::GetIntra16x16LumPlanePred(MacroBlockH264* pMb, OverlayMem2Dv2* lum, OverlayMem2Dv2* pred)
 {
+	MacroBlockH264* aboveMb			= GetIntraPredMb(pMb->_aboveMb);
+	MacroBlockH264* aboveLeftMb	= GetIntraPredMb(pMb->_aboveLeftMb);
+	MacroBlockH264* leftMb			= GetIntraPredMb(pMb->_leftMb);
 	int i,j;
 
-	if( (pMb->_aboveMb != NULL)&&(pMb->_aboveLeftMb != NULL)&&(pMb->_leftMb != NULL) )
+	if( (aboveMb != NULL)&&(aboveLeftMb != NULL)&&(leftMb != NULL) )
 	{
 		short**	img2D		= lum->Get2DSrcPtr();
 		int			iOffX		= lum->GetOriginX();	///< Top left of img2D pMb location.
@@ -6723,7 +8581,7 @@ the prediction. The H.264 std does not specify this last case for vert pred.
 int H264v2Codec::GetIntraVertPred(MacroBlockH264* pMb, OverlayMem2Dv2* img, OverlayMem2Dv2* pred, int lumFlag)
 {
 	int i;
-	MacroBlockH264* amb	= pMb->_aboveMb;
+	MacroBlockH264* amb	= GetIntraPredMb(pMb->_aboveMb);
 	
 	if(amb != NULL)
 	{
@@ -6772,7 +8630,7 @@ the prediction. The H.264 std does not specify this last case for vert pred.
 int H264v2Codec::GetIntraHorizPred(MacroBlockH264* pMb, OverlayMem2Dv2* img, OverlayMem2Dv2* pred, int lumFlag)
 {
 	int i,j;
-	MacroBlockH264* lmb	= pMb->_leftMb;
+	MacroBlockH264* lmb	= GetIntraPredMb(pMb->_leftMb);
 	
 	if(lmb != NULL)
 	{
@@ -6828,6 +8686,9 @@ int H264v2Codec::GetIntra8x8ChrPredAndMode(MacroBlockH264* pMb, OverlayMem2Dv2*
 																																OverlayMem2Dv2* refCb,	OverlayMem2Dv2* refCr, 
 																																OverlayMem2Dv2* predCb, OverlayMem2Dv2* predCr)
 {
+	MacroBlockH264* aboveMb			= GetIntraPredMb(pMb->_aboveMb);
+	MacroBlockH264* aboveLeftMb	= GetIntraPredMb(pMb->_aboveLeftMb);
+	MacroBlockH264* leftMb			= GetIntraPredMb(pMb->_leftMb);
 	int i,j;
 	int aCb,bCb,cCb,aCr,bCr,cCr;	///< Plane mode intermediates.
 	int predCbDC[4] = { 0, 0, 0, 0};	///< DC mode intermediates.
@@ -6852,10 +8713,10 @@ int H264v2Codec::GetIntra8x8ChrPredAndMode(MacroBlockH264* pMb, OverlayMem2Dv2*
 	/// Every mode has intermediate values that the predictions are based on and
 	/// these must be prepared first. The values are further dependent on the 
 	/// availability of the neighbourhood.
-	bool all						= (pMb->_aboveMb != NULL)&&(pMb->_aboveLeftMb != NULL)&&(pMb->_leftMb != NULL);
-	bool aboveOnly			= (pMb->_aboveMb != NULL)&&(pMb->_leftMb == NULL);	///< Don't care about above left.
-	bool leftOnly				= (pMb->_aboveMb == NULL)&&(pMb->_leftMb != NULL);	///< Don't care about above left.
-	bool aboveAndLeft		= (pMb->_aboveMb != NULL)&&(pMb->_leftMb != NULL);	///< Don't care about above left.
+	bool all						= (aboveMb != NULL)&&(aboveLeftMb != NULL)&&(leftMb != NULL);
+	bool aboveOnly			= (aboveMb != NULL)&&(leftMb == NULL);	///< Don't care about above left.
+	bool leftOnly				= (aboveMb == NULL)&&(leftMb != NULL);	///< Don't care about above left.
+	bool aboveAndLeft		= (aboveMb != NULL)&&(leftMb != NULL);	///< Don't care about above left.
 
 	/// The selection process uses a patial sum of the distortion method where a grid of sampling points
 	/// is tested with new sets of points at each iteration. If there is no change in the winning mode
@@ -7387,6 +9248,8 @@ this last case for DC pred.
 */
 void H264v2Codec::GetIntra8x8ChrDCPred(MacroBlockH264* pMb, OverlayMem2Dv2* chr, OverlayMem2Dv2* pred)
 {
+	MacroBlockH264* aboveMb			= GetIntraPredMb(pMb->_aboveMb);
+	MacroBlockH264* leftMb			= GetIntraPredMb(pMb->_leftMb);
 	int offX, offY, i;
 	int predValue[4];
 	int dirCnt		= 0;
@@ -7394,12 +9257,12 @@ void H264v2Codec::GetIntra8x8ChrDCPred(MacroBlockH264* pMb, OverlayMem2Dv2* chr,
 
 	short** img = chr->Get2DSrcPtr();
 
-	if(pMb->_aboveMb != NULL)
+	if(aboveMb != NULL)
 	{
 		dirCnt++;
 		/// The last row of the macroblock above.
-		offX = pMb->_aboveMb->_offChrX;
-		offY = pMb->_aboveMb->_offChrY + 7;
+		offX = aboveMb->_offChrX;
+		offY = aboveMb->_offChrY + 7;
 		for(i = 0; i < 4; i++)
 		{
 			sum[0] += img[offY][offX + i];
@@ -7407,12 +9270,12 @@ void H264v2Codec::GetIntra8x8ChrDCPred(MacroBlockH264* pMb, OverlayMem2Dv2* chr,
 		}//end for i...
 	}//end if _aboveMb...
 
-	if(pMb->_leftMb != NULL)
+	if(leftMb != NULL)
 	{
 		dirCnt++;
 		/// The last col of the macroblock to the left.
-		offX = pMb->_leftMb->_offChrX + 7;
-		offY = pMb->_leftMb->_offChrY;
+		offX = leftMb->_offChrX + 7;
+		offY = leftMb->_offChrY;
 		for(i = 0; i < 4; i++)
 		{
 			sum[2] += img[offY + i][offX];
@@ -7430,7 +9293,7 @@ void H264v2Codec::GetIntra8x8ChrDCPred(MacroBlockH264* pMb, OverlayMem2Dv2* chr,
 	}//end if dirCnt...
 	else if(dirCnt == 1)
 	{
-		if(pMb->_leftMb == NULL)
+		if(leftMb == NULL)
 		{
 			predValue[0] = (sum[0] + 2) >> 2;
 			predValue[1] = (sum[1] + 2) >> 2;
@@ -7482,9 +9345,12 @@ as the prediction. The H.264 std does not specify this last case for DC pred.
 */
 int H264v2Codec::GetIntra8x8ChrPlanePred(MacroBlockH264* pMb, OverlayMem2Dv2* chr, OverlayMem2Dv2* pred)
 {
+	MacroBlockH264* aboveMb			= GetIntraPredMb(pMb->_aboveMb);
+	MacroBlockH264* aboveLeftMb	= GetIntraPredMb(pMb->_aboveLeftMb);
+	MacroBlockH264* leftMb			= GetIntraPredMb(pMb->_leftMb);
 	int i,j;
 
-	if( (pMb->_aboveMb != NULL)&&(pMb->_aboveLeftMb != NULL)&&(pMb->_leftMb != NULL) )
+	if( (aboveMb != NULL)&&(aboveLeftMb != NULL)&&(leftMb != NULL) )
 	{
 		short**	img2D		= chr->Get2DSrcPtr();
 		int			iOffX		= chr->GetOriginX();	///< Top left of img2D pMb location.
@@ -7531,8 +9397,10 @@ Process all slices and their macroblocks in order. The reference is always
 written into for this implementation regardless of the state of the writeRef
 parameter. It is required for for later macroblock prediction. The macroblock 
 objs are prepared for coding onto the bit stream. The inclusion of the allowed 
-bits param provides for scope to use bit allocation procedures. Ver. 1 limits 
-the encoding to a single slice with no partitioning.
+bits param provides for scope to use bit allocation procedures. Ver. 1 has no
+intra prediction across slice boundaries and each slice is encoded by its slice
+worker on the thread pool. A single slice may be encoded as a wavefront of
+macroblock rows by the workers.
 @param allowedBits	: Total remaining bits to target.
 @param bitsUsed			: Num of bits used for this encoding (return value).
 @param writeRef			: Ignored.
@@ -7540,43 +9408,127 @@ the encoding to a single slice with no partitioning.
 */
 int H264v2Codec::IntraImgPlaneEncoderImplStdVer1::Encode(int allowedBits, int* bitsUsed, int writeRef)
 {
-	int mb;
-	int len	= _codec->_mbLength;
+	if(_codec->_numSlices > 1)
+		_codec->_pThreadPool->Run(IntraImgPlaneEncoderImplStdVer1::EncodeSliceTask, (void *)this, _codec->_numSlices);
+	else if(_codec->_pWavefrontSync != NULL)
+	{
+		/// The delta QP of the first macroblock in a row refers to the last macroblock
+		/// of the row above that may not be encoded yet. Set all QPs before starting.
+		for(int mb = 0; mb < _codec->_mbLength; mb++)
+			_codec->_pMb[mb]._mbQP = _codec->_slice._qp;
+		_codec->_pWavefrontSync->Reset();
+		_codec->_pThreadPool->Run(IntraImgPlaneEncoderImplStdVer1::EncodeWavefrontTask, (void *)this, _codec->_numWorkers);
+	}//end else if _pWavefrontSync...
+	else
+		EncodeSlice(0);
 
-	/// Set up the input and ref image mem overlays.
-	_codec->_Lum->SetOverlayDim(4,4);
-	_codec->_Cb->SetOverlayDim(4,4);
-	_codec->_Cr->SetOverlayDim(4,4);
-	_codec->_RefLum->SetOverlayDim(4,4);
-	_codec->_RefCb->SetOverlayDim(4,4);
-	_codec->_RefCr->SetOverlayDim(4,4);
-	_codec->_16x16->SetOverlayDim(16, 16);
-	_codec->_16x16->SetOrigin(0, 0);
-	_codec->_8x8_0->SetOverlayDim(8, 8);
-	_codec->_8x8_0->SetOrigin(0, 0);
-	_codec->_8x8_1->SetOverlayDim(8, 8);
-	_codec->_8x8_1->SetOrigin(0, 0);
+	*bitsUsed = 0;
+	return(1);
+}//end IntraImgPlaneEncoderImplStdVer1::Encode.
 
-	/// All integer transforms are Intra in this method.
-	_codec->_pF4x4TLum->SetMode(IForwardTransform::TransformOnly);
-	_codec->_pF4x4TLum->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
-	_codec->_pF4x4TChr->SetMode(IForwardTransform::TransformOnly);
-	_codec->_pF4x4TChr->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
-	/// By default the DC transforms were set in the TransformOnly mode in the Open() method.
-	_codec->_pFDC4x4T->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
-	_codec->_pFDC2x2T->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
+/** Encode the macroblocks of one slice.
+The slice worker's private overlays and IT filters are used with the shared
+image and macroblock mem.
+@param slice	: Slice index.
+@return				: none.
+*/
+void H264v2Codec::IntraImgPlaneEncoderImplStdVer1::EncodeSlice(int slice)
+{
+	int mb;
+	H264v2Codec* pCodec = _codec;
+	if(_codec->_numSlices > 1)
+		pCodec = _codec->_pSliceWorker[slice];
+	int firstMb = _codec->_pSliceFirstMb[slice];
+	int endMb		= _codec->_pSliceFirstMb[slice+1];
+
+	PrepareWorker(pCodec);
 
 	/// Whip through each macroblock in the slice and encode. The stream writing of
 	/// the macroblock is seperate to allow further decision making later.
-	for(mb = 0; mb < len; mb++)
+	for(mb = firstMb; mb < endMb; mb++)
+	{
+		pCodec->_pMb[mb]._mbQP = pCodec->_slice._qp;
+		pCodec->ProcessIntraMbImplStd(&(pCodec->_pMb[mb]), 0);
+		/// A macroblock that starts the next size bounded slice is predicted again from its new neighbours.
+		if( (pCodec->_pSizedSliceFirstMb != NULL)&&!pCodec->FitSizedSliceMb(mb) )
+		{
+			pCodec->_pMb[mb]._mbQP = pCodec->_slice._qp;
+			pCodec->ProcessIntraMbImplStd(&(pCodec->_pMb[mb]), 0);
+			pCodec->FitSizedSliceMb(mb);
+		}//end if _pSizedSliceFirstMb...
+		pCodec->RowLoopFilter(mb);
+	}//end for mb...
+
+}//end IntraImgPlaneEncoderImplStdVer1::EncodeSlice.
+
+/** Encode every n-th macroblock row of a single slice picture.
+Worker w encodes rows w, w+n, w+2n,... for n workers. Each macroblock waits
+for the row above to complete its above and above right neighbours so that
+the intra prediction reads the reconstructed ref img. The stream writing of
+the macroblocks remains in raster order after all the rows are complete.
+@param worker	: Worker index.
+@return				: none.
+*/
+void H264v2Codec::IntraImgPlaneEncoderImplStdVer1::EncodeWavefront(int worker)
+{
+	H264v2Codec*		pCodec	= _codec->_pSliceWorker[worker];
+	WavefrontSync*	pSync		= _codec->_pWavefrontSync;
+	int mbHeight	= pSync->GetNumRows();
+	int mbWidth		= _codec->_mbLength / mbHeight;
+
+	PrepareWorker(pCodec);
+
+	for(int row = worker; row < mbHeight; row += _codec->_numWorkers)
 	{
-		_codec->_pMb[mb]._mbQP = _codec->_slice._qp;
-		_codec->ProcessIntraMbImplStd(&(_codec->_pMb[mb]), 0);
-	}//end for mb...
+		for(int col = 0; col < mbWidth; col++)
+		{
+			int aboveCnt = col + 2;
+			if(aboveCnt > mbWidth)
+				aboveCnt = mbWidth;
+			pSync->WaitForProgress(row - 1, aboveCnt);
+
+			MacroBlockH264* pMb = &(pCodec->_Mb[row][col]);
+			pMb->_mbQP = pCodec->_slice._qp;
+			pCodec->ProcessIntraMbImplStd(pMb, 0);
+
+			pSync->SetProgress(row, col + 1);
+		}//end for col...
+	}//end for row...
+
+}//end IntraImgPlaneEncoderImplStdVer1::EncodeWavefront.
+
+/** Set up a worker for encoding.
+The input and ref image overlays and the IT filters of the worker are prepared
+for intra macroblocks.
+@param pCodec	: Worker codec.
+@return				: none.
+*/
+void H264v2Codec::IntraImgPlaneEncoderImplStdVer1::PrepareWorker(H264v2Codec* pCodec)
+{
+	/// Set up the input and ref image mem overlays.
+	pCodec->_Lum->SetOverlayDim(4,4);
+	pCodec->_Cb->SetOverlayDim(4,4);
+	pCodec->_Cr->SetOverlayDim(4,4);
+	pCodec->_RefLum->SetOverlayDim(4,4);
+	pCodec->_RefCb->SetOverlayDim(4,4);
+	pCodec->_RefCr->SetOverlayDim(4,4);
+	pCodec->_16x16->SetOverlayDim(16, 16);
+	pCodec->_16x16->SetOrigin(0, 0);
+	pCodec->_8x8_0->SetOverlayDim(8, 8);
+	pCodec->_8x8_0->SetOrigin(0, 0);
+	pCodec->_8x8_1->SetOverlayDim(8, 8);
+	pCodec->_8x8_1->SetOrigin(0, 0);
 
-	*bitsUsed = 0;
-	return(1);
-}//end IntraImgPlaneEncoderImplStdVer1::Encode.
+	/// All integer transforms are Intra in this method.
+	pCodec->_pF4x4TLum->SetMode(IForwardTransform::TransformOnly);
+	pCodec->_pF4x4TLum->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
+	pCodec->_pF4x4TChr->SetMode(IForwardTransform::TransformOnly);
+	pCodec->_pF4x4TChr->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
+	/// By default the DC transforms were set in the TransformOnly mode in the Open() method.
+	pCodec->_pFDC4x4T->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
+	pCodec->_pFDC2x2T->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
+
+}//end IntraImgPlaneEncoderImplStdVer1::PrepareWorker.
 
 /** Decode of the Intra macroblocks to the reference img.
 The macroblock obj encodings must be fully defined before calling
@@ -7600,89 +9552,102 @@ int H264v2Codec::IntraImgPlaneDecoderImplStdVer1::Decode(void)
 	/// and parameters have been extracted by the ReadMacroBlockLayer() method.
 	for(mb = 0; mb < len; mb++)
 	{
-		/// Simplify the referencing to the current macroblock.
-		MacroBlockH264* pMb = &(_codec->_pMb[mb]);
-		int lOffX = pMb->_offLumX;
-		int lOffY = pMb->_offLumY;
-		int cOffX = pMb->_offChrX;
-		int cOffY = pMb->_offChrY;
+		_codec->DecodeIntraMbImplStd(&(_codec->_pMb[mb]));
+		_codec->RowLoopFilter(mb);
+	}//end for mb...
 
-		/// --------------------- Inverse Transform & Quantisation --------------------------
-		if(pMb->_mbPartPredMode == MacroBlockH264::Intra_16x16)
-			_codec->InverseTransAndQuantIntra16x16MBlk(pMb, 0);
+	return(1);
+}//end IntraImgPlaneDecoderImplStdVer1::Decode.
 
-		/// --------------------- Image Prediction and Storing -------------------------------------
-		/// From the prediction mode settings, make the appropriate prediction macroblock and then
-		/// add the inverse transformed and quantised values to it. Fill the image (difference) colour 
-		/// components from all the non-DC 4x4 blks (i.e. Not blks = -1, 17, 18) of the macroblock blocks.
+/** Decode an Intra macroblock to the reference img.
+The macroblock encodings must be fully defined and the neighbouring
+macroblocks must be reconstructed in the ref img before calling.
+@param pMb	: Macroblock to decode.
+@return			: none.
+*/
+void H264v2Codec::DecodeIntraMbImplStd(MacroBlockH264* pMb)
+{
+	int lOffX = pMb->_offLumX;
+	int lOffY = pMb->_offLumY;
+	int cOffX = pMb->_offChrX;
+	int cOffY = pMb->_offChrY;
 
-		/// Store blocks into ref img.
-		MacroBlockH264::StoreBlks(pMb, _codec->_RefLum, lOffX, lOffY, _codec->_RefCb, _codec->_RefCr, cOffX, cOffY, 0);
+	/// --------------------- Inverse Transform & Quantisation --------------------------
+	if(pMb->_mbPartPredMode == MacroBlockH264::Intra_16x16)
+		InverseTransAndQuantIntra16x16MBlk(pMb, 0);
 
-		/// Predict the output from the previously decoded neighbour ref macroblocks.
-		/// Lum.
-		_codec->_RefLum->SetOverlayDim(16, 16);
-		_codec->_RefLum->SetOrigin(lOffX, lOffY); ///< Align the Ref Lum img block with this macroblock.
+	/// --------------------- Image Prediction and Storing -------------------------------------
+	/// From the prediction mode settings, make the appropriate prediction macroblock and then
+	/// add the inverse transformed and quantised values to it. Fill the image (difference) colour 
+	/// components from all the non-DC 4x4 blks (i.e. Not blks = -1, 17, 18) of the macroblock blocks.
 
-		switch(pMb->_intra16x16PredMode)
-		{
-			case MacroBlockH264::Intra_16x16_Vert:
-				_codec->GetIntraVertPred(pMb, _codec->_RefLum, _codec->_16x16, 1);
-				break;
-			case MacroBlockH264::Intra_16x16_Horiz:
-				_codec->GetIntraHorizPred(pMb, _codec->_RefLum, _codec->_16x16, 1);
-				break;
-			case MacroBlockH264::Intra_16x16_DC:
-				_codec->GetIntra16x16LumDCPred(pMb, _codec->_RefLum, _codec->_16x16);
-				break;
-			case MacroBlockH264::Intra_16x16_Plane:
-				_codec->GetIntra16x16LumPlanePred(pMb, _codec->_RefLum, _codec->_16x16);
-				break;
-		}//end switch _intra16x16PredMode...
-		
-		_codec->_RefCb->SetOverlayDim(8, 8);
-		_codec->_RefCr->SetOverlayDim(8, 8);
-		_codec->_RefCb->SetOrigin(cOffX, cOffY);
-		_codec->_RefCr->SetOrigin(cOffX, cOffY);
+	/// Store blocks into ref img.
+	MacroBlockH264::StoreBlks(pMb, _RefLum, lOffX, lOffY, _RefCb, _RefCr, cOffX, cOffY, 0);
 
-		switch(pMb->_intraChrPredMode)
-		{
-			case MacroBlockH264::Intra_Chr_DC:
-				_codec->GetIntra8x8ChrDCPred(pMb, _codec->_RefCb, _codec->_8x8_0);
-				_codec->GetIntra8x8ChrDCPred(pMb, _codec->_RefCr, _codec->_8x8_1);
-				break;
-			case MacroBlockH264::Intra_Chr_Horiz:
-				_codec->GetIntraHorizPred(pMb, _codec->_RefCb, _codec->_8x8_0, 0);
-				_codec->GetIntraHorizPred(pMb, _codec->_RefCr, _codec->_8x8_1, 0);
-				break;
-			case MacroBlockH264::Intra_Chr_Vert:
-				_codec->GetIntraVertPred(pMb, _codec->_RefCb, _codec->_8x8_0, 0);
-				_codec->GetIntraVertPred(pMb, _codec->_RefCr, _codec->_8x8_1, 0);
-				break;
-			case MacroBlockH264::Intra_Chr_Plane:
-				_codec->GetIntra8x8ChrPlanePred(pMb, _codec->_RefCb, _codec->_8x8_0);
-				_codec->GetIntra8x8ChrPlanePred(pMb, _codec->_RefCr, _codec->_8x8_1);
-				break;
-		}//end switch _intraChrPredMode...
+	/// Predict the output from the previously decoded neighbour ref macroblocks into the
+	/// temp overlays at their origin.
+	_16x16->SetOrigin(0, 0);
+	_8x8_0->SetOrigin(0, 0);
+	_8x8_1->SetOrigin(0, 0);
+	/// Lum.
+	_RefLum->SetOverlayDim(16, 16);
+	_RefLum->SetOrigin(lOffX, lOffY); ///< Align the Ref Lum img block with this macroblock.
 
-		/// --------------------- Add the prediction -----------------------------------------------
-		/// Lum.
-		_codec->_RefLum->SetOverlayDim(16, 16);
-		_codec->_RefLum->SetOrigin(lOffX, lOffY);           ///< Align the Ref Lum img block with this macroblock.
-		_codec->_RefLum->AddWithClip255(*(_codec->_16x16));	///< Add pred to ref Lum and leave result in ref img.
-		/// Cb.
-		_codec->_RefCb->SetOverlayDim(8, 8);
-		_codec->_RefCb->SetOrigin(cOffX, cOffY);
-		_codec->_RefCb->AddWithClip255(*(_codec->_8x8_0));
-		/// Cr.
-		_codec->_RefCr->SetOverlayDim(8, 8);
-		_codec->_RefCr->SetOrigin(cOffX, cOffY);
-		_codec->_RefCr->AddWithClip255(*(_codec->_8x8_1));
+	switch(pMb->_intra16x16PredMode)
+	{
+		case MacroBlockH264::Intra_16x16_Vert:
+			GetIntraVertPred(pMb, _RefLum, _16x16, 1);
+			break;
+		case MacroBlockH264::Intra_16x16_Horiz:
+			GetIntraHorizPred(pMb, _RefLum, _16x16, 1);
+			break;
+		case MacroBlockH264::Intra_16x16_DC:
+			GetIntra16x16LumDCPred(pMb, _RefLum, _16x16);
+			break;
+		case MacroBlockH264::Intra_16x16_Plane:
+			GetIntra16x16LumPlanePred(pMb, _RefLum, _16x16);
+			break;
+	}//end switch _intra16x16PredMode...
+	
+	_RefCb->SetOverlayDim(8, 8);
+	_RefCr->SetOverlayDim(8, 8);
+	_RefCb->SetOrigin(cOffX, cOffY);
+	_RefCr->SetOrigin(cOffX, cOffY);
 
-	}//end for mb...
+	switch(pMb->_intraChrPredMode)
+	{
+		case MacroBlockH264::Intra_Chr_DC:
+			GetIntra8x8ChrDCPred(pMb, _RefCb, _8x8_0);
+			GetIntra8x8ChrDCPred(pMb, _RefCr, _8x8_1);
+			break;
+		case MacroBlockH264::Intra_Chr_Horiz:
+			GetIntraHorizPred(pMb, _RefCb, _8x8_0, 0);
+			GetIntraHorizPred(pMb, _RefCr, _8x8_1, 0);
+			break;
+		case MacroBlockH264::Intra_Chr_Vert:
+			GetIntraVertPred(pMb, _RefCb, _8x8_0, 0);
+			GetIntraVertPred(pMb, _RefCr, _8x8_1, 0);
+			break;
+		case MacroBlockH264::Intra_Chr_Plane:
+			GetIntra8x8ChrPlanePred(pMb, _RefCb, _8x8_0);
+			GetIntra8x8ChrPlanePred(pMb, _RefCr, _8x8_1);
+			break;
+	}//end switch _intraChrPredMode...
 
-	return(1);
-}//end IntraImgPlaneDecoderImplStdVer1::Decode.
+	/// --------------------- Add the prediction -----------------------------------------------
+	/// Lum.
+	_RefLum->SetOverlayDim(16, 16);
+	_RefLum->SetOrigin(lOffX, lOffY);           ///< Align the Ref Lum img block with this macroblock.
+	_RefLum->AddWithClip255(*(_16x16));	///< Add pred to ref Lum and leave result in ref img.
+	/// Cb.
+	_RefCb->SetOverlayDim(8, 8);
+	_RefCb->SetOrigin(cOffX, cOffY);
+	_RefCb->AddWithClip255(*(_8x8_0));
+	/// Cr.
+	_RefCr->SetOverlayDim(8, 8);
+	_RefCr->SetOrigin(cOffX, cOffY);
+	_RefCr->AddWithClip255(*(_8x8_1));
+}//end DecodeIntraMbImplStd.
 
 /** Encode the image data for Intra pictures with adaptive PQ (minmax).
 The encoder seeks to find the optimal quant value for each macroblock using a minmax algorithm with
@@ -7842,7 +9807,7 @@ int H264v2Codec::IntraImgPlaneEncoderImplMinMax::Encode(int allowedBits, int* bi
 				MacroBlockH264* pMb = &(_codec->_pMb[mb]);
 
 				/// Record the found QP where the macroblock dist is just below Dmax and accumulate the rate for this macroblock.
-				_pQ[mb] = _codec->GetMbQPBelowDmaxVer2(*pMb, _pQ[mb], Dmax, &firstMbChange, qEnd, TRUE);
+				_pQ[mb] = _codec->GetMbQPBelowDmaxVer2(*pMb, _pQ[mb], Dmax, &firstMbChange, qEnd, true, NULL);
 				R += pMb->_rate[_pQ[mb]];
 
 				/// An accurate early exit strategy is not possible because the model prediction require two valid (Dmax,R) points 
@@ -8254,15 +10219,24 @@ int H264v2Codec::GetMbQPBelowDmax(MacroBlockH264 &mb, int atQP, int Dmax, int de
 @param changeMb			: Macroblock index from where the last change was made.
 @param lowestQ			: Lowest allowed quant.
 @param intra				: Is macroblock Intra.
+@param pDistKnown		: Inter mb bit mask of the QP values with a valid distortion. NULL = none.
 @return							: QP value that has dist < Dmax for this macroblock.
 */
-int H264v2Codec::GetMbQPBelowDmaxVer2(MacroBlockH264 &mb, int atQ, int Dmax, int* changeMb, int lowestQ, bool intra)
+int H264v2Codec::GetMbQPBelowDmaxVer2(MacroBlockH264 &mb, int atQ, int Dmax, int* changeMb, int lowestQ, bool intra, unsigned long long* pDistKnown)
 {
 	int i						= atQ;
 	int	di					= mb._distortion[i];
 	int mbIndex			= mb._mbIndex;
 	int lclChangeMb = *changeMb;
 
+	/// An Inter mb distortion at a QP value with a known distortion is not processed on 
+	/// each step. Only the state at the final QP value is required and it is processed 
+	/// once on the way out.
+	unsigned long long known = 0;
+	if(pDistKnown != NULL)
+		known = *pDistKnown;
+	int pending = 0;
+
   /// The delta QP for a mb is constrained to {-26...25}. Therefore if
   /// the current QP value results in a dQP > 25 or < -26 then it must 
   /// be reprocessed before continuing regardless of the Dmax value. The
@@ -8288,8 +10262,13 @@ int H264v2Codec::GetMbQPBelowDmaxVer2(MacroBlockH264 &mb, int atQ, int Dmax, int
       /// mbs and their changed QP values.
       if(mb._mbEncQP == i)
         mb._mb_qp_delta = GetDeltaQP(&mb);        ///< Process new delta QP.
+      else if(known & (1ULL << i))
+        pending = 1;
       else
+      {
 			  ProcessInterMbImplStd(&mb, 0, 2);         ///< Distortion only.
+        known |= (1ULL << i);
+      }//end else...
     }//end if !intra...
 		else
 			ProcessIntraMbImplStd(&mb, 2, 0); ///< Distortion only.
@@ -8312,7 +10291,16 @@ int H264v2Codec::GetMbQPBelowDmaxVer2(MacroBlockH264 &mb, int atQ, int Dmax, int
 
 			mb._mbQP = i;
       if(!intra)
-			  ProcessInterMbImplStd(&mb, 0, 2);
+      {
+        pending = 0;
+        if(known & (1ULL << i))
+          pending = 1;
+        else
+        {
+			    ProcessInterMbImplStd(&mb, 0, 2);
+          known |= (1ULL << i);
+        }//end else...
+      }//end if !intra...
       else
 			  ProcessIntraMbImplStd(&mb, 2, 1); ///< Distortion only without pred mode selection.
 
@@ -8321,6 +10309,15 @@ int H264v2Codec::GetMbQPBelowDmaxVer2(MacroBlockH264 &mb, int atQ, int Dmax, int
 		}//end while i...
 	}//end if i...
 
+  /// Bring the mb state up to the final QP value.
+  if(pending)
+  {
+    mb._mbQP = i;
+	  ProcessInterMbImplStd(&mb, 0, 2);
+  }//end if pending...
+  if(pDistKnown != NULL)
+    *pDistKnown = known;
+
   /// Set the new mb rate at this QP value.
   if(!intra)
   {
@@ -9143,31 +11140,13 @@ int H264v2Codec::InterImgPlaneEncoderImplStdVer1::Encode(int allowedBits, int* b
 	int addRef	= writeRef & 1;
 	int len			= _codec->_mbLength;
 
-	/// Slice without partitioning and therefore only one set of slice parameters.
-
-	/// Set up the input and ref image mem overlays.
-	_codec->_Lum->SetOverlayDim(4,4);
-	_codec->_Cb->SetOverlayDim(4,4);
-	_codec->_Cr->SetOverlayDim(4,4);
-	_codec->_RefLum->SetOverlayDim(4,4);
-	_codec->_RefCb->SetOverlayDim(4,4);
-	_codec->_RefCr->SetOverlayDim(4,4);
-	_codec->_16x16->SetOverlayDim(16, 16);
-	_codec->_8x8_0->SetOverlayDim(8, 8);
-	_codec->_8x8_1->SetOverlayDim(8, 8);
-
-	/// All integer transforms are Inter in this method.
-	_codec->_pF4x4TLum->SetMode(IForwardTransform::TransformOnly);
-	_codec->_pF4x4TLum->SetParameter(IForwardTransform::INTRA_FLAG_ID, 0);
-	_codec->_pF4x4TChr->SetMode(IForwardTransform::TransformOnly);
-	_codec->_pF4x4TChr->SetParameter(IForwardTransform::INTRA_FLAG_ID, 0);
-	/// By default the DC transforms were set in the TransformOnly mode in the Open() method.
+	/// All slices share one set of slice parameters.
 
 	/// Motion estimation has been previously performed outside of this method and therefore
-	/// only motion compensation is required here. Prepare for motion compensation on a per 
-	/// macoblock basis. The vectors themselves are held in _pMotionEstimationResult.
-	if(compRef)
-		_codec->_pMotionCompensator->PrepareForSingleVectorMode();
+	/// only motion compensation is required here. The vectors themselves are held in 
+	/// _pMotionEstimationResult. All the macroblocks are predicted from the unaltered ref 
+	/// before the predictions are written to the ref and therefore no copy of the ref is 
+	/// required.
 
 	/// Get the motion vector list to work with. Assume SIMPLE2D type list as only a
 	/// single 16x16 motion vector is considered per macroblock in this implementation
@@ -9231,23 +11210,52 @@ int H264v2Codec::InterImgPlaneEncoderImplStdVer1::Encode(int allowedBits, int* b
   //}//end if _frameNum...
   /////////////////////////////////////////////////////////////////////////////////////////////
 
-	/// Rip through each macroblock as a linear array and process the
-	/// motion vector and each block within the macroblock.
+	/// The intra refresh band of this picture as a range of macroblock columns or rows. The
+	/// bands of the refresh cycle evenly cover the picture.
+	int refreshStart	= 0;
+	int refreshEnd		= 0;
+	if(_codec->_intraRefresh > 0)
+	{
+		int mbCnt = _codec->_lumWidth/16;
+		if(_codec->_intraRefreshDirection)
+			mbCnt = _codec->_lumHeight/16;
+		int band			= _codec->_intraRefreshPos % _codec->_intraRefresh;
+		refreshStart	= (band * mbCnt)/_codec->_intraRefresh;
+		refreshEnd		= ((band + 1) * mbCnt)/_codec->_intraRefresh;
+	}//end if _intraRefresh...
+
+	/// Rip through each macroblock as a linear array and process the motion vector. All 
+	/// the macroblocks are compensated before the blocks within them are processed per slice.
 	for(int mb = 0; mb < len; mb++)
 	{
 		/// Simplify the referencing to the current macroblock.
 		MacroBlockH264* pMb = &(_codec->_pMb[mb]);
 
+		/// Intra refresh macroblocks have no motion vector and are not compensated. The neighbours
+		/// must see them as intra for their vector prediction.
+		int pos = (_codec->_intraRefreshDirection ? pMb->_offLumY : pMb->_offLumX)/16;
+		if( (pos >= refreshStart)&&(pos < refreshEnd) )
+		{
+			pMb->_intraFlag				= 1;
+			pMb->_mbPartPredMode	= MacroBlockH264::Intra_16x16;
+			pMb->_mbQP						= _codec->_slice._qp;
+			pMb->_mvX[MacroBlockH264::_16x16]		= 0;
+			pMb->_mvY[MacroBlockH264::_16x16]		= 0;
+			pMb->_mvdX[MacroBlockH264::_16x16]	= 0;
+			pMb->_mvdY[MacroBlockH264::_16x16]	= 0;
+			continue;
+		}//end if pos...
+
 		///------------------- Motion compensation ------------------------------------------------
-		pMb->_mbPartPredMode = MacroBlockH264::Inter_16x16;	///< Fixed at 16x16 for now.
+		pMb->_intraFlag				= 0;
+		pMb->_mbPartPredMode	= MacroBlockH264::Inter_16x16;	///< Fixed at 16x16 for now.
 
-		/// Get the 16x16 motion vector from the motion estimation result list and apply
-		/// it to the macroblock. The reference image will then hold the compensated macroblock
-		/// to be used as the prediction for calcualting the residual.
+		/// Get the 16x16 motion vector from the motion estimation result list and predict
+		/// the macroblock with it. 
 		int mvx = _codec->_pMotionEstimationResult->GetSimpleElement(mb, 0);
 		int mvy = _codec->_pMotionEstimationResult->GetSimpleElement(mb, 1);
 		if(compRef)
-			_codec->_pMotionCompensator->Compensate(pMb->_offLumX, pMb->_offLumY, mvx, mvy);
+			_codec->_pMotionCompensator->Predict(pMb->_offLumX, pMb->_offLumY, mvx, mvy);
 
     /////////////////////////////////////////////////////////////////////////////////////////////
     /// Research Data Collection: Mb data capture.
@@ -9274,6 +11282,10 @@ int H264v2Codec::InterImgPlaneEncoderImplStdVer1::Encode(int allowedBits, int* b
     //}//end if _frameNum...
     /////////////////////////////////////////////////////////////////////////////////////////////
 
+		/// The QP is set here for all macroblocks as the delta QP refers to the previous
+		/// macroblock that may be encoded concurrently.
+		pMb->_mbQP = _codec->_slice._qp;
+
 		/// Store the vector for this macroblock.
 		pMb->_mvX[MacroBlockH264::_16x16]	= mvx;
 		pMb->_mvY[MacroBlockH264::_16x16]	= mvy;
@@ -9285,12 +11297,32 @@ int H264v2Codec::InterImgPlaneEncoderImplStdVer1::Encode(int allowedBits, int* b
 		pMb->_mvdX[MacroBlockH264::_16x16] = mvx - predX;
 		pMb->_mvdY[MacroBlockH264::_16x16] = mvy - predY;
 
-		///------------------- Macroblock processing ----------------------------------------------
-		pMb->_mbQP = _codec->_slice._qp;
-    _codec->ProcessInterMbImplStd(pMb, addRef, 0);
-
 	}//end for mb...
 
+	/// The reference image will then hold the compensated macroblocks to be used as the 
+	/// prediction for calculating the residual.
+	if(compRef)
+	{
+		for(int mb = 0; mb < len; mb++)
+		{
+			MacroBlockH264* pMb = &(_codec->_pMb[mb]);
+			if(!pMb->_intraFlag)
+				_codec->_pMotionCompensator->CommitPrediction(pMb->_offLumX, pMb->_offLumY, pMb->_mvX[MacroBlockH264::_16x16], pMb->_mvY[MacroBlockH264::_16x16]);
+		}//end for mb...
+	}//end if compRef...
+
+	///------------------- Macroblock processing ----------------------------------------------
+	_addRef = addRef;
+	if(_codec->_numSlices > 1)
+		_codec->_pThreadPool->Run(InterImgPlaneEncoderImplStdVer1::EncodeSliceTask, (void *)this, _codec->_numSlices);
+	else if(_codec->_pWavefrontSync != NULL)
+	{
+		_codec->_pWavefrontSync->Reset();
+		_codec->_pThreadPool->Run(InterImgPlaneEncoderImplStdVer1::EncodeWavefrontTask, (void *)this, _codec->_numWorkers);
+	}//end else if _pWavefrontSync...
+	else
+		EncodeSlice(0);
+
   /////////////////////////////////////////////////////////////////////////////////////////////
   /// Research Data Collection: Dump to file and clean up in reverse order.
 
@@ -9342,6 +11374,192 @@ int H264v2Codec::InterImgPlaneEncoderImplStdVer1::Encode(int allowedBits, int* b
 	return(1);
 }//end InterImgPlaneEncoderImplStdVer1::Encode.
 
+/** Process the motion compensated macroblocks of one slice.
+The slice worker's private overlays and IT filters are used with the shared
+image and macroblock mem. The motion vectors must be set before calling.
+@param slice	: Slice index.
+@return				: none.
+*/
+void H264v2Codec::InterImgPlaneEncoderImplStdVer1::EncodeSlice(int slice)
+{
+	H264v2Codec* pCodec = _codec;
+	if(_codec->_numSlices > 1)
+		pCodec = _codec->_pSliceWorker[slice];
+	int firstMb = _codec->_pSliceFirstMb[slice];
+	int endMb		= _codec->_pSliceFirstMb[slice+1];
+
+	PrepareWorker(pCodec);
+
+	for(int mb = firstMb; mb < endMb; mb++)
+	{
+		MacroBlockH264* pMb = &(pCodec->_pMb[mb]);
+		pMb->_mbQP = pCodec->_slice._qp;
+		if(pMb->_intraFlag)
+			ProcessIntraRefreshMb(pCodec, pMb);
+		else
+		{
+			/// Size bounded slices may have started after the vectors were predicted.
+			if(pCodec->_pSizedSliceFirstMb != NULL)
+				SetMbMotionVecDiff(pMb);
+			pCodec->ProcessInterMbImplStd(pMb, _addRef, 0);
+		}//end else...
+		if( (pCodec->_pSizedSliceFirstMb != NULL)&&!pCodec->FitSizedSliceMb(mb) )
+		{
+			RecodeSizedSliceMb(pCodec, pMb);
+			pCodec->FitSizedSliceMb(mb);
+		}//end if _pSizedSliceFirstMb...
+		pCodec->RowLoopFilter(mb);
+	}//end for mb...
+
+}//end InterImgPlaneEncoderImplStdVer1::EncodeSlice.
+
+/** Process every n-th motion compensated macroblock row of a single slice picture.
+Worker w processes rows w, w+n, w+2n,... for n workers with each macroblock 
+trailing the row above by two macroblocks. The motion vectors must be set 
+before calling.
+@param worker	: Worker index.
+@return				: none.
+*/
+void H264v2Codec::InterImgPlaneEncoderImplStdVer1::EncodeWavefront(int worker)
+{
+	H264v2Codec*		pCodec	= _codec->_pSliceWorker[worker];
+	WavefrontSync*	pSync		= _codec->_pWavefrontSync;
+	int mbHeight	= pSync->GetNumRows();
+	int mbWidth		= _codec->_mbLength / mbHeight;
+
+	PrepareWorker(pCodec);
+
+	for(int row = worker; row < mbHeight; row += _codec->_numWorkers)
+	{
+		for(int col = 0; col < mbWidth; col++)
+		{
+			int aboveCnt = col + 2;
+			if(aboveCnt > mbWidth)
+				aboveCnt = mbWidth;
+			pSync->WaitForProgress(row - 1, aboveCnt);
+
+			MacroBlockH264* pMb = &(pCodec->_Mb[row][col]);
+			pMb->_mbQP = pCodec->_slice._qp;
+			if(pMb->_intraFlag)
+				ProcessIntraRefreshMb(pCodec, pMb);
+			else
+				pCodec->ProcessInterMbImplStd(pMb, _addRef, 0);
+
+			pSync->SetProgress(row, col + 1);
+		}//end for col...
+	}//end for row...
+
+}//end InterImgPlaneEncoderImplStdVer1::EncodeWavefront.
+
+/** Set up a worker for encoding.
+The input and ref image overlays and the IT filters of the worker are prepared
+for inter macroblocks.
+@param pCodec	: Worker codec.
+@return				: none.
+*/
+void H264v2Codec::InterImgPlaneEncoderImplStdVer1::PrepareWorker(H264v2Codec* pCodec)
+{
+	/// Set up the input and ref image mem overlays.
+	pCodec->_Lum->SetOverlayDim(4,4);
+	pCodec->_Cb->SetOverlayDim(4,4);
+	pCodec->_Cr->SetOverlayDim(4,4);
+	pCodec->_RefLum->SetOverlayDim(4,4);
+	pCodec->_RefCb->SetOverlayDim(4,4);
+	pCodec->_RefCr->SetOverlayDim(4,4);
+	pCodec->_16x16->SetOverlayDim(16, 16);
+	pCodec->_8x8_0->SetOverlayDim(8, 8);
+	pCodec->_8x8_1->SetOverlayDim(8, 8);
+
+	/// All integer transforms are Inter in this method.
+	pCodec->_pF4x4TLum->SetMode(IForwardTransform::TransformOnly);
+	pCodec->_pF4x4TLum->SetParameter(IForwardTransform::INTRA_FLAG_ID, 0);
+	pCodec->_pF4x4TChr->SetMode(IForwardTransform::TransformOnly);
+	pCodec->_pF4x4TChr->SetParameter(IForwardTransform::INTRA_FLAG_ID, 0);
+	/// By default the DC transforms were set in the TransformOnly mode in the Open() method.
+
+}//end InterImgPlaneEncoderImplStdVer1::PrepareWorker.
+
+/** Intra code an intra refresh macroblock of a P-picture.
+The IT filters of the worker are switched to intra for the macroblock and 
+then restored for the inter macroblocks that follow. The intra prediction 
+is from the reconstructed neighbours in the ref img.
+@param pCodec	: Worker codec.
+@param pMb		: Macroblock to encode.
+@return				: none.
+*/
+void H264v2Codec::InterImgPlaneEncoderImplStdVer1::ProcessIntraRefreshMb(H264v2Codec* pCodec, MacroBlockH264* pMb)
+{
+	/// The predictions are written to the temp overlays at their origin.
+	pCodec->_16x16->SetOverlayDim(16, 16);
+	pCodec->_16x16->SetOrigin(0, 0);
+	pCodec->_8x8_0->SetOverlayDim(8, 8);
+	pCodec->_8x8_0->SetOrigin(0, 0);
+	pCodec->_8x8_1->SetOverlayDim(8, 8);
+	pCodec->_8x8_1->SetOrigin(0, 0);
+
+	int dc2x2Intra = pCodec->_pFDC2x2T->GetParameter(IForwardTransform::INTRA_FLAG_ID);
+	pCodec->_pF4x4TLum->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
+	pCodec->_pF4x4TChr->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
+	pCodec->_pFDC4x4T->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
+	pCodec->_pFDC2x2T->SetParameter(IForwardTransform::INTRA_FLAG_ID, 1);
+
+	pCodec->ProcessIntraMbImplStd(pMb, 0);
+
+	pCodec->_pF4x4TLum->SetMode(IForwardTransform::TransformOnly);
+	pCodec->_pF4x4TLum->SetParameter(IForwardTransform::INTRA_FLAG_ID, 0);
+	pCodec->_pF4x4TChr->SetMode(IForwardTransform::TransformOnly);
+	pCodec->_pF4x4TChr->SetParameter(IForwardTransform::INTRA_FLAG_ID, 0);
+	pCodec->_pFDC2x2T->SetParameter(IForwardTransform::INTRA_FLAG_ID, dc2x2Intra);
+}//end InterImgPlaneEncoderImplStdVer1::ProcessIntraRefreshMb.
+
+/** Set the motion vector difference of an inter macroblock.
+The prediction is the median of the neighbourhood vectors within the slice.
+@param pMb	: Macroblock with its vector set.
+@return			: none.
+*/
+void H264v2Codec::InterImgPlaneEncoderImplStdVer1::SetMbMotionVecDiff(MacroBlockH264* pMb)
+{
+	int predX, predY;
+	MacroBlockH264::GetMbMotionMedianPred(pMb, &predX, &predY);
+	pMb->_mvdX[MacroBlockH264::_16x16] = pMb->_mvX[MacroBlockH264::_16x16] - predX;
+	pMb->_mvdY[MacroBlockH264::_16x16] = pMb->_mvY[MacroBlockH264::_16x16] - predY;
+}//end InterImgPlaneEncoderImplStdVer1::SetMbMotionVecDiff.
+
+/** Code a macroblock again as the first macroblock of a size bounded slice.
+An intra refresh macroblock is predicted from its new neighbours. The ref img
+already holds the reconstruction of an inter macroblock and its residual does
+not depend on the neighbours, therefore only the vector difference, delta QP
+and skip mode are determined again.
+@param pCodec	: Worker codec.
+@param pMb		: Macroblock to encode.
+@return				: none.
+*/
+void H264v2Codec::InterImgPlaneEncoderImplStdVer1::RecodeSizedSliceMb(H264v2Codec* pCodec, MacroBlockH264* pMb)
+{
+	pMb->_mbQP = pCodec->_slice._qp;
+	if(pMb->_intraFlag)
+	{
+		ProcessIntraRefreshMb(pCodec, pMb);
+		return;
+	}//end if _intraFlag...
+
+	SetMbMotionVecDiff(pMb);
+	pMb->_mb_qp_delta = pCodec->GetDeltaQP(pMb);
+
+	/// The same skip conditions as ProcessInterMbImplStd().
+	pMb->_skip = 0;
+	if(pMb->_coded_blk_pattern == 0)
+	{
+		if(MacroBlockH264::SkippedZeroMotionPredCondition(pMb))
+		{
+			if( (pMb->_mvX[MacroBlockH264::_16x16] == 0)&&(pMb->_mvY[MacroBlockH264::_16x16] == 0) )
+				pMb->_skip = 1;
+		}//end if SkippedZeroMotionPredCondition...
+		else if( (pMb->_mvdX[MacroBlockH264::_16x16] == 0)&&(pMb->_mvdY[MacroBlockH264::_16x16] == 0) )
+			pMb->_skip = 1;
+	}//end if _coded_blk_pattern...
+}//end InterImgPlaneEncoderImplStdVer1::RecodeSizedSliceMb.
+
 /** The forward and inverse loop of a Std Inter macroblock.
 Does NOT include motion prediction and compensation. Assumes these are 
 already set before called. Code factoring usage. Includes reading the 
@@ -9372,6 +11590,16 @@ int H264v2Codec::ProcessInterMbImplStd(MacroBlockH264* pMb, int addRef, int with
 	pMb->_skip			= 0;
 	pMb->_intraFlag = 0;
 
+	/// A cached residual has already been transformed and only requires quantisation.
+	short*	pCache = NULL;
+	int			cached = 0;
+	int			zeroResidual = 0;
+	if( (_pCoeffCache != NULL)&&(pMb->_mbPartPredMode == MacroBlockH264::Inter_16x16) )
+	{
+		pCache = &(_pCoeffCache[pMb->_mbIndex * H264V2_COEFF_CACHE_LEN]);
+		cached = _pCoeffCacheValid[pMb->_mbIndex];
+	}//end if _pCoeffCache...
+
 	/// Subtract the ref (compensated) macroblock from the input macroblock and place it in the temp image blocks.
 
 	/// Lum...
@@ -9382,8 +11610,11 @@ int H264v2Codec::ProcessInterMbImplStd(MacroBlockH264* pMb, int addRef, int with
 	_16x16->SetOverlayDim(16, 16);
 	_16x16->SetOrigin(0, 0);
 
-	_Lum->Read(*(_16x16));				      ///< Read from input Lum into temp.
-	_16x16->Sub16x16(*(_RefLum));	      ///< Subtract ref Lum and leave result in temp.
+	if(!cached)
+	{
+		_Lum->Read(*(_16x16));				      ///< Read from input Lum into temp.
+		_16x16->Sub16x16(*(_RefLum));	      ///< Subtract ref Lum and leave result in temp.
+	}//end if !cached...
 
 	/// ... and Chr components.
 	_RefCb->SetOverlayDim(8, 8);
@@ -9399,17 +11630,35 @@ int H264v2Codec::ProcessInterMbImplStd(MacroBlockH264* pMb, int addRef, int with
 	_8x8_1->SetOverlayDim(8, 8);
 	_8x8_1->SetOrigin(0, 0);
 
-	_Cb->Read(*(_8x8_0));
-	_8x8_0->Sub8x8(*(_RefCb));
-	_Cr->Read(*(_8x8_1));
-	_8x8_1->Sub8x8(*(_RefCr));
+	if(!cached)
+	{
+		_Cb->Read(*(_8x8_0));
+		_8x8_0->Sub8x8(*(_RefCb));
+		_Cr->Read(*(_8x8_1));
+		_8x8_1->Sub8x8(*(_RefCr));
 
-	/// Fill all the non-DC 4x4 blks (Not blks = -1, 17, 18) of the macroblock blocks with 
-	/// the residual image colour components (after motion compensation/prediction).
-	MacroBlockH264::LoadBlks(pMb, _16x16, 0, 0, _8x8_0, _8x8_1, 0, 0);
+		/// Fill all the non-DC 4x4 blks (Not blks = -1, 17, 18) of the macroblock blocks with 
+		/// the residual image colour components (after motion compensation/prediction).
+		MacroBlockH264::LoadBlks(pMb, _16x16, 0, 0, _8x8_0, _8x8_1, 0, 0);
+
+		/// ------------------ Early termination -----------------------------------------------
+		/// A residual that quantises to zero needs no transform and the mb is coded with a zero 
+		/// coded blk pattern or skipped. The ref already holds the prediction as the reconstruction.
+		if( _earlyTermination && (pMb->_mbPartPredMode == MacroBlockH264::Inter_16x16) )
+			zeroResidual = ZeroResidualInter16x16MBlk(pMb, _earlyTermination);
+	}//end if !cached...
 
 	/// ------------------ Transform & Quantisation --------------------------------------------
-	if(pMb->_mbPartPredMode == MacroBlockH264::Inter_16x16)
+	if(zeroResidual)
+	{
+		/// The blks are already cleared.
+	}//end if zeroResidual...
+	else if(pCache != NULL)
+	{
+		TransAndQuantInter16x16MBlkCached(pMb, pCache, cached);
+		_pCoeffCacheValid[pMb->_mbIndex] = 1;
+	}//end if pCache...
+	else if(pMb->_mbPartPredMode == MacroBlockH264::Inter_16x16)
 		TransAndQuantInter16x16MBlk(pMb);
 
   /// ------------------- Zero Coeffs for QP > H264V2_MAX_QP -------------------------------------
@@ -9789,23 +12038,8 @@ int H264v2Codec::InterImgPlaneEncoderImplMinMax::Encode(int allowedBits, int* bi
 
 	/// Slice without partitioning and therefore only one set of slice parameters.
 
-	/// Set up the input and ref image mem overlays.
-	_codec->_Lum->SetOverlayDim(4,4);
-	_codec->_Cb->SetOverlayDim(4,4);
-	_codec->_Cr->SetOverlayDim(4,4);
-	_codec->_RefLum->SetOverlayDim(4,4);
-	_codec->_RefCb->SetOverlayDim(4,4);
-	_codec->_RefCr->SetOverlayDim(4,4);
-	_codec->_16x16->SetOverlayDim(16, 16);
-	_codec->_8x8_0->SetOverlayDim(8, 8);
-	_codec->_8x8_1->SetOverlayDim(8, 8);
-
-	/// All integer transforms are Inter in this method.
-	_codec->_pF4x4TLum->SetMode(IForwardTransform::TransformOnly);
-	_codec->_pF4x4TLum->SetParameter(IForwardTransform::INTRA_FLAG_ID, 0);
-	_codec->_pF4x4TChr->SetMode(IForwardTransform::TransformOnly);
-	_codec->_pF4x4TChr->SetParameter(IForwardTransform::INTRA_FLAG_ID, 0);
-	/// By default the DC transforms were set in the TransformOnly mode in the Open() method.
+	/// Set up the input and ref image mem overlays and the Inter integer transforms.
+	PrepareWorker(_codec);
 
   /// Mark this time point for later use.
   int preMotionTime = 0;
@@ -9814,6 +12048,9 @@ int H264v2Codec::InterImgPlaneEncoderImplMinMax::Encode(int allowedBits, int* bi
 
 	///	---------------------- Motion Vector encoding ---------------------------------------
 	
+	/// The mb residuals of the previous picture in the coeff cache are no longer valid.
+	memset((void *)_codec->_pCoeffCacheValid, 0, len);
+
 	/// In this implementation QP adaptation is performed after full motion compensation.
 	/// Get the motion vector list to work with. Assume SIMPLE2D type list.
 	int	listLen = _codec->_pMotionEstimationResult->GetLength();
@@ -9938,6 +12175,8 @@ int H264v2Codec::InterImgPlaneEncoderImplMinMax::Encode(int allowedBits, int* bi
 		/// Accumulate the rate and find the largest distortion for all mbs. Call returns 0 for skipped mbs. The ref
     /// holding the compensated motion is not updated with the encoding in this traversal of the mbs.
 		Rl += _codec->ProcessInterMbImplStd(pMb, 0, 1);
+    /// The compensated ref is fixed for the QP search and therefore the mb distortion at each QP is too.
+    _pDistKnown[mb] = 1ULL << H264V2_MAX_QP;
     if(!pMb->_skip)
     {
       /// Sum of skip run and coded mb bits accumulated.
@@ -10018,6 +12257,16 @@ int H264v2Codec::InterImgPlaneEncoderImplMinMax::Encode(int allowedBits, int* bi
 			if( (Dmax < Du)||(Dmax > Dl)||(Dmax == prevDmax) )	///< Still out of bound.
 				Dmax = ((Du + Dl) + 1) >> 1;	///< Set the midpoint max distortion.
 
+			/// The distortions of the QP steps that each mb descends through are independent of the
+			/// other mbs and are evaluated on the workers first. Only the rates then remain for the
+			/// sequential pass below.
+			if(_codec->_numWorkers > 1)
+			{
+				_evalDmax			= Dmax;
+				_evalLowestQP	= qEnd;
+				_codec->_pThreadPool->Run(InterImgPlaneEncoderImplMinMax::EvaluateDistortionTask, (void *)this, _codec->_numWorkers);
+			}//end if _numWorkers...
+
 			/// At each macroblock reduce the quant value until the distortion is lower
 			/// than Dmax. pQ[] must always hold the lower rate (smaller valued) quant vector 
 			/// as the previous best choice.
@@ -10031,7 +12280,7 @@ int H264v2Codec::InterImgPlaneEncoderImplMinMax::Encode(int allowedBits, int* bi
 				MacroBlockH264* pMb = &(_codec->_pMb[mb]);
 
 				/// Record the found QP where the macroblock dist is just below Dmax and accumulate the rate for this macroblock.
-				_pQ[mb] = _codec->GetMbQPBelowDmaxVer2(*pMb, _pQ[mb], Dmax, &firstMbChange, qEnd, FALSE);
+				_pQ[mb] = _codec->GetMbQPBelowDmaxVer2(*pMb, _pQ[mb], Dmax, &firstMbChange, qEnd, false, &(_pDistKnown[mb]));
 				R += pMb->_rate[_pQ[mb]]; ///< Rate = 0 for skipped mbs.
         if(!pMb->_skip)
         {
@@ -10180,6 +12429,92 @@ int H264v2Codec::InterImgPlaneEncoderImplMinMax::Encode(int allowedBits, int* bi
 	return(ret);
 }//end InterImgPlaneEncoderImplMinMax::Encode.
 
+/** Evaluate the distortions of the QP search for a range of macroblocks.
+Worker w takes the w-th of n equal runs of macroblocks for n workers. From the 
+current QP of each mb the distortion of every QP step down is evaluated until 
+it is below Dmax as GetMbQPBelowDmaxVer2() will step. The mb is processed in 
+the worker's private mb so that the state of the shared mbs is not disturbed 
+and only the distortion values are written back.
+@param worker	: Worker index.
+@return				: none.
+*/
+void H264v2Codec::InterImgPlaneEncoderImplMinMax::EvaluateDistortion(int worker)
+{
+	H264v2Codec*		pCodec	= _codec->_pSliceWorker[worker];
+	MacroBlockH264* pEval		= &(pCodec->_distortionMb);
+	int len			= _codec->_mbLength;
+	int firstMb = (len * worker) / _codec->_numWorkers;
+	int endMb		= (len * (worker + 1)) / _codec->_numWorkers;
+
+	PrepareWorker(pCodec);
+
+	for(int mb = firstMb; mb < endMb; mb++)
+	{
+		MacroBlockH264* pMb = &(_codec->_pMb[mb]);
+
+		/// Only the position and the motion of the mb are required for its distortion.
+		pEval->_mbIndex					= pMb->_mbIndex;
+		pEval->_slice						= pMb->_slice;
+		pEval->_offLumX					= pMb->_offLumX;
+		pEval->_offLumY					= pMb->_offLumY;
+		pEval->_offChrX					= pMb->_offChrX;
+		pEval->_offChrY					= pMb->_offChrY;
+		pEval->_mbPartPredMode	= pMb->_mbPartPredMode;
+		pEval->_mvX[MacroBlockH264::_16x16]		= pMb->_mvX[MacroBlockH264::_16x16];
+		pEval->_mvY[MacroBlockH264::_16x16]		= pMb->_mvY[MacroBlockH264::_16x16];
+		pEval->_mvdX[MacroBlockH264::_16x16]	= pMb->_mvdX[MacroBlockH264::_16x16];
+		pEval->_mvdY[MacroBlockH264::_16x16]	= pMb->_mvdY[MacroBlockH264::_16x16];
+
+		int i = _pQ[mb];
+		while(1)
+		{
+			if( !(_pDistKnown[mb] & (1ULL << i)) )
+			{
+				pEval->_mbQP = i;
+				pCodec->ProcessInterMbImplStd(pEval, 0, 2);
+				pMb->_distortion[i] = pEval->_distortion[i];
+				_pDistKnown[mb] |= (1ULL << i);
+			}//end if !_pDistKnown...
+
+			if( (i <= _evalLowestQP)||(pMb->_distortion[i] <= _evalDmax) )
+				break;
+		  i -= MbStepSize[i];
+			if(i < _evalLowestQP) i = _evalLowestQP;
+		}//end while 1...
+	}//end for mb...
+
+}//end InterImgPlaneEncoderImplMinMax::EvaluateDistortion.
+
+/** Set up a worker for encoding.
+The input and ref image overlays and the IT filters of the worker are prepared
+for inter macroblocks.
+@param pCodec	: Worker codec.
+@return				: none.
+*/
+void H264v2Codec::InterImgPlaneEncoderImplMinMax::PrepareWorker(H264v2Codec* pCodec)
+{
+	/// Set up the input and ref image mem overlays.
+	pCodec->_Lum->SetOverlayDim(4,4);
+	pCodec->_Cb->SetOverlayDim(4,4);
+	pCodec->_Cr->SetOverlayDim(4,4);
+	pCodec->_RefLum->SetOverlayDim(4,4);
+	pCodec->_RefCb->SetOverlayDim(4,4);
+	pCodec->_RefCr->SetOverlayDim(4,4);
+	pCodec->_16x16->SetOverlayDim(16, 16);
+	pCodec->_8x8_0->SetOverlayDim(8, 8);
+	pCodec->_8x8_1->SetOverlayDim(8, 8);
+
+	/// All integer transforms are Inter in this method.
+	pCodec->_pF4x4TLum->SetMode(IForwardTransform::TransformOnly);
+	pCodec->_pF4x4TLum->SetParameter(IForwardTransform::INTRA_FLAG_ID, 0);
+	pCodec->_pF4x4TChr->SetMode(IForwardTransform::TransformOnly);
+	pCodec->_pF4x4TChr->SetParameter(IForwardTransform::INTRA_FLAG_ID, 0);
+	/// By default the DC transforms were set in the TransformOnly mode in the Open() method. The
+	/// chr DC transform keeps the setting of the last I-frame and the workers must match it.
+	pCodec->_pFDC2x2T->SetParameter(IForwardTransform::INTRA_FLAG_ID, _codec->_pFDC2x2T->GetParameter(IForwardTransform::INTRA_FLAG_ID));
+
+}//end InterImgPlaneEncoderImplMinMax::PrepareWorker.
+
 /** Damage control algorithm for motion vectors only condition.
 Clean up all remaining macroblocks as skipped and exit. In this implementation
 when there are not enough bits to encode all the motion vectors the estimated list
@@ -10797,7 +13132,7 @@ int H264v2Codec::InterImgPlaneEncoderImplMinMax::DamageControl(int allowedBits,
 				  MacroBlockH264* pMb = &(_codec->_pMb[mb]);
 
 				  /// Record the found QP where the macroblock dist is just below Dmax and accumulate the rate for this macroblock.
-				  _pQ[mb] = _codec->GetMbQPBelowDmaxVer3(*pMb, _pQ[mb], Dmax, &firstMbChange, qEnd, FALSE);
+				  _pQ[mb] = _codec->GetMbQPBelowDmaxVer3(*pMb, _pQ[mb], Dmax, &firstMbChange, qEnd, false);
 				  R += pMb->_rate[_pQ[mb]]; ///< Rate = 0 for skipped mbs.
           if(!pMb->_skip)
           {
@@ -10952,8 +13287,31 @@ int H264v2Codec::InterImgPlaneDecoderImplStdVer1::Decode(void)
 	_codec->_8x8_0->SetOverlayDim(8, 8);
 	_codec->_8x8_1->SetOverlayDim(8, 8);
 
-	/// Prepare for motion compensation on a per macoblock basis.
-	_codec->_pMotionCompensator->PrepareForSingleVectorMode();
+	///------------------- Motion compensation -----------------------------------------------------------
+	/// Predict every macroblock from the unaltered ref before any are reconstructed into 
+	/// it and therefore no copy of the ref is required. The motion vectors were decoded 
+	/// from the vector differences in the ReadMacroBlockLayer() method. Intra (refresh)
+	/// macroblocks are predicted from their reconstructed neighbours later.
+	for(mb = 0; mb < len; mb++)
+	{
+		MacroBlockH264* pMb = &(_codec->_pMb[mb]);
+		if(pMb->_intraFlag)
+		{
+			if(pMb->_mbPartPredMode != MacroBlockH264::Intra_16x16)
+			{
+				_codec->_errorStr = "[H264V2::InterImgPlaneDecoderImplStdVer1::Decode] Only supports Intra_16x16 intra mode";
+				return(0);
+			}//end if !Intra_16x16...
+			continue;
+		}//end if _intraFlag...
+		if(pMb->_mbPartPredMode != MacroBlockH264::Inter_16x16)	///< Fixed at 16x16 mode for now.
+		{
+			_codec->_errorStr = "[H264V2::InterImgPlaneDecoderImplStdVer1::Decode] Only supports Inter_16x16 mode";
+			return(0);
+		}//end if !Inter_16x16...
+
+		_codec->_pMotionCompensator->Predict(pMb->_offLumX, pMb->_offLumY, pMb->_mvX[MacroBlockH264::_16x16], pMb->_mvY[MacroBlockH264::_16x16]);
+	}//end for mb...
 
 	/// Whip through each macroblock. Decode the extracted encodings. All modes
 	/// and parameters have been extracted by the ReadMacroBlockLayer() method.
@@ -10966,17 +13324,15 @@ int H264v2Codec::InterImgPlaneDecoderImplStdVer1::Decode(void)
 		int cOffX = pMb->_offChrX;
 		int cOffY = pMb->_offChrY;
 
-		///------------------- Motion compensation -----------------------------------------------------------
-		if(pMb->_mbPartPredMode != MacroBlockH264::Inter_16x16)	///< Fixed at 16x16 mode for now.
+		if(pMb->_intraFlag)
 		{
-			_codec->_errorStr = "[H264V2::InterImgPlaneDecoderImplStdVer1::Decode] Only supports Inter_16x16 mode";
-			return(0);
-		}//end if !Inter_16x16...
+			_codec->DecodeIntraMbImplStd(pMb);
+			_codec->RowLoopFilter(mb);
+			continue;
+		}//end if _intraFlag...
 
-		/// Compensate the vector and hope the encoder estimator ensured that
-		/// all pels fall inside the image space. The motion vector was decoded
-		/// from the vector differences in the ReadMacroBlockLayer() method.
-		_codec->_pMotionCompensator->Compensate(lOffX, lOffY, pMb->_mvX[MacroBlockH264::_16x16], pMb->_mvY[MacroBlockH264::_16x16]);
+		/// The predicted macroblock is the base to which the residual is added.
+		_codec->_pMotionCompensator->CommitPrediction(lOffX, lOffY, pMb->_mvX[MacroBlockH264::_16x16], pMb->_mvY[MacroBlockH264::_16x16]);
 
 		if(pMb->_coded_blk_pattern)
 		{
@@ -11011,6 +13367,7 @@ int H264v2Codec::InterImgPlaneDecoderImplStdVer1::Decode(void)
 
 		}//end if _coded_blk_pattern...
 
+		_codec->RowLoopFilter(mb);
 	}//end for mb...
 
 	return(1);
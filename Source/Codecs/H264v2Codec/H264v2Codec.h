@@ -53,16 +53,21 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IMotionEstimator.h"
 #include "IMotionCompensator.h"
 #include "IMotionVectorPredictor.h"
+#include "RefPictureH264.h"
+#include "LookaheadH264.h"
 
 #include "IVlcEncoder.h"
 #include "IVlcDecoder.h"
 
 #include "NalHeaderH264.h"
 #include "SliceHeaderH264.h"
-#include "SeqparamSetH264.h"
-#include "PicparamSetH264.h"
+#include "SeqParamSetH264.h"
+#include "PicParamSetH264.h"
 
 #include "MacroBlockH264.h" 
+#include "ThreadPool.h"
+#include "WavefrontSync.h"
+#include "Shared/MonotonicClock.h"
 
 /// For storing measurements during testing.
 //#define H264V2_DUMP_HEADERS 1
@@ -108,7 +113,7 @@ public:
 	int		GetCompressedBitLength(void) { return((int)_bitStreamSize); }
 	int		GetCompressedByteLength(void) 
 		{ int x = (int)_bitStreamSize/8; if(_bitStreamSize & 0x7) x++; return(x); }
-	void* GetReference(int refNum) { return( (void*)_pRLum ); }
+	void* GetReference(int refNum) { CompleteLoopFilter(); return( (void*)_pRLum ); }
 
 	void	Restart(void);
 	int		Open(void);
@@ -155,6 +160,58 @@ private:
 
 	int		_startCodeEmulationPrevention;									///< "start code emulation prevention"
 
+	/// Picture partitioning.
+	int		_slicesPerPicture;															///< "slices per picture"
+	int		_wavefrontThreads;															///< "wavefront threads"
+	int		_pipelinedMotionEstimation;											///< "pipelined motion estimation"
+	/// Slices are closed before their NAL unit exceeds this many bytes, excluding the start 
+	/// code and emulation prevention bytes, so that each fits a single RTP packet. 0 = off. 
+	/// Replaces the "slices per picture" and "wavefront threads" partitioning. Open mode of 
+	/// operation only.
+	int		_maxSliceBytes;																	///< "max slice bytes"
+
+	/// YUV420P8 and YUV420P16 input plane strides in pels. 0 = same as the plane width.
+	int		_inLumStride;																		///< "in lum stride"
+	int		_inChrStride;																		///< "in chr stride"
+
+	/// Table lookup coeff token, total zeros and run before decoders. 0 = code tree decoders.
+	int		_tableVlcDecoders;															///< "table vlc decoders"
+
+	/// Loop filter each macroblock row while the plane encoders/decoders reconstruct the row 
+	/// below instead of after the whole picture. 0 = whole picture.
+	int		_rowLoopFilter;																	///< "row loop filter"
+
+	/// Seed the motion search with the previous and neighbouring vectors and end it early on 
+	/// static macroblocks. 0 = multiresolution search only.
+	int		_predictiveMotionEstimation;										///< "predictive motion estimation"
+
+	/// Motion estimator implementation. 0 = multiresolution cross search, 1 = multiresolution full 
+	/// search, 2 = multiresolution cross search (ver 1), 3 = small diamond, 4 = large diamond, 
+	/// 5 = hexagon, 6 = EPZS.
+	int		_motionEstimator;																///< "motion estimator"
+
+	/// Read only statistics of the last motion estimation for comparing the estimators.
+	int		_motionEstimationUsec;													///< "motion estimation usec"
+	int		_motionEstimationDistortion;										///< "motion estimation distortion"
+
+	/// End the inter macroblock processing before the transform when the motion compensated 
+	/// residual quantises to zero. 0 = off, 1 = exact, 2 = relaxed AC coeff bound.
+	int		_earlyTermination;															///< "early termination"
+
+	/// The auto I-picture lookahead declares a scene change when the level 2 inter cost exceeds 
+	/// this percentage of the intra cost. The costs of the last picture are read only.
+	int		_sceneChangeThreshold;													///< "scene change threshold"
+	int		_lookaheadInterCost;														///< "lookahead inter cost"
+	int		_lookaheadIntraCost;														///< "lookahead intra cost"
+
+	/// Rolling intra refresh as an alternative to periodic I-pictures. A band of macroblocks 
+	/// is intra coded in every P-picture such that the whole picture is refreshed every 
+	/// "intra refresh" P-pictures. 0 = off. The direction is 0 = column band moving left to 
+	/// right and 1 = row band moving top to bottom. Open mode of operation only.
+	int		_intraRefresh;																	///< "intra refresh"
+	int		_intraRefreshDirection;													///< "intra refresh direction"
+	int		_intraRefreshPos;																///< Band of the current P-picture in the refresh cycle.
+
 
 	/// -------------- Dynamic Parameters ------------------------------------------------------ 
 	/// Set before Code()/Decode(). Remain in effect until modified.
@@ -165,7 +222,7 @@ private:
 	int		_pQuant;																				///"quality"
 
 	/// I-Picture modifiers.
-	int		_autoIPicture;																	///"autoipicture"
+	int		_autoIPicture;																	///"autoipicture" 0 = off, 1 = lookahead, 2 = motion distortion.
 	int		_iPictureMultiplier;														///"ipicturemultiplier"
 	int		_iPictureFraction;															///"ipicturefraction"
 
@@ -226,16 +283,28 @@ private:
 	int					ReadTrailingBits(IBitStreamReader* bsr, int remainingBits, int* bitsUsed);
 
   int         InsertEmulationPrevention(IBitStreamWriter* bsw, int startOffset);
-  int         RemoveEmulationPrevention(IBitStreamReader* bsr);
+  int         RemoveEmulationPrevention(IBitStreamReader* bsr, int startBytePos, int endBytePos);
 
-	int					WriteSliceDataLayer(IBitStreamWriter* bsw, int allowedBits, int* bitsUsed);
-	int					ReadSliceDataLayer(IBitStreamReader* bsr, int remainingBits, int* bitsUsed);
+	int					WriteSliceDataLayer(IBitStreamWriter* bsw, int firstMb, int lastMb, int allowedBits, int* bitsUsed);
+	int					ReadSliceDataLayer(IBitStreamReader* bsr, int firstMb, int remainingBits, int* bitsUsed);
 
 	int					WriteMacroBlockLayer(IBitStreamWriter* bsw, MacroBlockH264* pMb, int allowedBits, int* bitsUsed);
 	int					MacroBlockLayerBitCounter(MacroBlockH264* pMb);
 	int					ReadMacroBlockLayer(IBitStreamReader* bsr, int remainingBits, int* bitsUsed);
 
 	void				ApplyLoopFilter(void);
+	static void	LoopFilterTask(void* pParam, int index);
+	void				LoopFilterRows(int firstRow, int endRow, int rowStep, WavefrontSync* pSync);
+	void				StartRowLoopFilter(int fromCoeffs);
+	void				RowLoopFilter(int mb);
+	int					EndRowLoopFilter(void);
+	void				LoopFilterMb(MacroBlockH264* pMb, short** lumRef, short** cbRef, short** crRef);
+	void				GetBoundaryStrengths(MacroBlockH264* pMb, int bSV[4][4], int bSH[4][4]);
+	/// Non-zero coeffs in a block. The num of coeffs is only current after vlc coding.
+	int					IsBlkCodedForLoopFilter(BlockH264* pBlk) { return(_loopFilterFromCoeffs ? !pBlk->IsZero2() : pBlk->GetNumCoeffs()); }
+	void				VerticalEdgeFilter(MacroBlockH264* pMb, short** img, int lumFlag, int colOff, const int* bS);
+	void				HorizontalEdgeFilter(MacroBlockH264* pMb, short** img, int lumFlag, int rowOff, const int* bS);
+	static void	GetEdgeLanes(const int* bS, int seg, int len, int qPav, short* pBS, short* pTC0);
 	void				VerticalFilter(MacroBlockH264* pMb, short** img, int lumFlag, int rowOff, int colOff, int iter, int boundaryStrength);
 	void				HorizontalFilter(MacroBlockH264* pMb, short** img, int lumFlag, int rowOff, int colOff, int iter, int boundaryStrength);
 
@@ -245,6 +314,9 @@ private:
 	void				InvTransAndQuantIntra16x16ModeBlk(IInverseTransform* pTQ, BlockH264* pBlk, short* pDcBlkCoeff);
 
 	void				TransAndQuantInter16x16MBlk(MacroBlockH264* pMb);
+	void				TransAndQuantInter16x16MBlkCached(MacroBlockH264* pMb, short* pCache, int cached);
+	int					ZeroResidualInter16x16MBlk(MacroBlockH264* pMb, int mode);
+	static int	ZeroResidual4x4(const short* pB, const int* pNorm, int lim, int mode, int* pSum);
 	void				InverseTransAndQuantInter16x16MBlk(MacroBlockH264* pMb, int tmpBlkFlag);
 
 	int					GetIntra16x16LumPredAndMode(MacroBlockH264* pMb, OverlayMem2Dv2* in, OverlayMem2Dv2* ref, OverlayMem2Dv2* pred);
@@ -259,6 +331,21 @@ private:
                                         OverlayMem2Dv2* refCb,	OverlayMem2Dv2* refCr, OverlayMem2Dv2* predCb, OverlayMem2Dv2* predCr);
 
 	int					Median(int x, int y, int z);
+
+	int					CreateITFilters(void);
+	int					CreateVlcCodecs(void);
+
+	int					OpenSliceWorker(H264v2Codec* pOwner, unsigned char* pStream, int streamByteLen);
+	void				CloseSliceWorkers(void);
+	int					WriteSliceNALUnit(int firstMb, int lastMb, int allowedBits);
+	void				StartSizedSlices(int headerBits);
+	int					FitSizedSliceMb(int mb);
+	int					WriteSizedSliceNALUnits(int bitLimit);
+	static void	WriteSliceNALUnitTask(void* pParam, int index);
+	static void	PipelineTask(void* pParam, int index);
+	void				CompleteLoopFilter(void);
+	void				LoadInputImage(void* pSrc);
+
   static void DumpBlock(OverlayMem2Dv2* pBlk, char* filename, const char* title);
 
 /// The implementations of img plane encoders and decoders is done through a common
@@ -292,6 +379,13 @@ private:
 			IntraImgPlaneEncoderImplStdVer1(H264v2Codec* codec) { _codec = codec; }
 			virtual ~IntraImgPlaneEncoderImplStdVer1(void) { }
 			int Encode(int allowedBits, int* bitsUsed, int writeRef);
+			void EncodeSlice(int slice);
+			static void EncodeSliceTask(void* pParam, int index) 
+        { ((IntraImgPlaneEncoderImplStdVer1 *)pParam)->EncodeSlice(index); }
+			void EncodeWavefront(int worker);
+			static void EncodeWavefrontTask(void* pParam, int index) 
+        { ((IntraImgPlaneEncoderImplStdVer1 *)pParam)->EncodeWavefront(index); }
+			void PrepareWorker(H264v2Codec* pCodec);
 		private:
 			H264v2Codec* _codec;
 	};//end class IntraImgPlaneEncoderImplStdVer1.
@@ -321,11 +415,22 @@ private:
 	class InterImgPlaneEncoderImplStdVer1 : public IImagePlaneEncoder	/// P-frame baseline encoder.
 	{
 		public:
-			InterImgPlaneEncoderImplStdVer1(H264v2Codec* codec) { _codec = codec; }
+			InterImgPlaneEncoderImplStdVer1(H264v2Codec* codec) { _codec = codec; _addRef = 1; }
 			virtual ~InterImgPlaneEncoderImplStdVer1(void) { }
 			int Encode(int allowedBits, int* bitsUsed, int writeRef);
+			void EncodeSlice(int slice);
+			static void EncodeSliceTask(void* pParam, int index) 
+        { ((InterImgPlaneEncoderImplStdVer1 *)pParam)->EncodeSlice(index); }
+			void EncodeWavefront(int worker);
+			static void EncodeWavefrontTask(void* pParam, int index) 
+        { ((InterImgPlaneEncoderImplStdVer1 *)pParam)->EncodeWavefront(index); }
+			void PrepareWorker(H264v2Codec* pCodec);
+			void ProcessIntraRefreshMb(H264v2Codec* pCodec, MacroBlockH264* pMb);
+			void SetMbMotionVecDiff(MacroBlockH264* pMb);
+			void RecodeSizedSliceMb(H264v2Codec* pCodec, MacroBlockH264* pMb);
 		private:
 			H264v2Codec* _codec;
+			int					 _addRef;	///< Current Encode() writeRef setting for the slice tasks.
 	};//end class InterImgPlaneEncoderImplStdVer1.
 	friend class InterImgPlaneEncoderImplStdVer1;
 
@@ -334,8 +439,10 @@ private:
 		/// MinMax algorithm with rate constraint. Uses bisection method to find optimal selection.
 		public:
 			InterImgPlaneEncoderImplMinMax(H264v2Codec* codec) 
-        { _codec = codec; _pQ = NULL; _pQl = NULL; _pDistortionDiff = NULL; _pMbList = NULL; _pLastMbCoded = NULL; _pLastMbQP = NULL; }
-			virtual ~InterImgPlaneEncoderImplMinMax(void) { if(_pQ != NULL) delete[] _pQ; _pQ = NULL; }
+        { _codec = codec; _pQ = NULL; _pQl = NULL; _pDistortionDiff = NULL; _pMbList = NULL; _pLastMbCoded = NULL; _pLastMbQP = NULL; 
+          _pDistKnown = NULL; _evalDmax = 0; _evalLowestQP = 0; }
+			virtual ~InterImgPlaneEncoderImplMinMax(void) 
+        { if(_pQ != NULL) delete[] _pQ; _pQ = NULL; if(_pDistKnown != NULL) delete[] _pDistKnown; _pDistKnown = NULL; }
 			int Encode(int allowedBits, int* bitsUsed, int writeRef);
       int DamageControlMvOnly(int allowedBits, int* bitsUsed);
       int DamageControl(int allowedBits, int currBitCost);
@@ -343,8 +450,15 @@ private:
 				{ if(_pQ != NULL) delete[] _pQ; _pQ = NULL;
 					_pQ = new int[6 * length]; if(_pQ == NULL) return(0);
 					_pQl = _pQ + length; _pDistortionDiff = _pQl + length; _pMbList = _pDistortionDiff + length; 
-          _pLastMbCoded = _pMbList + length; _pLastMbQP = _pLastMbCoded + length; return(1);
+          _pLastMbCoded = _pMbList + length; _pLastMbQP = _pLastMbCoded + length;
+          if(_pDistKnown != NULL) delete[] _pDistKnown; 
+          _pDistKnown = new unsigned long long[length]; if(_pDistKnown == NULL) return(0);
+          return(1);
 				}
+			void EvaluateDistortion(int worker);
+			static void EvaluateDistortionTask(void* pParam, int index) 
+        { ((InterImgPlaneEncoderImplMinMax *)pParam)->EvaluateDistortion(index); }
+			void PrepareWorker(H264v2Codec* pCodec);
 		private:
 			H264v2Codec* _codec;
 			int*	_pQ;
@@ -353,6 +467,9 @@ private:
       int*  _pMbList;
       int*  _pLastMbCoded;  ///< Audit trail.
       int*  _pLastMbQP;
+      unsigned long long* _pDistKnown;  ///< [length] Bit qp is set when the mb _distortion[qp] is valid for this picture.
+      int   _evalDmax;                  ///< Current iteration settings for the EvaluateDistortion() tasks.
+      int   _evalLowestQP;
 	};//end class InterImgPlaneEncoderImplMinMax.
 	friend class InterImgPlaneEncoderImplMinMax;
 
@@ -387,11 +504,12 @@ private:
 	int ProcessIntraMbImplStd(MacroBlockH264* pMb, int withDR);																		
 	int ProcessIntraMbImplStd(MacroBlockH264* pMb, int withDR, int usePrevPred);																		
 	int ProcessIntraMbImplStdMin(MacroBlockH264* pMb);																		
+	void DecodeIntraMbImplStd(MacroBlockH264* pMb);
 	int ProcessInterMbImplStd(MacroBlockH264* pMb, int addRef, int withDR);																		
 	int ProcessInterMbImplStdMin(MacroBlockH264* pMb);																		
 	int GetDeltaQP(MacroBlockH264* pMb);																	
 	int GetMbQPBelowDmax(MacroBlockH264 &mb, int atQP, int Dmax, int decQP, int* changeMb, int lowestQP, bool intra);
-	int GetMbQPBelowDmaxVer2(MacroBlockH264 &mb, int atQ, int Dmax, int* changeMb, int lowestQ, bool intra);
+	int GetMbQPBelowDmaxVer2(MacroBlockH264 &mb, int atQ, int Dmax, int* changeMb, int lowestQ, bool intra, unsigned long long* pDistKnown);
 	int GetMbQPBelowDmaxVer3(MacroBlockH264 &mb, int atQ, int Dmax, int* changeMb, int lowestQ, bool intra);
 	int GetMbQPBelowDmaxApprox(MacroBlockH264 &mb, int atQP, int Dmax, int epsilon, int decQP, int* changeMb, int lowestQP, bool intra);
 
@@ -413,27 +531,38 @@ private:
   */
   inline int GetNextMbQP(MacroBlockH264* pMb);
 
-  /** Run a high performance timer
+  /** Get a neighbouring macroblock for intra prediction.
+  With constrained intra prediction set in the current picture parameter set
+  an inter coded neighbour is not available for intra prediction.
+  @param pNMb   : Neighbouring macroblock (NULL if outside the picture or slice).
+  @return       : The neighbour or NULL if not available.
+  */
+  inline MacroBlockH264* GetIntraPredMb(MacroBlockH264* pNMb)
+  {
+    if( (pNMb != NULL)&&(!pNMb->_intraFlag)&&(_picParam[_currPicParam]._constrained_intra_pred_flag) )
+      return(NULL);
+    return(pNMb);
+  }//end GetIntraPredMb.
+
+  /** Run a high performance monotonic timer
   @return : A timer exists.
   */
   static double _cpuFreq;
+  static long long _counterOrigin;
   int _startTime;
   inline static int SetCounter(void) 
   {
-    _cpuFreq = 0.0;
-    LARGE_INTEGER li;
-    if(!QueryPerformanceFrequency(&li))
+    if(_cpuFreq == 0.0)
 	    return(0);
-    _cpuFreq = double(li.QuadPart)/1000.0;  ///< In ms
     return(1);
   }//end SetCounter.
 
+  /// Elapsed ms from the process start. The small origin keeps the value in range
+  /// for the time limit code that truncates it to an int.
   inline static double GetCounter(void)
   {
-    LARGE_INTEGER li;
-    QueryPerformanceCounter(&li);
     if(_cpuFreq != 0)
-      return( double(li.QuadPart)/_cpuFreq );
+      return( double(MonotonicClock::GetTicks() - _counterOrigin)/_cpuFreq );
     else
       return(0.0);
   }//end GetCounter.
@@ -486,6 +615,9 @@ private:
 	static const int MbStepSize[];
   static const int NextQPDec[];
 
+	/// Inter 4x4 quant norm factors for the zero residual early termination test.
+	static const int zeroResidualNorm[6][3];
+
 /// Operational members.
 private:
 	/// Compressed data stream access members.
@@ -522,6 +654,25 @@ private:
 	IMotionCompensator*		  _pMotionCompensator;			///< Selected compensator dependent on mode.
 	VectorStructList*			  _pMotionVectors;					///< Motion vector list input to compensators.
   IMotionVectorPredictor* _pMotionPredictor;        ///< Predictor for motion vector from neighbouring mbs.
+	RefPictureH264*					_pRefPicture;							///< 1/2 pel planes of the ref shared by the estimator and compensator.
+	LookaheadH264*					_pLookahead;							///< Level 2 scene change detection for the auto I-picture.
+
+	/// In pipelined mode the motion estimation is against the previous input image and 
+	/// runs concurrently with the loop filter of the previous picture that is deferred 
+	/// to the start of the next Code() call or to the next access of the ref img. The 
+	/// predictor has its own macroblocks so as not to disturb the vectors used by the 
+	/// loop filter.
+	short*									_pPrevLum;								///< Previous input lum image.
+	MacroBlockH264*					_pMotionPredMb;						///< [_mbLength] Predictor macroblocks.
+	MacroBlockH264**				_MotionPredMb;						///< Predictor macroblock 2-D reference.
+	int											_loopFilterPending;				///< Ref img still to be loop filtered.
+	long										_pipelineMotionDistortion;
+
+	/// In row loop filter mode the StdVer1 plane encoders and decoders filter macroblock row 
+	/// r-1 as soon as row r has been reconstructed. The intra prediction of row r reads the 
+	/// unfiltered row r-1 and therefore the filtering must trail by a full row.
+	int											_loopFilterRowsDone;			///< Mb rows filtered in this picture. -1 = not in row mode.
+	int											_loopFilterFromCoeffs;		///< Row mode encoding where the blk num of coeffs is not yet set.
 
 	/// Vlc encoders and decoders for use with CAVLC.
 	IVlcEncoder*	_pPrefixVlcEnc;
@@ -559,6 +710,12 @@ private:
 	MacroBlockH264*		_pMb;				///< Base macroblock linear reference.
 	MacroBlockH264**	_Mb;				///< Macroblock 2-D reference.
 
+	/// The MinMax modes process the same Inter mb residual at many QP values. The unquantised
+	/// transform coeffs of each mb are kept so that a new QP only requires quantisation. The
+	/// cache is only created in the MinMax mode and is invalidated for every new picture.
+	short*						_pCoeffCache;				///< [_mbLength * H264V2_COEFF_CACHE_LEN] Unquantised Inter coeffs.
+	unsigned char*		_pCoeffCacheValid;	///< [_mbLength] Non-zero when the mb coeffs are in the cache.
+
 	/// Internal picture properties. (For now)
 
 	/// NAL unit definition.
@@ -580,11 +737,39 @@ private:
 	int						_maxFrameNum;			///< Used for and derived from SeqParamSet._log2_max_frame_num_minus4
 	int						_idrFrameNum;			///< Used for SliceHeader._idr_pic_id
 
-	/// This implementation has only 1 slice for the entire frame without
-	/// partitioning and therefore the slice parameters are simple.
+	/// The slice parameters are common to all slices in the picture except for the 
+	/// first macroblock in each slice.
 	SliceHeaderH264	_slice;
 	int							_mb_skip_run;		///< For P-Slices a skip run preceeds each macroblock.
 
+	/// Multiple slices per picture are formed from whole rows of macroblocks. Each slice 
+	/// after the first is coded by a slice worker, which is a partially opened codec that 
+	/// shares the image and macroblock mem of this codec but has its own overlays, IT 
+	/// filters, vlc encoders and bit stream writer. The slices are then coded concurrently 
+	/// on the thread pool and the NAL units concatenated in slice order. With a single
+	/// slice the same workers are used to encode the macroblock rows as a wavefront
+	/// where each row trails the row above by two macroblocks. The MinMax P-frame QP
+	/// search also uses the workers to evaluate the macroblock distortions.
+	int							_numSlices;				///< Slices in use for this Open() session.
+	int*						_pSliceFirstMb;		///< [_numSlices + 1] with the last entry = _mbLength.
+	int							_numWorkers;			///< Slice or wavefront workers including this codec.
+	H264v2Codec**		_pSliceWorker;		///< [_numWorkers] with _pSliceWorker[0] = this.
+	unsigned char*	_pSliceStreamMem;	///< Bit stream mem for the slice workers.
+	int							_sliceStreamByteLen;	///< Length of this worker stream mem.
+	int							_sliceAllowedBits;	///< Slice worker bit limit for WriteSliceNALUnit().
+	int							_sliceErr;				///< Slice worker return code from WriteSliceNALUnit().
+	/// Size bounded slices are started by the StdVer1 plane encoders whenever the next 
+	/// macroblock would take the NAL unit of the current slice over "max slice bytes".
+	int							_sizedSliceBytes;				///< "max slice bytes" at Open().
+	int							_numSizedSlices;				///< Slices of the current picture.
+	int*						_pSizedSliceFirstMb;		///< [_mbLength + 1] with the last entry = _mbLength. Non-NULL in this mode.
+	int							_sizedSliceHeaderBits;	///< Slice header bits of the current slice.
+	int							_sizedSliceDataBits;		///< Slice data bits up to the last non-skipped macroblock.
+	int							_sizedSliceSkipRun;			///< Skipped macroblocks pending after the last non-skipped macroblock.
+	ThreadPool*			_pThreadPool;
+	WavefrontSync*	_pWavefrontSync;	///< Macroblock row progress. Non-NULL in wavefront mode.
+	MacroBlockH264	_distortionMb;		///< Private mb for the MinMax distortion evaluation tasks.
+
 	/// Image plane encoders/decoders. 
 	IImagePlaneEncoder*		_pIntraImgPlaneEncoder;
 	IImagePlaneEncoder*		_pInterImgPlaneEncoder;
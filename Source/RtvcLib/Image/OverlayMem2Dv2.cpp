@@ -56,6 +56,7 @@ RESTRICTIONS	: Redistribution and use in source and binary forms, with or withou
 #include <stdlib.h>
 
 #include "OverlayMem2Dv2.h"
+#include "SimdDefs.h"
 
 /*
 ---------------------------------------------------------------------------
@@ -77,6 +78,237 @@ int OverlayMem2Dv2::OM2DV2_Tp[17] = {0, 0, 2, 0, 2, 1, 3, 1, 3, 0, 2, 1, 3, 0, 2
 
 #define OM2DV2_CLIP255(x)	( (((x) <= 255)&&((x) >= 0))? (x) : ( ((x) < 0)? 0:255 ) )
 
+/*
+---------------------------------------------------------------------------
+	SIMD distortion kernels.
+---------------------------------------------------------------------------
+*/
+/// The Tsd/Tad 4x4, 8x8 and 16x16 methods used by the motion estimators are 
+/// dispatched at run time to SSE2 or AVX2 kernels on x86 processors. The sums are
+/// integer and therefore bit-exact with the scalar code for sample differences 
+/// that fit in 16 bits. The LessThan kernels test for an early exit every 4 rows
+/// and may return a larger value than the scalar code, but only when it already
+/// exceeds min.
+#if defined(RTVC_SIMD_AVX2) && defined(__GNUC__)
+#define OM2DV2_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define OM2DV2_TARGET_AVX2
+#endif
+
+static int OM2DV2_DetectSimdLevel(void)
+{
+	int level = OverlayMem2Dv2::SIMD_NONE;
+#ifdef RTVC_SIMD_DISPATCH
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int maxId = info[0];
+	__cpuid(info, 1);
+	if(info[3] & (1 << 26))
+		level = OverlayMem2Dv2::SIMD_SSE2;
+#ifdef RTVC_SIMD_AVX2
+	/// The OS must also save the ymm registers.
+	if( (maxId >= 7)&&(info[2] & (1 << 27))&&((_xgetbv(0) & 6) == 6) )
+	{
+		__cpuidex(info, 7, 0);
+		if(info[1] & (1 << 5))
+			level = OverlayMem2Dv2::SIMD_AVX2;
+	}//end if maxId...
+#endif
+#else
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("sse2"))
+		level = OverlayMem2Dv2::SIMD_SSE2;
+#ifdef RTVC_SIMD_AVX2
+	if(__builtin_cpu_supports("avx2"))
+		level = OverlayMem2Dv2::SIMD_AVX2;
+#endif
+#endif	// _MSC_VER
+#endif	// RTVC_SIMD_DISPATCH
+	return(level);
+}//end OM2DV2_DetectSimdLevel.
+
+int OverlayMem2Dv2::OM2DV2_SimdDetected	= OM2DV2_DetectSimdLevel();
+int OverlayMem2Dv2::OM2DV2_SimdLevel		= OverlayMem2Dv2::OM2DV2_SimdDetected;
+
+#ifdef RTVC_SIMD_DISPATCH
+
+static inline int OM2DV2_HSum32(__m128i v)
+{
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0x4E));
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0xB1));
+	return(_mm_cvtsi128_si32(v));
+}//end OM2DV2_HSum32.
+
+/// Load 4 or 8 samples from a row.
+static inline __m128i OM2DV2_Load(const short* p, int width)
+{
+	if(width == 4)
+		return(_mm_loadl_epi64((const __m128i *)p));
+	return(_mm_loadu_si128((const __m128i *)p));
+}//end OM2DV2_Load.
+
+/** Total square or absolute difference of width x height blocks with SSE2.
+@param pA, ax, ay	: Rows and origin of the first block.
+@param pB, bx, by	: Rows and origin of the second block.
+@param width			: 4, 8 or 16.
+@param height			: Rows.
+@param absDiff		: 1 = absolute diff, 0 = square diff.
+@param min				: Early exit value when earlyExit is set.
+@param earlyExit	: Test against min every 4 rows.
+@return						: Total diff.
+*/
+static int OM2DV2_TdSse2(short** pA, int ax, int ay, short** pB, int bx, int by, 
+												 int width, int height, int absDiff, int min, int earlyExit)
+{
+	__m128i acc		= _mm_setzero_si128();
+	__m128i ones	= _mm_set1_epi16(1);
+	for(int row = 0; row < height; row++)
+	{
+		const short* a = &(pA[ay + row][ax]);
+		const short* b = &(pB[by + row][bx]);
+		for(int col = 0; col < width; col += 8)
+		{
+			__m128i x = OM2DV2_Load(&(a[col]), width);
+			__m128i y = OM2DV2_Load(&(b[col]), width);
+			if(absDiff)
+			{
+				__m128i d = _mm_sub_epi16(_mm_max_epi16(x, y), _mm_min_epi16(x, y));
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(d, ones));
+			}//end if absDiff...
+			else
+			{
+				__m128i d = _mm_sub_epi16(x, y);
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+			}//end else...
+		}//end for col...
+
+		if( earlyExit && ((row & 3) == 3) )
+		{
+			int sum = OM2DV2_HSum32(acc);
+			if(sum > min)
+				return(sum);
+		}//end if earlyExit...
+	}//end for row...
+
+	return(OM2DV2_HSum32(acc));
+}//end OM2DV2_TdSse2.
+
+/** Partial square difference of square blocks with SSE2.
+The scalar PartialLessThan methods sum 16 sub-sampled partials in the order
+of (Sp[p],Tp[p]) phases. Here all 4 col phases of a row phase are summed
+together when the row phase is first required and the partials are then
+tested in the same order to give identical results.
+@param size	: 8 or 16.
+@return			: As for the scalar PartialLessThan methods.
+*/
+static int OM2DV2_TsdPartialSse2(short** pA, int ax, int ay, short** pB, int bx, int by, 
+																 int size, int min, int* Sp, int* Tp)
+{
+	int ps[4][4];	///< [row phase][col phase] partials.
+	int done[4]	= {0, 0, 0, 0};
+	int Dp			= 0;
+
+	for(int p = 1; p <= 16; p++)
+	{
+		int t = Tp[p];
+		if(!done[t])
+		{
+			__m128i acc = _mm_setzero_si128();
+			for(int row = t; row < size; row += 4)
+			{
+				const short* a = &(pA[ay + row][ax]);
+				const short* b = &(pB[by + row][bx]);
+				for(int col = 0; col < size; col += 8)
+				{
+					__m128i d = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)&(a[col])), _mm_loadu_si128((const __m128i *)&(b[col])));
+					/// Pair cols of the same phase: d0,d4,d1,d5,d2,d6,d3,d7.
+					d = _mm_unpacklo_epi16(d, _mm_srli_si128(d, 8));
+					acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+				}//end for col...
+			}//end for row...
+			_mm_storeu_si128((__m128i *)ps[t], acc);
+			done[t] = 1;
+		}//end if !done...
+
+		Dp += ps[t][Sp[p]];
+		if( (Dp << 4) > (p * min) )
+			return( Dp << 4 );
+	}//end for p...
+
+	return(Dp);
+}//end OM2DV2_TsdPartialSse2.
+
+#ifdef RTVC_SIMD_AVX2
+/** Total square or absolute difference of 16x16 blocks with AVX2.
+Params as for OM2DV2_TdSse2().
+*/
+OM2DV2_TARGET_AVX2 static int OM2DV2_Td16x16Avx2(short** pA, int ax, int ay, short** pB, int bx, int by, 
+																								 int absDiff, int min, int earlyExit)
+{
+	__m256i acc		= _mm256_setzero_si256();
+	__m256i ones	= _mm256_set1_epi16(1);
+	for(int row = 0; row < 16; row++)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i *)&(pA[ay + row][ax]));
+		__m256i y = _mm256_loadu_si256((const __m256i *)&(pB[by + row][bx]));
+		if(absDiff)
+		{
+			__m256i d = _mm256_sub_epi16(_mm256_max_epi16(x, y), _mm256_min_epi16(x, y));
+			acc = _mm256_add_epi32(acc, _mm256_madd_epi16(d, ones));
+		}//end if absDiff...
+		else
+		{
+			__m256i d = _mm256_sub_epi16(x, y);
+			acc = _mm256_add_epi32(acc, _mm256_madd_epi16(d, d));
+		}//end else...
+
+		if( earlyExit && ((row & 3) == 3) )
+		{
+			__m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+			s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+			s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+			int sum = _mm_cvtsi128_si32(s);
+			if(sum > min)
+				return(sum);
+		}//end if earlyExit...
+	}//end for row...
+
+	__m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+	s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+	s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+	return(_mm_cvtsi128_si32(s));
+}//end OM2DV2_Td16x16Avx2.
+#endif	// RTVC_SIMD_AVX2
+
+#endif	// RTVC_SIMD_DISPATCH
+
+/// Dispatch to the widest available kernel. The calling method returns the kernel result.
+#ifdef RTVC_SIMD_DISPATCH
+#define RTVC_SIMD_DISPATCH_TD(w, h, absDiff, min, earlyExit) \
+	if(OM2DV2_SimdLevel >= SIMD_SSE2) \
+		return( OM2DV2_TdSse2(me._pBlock, me._xPos, me._yPos, b.Get2DSrcPtr(), b._xPos, b._yPos, w, h, absDiff, min, earlyExit) );
+#else
+#define RTVC_SIMD_DISPATCH_TD(w, h, absDiff, min, earlyExit)
+#endif
+
+#ifdef RTVC_SIMD_AVX2
+#define RTVC_SIMD_DISPATCH_TD16X16(absDiff, min, earlyExit) \
+	if(OM2DV2_SimdLevel >= SIMD_AVX2) \
+		return( OM2DV2_Td16x16Avx2(me._pBlock, me._xPos, me._yPos, b.Get2DSrcPtr(), b._xPos, b._yPos, absDiff, min, earlyExit) ); \
+	RTVC_SIMD_DISPATCH_TD(16, 16, absDiff, min, earlyExit)
+#else
+#define RTVC_SIMD_DISPATCH_TD16X16(absDiff, min, earlyExit) RTVC_SIMD_DISPATCH_TD(16, 16, absDiff, min, earlyExit)
+#endif
+
+#ifdef RTVC_SIMD_DISPATCH
+#define RTVC_SIMD_DISPATCH_TSDPARTIAL(size, min) \
+	if(OM2DV2_SimdLevel >= SIMD_SSE2) \
+		return( OM2DV2_TsdPartialSse2(me._pBlock, me._xPos, me._yPos, b.Get2DSrcPtr(), b._xPos, b._yPos, size, min, OM2DV2_Sp, OM2DV2_Tp) );
+#else
+#define RTVC_SIMD_DISPATCH_TSDPARTIAL(size, min)
+#endif
+
 /*
 ---------------------------------------------------------------------------
 	Construction, initialisation and destruction.
@@ -1608,6 +1840,8 @@ so use with caution.
 */
 int OverlayMem2Dv2::Tsd4x4(OverlayMem2Dv2& me, OverlayMem2Dv2& b)
 {
+	RTVC_SIMD_DISPATCH_TD(4, 4, 0, 0, 0)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -1652,6 +1886,8 @@ so use with caution.
 */
 int OverlayMem2Dv2::Tsd8x8(OverlayMem2Dv2& me, OverlayMem2Dv2& b)
 {
+	RTVC_SIMD_DISPATCH_TD(8, 8, 0, 0, 0)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -1708,6 +1944,8 @@ so use with caution.
 */
 int OverlayMem2Dv2::Tsd16x16(OverlayMem2Dv2& me, OverlayMem2Dv2& b)
 {
+	RTVC_SIMD_DISPATCH_TD16X16(0, 0, 0)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -1824,6 +2062,8 @@ with caution for speed with unrolled inner loop.
 */
 int OverlayMem2Dv2::Tsd4x4LessThan(OverlayMem2Dv2& me, OverlayMem2Dv2& b, int min)
 {
+	RTVC_SIMD_DISPATCH_TD(4, 4, 0, min, 1)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -1912,6 +2152,8 @@ with caution for speed with unrolled inner loop.
 */
 int OverlayMem2Dv2::Tsd8x8LessThan(OverlayMem2Dv2& me, OverlayMem2Dv2& b, int min)
 {
+	RTVC_SIMD_DISPATCH_TD(8, 8, 0, min, 1)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -1971,6 +2213,8 @@ int OverlayMem2Dv2::Tsd8x8LessThan(OverlayMem2Dv2& me, OverlayMem2Dv2& b, int mi
 
 int OverlayMem2Dv2::Tsd8x8PartialLessThan(OverlayMem2Dv2& me, OverlayMem2Dv2& b, int min)
 {
+	RTVC_SIMD_DISPATCH_TSDPARTIAL(8, min)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	int Dp = 0;	/// Accumulated partial sqare error.
 
@@ -2008,6 +2252,8 @@ with caution for speed with unrolled inner loop.
 */
 int OverlayMem2Dv2::Tsd16x16LessThan(OverlayMem2Dv2& me, OverlayMem2Dv2& b, int min)
 {
+	RTVC_SIMD_DISPATCH_TD16X16(0, min, 1)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -2107,6 +2353,8 @@ with caution for speed with unrolled inner loop.
 */
 int OverlayMem2Dv2::Tsd16x16PartialLessThan(OverlayMem2Dv2& me, OverlayMem2Dv2& b, int min)
 {
+	RTVC_SIMD_DISPATCH_TSDPARTIAL(16, min)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	int Dp = 0;	/// Accumulated partial square error.
 
@@ -2171,6 +2419,8 @@ so use with caution.
 */
 int OverlayMem2Dv2::Tad4x4(OverlayMem2Dv2& me, OverlayMem2Dv2& b)
 {
+	RTVC_SIMD_DISPATCH_TD(4, 4, 1, 0, 0)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -2215,6 +2465,8 @@ so use with caution.
 */
 int OverlayMem2Dv2::Tad8x8(OverlayMem2Dv2& me, OverlayMem2Dv2& b)
 {
+	RTVC_SIMD_DISPATCH_TD(8, 8, 1, 0, 0)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -2271,6 +2523,8 @@ so use with caution.
 */
 int OverlayMem2Dv2::Tad16x16(OverlayMem2Dv2& me, OverlayMem2Dv2& b)
 {
+	RTVC_SIMD_DISPATCH_TD16X16(1, 0, 0)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -2387,6 +2641,8 @@ with caution for speed with unrolled inner loop.
 */
 int OverlayMem2Dv2::Tad4x4LessThan(OverlayMem2Dv2& me, OverlayMem2Dv2& b, int min)
 {
+	RTVC_SIMD_DISPATCH_TD(4, 4, 1, min, 1)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -2438,6 +2694,8 @@ with caution for speed with unrolled inner loop.
 */
 int OverlayMem2Dv2::Tad8x8LessThan(OverlayMem2Dv2& me, OverlayMem2Dv2& b, int min)
 {
+	RTVC_SIMD_DISPATCH_TD(8, 8, 1, min, 1)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -2505,6 +2763,8 @@ with caution for speed with unrolled inner loop.
 */
 int OverlayMem2Dv2::Tad16x16LessThan(OverlayMem2Dv2& me, OverlayMem2Dv2& b, int min)
 {
+	RTVC_SIMD_DISPATCH_TD16X16(1, min, 1)
+
 	short**	bPtr	= b.Get2DSrcPtr();
 	short*	pP;
 	short*	pI;
@@ -2630,17 +2890,20 @@ ASSUMPTION: All values are positive.
 @param dstPtr		: 2D addressable dstPtr[srcHeight/2 + heightOff][srcWidth/2 + widthOff].
 @param widthOff	: X offset into dst.
 @param heightOff: Y offset into dst.
+@param srcWidthOff	: X offset into src.
+@param srcHeightOff	: Y offset into src.
 @return					: none.
 */
 void OverlayMem2Dv2::Half(void** srcPtr, int srcWidth, int srcHeight, 
-												void** dstPtr, int widthOff, int heightOff)
+												void** dstPtr, int widthOff, int heightOff,
+												int srcWidthOff, int srcHeightOff)
 {
 	short** ppS = (short **)(srcPtr);
 	short** ppD = (short **)(dstPtr);
 
 	int m,n,x,y;
-  for(m = 0, y = heightOff; m < srcHeight; m += 2, y++)
-		for(n = 0, x = widthOff; n < srcWidth; n += 2, x++)
+  for(m = srcHeightOff, y = heightOff; m < (srcHeight + srcHeightOff); m += 2, y++)
+		for(n = srcWidthOff, x = widthOff; n < (srcWidth + srcWidthOff); n += 2, x++)
   {
 		ppD[y][x] = (ppS[m][n] + ppS[m][n+1] + ppS[m+1][n] + ppS[m+1][n+1] + 2) >> 2;
 	}//end for m & n...
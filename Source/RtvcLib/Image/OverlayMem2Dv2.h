@@ -281,14 +281,26 @@ public:
 
 	/// Static independent helper functions.
 public:
-	/// Sub sample the src by half into another 2D mem block with possible offset.
+	/// Sub sample the src by half into another 2D mem block with possible offsets.
 	static void Half(void**	srcPtr, int srcWidth,			int srcHeight,
-									 void** dstPtr, int widthOff = 0, int heightOff = 0);
+									 void** dstPtr, int widthOff = 0, int heightOff = 0,
+									 int srcWidthOff = 0, int srcHeightOff = 0);
+
+	/// SIMD levels for the 4x4, 8x8 and 16x16 Tsd/Tad methods. The level is detected 
+	/// at start up and may only be lowered from the detected level.
+	static const int SIMD_NONE	= 0;
+	static const int SIMD_SSE2	= 1;
+	static const int SIMD_AVX2	= 2;
+	static int	GetSimdLevel(void) { return(OM2DV2_SimdLevel); }
+	static int	SetSimdLevel(int level)
+		{ OM2DV2_SimdLevel = (level < OM2DV2_SimdDetected)? level : OM2DV2_SimdDetected; return(OM2DV2_SimdLevel); }
 
 protected:
 	/// Class constants
 	static int OM2DV2_Sp[17];
 	static int OM2DV2_Tp[17];
+	static int OM2DV2_SimdDetected;
+	static int OM2DV2_SimdLevel;
 
 protected:
 	int					_width;				///< Overlay mem width and height.
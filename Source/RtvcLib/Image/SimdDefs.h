@@ -0,0 +1,58 @@
+/** @file
+
+MODULE				: SimdDefs
+
+TAG						: SIMD
+
+FILE NAME			: SimdDefs.h
+
+DESCRIPTION		: The single compile time gate for the SSE2 and AVX2 code
+								paths in the image and codec modules. Define RTVC_NO_SIMD
+								to build the scalar code only everywhere.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+#ifndef _SIMDDEFS_H
+#define _SIMDDEFS_H
+
+/// RTVC_SIMD: SSE2 is part of the target instruction set and may be used
+/// unconditionally. This is always so for x64 and requires /arch:SSE2 for 32 bit
+/// MSVC builds and -msse2 for 32 bit gcc builds.
+#if !defined(RTVC_NO_SIMD) && ( defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__) )
+#define RTVC_SIMD
+#include <emmintrin.h>
+#endif
+
+/// RTVC_SIMD_DISPATCH: SSE2 and AVX2 kernels may be compiled for code that tests 
+/// the processor at run time before calling them. All MSVC x86 targets qualify.
+/// RTVC_SIMD_AVX2 is defined where the compiler has the AVX2 intrinsics (VS2013).
+#if !defined(RTVC_NO_SIMD) && ( defined(RTVC_SIMD) || (defined(_MSC_VER) && defined(_M_IX86)) )
+#define RTVC_SIMD_DISPATCH
+#include <emmintrin.h>
+#if !defined(_MSC_VER) || (_MSC_VER >= 1800)
+#define RTVC_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif	// RTVC_SIMD_DISPATCH
+
+#endif	// _SIMDDEFS_H
@@ -0,0 +1,72 @@
+/** @file
+
+MODULE				: MonotonicClock
+
+TAG						: MC
+
+FILE NAME			: MonotonicClock.h
+
+DESCRIPTION		: A high resolution monotonic clock for measuring elapsed time.
+								The Windows performance counter is used on Windows and the
+								POSIX CLOCK_MONOTONIC clock elsewhere. The methods hold no
+								state and may be called from any thread.
+
+LICENSE	: GNU Lesser General Public License
+
+Copyright (c) 2008 - 2013, CSIR
+All rights reserved.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+class MonotonicClock
+{
+public:
+
+  /// Ticks per second. 0 if there is no monotonic clock.
+  static long long GetFrequency()
+  {
+#ifdef _WIN32
+    LARGE_INTEGER li;
+    if(!QueryPerformanceFrequency(&li)) return 0;
+    return li.QuadPart;
+#else
+    struct timespec ts;
+    if(clock_gettime(CLOCK_MONOTONIC, &ts) != 0) return 0;
+    return 1000000000LL;
+#endif
+  }
+
+  /// Current tick count from an arbitrary fixed origin.
+  static long long GetTicks()
+  {
+#ifdef _WIN32
+    LARGE_INTEGER li;
+    QueryPerformanceCounter(&li);
+    return li.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((long long)ts.tv_sec * 1000000000LL) + (long long)ts.tv_nsec;
+#endif
+  }
+};
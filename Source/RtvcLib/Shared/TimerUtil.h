@@ -1,6 +1,6 @@
 #pragma once
 
-#include <windows.h>
+#include "MonotonicClock.h"
 
 class TimerUtil
 {
@@ -16,24 +16,21 @@ public:
 
   void start()
   {
-    LARGE_INTEGER li;
-    if(!QueryPerformanceFrequency(&li)) return;
-      //cout << "QueryPerformanceFrequency failed!\n";
+    long long freq = MonotonicClock::GetFrequency();
+    if(!freq) return;
+      //cout << "No monotonic clock!\n";
 
-    m_dPCFreq = double(li.QuadPart)/1000.0;
+    m_dPCFreq = double(freq)/1000.0;
 
-    QueryPerformanceCounter(&li);
-    m_tStart = li.QuadPart;
+    m_tStart = MonotonicClock::GetTicks();
   }
 
   double stop()
   {
-    LARGE_INTEGER li;
-    QueryPerformanceCounter(&li);
-    return double(li.QuadPart-m_tStart)/m_dPCFreq;
+    return double(MonotonicClock::GetTicks()-m_tStart)/m_dPCFreq;
   }
 
 private:
   double m_dPCFreq;
-  __int64 m_tStart;
+  long long m_tStart;
 };